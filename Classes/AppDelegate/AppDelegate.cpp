@@ -4,7 +4,10 @@
 #include "AppDelegate.h"
 #include "Scene/StartupScene.h"
 #include "Manager/AnimationManager.h"
+#include "Manager/AtlasManager.h"
+#include "Manager/BattleEffectPool.h"
 #include "Manager/VillageDataManager.h"
+#include "Manager/VillageSaveService.h"
 #include "Manager/Resource/ResourceProductionSystem.h" // 添加此行
 
 // #define USE_AUDIO_ENGINE 1
@@ -98,14 +101,21 @@ bool AppDelegate::applicationDidFinishLaunching() {
     }
 #endif
     register_all_packages();
+
+    // 加载建筑和界面图集（未打包时回退散图）
+    AtlasManager::getInstance()->loadAtlases();
     
     // 初始化动画管理器
     auto animMgr = AnimationManager::getInstance();
     animMgr->preloadBattleAnimations();
     animMgr->initializeDefaultConfigs();
+    animMgr->preloadAnimationCache();
 
     CCLOG("AppDelegate: Animation system initialized");
 
+    // 预分配战斗特效节点
+    BattleEffectPool::getInstance()->prewarm();
+
     // 加载村庄存档数据
     VillageDataManager::getInstance()->loadFromFile("village.json");
     // loadFromFile() 内部会处理：
@@ -129,6 +139,9 @@ bool AppDelegate::applicationDidFinishLaunching() {
 void AppDelegate::applicationDidEnterBackground() {
     Director::getInstance()->stopAnimation();
 
+    // 进入后台可能被系统直接结束，立即写入未保存的修改
+    VillageSaveService::getInstance()->flush();
+
 #if USE_AUDIO_ENGINE
     AudioEngine::pauseAll();
 #elif USE_SIMPLE_AUDIO_ENGINE
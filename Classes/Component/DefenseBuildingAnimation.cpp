@@ -4,6 +4,7 @@
 #include "DefenseBuildingAnimation.h"
 #include "Sprite/BuildingSprite.h"
 #include "Util/GridMapUtils.h"
+#include "Manager/BattleEffectPool.h"
 #include <cmath>
 
 USING_NS_CC;
@@ -23,7 +24,7 @@ DefenseBuildingAnimation::DefenseBuildingAnimation()
     , _parentNode(nullptr)
     , _baseSprite(nullptr)
     , _barrelSprite(nullptr)
-    , _muzzleFlashSprite(nullptr)
+    , _aimDirection(Vec2(1.0f, 0.0f))
     , _animationOffset(Vec2::ZERO)
     , _barrelOffset(Vec2::ZERO) {}
 
@@ -163,6 +164,8 @@ void DefenseBuildingAnimation::aimAt(const Vec2& targetWorldPos) {
         return;
     }
 
+    _aimDirection = direction.getNormalized();
+
     // 计算角度
     float angleRadians = atan2(direction.y, direction.x);
     float angleDegrees = CC_RADIANS_TO_DEGREES(angleRadians);
@@ -250,7 +253,16 @@ void DefenseBuildingAnimation::playFireAnimation(const std::function<void()>& ca
 }
 
 void DefenseBuildingAnimation::playMuzzleFlash() {
-    CCLOG("DefenseBuildingAnimation: Muzzle flash played");
+    if (!_barrelSprite) return;
+
+    // 火光挂在炮管上，沿瞄准方向偏离炮管中心
+    auto flash = BattleEffectPool::getInstance()->acquireParticle(
+        BattleEffectPool::EffectType::MUZZLE_FLASH, _barrelSprite, 2);
+    if (!flash) return;
+
+    auto barrelSize = _barrelSprite->getContentSize();
+    Vec2 center(barrelSize.width / 2, barrelSize.height / 2);
+    flash->setPosition(center + _aimDirection * (barrelSize.width * 0.4f));
 }
 
 void DefenseBuildingAnimation::resetBarrel() {
@@ -55,7 +55,7 @@ private:
 
     Sprite* _baseSprite;            // 底座精灵
     Sprite* _barrelSprite;          // 炮管精灵
-    Sprite* _muzzleFlashSprite;     // 炮口火焰精灵
+    Vec2 _aimDirection;             // 最近一次瞄准方向（单位向量）
 
     Vec2 _animationOffset;          // 动画整体偏移
     Vec2 _barrelOffset;             // 炮管偏移
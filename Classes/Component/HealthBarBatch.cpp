@@ -0,0 +1,260 @@
+﻿// HealthBarBatch.cpp
+// 批量血条渲染实现，把可见血条合并为一个 TrianglesCommand 绘制
+
+#include "HealthBarBatch.h"
+
+USING_NS_CC;
+
+const char* HealthBarBatch::NODE_NAME = "HealthBarBatch";
+
+namespace {
+    // 每个血条两个四边形（背景 + 前景）
+    const int VERTICES_PER_QUAD = 4;
+    const int INDICES_PER_QUAD = 6;
+
+    // 索引为 unsigned short，限制单批顶点数
+    const size_t MAX_QUADS = 65536 / VERTICES_PER_QUAD;
+
+    const Color3B BACKGROUND_COLOR(40, 40, 40);
+    const GLubyte BACKGROUND_OPACITY = 200;
+
+    const char* WHITE_TEXTURE_KEY = "/health_bar_white_image";
+}
+
+HealthBarBatch* HealthBarBatch::create() {
+    auto batch = new (std::nothrow) HealthBarBatch();
+    if (batch && batch->init()) {
+        batch->autorelease();
+        return batch;
+    }
+    CC_SAFE_DELETE(batch);
+    return nullptr;
+}
+
+HealthBarBatch::~HealthBarBatch() {
+    CC_SAFE_RELEASE(_texture);
+}
+
+HealthBarBatch* HealthBarBatch::getFor(Node* owner) {
+    if (!owner || !owner->getParent()) return nullptr;
+    return dynamic_cast<HealthBarBatch*>(owner->getParent()->getChildByName(NODE_NAME));
+}
+
+bool HealthBarBatch::init() {
+    if (!Node::init()) {
+        return false;
+    }
+
+    this->setName(NODE_NAME);
+
+    _texture = getWhiteTexture();
+    CC_SAFE_RETAIN(_texture);
+    _blendFunc = (_texture && _texture->hasPremultipliedAlpha())
+        ? BlendFunc::ALPHA_PREMULTIPLIED : BlendFunc::ALPHA_NON_PREMULTIPLIED;
+
+    // 顶点在 CPU 端按 transform 变换，与 Sprite 使用同一着色器
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(
+        GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP));
+
+    // 只用于淡入计时
+    this->scheduleUpdate();
+
+    return true;
+}
+
+void HealthBarBatch::update(float dt) {
+    _time += dt;
+}
+
+int HealthBarBatch::addBar(Node* owner, const Config& config) {
+    if (!owner) return -1;
+
+    int handle;
+    if (!_freeSlots.empty()) {
+        handle = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        handle = static_cast<int>(_bars.size());
+        _bars.emplace_back();
+    }
+
+    // 与原血条组件一致：位于宿主顶部中心再加偏移
+    const Size& ownerSize = owner->getContentSize();
+
+    Bar& bar = _bars[handle];
+    bar = Bar();
+    bar.owner = owner;
+    bar.center = Vec2(ownerSize.width / 2 + config.offset.x, ownerSize.height + config.offset.y);
+    bar.size = Size(config.width, config.height);
+    bar.fadeInDuration = config.fadeInDuration;
+    bar.highThreshold = config.highThreshold;
+    bar.mediumThreshold = config.mediumThreshold;
+    bar.showWhenFull = config.showWhenFull;
+    bar.color = getColorForPercent(bar, 100.0f);
+
+    return handle;
+}
+
+void HealthBarBatch::removeBar(int handle) {
+    if (!isValidHandle(handle)) return;
+
+    setBarVisible(_bars[handle], false);
+    _bars[handle].owner = nullptr;
+    _freeSlots.push_back(handle);
+}
+
+void HealthBarBatch::updateHealth(int handle, int currentHP, int maxHP) {
+    if (!isValidHandle(handle)) return;
+
+    Bar& bar = _bars[handle];
+    if (currentHP == bar.lastHP && maxHP == bar.lastMaxHP) return;
+    bar.lastHP = currentHP;
+    bar.lastMaxHP = maxHP;
+
+    // 死亡或无效血量时隐藏
+    if (maxHP <= 0 || currentHP <= 0) {
+        setBarVisible(bar, false);
+        return;
+    }
+
+    float percent = (float)currentHP / (float)maxHP * 100.0f;
+    percent = std::max(0.0f, std::min(100.0f, percent));
+
+    // 满血时是否隐藏
+    if (!bar.showWhenFull && percent >= 100.0f) {
+        setBarVisible(bar, false);
+        return;
+    }
+
+    bar.fraction = percent / 100.0f;
+    bar.color = getColorForPercent(bar, percent);
+    setBarVisible(bar, true);
+}
+
+void HealthBarBatch::hideBar(int handle) {
+    if (!isValidHandle(handle)) return;
+
+    setBarVisible(_bars[handle], false);
+    // 之后再次更新血量时重新判断显示
+    _bars[handle].lastHP = -1;
+}
+
+bool HealthBarBatch::isValidHandle(int handle) const {
+    return handle >= 0 && handle < static_cast<int>(_bars.size()) && _bars[handle].owner;
+}
+
+void HealthBarBatch::setBarVisible(Bar& bar, bool visible) {
+    if (bar.visible == visible) return;
+
+    bar.visible = visible;
+    _visibleCount += visible ? 1 : -1;
+    if (visible) {
+        bar.showTime = _time;
+    }
+}
+
+void HealthBarBatch::draw(Renderer* renderer, const Mat4& transform, uint32_t flags) {
+    if (_visibleCount == 0 || !_texture) return;
+
+    _vertices.clear();
+    _indices.clear();
+
+    // 宿主与本节点同一父节点：宿主局部坐标 -> 父节点坐标 -> 本节点坐标
+    const Mat4& parentToLocal = getParentToNodeTransform();
+
+    for (const auto& bar : _bars) {
+        if (!bar.owner || !bar.visible || !bar.owner->isVisible()) continue;
+        if (_vertices.size() / VERTICES_PER_QUAD + 2 > MAX_QUADS) break;
+
+        // 淡入
+        float alpha = 1.0f;
+        if (bar.fadeInDuration > 0) {
+            alpha = std::min(1.0f, (_time - bar.showTime) / bar.fadeInDuration);
+        }
+
+        Mat4 toLocal = parentToLocal * bar.owner->getNodeToParentTransform();
+        Vec2 origin(bar.center.x - bar.size.width / 2, bar.center.y - bar.size.height / 2);
+
+        appendQuad(toLocal, origin, bar.size.width, bar.size.height,
+                   Color4B(BACKGROUND_COLOR, static_cast<GLubyte>(BACKGROUND_OPACITY * alpha)));
+        appendQuad(toLocal, origin, bar.size.width * bar.fraction, bar.size.height,
+                   Color4B(bar.color, static_cast<GLubyte>(255 * alpha)));
+    }
+
+    if (_vertices.empty()) return;
+
+    TrianglesCommand::Triangles triangles;
+    triangles.verts = _vertices.data();
+    triangles.vertCount = static_cast<int>(_vertices.size());
+    triangles.indices = _indices.data();
+    triangles.indexCount = static_cast<int>(_indices.size());
+
+    _command.init(_globalZOrder, _texture, getGLProgramState(), _blendFunc, triangles, transform, flags);
+    renderer->addCommand(&_command);
+}
+
+void HealthBarBatch::appendQuad(const Mat4& toLocal, const Vec2& origin, float width, float height, const Color4B& color) {
+    if (width <= 0 || height <= 0) return;
+
+    unsigned short base = static_cast<unsigned short>(_vertices.size());
+
+    // 顺序：左下、右下、左上、右上
+    const Vec2 corners[VERTICES_PER_QUAD] = {
+        Vec2(origin.x, origin.y),
+        Vec2(origin.x + width, origin.y),
+        Vec2(origin.x, origin.y + height),
+        Vec2(origin.x + width, origin.y + height)
+    };
+    const Tex2F texCoords[VERTICES_PER_QUAD] = {
+        Tex2F(0, 1), Tex2F(1, 1), Tex2F(0, 0), Tex2F(1, 0)
+    };
+
+    for (int i = 0; i < VERTICES_PER_QUAD; ++i) {
+        Vec3 pos(corners[i].x, corners[i].y, 0);
+        toLocal.transformPoint(&pos);
+
+        V3F_C4B_T2F vertex;
+        vertex.vertices = pos;
+        vertex.colors = color;
+        vertex.texCoords = texCoords[i];
+        _vertices.push_back(vertex);
+    }
+
+    const unsigned short quadIndices[INDICES_PER_QUAD] = { 0, 1, 2, 3, 2, 1 };
+    for (int i = 0; i < INDICES_PER_QUAD; ++i) {
+        _indices.push_back(base + quadIndices[i]);
+    }
+}
+
+Color3B HealthBarBatch::getColorForPercent(const Bar& bar, float percent) {
+    if (percent > bar.highThreshold) {
+        // 高血量：绿色
+        return Color3B(50, 205, 50);
+    } else if (percent > bar.mediumThreshold) {
+        // 中血量：黄色
+        return Color3B(255, 200, 0);
+    } else {
+        // 低血量：红色
+        return Color3B(220, 50, 50);
+    }
+}
+
+Texture2D* HealthBarBatch::getWhiteTexture() {
+    auto cache = Director::getInstance()->getTextureCache();
+    auto texture = cache->getTextureForKey(WHITE_TEXTURE_KEY);
+    if (texture) return texture;
+
+    // 2x2 纯白纹理，颜色完全由顶点色决定
+    static unsigned char whitePixels[2 * 2 * 4] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+    };
+
+    auto image = new (std::nothrow) Image();
+    if (image && image->initWithRawData(whitePixels, sizeof(whitePixels), 2, 2, 8)) {
+        texture = cache->addImage(image, WHITE_TEXTURE_KEY);
+    }
+    CC_SAFE_RELEASE(image);
+
+    return texture;
+}
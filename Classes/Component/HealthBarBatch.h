@@ -0,0 +1,105 @@
+﻿// HealthBarBatch.h
+// 批量血条渲染节点声明，一个战斗层内所有单位和建筑的血条合并为一次绘制
+
+#pragma once
+
+#include "cocos2d.h"
+#include <vector>
+
+USING_NS_CC;
+
+// 血条批量渲染节点
+// 功能：每个血条只是数组中的一项（宿主节点、锚点、尺寸、血量比例、颜色），
+//       draw 时把所有可见血条拼成四边形放进同一个 TrianglesCommand，
+//       血条数量再多也只有一次绘制调用
+// 约定：宿主节点必须与本节点同一父节点（血条按宿主变换跟随移动），
+//       宿主离开场景前需调用 removeBar 释放槽位
+class HealthBarBatch : public Node {
+public:
+    // 血条样式
+    struct Config {
+        float width;           // 血条宽度（宿主局部坐标）
+        float height;          // 血条高度（宿主局部坐标）
+        Vec2 offset;           // 相对宿主顶部中心的偏移（X, Y）
+        float highThreshold;   // 高血量阈值（%），超过此值显示绿色
+        float mediumThreshold; // 中血量阈值（%），介于此值和高阈值之间显示黄色
+        bool showWhenFull;     // 满血时是否显示
+        float fadeInDuration;  // 淡入时长（秒）
+
+        // 默认配置
+        Config() : width(40.0f), height(6.0f), offset(Vec2(0, 10)),
+                   highThreshold(60.0f), mediumThreshold(30.0f),
+                   showWhenFull(false), fadeInDuration(0.2f) {}
+    };
+
+    // 节点名称（宿主通过父节点查找批量节点）
+    static const char* NODE_NAME;
+
+    // 战斗地图层中的Z序（高于所有建筑和飞行单位）
+    static const int Z_ORDER = 5000;
+
+    static HealthBarBatch* create();
+
+    // 查找宿主所在层的批量节点，没有返回 nullptr
+    static HealthBarBatch* getFor(Node* owner);
+
+    virtual ~HealthBarBatch();
+    virtual bool init() override;
+    virtual void update(float dt) override;
+    virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags) override;
+
+    // 为宿主登记血条，返回句柄（初始隐藏）
+    int addBar(Node* owner, const Config& config);
+
+    // 释放血条槽位
+    void removeBar(int handle);
+
+    // 更新血量，只有血量变化时才重新计算比例和颜色
+    void updateHealth(int handle, int currentHP, int maxHP);
+
+    // 隐藏血条（死亡、摧毁时调用）
+    void hideBar(int handle);
+
+    // 当前显示中的血条数量
+    int getVisibleCount() const { return _visibleCount; }
+
+private:
+    // 单个血条数据
+    struct Bar {
+        Node* owner = nullptr;    // 宿主节点（为空表示空闲槽位）
+        Vec2 center;              // 血条中心（宿主局部坐标）
+        Size size;                // 血条尺寸（宿主局部坐标）
+        float fraction = 1.0f;    // 血量比例 0~1
+        Color3B color;            // 前景颜色
+        float showTime = 0.0f;    // 开始显示的时间（用于淡入）
+        float fadeInDuration = 0.0f;
+        float highThreshold = 60.0f;
+        float mediumThreshold = 30.0f;
+        bool showWhenFull = false;
+        bool visible = false;
+        int lastHP = -1;
+        int lastMaxHP = -1;
+    };
+
+    std::vector<Bar> _bars;
+    std::vector<int> _freeSlots;
+    int _visibleCount = 0;
+    float _time = 0.0f;
+
+    // 每帧重建的顶点和索引（只包含可见血条）
+    std::vector<V3F_C4B_T2F> _vertices;
+    std::vector<unsigned short> _indices;
+
+    Texture2D* _texture = nullptr;
+    BlendFunc _blendFunc;
+    TrianglesCommand _command;
+
+    bool isValidHandle(int handle) const;
+    void setBarVisible(Bar& bar, bool visible);
+
+    // 追加一个四边形（宿主局部坐标矩形经 toLocal 变换到本节点坐标）
+    void appendQuad(const Mat4& toLocal, const Vec2& origin, float width, float height, const Color4B& color);
+
+    static Color3B getColorForPercent(const Bar& bar, float percent);
+    static Texture2D* getWhiteTexture();
+};
@@ -0,0 +1,312 @@
+﻿// AttackPlanner.cpp
+// 进攻规划器实现，候选方案生成 + 多线程逐轮淘汰的蒙特卡洛评估
+
+#include "AttackPlanner.h"
+#include "../Model/BattleMapData.h"
+#include "../Util/GridMapUtils.h"
+#include "cocos2d.h"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <random>
+
+USING_NS_CC;
+
+AttackPlanner* AttackPlanner::_instance = nullptr;
+constexpr int AttackPlanner::MIN_SURVIVORS;
+
+namespace {
+
+// 长按连续放兵的间隔（与 BattleScene 的 long_press_deploy 一致）
+const float DEPLOY_INTERVAL = 0.15f;
+
+// 外围放兵点采样数量
+const int DEPLOY_POINT_SAMPLES = 32;
+
+// 候选方案的评估累计值
+struct CandidateStats {
+    double stars = 0.0;
+    double destruction = 0.0;
+    double loot = 0.0;
+    int samples = 0;
+};
+
+// 由基础种子、方案下标和采样下标生成互不相关的模拟种子
+uint32_t mixSeed(uint32_t base, uint32_t candidate, uint32_t sample) {
+    uint32_t h = base ^ (candidate * 0x9E3779B1u) ^ (sample * 0x85EBCA77u);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    return h;
+}
+
+float scoreOf(const CandidateStats& stats, int totalLootable) {
+    if (stats.samples == 0) return 0.0f;
+    double n = stats.samples;
+    double lootRatio = totalLootable > 0 ? (stats.loot / n) / totalLootable : 0.0;
+    return static_cast<float>(stats.stars / n * 100.0 + stats.destruction / n + lootRatio * 30.0);
+}
+
+} // namespace
+
+AttackPlanner* AttackPlanner::getInstance() {
+    if (!_instance) {
+        _instance = new AttackPlanner();
+    }
+    return _instance;
+}
+
+void AttackPlanner::destroyInstance() {
+    if (_instance) {
+        delete _instance;
+        _instance = nullptr;
+    }
+}
+
+AttackPlanner::~AttackPlanner() {
+    cancel();
+}
+
+// ==========================================
+// 异步接口
+// ==========================================
+
+bool AttackPlanner::requestSuggestion(const BattleMapData& mapData,
+                                      const std::map<int, int>& army,
+                                      ResultCallback callback) {
+    if (_searching) return false;
+
+    if (_searchThread.joinable()) {
+        _searchThread.join();
+    }
+
+    // 配置单例只在主线程读取，工作线程只使用快照
+    HeadlessBattleSetup setup = HeadlessBattleSim::buildSetup(mapData);
+    uint32_t seed = static_cast<uint32_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+    unsigned int generation = ++_generation;
+
+    _cancelRequested = false;
+    _searching = true;
+
+    _searchThread = std::thread([this, setup, army, seed, generation, callback]() {
+        AttackPlan plan = search(setup, army, seed);
+        if (_cancelRequested) return;
+
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread(
+            [generation, plan, callback]() {
+                auto planner = AttackPlanner::_instance;
+                if (!planner || planner->_generation != generation) return;
+                planner->_searching = false;
+                if (callback) callback(plan);
+            });
+    });
+
+    return true;
+}
+
+void AttackPlanner::cancel() {
+    _cancelRequested = true;
+    ++_generation;
+    if (_searchThread.joinable()) {
+        _searchThread.join();
+    }
+    _searching = false;
+}
+
+// ==========================================
+// 候选方案生成
+// ==========================================
+
+std::vector<std::pair<int, int>> AttackPlanner::collectDeployPoints(const HeadlessBattleSetup& setup) {
+    // 沿建筑包围盒外扩两格的矩形边界走一圈
+    int x0 = std::max(0, setup.minX - 2);
+    int y0 = std::max(0, setup.minY - 2);
+    int x1 = std::min(GridMapUtils::GRID_WIDTH - 1, setup.maxX + 2);
+    int y1 = std::min(GridMapUtils::GRID_HEIGHT - 1, setup.maxY + 2);
+
+    std::vector<std::pair<int, int>> ring;
+    for (int x = x0; x <= x1; ++x) ring.push_back({ x, y0 });
+    for (int y = y0 + 1; y <= y1; ++y) ring.push_back({ x1, y });
+    for (int x = x1 - 1; x >= x0; --x) ring.push_back({ x, y1 });
+    for (int y = y1 - 1; y > y0; --y) ring.push_back({ x0, y });
+
+    std::vector<std::pair<int, int>> valid;
+    for (const auto& p : ring) {
+        if (setup.canDeployAt(p.first, p.second)) valid.push_back(p);
+    }
+
+    if (static_cast<int>(valid.size()) <= DEPLOY_POINT_SAMPLES) return valid;
+
+    std::vector<std::pair<int, int>> sampled;
+    sampled.reserve(DEPLOY_POINT_SAMPLES);
+    for (int i = 0; i < DEPLOY_POINT_SAMPLES; ++i) {
+        sampled.push_back(valid[i * valid.size() / DEPLOY_POINT_SAMPLES]);
+    }
+    return sampled;
+}
+
+std::vector<AttackPlan> AttackPlanner::generateCandidates(const HeadlessBattleSetup& setup,
+                                                          const std::map<int, int>& army,
+                                                          uint32_t seed, int count) {
+    std::vector<AttackPlan> candidates;
+    auto points = collectDeployPoints(setup);
+    if (points.empty()) return candidates;
+
+    std::vector<int> troopOrder;
+    for (const auto& pair : army) {
+        if (pair.second > 0) troopOrder.push_back(pair.first);
+    }
+    if (troopOrder.empty()) return candidates;
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pointDist(0, points.size() - 1);
+    std::uniform_int_distribution<int> strategyDist(0, 2);
+    std::uniform_real_distribution<float> gapDist(0.0f, 4.0f);
+
+    candidates.reserve(count);
+    for (int c = 0; c < count; ++c) {
+        AttackPlan plan;
+        std::shuffle(troopOrder.begin(), troopOrder.end(), rng);
+
+        // 0 = 全部兵种同一点，1 = 每个兵种各自一点，2 = 每个兵种分两点
+        int strategy = strategyDist(rng);
+        auto mainPoint = points[pointDist(rng)];
+        float groupStart = 0.0f;
+
+        for (int troopId : troopOrder) {
+            int total = army.at(troopId);
+            auto pointA = (strategy == 0) ? mainPoint : points[pointDist(rng)];
+            auto pointB = (strategy == 2) ? points[pointDist(rng)] : pointA;
+
+            for (int i = 0; i < total; ++i) {
+                const auto& p = (i % 2 == 0) ? pointA : pointB;
+                plan.deployments.push_back({ groupStart + i * DEPLOY_INTERVAL, troopId, p.first, p.second });
+            }
+            groupStart += total * DEPLOY_INTERVAL + gapDist(rng);
+        }
+
+        candidates.push_back(std::move(plan));
+    }
+    return candidates;
+}
+
+// ==========================================
+// 并行评估
+// ==========================================
+
+AttackPlan AttackPlanner::search(const HeadlessBattleSetup& setup,
+                                 const std::map<int, int>& army,
+                                 uint32_t seed) {
+    auto startTime = std::chrono::steady_clock::now();
+    auto elapsed = [&startTime]() {
+        return std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+    };
+
+    std::vector<AttackPlan> candidates = generateCandidates(setup, army, seed, CANDIDATE_COUNT);
+    if (candidates.empty()) return AttackPlan();
+
+    std::vector<CandidateStats> stats(candidates.size());
+    std::vector<int> survivors(candidates.size());
+    std::iota(survivors.begin(), survivors.end(), 0);
+
+    int samplesPerRound = 1;
+    int totalSims = 0;
+    int round = 0;
+
+    // 逐轮淘汰：每轮对存活方案加倍采样，然后保留评分较高的一半
+    while (!_cancelRequested) {
+        float roundStart = elapsed();
+        int jobs = static_cast<int>(survivors.size()) * samplesPerRound;
+        std::vector<SimResult> results(jobs);
+
+        HeadlessBattleSim::parallelFor(jobs, [&](int job) {
+            if (_cancelRequested) return;
+            int candidate = survivors[job / samplesPerRound];
+            uint32_t sample = static_cast<uint32_t>(stats[candidate].samples + job % samplesPerRound);
+            results[job] = HeadlessBattleSim::run(setup, candidates[candidate].deployments,
+                                                  mixSeed(seed, candidate, sample));
+        });
+
+        for (int job = 0; job < jobs; ++job) {
+            auto& s = stats[survivors[job / samplesPerRound]];
+            s.stars += results[job].stars;
+            s.destruction += results[job].destruction;
+            s.loot += results[job].lootedGold + results[job].lootedElixir;
+            s.samples++;
+        }
+        totalSims += jobs;
+        round++;
+
+        std::sort(survivors.begin(), survivors.end(), [&](int a, int b) {
+            return scoreOf(stats[a], setup.totalLootable) > scoreOf(stats[b], setup.totalLootable);
+        });
+
+        if (static_cast<int>(survivors.size()) <= MIN_SURVIVORS) break;
+        // 下一轮的模拟次数与本轮相同，预计超出预算时提前结束
+        float now = elapsed();
+        if (now + (now - roundStart) >= TIME_BUDGET) break;
+
+        survivors.resize(std::max(MIN_SURVIVORS, static_cast<int>(survivors.size()) / 2));
+        samplesPerRound *= 2;
+    }
+
+    int bestIndex = survivors.front();
+    const auto& best = stats[bestIndex];
+
+    AttackPlan plan = candidates[bestIndex];
+    plan.samples = best.samples;
+    if (best.samples > 0) {
+        plan.expectedStars = static_cast<float>(best.stars / best.samples);
+        plan.expectedDestruction = static_cast<float>(best.destruction / best.samples);
+        plan.expectedLoot = static_cast<float>(best.loot / best.samples);
+    }
+    plan.score = scoreOf(best, setup.totalLootable);
+
+    CCLOG("AttackPlanner: %d simulations in %d rounds, %.3fs, best plan %.2f stars / %.1f%% / loot %.0f",
+          totalSims, round, elapsed(), plan.expectedStars, plan.expectedDestruction, plan.expectedLoot);
+
+    return plan;
+}
+
+// ==========================================
+// 性能测试
+// ==========================================
+
+SimBenchmarkResult AttackPlanner::runBenchmark(const BattleMapData& mapData,
+                                               const std::map<int, int>& army,
+                                               int simulationCount) {
+    SimBenchmarkResult result;
+    result.simulations = simulationCount;
+    result.threads = HeadlessBattleSim::getWorkerCount();
+
+    HeadlessBattleSetup setup = HeadlessBattleSim::buildSetup(mapData);
+    auto candidates = generateCandidates(setup, army, 12345u, 64);
+    if (candidates.empty() || simulationCount <= 0) {
+        CCLOG("AttackPlanner: Benchmark skipped (no army or no deploy points)");
+        return result;
+    }
+
+    auto runOne = [&](int i) {
+        const auto& plan = candidates[i % candidates.size()];
+        HeadlessBattleSim::run(setup, plan.deployments, mixSeed(12345u, i, 0));
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < simulationCount; ++i) {
+        runOne(i);
+    }
+    double singleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    HeadlessBattleSim::parallelFor(simulationCount, runOne);
+    double parallelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (singleSeconds > 0.0) result.singleThreadSimsPerSecond = simulationCount / singleSeconds;
+    if (parallelSeconds > 0.0) result.parallelSimsPerSecond = simulationCount / parallelSeconds;
+
+    CCLOG("AttackPlanner: Benchmark %d sims - 1 thread: %.0f sims/s, %d threads: %.0f sims/s",
+          simulationCount, result.singleThreadSimsPerSecond, result.threads, result.parallelSimsPerSecond);
+
+    return result;
+}
@@ -0,0 +1,90 @@
+﻿// AttackPlanner.h
+// 进攻规划器声明，用多线程无界面模拟评估大量部署方案，给出期望星数和掠夺最高的方案
+
+#ifndef __ATTACK_PLANNER_H__
+#define __ATTACK_PLANNER_H__
+
+#include "HeadlessBattleSim.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <thread>
+#include <vector>
+
+struct BattleMapData;
+
+// 部署方案及其评估结果
+struct AttackPlan {
+    std::vector<SimDeployment> deployments;
+    float expectedStars = 0.0f;
+    float expectedDestruction = 0.0f;   // 期望摧毁百分比
+    float expectedLoot = 0.0f;          // 期望掠夺资源总量
+    float score = 0.0f;                 // 综合评分（星数优先，其次摧毁率和掠夺）
+    int samples = 0;                    // 实际模拟次数
+};
+
+// 模拟性能测试结果
+struct SimBenchmarkResult {
+    int simulations = 0;
+    int threads = 0;
+    double singleThreadSimsPerSecond = 0.0;
+    double parallelSimsPerSecond = 0.0;
+};
+
+// 进攻规划器类
+// 职责：生成候选部署方案（放兵点 x 时间 x 兵种顺序），在线程池上并行蒙特卡洛评估，
+//       按轮次淘汰较差的一半（逐轮加倍采样），在时间预算内返回最优方案
+class AttackPlanner {
+public:
+    using ResultCallback = std::function<void(const AttackPlan&)>;
+
+    static constexpr int CANDIDATE_COUNT = 1024;    // 初始候选方案数
+    static constexpr int MIN_SURVIVORS = 4;         // 淘汰到剩余该数量时停止
+    static constexpr float TIME_BUDGET = 0.9f;      // 搜索时间预算（秒）
+
+    static AttackPlanner* getInstance();
+    static void destroyInstance();
+
+    // 异步搜索最优方案（必须在主线程调用），结果回调在主线程执行
+    // 已有搜索进行中时返回 false
+    bool requestSuggestion(const BattleMapData& mapData,
+                           const std::map<int, int>& army,
+                           ResultCallback callback);
+
+    // 取消进行中的搜索，已排队的回调不再执行（场景退出时调用）
+    void cancel();
+
+    bool isSearching() const { return _searching; }
+
+    // 同步搜索（不访问单例，可在任意线程调用）
+    AttackPlan search(const HeadlessBattleSetup& setup,
+                      const std::map<int, int>& army,
+                      uint32_t seed);
+
+    // 模拟吞吐量测试：分别用单线程和全部线程运行 simulationCount 次模拟（必须在主线程调用）
+    SimBenchmarkResult runBenchmark(const BattleMapData& mapData,
+                                    const std::map<int, int>& army,
+                                    int simulationCount);
+
+private:
+    AttackPlanner() = default;
+    ~AttackPlanner();
+
+    static AttackPlanner* _instance;
+
+    // 沿防守方外围收集可放兵的格子
+    static std::vector<std::pair<int, int>> collectDeployPoints(const HeadlessBattleSetup& setup);
+
+    // 随机生成候选方案
+    static std::vector<AttackPlan> generateCandidates(const HeadlessBattleSetup& setup,
+                                                      const std::map<int, int>& army,
+                                                      uint32_t seed, int count);
+
+    std::thread _searchThread;
+    std::atomic<bool> _searching{ false };
+    std::atomic<bool> _cancelRequested{ false };
+    unsigned int _generation = 0;   // 只在主线程读写，用于丢弃过期回调
+};
+
+#endif // __ATTACK_PLANNER_H__
@@ -0,0 +1,159 @@
+﻿// BattleEventBus.cpp
+// 战斗事件总线实现，固定容量环形队列（满时转存溢出队列）+ 按类型掩码分发
+
+#include "BattleEventBus.h"
+#include "cocos2d.h"
+#include <algorithm>
+
+BattleEventBus* BattleEventBus::_instance = nullptr;
+
+BattleEventBus* BattleEventBus::getInstance() {
+    if (!_instance) {
+        _instance = new BattleEventBus();
+    }
+    return _instance;
+}
+
+void BattleEventBus::destroyInstance() {
+    if (_instance) {
+        delete _instance;
+        _instance = nullptr;
+    }
+}
+
+BattleEventBus::BattleEventBus() {
+    _subscriptions.reserve(8);
+}
+
+// ==========================================
+// 投递事件
+// ==========================================
+
+void BattleEventBus::post(const BattleEvent& event) {
+    // 环形队列已满或溢出队列中还有事件时追加到溢出队列，分发时按顺序接在环形队列之后
+    if (_count == CAPACITY || !_overflow.empty()) {
+        if (_overflow.empty()) {
+            CCLOG("BattleEventBus: WARNING - queue full (%zu events), spilling to overflow queue", CAPACITY);
+        }
+        _overflow.push_back(event);
+        return;
+    }
+
+    _ring[(_head + _count) % CAPACITY] = event;
+    _count++;
+}
+
+void BattleEventBus::postBuildingDamaged(int buildingId, int buildingType, int damage) {
+    post({ BattleEventType::BUILDING_DAMAGED, buildingId, buildingType, damage, 0.0f });
+}
+
+void BattleEventBus::postBuildingDestroyed(int buildingId, int buildingType) {
+    post({ BattleEventType::BUILDING_DESTROYED, buildingId, buildingType, 0, 0.0f });
+}
+
+void BattleEventBus::postTargetLocked(int buildingId) {
+    post({ BattleEventType::UNIT_TARGET_LOCKED, buildingId, 0, 0, 0.0f });
+}
+
+void BattleEventBus::postProgress(float progress, int stars) {
+    post({ BattleEventType::DESTRUCTION_PROGRESS, -1, 0, stars, progress });
+}
+
+void BattleEventBus::postStarAwarded(int starIndex) {
+    post({ BattleEventType::STAR_AWARDED, -1, 0, starIndex, 0.0f });
+}
+
+// ==========================================
+// 订阅管理
+// ==========================================
+
+int BattleEventBus::subscribe(uint32_t typeMask, Handler handler) {
+    int id = _nextSubscriptionId++;
+
+    // 分发期间新增的订阅先暂存，避免正在调用的回调所在的容器扩容
+    if (_isDispatching) {
+        _pendingSubscriptions.push_back({ id, typeMask, std::move(handler) });
+    } else {
+        _subscriptions.push_back({ id, typeMask, std::move(handler) });
+    }
+    return id;
+}
+
+void BattleEventBus::unsubscribe(int subscriptionId) {
+    for (auto& sub : _subscriptions) {
+        if (sub.id == subscriptionId) {
+            // 只清空掩码做标记：回调可能正在执行，分发结束后再统一移除
+            sub.mask = 0;
+            _hasCancelledSubscriptions = true;
+            break;
+        }
+    }
+
+    auto pendingIt = std::remove_if(_pendingSubscriptions.begin(), _pendingSubscriptions.end(),
+                                    [subscriptionId](const Subscription& sub) { return sub.id == subscriptionId; });
+    _pendingSubscriptions.erase(pendingIt, _pendingSubscriptions.end());
+
+    if (!_isDispatching) {
+        removeCancelledSubscriptions();
+    }
+}
+
+void BattleEventBus::removeCancelledSubscriptions() {
+    if (!_hasCancelledSubscriptions) return;
+
+    _subscriptions.erase(
+        std::remove_if(_subscriptions.begin(), _subscriptions.end(),
+                       [](const Subscription& sub) { return sub.mask == 0; }),
+        _subscriptions.end());
+    _hasCancelledSubscriptions = false;
+}
+
+// ==========================================
+// 分发
+// ==========================================
+
+void BattleEventBus::dispatchPending() {
+    if (_isDispatching) return;
+    _isDispatching = true;
+
+    while (_count > 0 || !_overflow.empty()) {
+        if (_count == 0) {
+            refillFromOverflow();
+        }
+
+        BattleEvent event = _ring[_head];
+        _head = (_head + 1) % CAPACITY;
+        _count--;
+
+        uint32_t mask = maskOf(event.type);
+
+        for (size_t i = 0; i < _subscriptions.size(); ++i) {
+            if (_subscriptions[i].mask & mask) {
+                _subscriptions[i].handler(event);
+            }
+        }
+    }
+
+    _isDispatching = false;
+    removeCancelledSubscriptions();
+
+    for (auto& sub : _pendingSubscriptions) {
+        _subscriptions.push_back(std::move(sub));
+    }
+    _pendingSubscriptions.clear();
+}
+
+void BattleEventBus::refillFromOverflow() {
+    size_t moved = std::min(CAPACITY - _count, _overflow.size());
+    for (size_t i = 0; i < moved; ++i) {
+        _ring[(_head + _count) % CAPACITY] = _overflow[i];
+        _count++;
+    }
+    _overflow.erase(_overflow.begin(), _overflow.begin() + moved);
+}
+
+void BattleEventBus::clear() {
+    _head = 0;
+    _count = 0;
+    _overflow.clear();
+}
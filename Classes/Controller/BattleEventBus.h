@@ -0,0 +1,95 @@
+﻿// BattleEventBus.h
+// 战斗事件总线声明，以枚举事件ID + POD数据的环形队列替代字符串自定义事件
+
+#ifndef __BATTLE_EVENT_BUS_H__
+#define __BATTLE_EVENT_BUS_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 战斗事件类型
+enum class BattleEventType : uint8_t {
+    BUILDING_DAMAGED,       // 建筑受到伤害（value = 实际伤害）
+    BUILDING_DESTROYED,     // 建筑被摧毁（含陷阱爆炸）
+    UNIT_TARGET_LOCKED,     // 兵种锁定目标建筑
+    DESTRUCTION_PROGRESS,   // 摧毁进度更新（progress / value = 星数）
+    STAR_AWARDED,           // 获得星星（value = 星星索引 0/1/2）
+    COUNT
+};
+
+// 战斗事件数据（POD，按值存入环形队列，不持有任何指针）
+struct BattleEvent {
+    BattleEventType type;
+    int buildingId;     // 相关建筑ID，无则为 -1
+    int buildingType;   // 相关建筑类型，无则为 0
+    int value;          // 伤害值 / 星数 / 星星索引
+    float progress;     // 摧毁进度百分比
+};
+
+// 战斗事件总线类
+// 职责：收集一帧内的战斗事件，由 BattleScene 每帧统一分发一次，保证事件顺序确定
+class BattleEventBus {
+public:
+    using Handler = std::function<void(const BattleEvent&)>;
+
+    static constexpr size_t CAPACITY = 512;     // 环形队列容量（超出部分进入溢出队列，不丢弃）
+
+    static BattleEventBus* getInstance();
+    static void destroyInstance();
+
+    // 事件类型掩码
+    static uint32_t maskOf(BattleEventType type) { return 1u << static_cast<uint32_t>(type); }
+
+    // 投递事件（仅写入队列，不立即分发；环形队列满时写入溢出队列，保持先后顺序）
+    void post(const BattleEvent& event);
+    void postBuildingDamaged(int buildingId, int buildingType, int damage);
+    void postBuildingDestroyed(int buildingId, int buildingType);
+    void postTargetLocked(int buildingId);
+    void postProgress(float progress, int stars);
+    void postStarAwarded(int starIndex);
+
+    // 订阅指定类型掩码的事件，返回订阅ID
+    int subscribe(uint32_t typeMask, Handler handler);
+    void unsubscribe(int subscriptionId);
+
+    // 分发队列中的全部事件（分发期间新投递的事件在同一轮按顺序分发）
+    void dispatchPending();
+
+    // 丢弃未分发的事件（战斗开始时调用）
+    void clear();
+
+    size_t getPendingCount() const { return _count + _overflow.size(); }
+
+private:
+    BattleEventBus();
+    ~BattleEventBus() = default;
+
+    static BattleEventBus* _instance;
+
+    struct Subscription {
+        int id;
+        uint32_t mask;
+        Handler handler;
+    };
+
+    void removeCancelledSubscriptions();
+
+    // 环形队列取空后，把溢出队列中最早的事件移回环形队列
+    void refillFromOverflow();
+
+    std::array<BattleEvent, CAPACITY> _ring;  // 环形队列
+    size_t _head = 0;                         // 队首下标
+    size_t _count = 0;                        // 队列中的事件数
+    std::vector<BattleEvent> _overflow;       // 环形队列满时的溢出事件（按投递顺序）
+
+    std::vector<Subscription> _subscriptions;
+    std::vector<Subscription> _pendingSubscriptions;  // 分发期间新增的订阅
+    int _nextSubscriptionId = 1;
+    bool _isDispatching = false;
+    bool _hasCancelledSubscriptions = false;
+};
+
+#endif // __BATTLE_EVENT_BUS_H__
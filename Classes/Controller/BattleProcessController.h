@@ -5,6 +5,7 @@
 
 #include "cocos2d.h"
 #include "../Model/VillageData.h"
+#include "Model/ReplayData.h"
 #include <map>
 #include <set>
 #include <functional>
@@ -17,6 +18,7 @@ struct BuildingInstance;
 
 /**
  * @brief 战斗流程控制器 - 管理战斗中的单位AI和行为逻辑
+ * 目标选择、路线规划、射程判定和伤害结算调用 BattleRules，这里负责驱动精灵动作和投递事件
  */
 class BattleProcessController {
 public:
@@ -29,17 +31,19 @@ public:
     // 启动战斗循环
     void startCombatLoop(BattleUnitSprite* unit, BattleTroopLayer* troopLayer);
     void startCombatLoopWithForcedTarget(BattleUnitSprite* unit, BattleTroopLayer* troopLayer, const BuildingInstance* forcedTarget);
+
+    // 按关键帧中的 AI 状态恢复单位行为（回放跳转用）：继续剩余路径或等待剩余攻击冷却，状态失效时重新启动AI
+    // path 为剩余路径点（像素坐标）
+    void resumeUnitAI(BattleUnitSprite* unit, BattleTroopLayer* troopLayer,
+                      const UnitKeyframe& state, const std::vector<cocos2d::Vec2>& path);
     
     // 重置战斗状态
     void resetBattleState();
 
-    // 绕路阈值常量（像素）
-    static constexpr float PIXEL_DETOUR_THRESHOLD = 800.0f;
-
     // 炸弹兵自爆攻击
     void performWallBreakerSuicideAttack(
         BattleUnitSprite* unit,
-        BuildingInstance* target,
+        const BuildingInstance* target,
         BattleTroopLayer* troopLayer,
         const std::function<void()>& onComplete
     );
@@ -56,9 +60,6 @@ private:
     // 累积伤害系统
     std::map<BattleUnitSprite*, float> _accumulatedDamage;
 
-    // 获取直线上第一个城墙
-    const BuildingInstance* getFirstWallInLine(const cocos2d::Vec2& startPixel, const cocos2d::Vec2& endPixel);
-
     // 执行攻击逻辑
     void executeAttack(
         BattleUnitSprite* unit,
@@ -69,6 +70,6 @@ private:
         const std::function<void()>& onContinueAttack
     );
 
-    // 判断是否应放弃当前城墙寻找更优路径
-    bool shouldAbandonWallForBetterPath(BattleUnitSprite* unit, int currentWallID);
+    // 强制攻击城墙的一击结算后：城墙仍在则继续（或发现更优路径时重新选目标），否则重新启动AI
+    void continueForcedAttack(BattleUnitSprite* unit, BattleTroopLayer* troopLayer, int targetID);
 };
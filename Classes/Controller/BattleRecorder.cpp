@@ -11,17 +11,59 @@
 #include "../Manager/AudioManager.h"
 #include "../Controller/BattleProcessController.h"
 #include "../Controller/DestructionTracker.h"
+#include "../Controller/HeadlessBattleSim.h"
+#include "../Controller/TrapSystem.h"
+#include "../Sprite/BattleUnitSprite.h"
 #include "../UI/BattleProgressUI.h"
+#include "../Util/FindPathUtil.h"
+#include "../Util/GridMapUtils.h"
+#include <cmath>
+#include <memory>
 
 USING_NS_CC;
 
+namespace {
+
+// 兵种ID映射到单位名称
+std::string troopNameForId(int troopId) {
+    if (troopId == 1002) return "Archer";
+    if (troopId == 1003) return "Goblin";
+    if (troopId == 1004) return "Giant";
+    if (troopId == 1005) return "Wall_Breaker";
+    if (troopId == 1006) return "Balloon";
+    return "Barbarian";
+}
+
+// 带小数的网格坐标转像素坐标（GridMapUtils::gridToPixel 会截断为整数格）
+Vec2 gridToPixelExact(float gridX, float gridY) {
+    return Vec2(
+        GridMapUtils::GRID_ORIGIN_X + gridX * GridMapUtils::GRID_X_UNIT_X + gridY * GridMapUtils::GRID_Y_UNIT_X,
+        GridMapUtils::GRID_ORIGIN_Y + gridX * GridMapUtils::GRID_X_UNIT_Y + gridY * GridMapUtils::GRID_Y_UNIT_Y);
+}
+
+bool isTrap(const BuildingInstance& building) {
+    return building.type == 401 || building.type == 404;
+}
+
+// 每隔多少个固定步长采样一次状态哈希
+const int HASH_SAMPLE_TICKS = static_cast<int>(BattleStateHasher::SAMPLE_INTERVAL / BattleRecorder::SYSTEM_TICK + 0.5f);
+
+} // namespace
+
+const float BattleRecorder::PLAYBACK_SPEEDS[BattleRecorder::PLAYBACK_SPEED_COUNT] = {
+    1.0f, 2.0f, 4.0f, 8.0f, 0.5f
+};
+
 BattleRecorder::BattleRecorder()
     : _isRecording(false)
-    , _battleStartTime(0.0f)
+    , _recordClock(0.0f)
     , _isReplayMode(false)
-    , _replayStartTime(0.0f)
+    , _replayClock(0.0f)
     , _currentEventIndex(0)
     , _isEndingScheduled(false)
+    , _playbackSpeedIndex(0)
+    , _isFastForwarding(false)
+    , _divergentTick(-1)
 {
 }
 
@@ -29,7 +71,7 @@ BattleRecorder::BattleRecorder()
 
 void BattleRecorder::startRecording() {
     _isRecording = true;
-    _battleStartTime = Director::getInstance()->getTotalFrames() / 60.0f;
+    _recordClock = 0.0f;
 
     // 清空数据
     _replayData = BattleReplayData();
@@ -41,25 +83,24 @@ void BattleRecorder::startRecording() {
     _replayData.defenderName = "AI Village";
     _replayData.timestamp = time(nullptr);
 
-    CCLOG("BattleRecorder: Recording started at time %.2f (map will be saved when battle starts)", _battleStartTime);
+    CCLOG("BattleRecorder: Recording started (map will be saved when battle starts)");
 }
 
 void BattleRecorder::saveCurrentMap() {
     if (!_isRecording) return;
 
-    // 保存当前地图状态
+    // 引用当前对手的布局快照（开战时建筑尚未受损，与布局一致）
     auto dataManager = VillageDataManager::getInstance();
-    _replayData.initialBuildings = dataManager->getAllBuildings();
+    _replayData.initialBuildings = dataManager->getBattleLayout();
     _replayData.battleMapSeed = 0;
 
-    CCLOG("BattleRecorder: Map state saved with %zu buildings", _replayData.initialBuildings.size());
+    CCLOG("BattleRecorder: Map state saved with %zu buildings", _replayData.getInitialBuildings().size());
 }
 
 void BattleRecorder::recordTroopDeployment(int troopId, int gridX, int gridY) {
     if (!_isRecording) return;
 
-    float currentTime = Director::getInstance()->getTotalFrames() / 60.0f;
-    float timestamp = currentTime - _battleStartTime;
+    float timestamp = _recordClock;
 
     TroopDeployEvent event;
     event.timestamp = timestamp;
@@ -73,6 +114,254 @@ void BattleRecorder::recordTroopDeployment(int troopId, int gridX, int gridY) {
           troopId, gridX, gridY, timestamp);
 }
 
+void BattleRecorder::updateRecording(float dt) {
+    if (!_isRecording) return;
+
+    _recordClock += dt;
+}
+
+// ========== 关键帧 ==========
+
+void BattleRecorder::captureKeyframeIfDue(BattleTroopLayer* troopLayer, int lootedGold, int lootedElixir) {
+    if (!troopLayer || (!_isRecording && !_isReplayMode)) return;
+
+    // 回放中只为缺少关键帧的区间补录（旧版回放文件、或回放超过最后一个关键帧）
+    float clock = getBattleClock();
+    auto& keyframes = _replayData.keyframes;
+    float lastTime = keyframes.empty() ? 0.0f : keyframes.back().time;
+    if (clock < lastTime + KEYFRAME_INTERVAL) return;
+
+    BattleKeyframe keyframe;
+    keyframe.time = clock;
+    keyframe.eventIndex = static_cast<int>(_isReplayMode ? _currentEventIndex : _replayData.troopEvents.size());
+    keyframe.lootedGold = lootedGold;
+    keyframe.lootedElixir = lootedElixir;
+
+    auto tracker = DestructionTracker::getInstance();
+    keyframe.destructionProgress = tracker->getProgress();
+    keyframe.stars = tracker->getStars();
+
+    // 建筑：只保存与初始布局不同的（受损、摧毁、冷却中、陷阱倒计时中）
+    // 战斗布局就是回放的初始布局，布局中的生命值即初始值
+    auto dataManager = VillageDataManager::getInstance();
+    const auto& buildings = dataManager->getBattleBuildings();
+    const auto& battleState = dataManager->getBattleState();
+    auto trapSystem = TrapSystem::getInstance();
+    for (int i = 0; i < battleState.size(); ++i) {
+        const auto& building = buildings[i];
+        float trapTimer = isTrap(building) ? trapSystem->getTrapTimer(building.id) : -1.0f;
+
+        bool unchanged = battleState.getHP(i) == building.currentHP && !battleState.isDestroyed(i) &&
+                         battleState.getCooldown(i) <= 0.0f && trapTimer < 0.0f;
+        if (unchanged) continue;
+
+        BuildingKeyframe state;
+        state.id = building.id;
+        state.currentHP = battleState.getHP(i);
+        state.isDestroyed = battleState.isDestroyed(i);
+        state.attackCooldown = battleState.getCooldown(i);
+        state.trapTimer = trapTimer;
+        keyframe.buildings.push_back(state);
+    }
+
+    // 单位：只保存存活的
+    const auto& store = troopLayer->getUnitStore();
+    keyframe.units.reserve(store.size());
+    for (int i = 0; i < store.size(); ++i) {
+        if (store.isDead(i)) continue;
+
+        UnitKeyframe unit;
+        unit.troopId = static_cast<int>(store.getType(i));
+        unit.gridX = store.getGridX(i);
+        unit.gridY = store.getGridY(i);
+        unit.currentHP = store.getHP(i);
+        unit.targetBuildingId = store.getTargetBuildingId(i);
+        unit.forcedTargetId = store.getForcedTargetId(i);
+
+        // AI 状态：正在走的剩余路径或正在进行的攻击的剩余时间
+        unit.aiState = UnitAIState::IDLE;
+        unit.attackCooldown = 0.0f;
+        auto view = store.getView(i);
+        float attackRemaining = view ? view->getAttackRemaining() : -1.0f;
+        if (view && view->isFollowingPath()) {
+            unit.aiState = UnitAIState::MOVING;
+            for (const auto& waypoint : view->getRemainingPath()) {
+                unit.path.push_back(GridMapUtils::pixelToGrid(waypoint));
+            }
+        } else if (attackRemaining >= 0.0f) {
+            unit.aiState = UnitAIState::ATTACKING;
+            unit.attackCooldown = attackRemaining;
+        }
+        keyframe.units.push_back(unit);
+    }
+
+    CCLOG("BattleRecorder: Keyframe @ %.2fs (%zu buildings changed, %zu units)",
+          keyframe.time, keyframe.buildings.size(), keyframe.units.size());
+
+    keyframes.push_back(std::move(keyframe));
+}
+
+// ========== 状态哈希 ==========
+
+void BattleRecorder::sampleStateHash(int systemTick, BattleTroopLayer* troopLayer) {
+    if (!troopLayer || (!_isRecording && !_isReplayMode)) return;
+    if (systemTick % HASH_SAMPLE_TICKS != 0) return;
+
+    const auto& battleState = VillageDataManager::getInstance()->getBattleState();
+    StateHashSample sample = BattleStateHasher::sample(battleState, troopLayer->getUnitStore(),
+                                                       systemTick / HASH_SAMPLE_TICKS);
+
+    if (_isReplayMode) {
+        _pendingHashes.push_back(sample);
+    } else {
+        _replayData.stateHashes.push_back(sample);
+    }
+}
+
+void BattleRecorder::checkStateHashes() {
+    for (const auto& sample : _pendingHashes) {
+        if (_divergentTick >= 0) break;
+
+        const StateHashSample* expected = BattleStateHasher::findSample(_replayData.stateHashes, sample.tick);
+        if (expected && expected->hash != sample.hash) {
+            _divergentTick = sample.tick;
+            CCLOG("BattleRecorder: Replay diverged from recording at tick %d (%.2fs): %s",
+                  sample.tick, sample.tick * BattleStateHasher::SAMPLE_INTERVAL,
+                  BattleStateHasher::describeDiff(*expected, sample).c_str());
+        }
+    }
+    _pendingHashes.clear();
+}
+
+// ========== 模拟器基准哈希 ==========
+
+void BattleRecorder::saveWithSimHashes(const BattleReplayData& replayData) {
+    auto data = std::make_shared<BattleReplayData>(replayData);
+    data->simHashes.clear();
+    if (data->getInitialBuildings().empty()) {
+        ReplayManager::getInstance()->saveReplay(*data);
+        return;
+    }
+
+    // 配置表只在主线程读取：先构建推演输入，后台线程只运行模拟器
+    // 与 ReplayResim 相同的推演方式（不加扰动），工具重算时逐个采样比对
+    auto setup = std::make_shared<HeadlessBattleSetup>(HeadlessBattleSim::buildSetup(*data));
+    auto deployments = std::make_shared<std::vector<SimDeployment>>(HeadlessBattleSim::deploymentsFromReplay(*data));
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER,
+        [data](void*) {
+            CCLOG("BattleRecorder: Computed %zu simulation hash samples", data->simHashes.size());
+            ReplayManager::getInstance()->saveReplay(*data);
+        },
+        nullptr,
+        [data, setup, deployments]() {
+            HeadlessBattleSim::run(*setup, *deployments, 0u, false, &data->simHashes);
+        });
+}
+
+const BattleKeyframe* BattleRecorder::findKeyframe(float time) const {
+    const BattleKeyframe* found = nullptr;
+    for (const auto& keyframe : _replayData.keyframes) {
+        if (keyframe.time > time) break;
+        found = &keyframe;
+    }
+    return found;
+}
+
+void BattleRecorder::restoreKeyframe(const BattleKeyframe* keyframe, BattleMapLayer* mapLayer,
+                                     BattleTroopLayer* troopLayer) {
+    if (!_isReplayMode || !mapLayer || !troopLayer) return;
+
+    CCLOG("BattleRecorder: Restoring keyframe @ %.2fs", keyframe ? keyframe->time : 0.0f);
+
+    // 1. 移除所有单位和墓碑（同时停止它们的动作和AI回调）
+    troopLayer->removeAllUnits();
+    troopLayer->clearAllTombstones();
+
+    // 2. 从初始布局重建建筑数据，再应用关键帧中的差异
+    auto dataManager = VillageDataManager::getInstance();
+    dataManager->loadBattleLayout(_replayData.initialBuildings);
+
+    auto trapSystem = TrapSystem::getInstance();
+    trapSystem->reset();
+
+    if (keyframe) {
+        auto& battleState = dataManager->getBattleState();
+        for (const auto& state : keyframe->buildings) {
+            int index = battleState.indexOf(state.id);
+            if (index < 0) continue;
+
+            battleState.restore(index, state.currentHP, state.isDestroyed, state.attackCooldown);
+            if (state.trapTimer >= 0.0f) {
+                trapSystem->restoreTrapTimer(state.id, state.trapTimer);
+            }
+        }
+    }
+
+    // 3. 重建建筑精灵，已触发的陷阱保持可见
+    mapLayer->reloadMapFromData();
+    if (keyframe) {
+        for (const auto& state : keyframe->buildings) {
+            if (state.trapTimer < 0.0f && !state.isDestroyed) continue;
+
+            const BuildingInstance* building = dataManager->getBattleBuilding(state.id);
+            if (!building || !isTrap(*building)) continue;
+
+            auto trapSprite = mapLayer->getChildByName("Building_" + std::to_string(state.id));
+            if (trapSprite) trapSprite->setVisible(true);
+        }
+    }
+    FindPathUtil::getInstance()->updatePathfindingMap(dataManager->getBattleState());
+
+    // 4. 按恢复后的建筑状态重新统计摧毁进度和星数
+    DestructionTracker::getInstance()->initTracking();
+
+    // 5. 恢复单位
+    if (keyframe) {
+        restoreUnits(*keyframe, troopLayer);
+    }
+
+    // 6. 回放进度
+    _replayClock = keyframe ? keyframe->time : 0.0f;
+    _currentEventIndex = keyframe ? static_cast<size_t>(keyframe->eventIndex) : 0;
+    _isEndingScheduled = false;
+
+    // 跳转后从恢复点重新开始比对
+    _pendingHashes.clear();
+    _divergentTick = -1;
+}
+
+void BattleRecorder::restoreUnits(const BattleKeyframe& keyframe, BattleTroopLayer* troopLayer) {
+    auto processController = BattleProcessController::getInstance();
+
+    for (const auto& state : keyframe.units) {
+        int cellX = static_cast<int>(std::floor(state.gridX));
+        int cellY = static_cast<int>(std::floor(state.gridY));
+        cellX = std::max(0, std::min(cellX, GridMapUtils::GRID_WIDTH - 1));
+        cellY = std::max(0, std::min(cellY, GridMapUtils::GRID_HEIGHT - 1));
+
+        auto unit = troopLayer->spawnUnit(troopNameForId(state.troopId), cellX, cellY);
+        if (!unit) continue;
+
+        // 移动中的单位不在格子中心，按记录的小数坐标放回原位
+        unit->setPosition(gridToPixelExact(state.gridX, state.gridY));
+        troopLayer->getUnitStore().setGridPosition(unit->getStoreIndex(), state.gridX, state.gridY);
+
+        int damage = unit->getMaxHP() - state.currentHP;
+        if (damage > 0) {
+            unit->takeDamage(damage);
+        }
+
+        // 按记录的 AI 状态继续剩余路径或攻击；旧版关键帧没有 AI 状态，从当前位置重新选择目标
+        std::vector<Vec2> path;
+        path.reserve(state.path.size());
+        for (const auto& waypoint : state.path) {
+            path.push_back(gridToPixelExact(waypoint.x, waypoint.y));
+        }
+        processController->resumeUnitAI(unit, troopLayer, state, path);
+    }
+}
+
 void BattleRecorder::stopRecording(int lootedGold, int lootedElixir,
                                     const std::map<int, int>& usedTroops,
                                     const std::map<int, int>& troopLevels) {
@@ -88,12 +377,12 @@ void BattleRecorder::stopRecording(int lootedGold, int lootedElixir,
     _replayData.lootedElixir = lootedElixir;
     _replayData.usedTroops = usedTroops;
     _replayData.troopLevels = troopLevels;
-    _replayData.battleDuration = Director::getInstance()->getTotalFrames() / 60.0f - _battleStartTime;
+    _replayData.battleDuration = _recordClock;
 
-    // 保存到本地
-    ReplayManager::getInstance()->saveReplay(_replayData);
+    // 推演基准哈希后保存到本地
+    saveWithSimHashes(_replayData);
 
-    CCLOG("BattleRecorder: Recording stopped, saved replay with %zu events",
+    CCLOG("BattleRecorder: Recording stopped, saving replay with %zu events",
           _replayData.troopEvents.size());
 }
 
@@ -104,6 +393,8 @@ void BattleRecorder::initReplayMode(const BattleReplayData& replayData) {
     _replayData = replayData;
     _currentEventIndex = 0;
     _isEndingScheduled = false;
+    _pendingHashes.clear();
+    _divergentTick = -1;
     CCLOG("BattleRecorder: Initialized replay mode with %zu events",
           _replayData.troopEvents.size());
 }
@@ -120,9 +411,16 @@ void BattleRecorder::startReplay(BattleHUDLayer* hudLayer, std::function<void()>
         CCLOG("BattleRecorder: HUD controls hidden for replay mode");
     }
 
-    _replayStartTime = Director::getInstance()->getTotalFrames() / 60.0f;
+    _replayClock = 0.0f;
     _currentEventIndex = 0;
     _isEndingScheduled = false;
+    _pendingHashes.clear();
+    _divergentTick = -1;
+
+    if (hudLayer) {
+        hudLayer->showReplayPlaybackControls(getPlaybackSpeed());
+    }
+    applyPlaybackSpeed();
 
     // 自动进入战斗状态
     if (onSwitchToFighting) {
@@ -134,12 +432,15 @@ void BattleRecorder::updateReplay(float dt, BattleTroopLayer* troopLayer,
                                    std::function<void()> onReplayFinished) {
     if (!_isReplayMode) return;
 
-    float currentTime = Director::getInstance()->getTotalFrames() / 60.0f;
-    float elapsedTime = currentTime - _replayStartTime;
+    _replayClock += dt;
+    float elapsedTime = _replayClock;
 
     // 检查是否有兵种需要部署
     checkAndDeployNextTroop(elapsedTime, troopLayer);
 
+    // 与录制的状态哈希比对
+    checkStateHashes();
+
     // 当经过完整战斗时长后触发结束回调
     if (elapsedTime >= _replayData.battleDuration && !_isEndingScheduled) {
         _isEndingScheduled = true;
@@ -152,6 +453,12 @@ void BattleRecorder::updateReplay(float dt, BattleTroopLayer* troopLayer,
     }
 }
 
+void BattleRecorder::deployDueTroops(float battleTime, BattleTroopLayer* troopLayer) {
+    if (!_isReplayMode) return;
+
+    checkAndDeployNextTroop(battleTime, troopLayer);
+}
+
 void BattleRecorder::checkAndDeployNextTroop(float elapsedTime, BattleTroopLayer* troopLayer) {
     if (!troopLayer) return;
 
@@ -163,31 +470,13 @@ void BattleRecorder::checkAndDeployNextTroop(float elapsedTime, BattleTroopLayer
             break;
         }
 
-        // 兵种ID映射
-        std::string name = "Barbarian";
-        if (event.troopId == 1001) name = "Barbarian";
-        else if (event.troopId == 1002) name = "Archer";
-        else if (event.troopId == 1003) name = "Goblin";
-        else if (event.troopId == 1004) name = "Giant";
-        else if (event.troopId == 1005) name = "Wall_Breaker";
-        else if (event.troopId == 1006) name = "Balloon";
+        std::string name = troopNameForId(event.troopId);
 
         auto unit = troopLayer->spawnUnit(name, event.gridX, event.gridY);
         if (unit) {
-            // 播放部署音效
-            auto audioManager = AudioManager::getInstance();
-            if (event.troopId == 1001) {
-                audioManager->playEffect("Audios/barbarian_deploy.mp3", 0.8f);
-            } else if (event.troopId == 1002) {
-                audioManager->playEffect("Audios/archer_deploy.mp3", 0.8f);
-            } else if (event.troopId == 1003) {
-                audioManager->playEffect("Audios/goblin_deploy.mp3", 0.8f);
-            } else if (event.troopId == 1004) {
-                audioManager->playEffect("Audios/giant_deploy.mp3", 0.8f);
-            } else if (event.troopId == 1005) {
-                audioManager->playEffect("Audios/wall_breaker_deploy.mp3", 0.8f);
-            } else if (event.troopId == 1006) {
-                audioManager->playEffect("Audios/balloon_deploy.mp3", 0.8f);
+            // 播放部署音效（快进时跳过）
+            if (!_isFastForwarding) {
+                playDeploySound(event.troopId);
             }
 
             BattleProcessController::getInstance()->startUnitAI(unit, troopLayer);
@@ -199,24 +488,61 @@ void BattleRecorder::checkAndDeployNextTroop(float elapsedTime, BattleTroopLayer
     }
 }
 
+void BattleRecorder::playDeploySound(int troopId) {
+    auto audioManager = AudioManager::getInstance();
+    if (troopId == 1001) {
+        audioManager->playEffect("Audios/barbarian_deploy.mp3", 0.8f);
+    } else if (troopId == 1002) {
+        audioManager->playEffect("Audios/archer_deploy.mp3", 0.8f);
+    } else if (troopId == 1003) {
+        audioManager->playEffect("Audios/goblin_deploy.mp3", 0.8f);
+    } else if (troopId == 1004) {
+        audioManager->playEffect("Audios/giant_deploy.mp3", 0.8f);
+    } else if (troopId == 1005) {
+        audioManager->playEffect("Audios/wall_breaker_deploy.mp3", 0.8f);
+    } else if (troopId == 1006) {
+        audioManager->playEffect("Audios/balloon_deploy.mp3", 0.8f);
+    }
+}
+
+// ========== 回放倍速 ==========
+
+float BattleRecorder::cyclePlaybackSpeed() {
+    _playbackSpeedIndex = (_playbackSpeedIndex + 1) % PLAYBACK_SPEED_COUNT;
+    applyPlaybackSpeed();
+
+    CCLOG("BattleRecorder: Playback speed set to %.1fx", getPlaybackSpeed());
+    return getPlaybackSpeed();
+}
+
+void BattleRecorder::resetPlaybackSpeed() {
+    _playbackSpeedIndex = 0;
+    applyPlaybackSpeed();
+}
+
+void BattleRecorder::setFastForwarding(bool fastForwarding) {
+    _isFastForwarding = fastForwarding;
+
+    // 快进以固定步长推进调度器，步长不能再被倍速放大
+    Director::getInstance()->getScheduler()->setTimeScale(fastForwarding ? 1.0f : getPlaybackSpeed());
+}
+
+void BattleRecorder::applyPlaybackSpeed() {
+    // 缩放整个调度器：场景update、动作（移动/攻击动画）都按倍速推进
+    Director::getInstance()->getScheduler()->setTimeScale(getPlaybackSpeed());
+}
+
 // ========== 加载回放地图 ==========
 
 void BattleRecorder::loadReplayMap(BattleMapLayer* mapLayer, BattleHUDLayer* hudLayer) {
     if (!mapLayer) return;
 
     CCLOG("BattleRecorder: Loading replay map with %zu buildings",
-          _replayData.initialBuildings.size());
+          _replayData.getInitialBuildings().size());
 
-    // 将回放的建筑数据加载到VillageDataManager
+    // 用回放的初始布局重建战斗建筑（布局与回放数据共享，不逐个复制）
     auto dataManager = VillageDataManager::getInstance();
-
-    // 清空当前战斗地图数据
-    dataManager->clearBattleMap();
-
-    // 加载回放的建筑
-    for (const auto& building : _replayData.initialBuildings) {
-        dataManager->addBattleBuildingFromReplay(building);
-    }
+    dataManager->loadBattleLayout(_replayData.initialBuildings);
 
     // 刷新地图层显示
     mapLayer->reloadMapFromData();
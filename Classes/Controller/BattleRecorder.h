@@ -15,8 +15,19 @@ class BattleProgressUI;
 
 // 战斗回放管理器类
 // 职责：录制战斗事件、保存回放数据、播放回放
+// 录制和回放都使用由场景逐帧推进的战斗时钟（累加 dt），与帧率无关
+// 倍速回放通过调度器时间缩放实现，动作、动画和防御/陷阱更新都按倍速推进
+// 战斗中每隔 KEYFRAME_INTERVAL 秒保存一次关键帧，回放跳转时从最近的关键帧恢复后快进到目标时间
+// 防御/陷阱系统按 SYSTEM_TICK 固定步长推进，每隔 BattleStateHasher::SAMPLE_INTERVAL 对建筑状态表和单位数据取哈希：
+// 录制时保存，回放时与录制的哈希比对，报告第一个不一致的采样
+// 停止录制时在后台线程用无界面模拟器推演部署序列，生成批量重算用的基准哈希后再保存
 class BattleRecorder {
 public:
+    static const int PLAYBACK_SPEED_COUNT = 5;
+    static const float PLAYBACK_SPEEDS[PLAYBACK_SPEED_COUNT];   // 1x, 2x, 4x, 8x, 0.5x
+    static constexpr float KEYFRAME_INTERVAL = 5.0f;            // 关键帧间隔（秒）
+    static constexpr float SYSTEM_TICK = 1.0f / 30.0f;          // 防御/陷阱系统的固定步长（秒）
+
     BattleRecorder();
     ~BattleRecorder() = default;
 
@@ -33,7 +44,22 @@ public:
     
     // 记录兵种部署事件
     void recordTroopDeployment(int troopId, int gridX, int gridY);
-    
+
+    // 推进录制时钟（录制期间每帧调用）
+    void updateRecording(float dt);
+
+    // 到达间隔时保存关键帧（战斗中每帧调用；回放旧版文件时补录缺少的关键帧）
+    void captureKeyframeIfDue(BattleTroopLayer* troopLayer, int lootedGold, int lootedElixir);
+
+    // 回放时部署时间不晚于 battleTime 的兵种（固定步长时钟每步之前调用，兵种与录制时从同一步开始参与结算）
+    void deployDueTroops(float battleTime, BattleTroopLayer* troopLayer);
+
+    // 固定步长时钟第 systemTick 步结束时调用，到达采样点时计算状态哈希：录制时保存，回放时留给 updateReplay 比对
+    void sampleStateHash(int systemTick, BattleTroopLayer* troopLayer);
+
+    // 当前战斗时间（录制时为录制时钟，回放时为回放时钟）
+    float getBattleClock() const { return _isReplayMode ? _replayClock : _recordClock; }
+
     // 是否正在录制
     bool isRecording() const { return _isRecording; }
 
@@ -43,9 +69,30 @@ public:
     // 开始播放回放
     void startReplay(BattleHUDLayer* hudLayer, std::function<void()> onSwitchToFighting);
     
-    // 更新回放进度
+    // 更新回放进度（dt 为调度器缩放后的时间）
     void updateReplay(float dt, BattleTroopLayer* troopLayer,
                       std::function<void()> onReplayFinished);
+
+    // 回放倍速：切换到下一档并返回新倍速
+    float cyclePlaybackSpeed();
+    float getPlaybackSpeed() const { return PLAYBACK_SPEEDS[_playbackSpeedIndex]; }
+
+    // 恢复1倍速（离开回放或进入结算时调用）
+    void resetPlaybackSpeed();
+
+    // 快进状态：快进时不播放部署音效，调度器临时使用1倍速，结束后恢复当前倍速
+    void setFastForwarding(bool fastForwarding);
+    bool isFastForwarding() const { return _isFastForwarding; }
+
+    // 当前回放时间（秒）
+    float getReplayTime() const { return _replayClock; }
+
+    // 查找不晚于指定时间的最近关键帧，没有返回 nullptr（表示战斗开始时的状态）
+    const BattleKeyframe* findKeyframe(float time) const;
+
+    // 把地图、单位、陷阱和回放进度恢复到关键帧（nullptr 表示战斗开始时的状态）
+    void restoreKeyframe(const BattleKeyframe* keyframe, BattleMapLayer* mapLayer,
+                         BattleTroopLayer* troopLayer);
     
     // 是否为回放模式
     bool isReplayMode() const { return _isReplayMode; }
@@ -61,16 +108,37 @@ private:
     // 检查并部署下一个兵种
     void checkAndDeployNextTroop(float elapsedTime, BattleTroopLayer* troopLayer);
 
+    // 恢复关键帧中的单位
+    void restoreUnits(const BattleKeyframe& keyframe, BattleTroopLayer* troopLayer);
+
+    // 把本帧的回放采样与录制的哈希比对，只报告第一个不一致的采样
+    void checkStateHashes();
+
+    // 后台推演模拟器基准哈希，完成后在主线程保存回放
+    static void saveWithSimHashes(const BattleReplayData& replayData);
+
+    // 播放兵种部署音效
+    void playDeploySound(int troopId);
+
+    // 应用倍速到调度器
+    void applyPlaybackSpeed();
+
     // 录制状态
     bool _isRecording = false;
-    float _battleStartTime = 0.0f;
+    float _recordClock = 0.0f;       // 录制开始后经过的战斗时间（秒）
     BattleReplayData _replayData;
 
     // 回放状态
     bool _isReplayMode = false;
-    float _replayStartTime = 0.0f;
+    float _replayClock = 0.0f;       // 回放开始后经过的战斗时间（秒）
     size_t _currentEventIndex = 0;
     bool _isEndingScheduled = false;
+    int _playbackSpeedIndex = 0;
+    bool _isFastForwarding = false;
+
+    // 状态哈希
+    std::vector<StateHashSample> _pendingHashes;    // 回放中尚未比对的采样
+    int _divergentTick = -1;                        // 回放第一个不一致的采样序号，-1 表示目前一致
 };
 
 #endif // __BATTLE_RECORDER_H__
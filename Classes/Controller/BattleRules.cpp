@@ -0,0 +1,512 @@
+﻿// BattleRules.cpp
+// 战斗规则实现：目标选择、路线规划、射程判定和伤害结算
+
+#include "BattleRules.h"
+#include "../Util/FindPathUtil.h"
+#include "../Util/GridMapUtils.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <set>
+
+USING_NS_CC;
+
+constexpr float BattleRules::UNIT_MOVE_SPEED;
+constexpr float BattleRules::DETOUR_THRESHOLD;
+constexpr float BattleRules::TRAP_DELAY;
+constexpr int BattleRules::WALL_BREAKER_WALL_MULTIPLIER;
+
+namespace {
+
+// 计算路径总长度（从第一个路径点算起）
+float calculatePathLength(const std::vector<Vec2>& path) {
+    if (path.size() < 2) return 0.0f;
+    float totalDist = 0.0f;
+    for (size_t i = 0; i < path.size() - 1; ++i) {
+        totalDist += path[i].distance(path[i + 1]);
+    }
+    return totalDist;
+}
+
+// 绕路是否可接受：多出的长度不超过阈值，且不超过直线距离的两倍
+bool isDetourAcceptable(float pathLength, float directDistance) {
+    float detourCost = pathLength - directDistance;
+    return detourCost <= BattleRules::DETOUR_THRESHOLD && pathLength <= directDistance * 2.0f;
+}
+
+} // namespace
+
+// ==========================================
+// 兵种参数
+// ==========================================
+
+int BattleRules::getAttackRange(UnitTypeID type) {
+    switch (type) {
+        case UnitTypeID::ARCHER:
+            return 3;
+        case UnitTypeID::WALL_BREAKER:
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+float BattleRules::getAttackDuration(UnitTypeID type, AnimationType animType) {
+    bool side = (animType == AnimationType::ATTACK);
+    bool up = (animType == AnimationType::ATTACK_UP);
+
+    // 与 AnimationManager::initializeDefaultConfigs 中的攻击动画配置一致
+    switch (type) {
+        case UnitTypeID::BARBARIAN:    return (side ? 10 : 11) * 0.12f;
+        case UnitTypeID::ARCHER:       return 7 * 0.08f;
+        case UnitTypeID::GOBLIN:       return 5 * 0.1f;
+        case UnitTypeID::GIANT:        return (up ? 8 : 9) * 0.15f;
+        case UnitTypeID::WALL_BREAKER: return 8 * 0.08f;
+        case UnitTypeID::BALLOON:      return 0.8f;
+        default:                       return 1.0f;
+    }
+}
+
+void BattleRules::selectAttackAnimation(const Vec2& direction, AnimationType& outAnimType, bool& outFlipX) {
+    float angle = CC_RADIANS_TO_DEGREES(atan2f(direction.y, direction.x));
+
+    // 角度归一化到[0, 360)
+    while (angle < 0) angle += 360;
+    while (angle >= 360) angle -= 360;
+
+    // 八方向选择攻击动画
+    if (angle >= 337.5f || angle < 22.5f) {
+        outAnimType = AnimationType::ATTACK;
+        outFlipX = false;
+    } else if (angle < 112.5f) {
+        outAnimType = AnimationType::ATTACK_UP;
+        outFlipX = false;
+    } else if (angle < 157.5f) {
+        outAnimType = AnimationType::ATTACK_UP;
+        outFlipX = true;
+    } else if (angle < 202.5f) {
+        outAnimType = AnimationType::ATTACK;
+        outFlipX = true;
+    } else if (angle < 247.5f) {
+        outAnimType = AnimationType::ATTACK_DOWN;
+        outFlipX = true;
+    } else {
+        outAnimType = AnimationType::ATTACK_DOWN;
+        outFlipX = false;
+    }
+}
+
+// ==========================================
+// 目标选择
+// ==========================================
+
+int BattleRules::findTarget(const BattleBuildingStore& buildings, UnitTypeID type, const Vec2& unitPixel) {
+    // 炸弹兵：只攻击城墙
+    if (type == UnitTypeID::WALL_BREAKER) {
+        return findNearestWall(buildings, unitPixel);
+    }
+
+    bool preferResource = (type == UnitTypeID::GOBLIN);
+    bool preferDefense = (type == UnitTypeID::GIANT || type == UnitTypeID::BALLOON);
+
+    int best = -1;
+    int fallback = -1;
+    float minDistanceSq = FLT_MAX;
+    float fallbackMinDistanceSq = FLT_MAX;
+
+    for (int i = 0; i < buildings.size(); ++i) {
+        const auto& b = buildings.getInfo(i);
+        if (!b.active || !buildings.isAlive(i)) continue;
+
+        // 跳过城墙和陷阱
+        if (b.isWall || b.isTrap) continue;
+
+        Vec2 bPos = GridMapUtils::getBuildingCenterPixel(b.gridX, b.gridY, b.gridWidth, b.gridHeight);
+        float distSq = unitPixel.distanceSquared(bPos);
+
+        // 有偏好的兵种先找偏好类型，找不到时退回最近的其它建筑
+        bool preferred = true;
+        if (preferResource) preferred = b.isResource;
+        else if (preferDefense) preferred = b.isDefense;
+
+        if (preferred) {
+            if (distSq < minDistanceSq) {
+                minDistanceSq = distSq;
+                best = i;
+            }
+        } else if (distSq < fallbackMinDistanceSq) {
+            fallbackMinDistanceSq = distSq;
+            fallback = i;
+        }
+    }
+
+    return best >= 0 ? best : fallback;
+}
+
+int BattleRules::findNearestWall(const BattleBuildingStore& buildings, const Vec2& unitPixel) {
+    int nearestWall = -1;
+    float minDistanceSq = FLT_MAX;
+
+    for (int i = 0; i < buildings.size(); ++i) {
+        const auto& b = buildings.getInfo(i);
+        if (!b.isWall || !b.active || !buildings.isAlive(i)) continue;
+
+        Vec2 bPos = GridMapUtils::gridToPixelCenter(b.gridX, b.gridY);
+        float distSq = unitPixel.distanceSquared(bPos);
+
+        if (distSq < minDistanceSq) {
+            minDistanceSq = distSq;
+            nearestWall = i;
+        }
+    }
+
+    return nearestWall;
+}
+
+bool BattleRules::isInAttackRange(const BattleBuildingStore& buildings, int index,
+                                  UnitTypeID type, const Vec2& unitPixel) {
+    const auto& b = buildings.getInfo(index);
+
+    // 气球兵使用像素距离判定
+    if (type == UnitTypeID::BALLOON) {
+        Vec2 buildingCenter = GridMapUtils::gridToPixelCenter(b.gridX + b.gridWidth / 2, b.gridY + b.gridHeight / 2);
+        float maxAttackDistance = (std::max(b.gridWidth, b.gridHeight) + 1) * 32.0f;
+        return unitPixel.distance(buildingCenter) <= maxAttackDistance;
+    }
+
+    // 其余兵种：到建筑矩形的切比雪夫格子距离
+    Vec2 unitGridPos = GridMapUtils::pixelToGrid(unitPixel);
+    int unitGridX = static_cast<int>(std::floor(unitGridPos.x));
+    int unitGridY = static_cast<int>(std::floor(unitGridPos.y));
+
+    int gridDistX = 0;
+    int gridDistY = 0;
+    if (unitGridX < b.gridX) {
+        gridDistX = b.gridX - unitGridX;
+    } else if (unitGridX >= b.gridX + b.gridWidth) {
+        gridDistX = unitGridX - (b.gridX + b.gridWidth - 1);
+    }
+    if (unitGridY < b.gridY) {
+        gridDistY = b.gridY - unitGridY;
+    } else if (unitGridY >= b.gridY + b.gridHeight) {
+        gridDistY = unitGridY - (b.gridY + b.gridHeight - 1);
+    }
+
+    return std::max(gridDistX, gridDistY) <= getAttackRange(type);
+}
+
+// ==========================================
+// 路线规划
+// ==========================================
+
+BattleRules::Route BattleRules::planRoute(const BattleBuildingStore& buildings, FindPathUtil& pathfinder,
+                                          UnitTypeID type, const Vec2& unitPixel, int target) {
+    Route route;
+    const auto& b = buildings.getInfo(target);
+    int attackRange = getAttackRange(type);
+    Vec2 targetCenter = GridMapUtils::gridToPixelCenter(b.gridX, b.gridY);
+
+    // 气球兵飞越城墙：直线飞到建筑边缘的攻击点
+    if (type == UnitTypeID::BALLOON) {
+        Vec2 buildingCenter = GridMapUtils::gridToPixelCenter(
+            static_cast<int>(b.gridX + b.gridWidth / 2.0f),
+            static_cast<int>(b.gridY + b.gridHeight / 2.0f));
+
+        Vec2 direction = buildingCenter - unitPixel;
+        direction.normalize();
+
+        float attackDistancePixels = (attackRange + b.gridWidth / 2.0f) * 32.0f;
+        Vec2 attackPosition = buildingCenter - direction * attackDistancePixels;
+
+        // 攻击点比建筑中心更远时直接飞到中心
+        if (unitPixel.distance(attackPosition) > unitPixel.distance(buildingCenter)) {
+            attackPosition = buildingCenter;
+        }
+
+        route.path.push_back(attackPosition);
+        return route;
+    }
+
+    std::vector<Vec2> pathAround = pathfinder.findPathToAttackBuilding(
+        unitPixel, b.gridX, b.gridY, b.gridWidth, b.gridHeight, attackRange);
+    if (!pathAround.empty() &&
+        isDetourAcceptable(calculatePathLength(pathAround), unitPixel.distance(targetCenter))) {
+        route.path = std::move(pathAround);
+        return route;
+    }
+
+    // 绕路太远或无路可走：先破开直线上的第一面城墙
+    int wall = findFirstWallInLine(buildings, pathfinder, unitPixel, targetCenter);
+    if (wall >= 0) {
+        const auto& w = buildings.getInfo(wall);
+        route.forcedWall = wall;
+        route.path = pathfinder.findPathToAttackBuilding(
+            unitPixel, w.gridX, w.gridY, w.gridWidth, w.gridHeight, attackRange);
+        return route;
+    }
+
+    // 找不到城墙：直线前往目标
+    route.path.push_back(targetCenter);
+    return route;
+}
+
+std::vector<Vec2> BattleRules::planApproach(const BattleBuildingStore& buildings, FindPathUtil& pathfinder,
+                                            UnitTypeID type, const Vec2& unitPixel, int target) {
+    const auto& b = buildings.getInfo(target);
+    std::vector<Vec2> path = pathfinder.findPathToAttackBuilding(
+        unitPixel, b.gridX, b.gridY, b.gridWidth, b.gridHeight, getAttackRange(type));
+    if (path.empty()) {
+        path.push_back(GridMapUtils::gridToPixelCenter(b.gridX, b.gridY));
+    }
+    return path;
+}
+
+int BattleRules::findFirstWallInLine(const BattleBuildingStore& buildings, FindPathUtil& pathfinder,
+                                     const Vec2& startPixel, const Vec2& endPixel) {
+    auto isAliveWall = [&buildings](int index) {
+        return index >= 0 && buildings.getInfo(index).isWall && buildings.isAlive(index);
+    };
+
+    // 方法1：沿穿墙路径查找
+    std::vector<Vec2> throughPath = pathfinder.findPathIgnoringWalls(startPixel, endPixel);
+    for (const auto& worldPt : throughPath) {
+        Vec2 gridF = GridMapUtils::pixelToGrid(worldPt);
+        int gx = static_cast<int>(std::floor(gridF.x + 0.5f));
+        int gy = static_cast<int>(std::floor(gridF.y + 0.5f));
+
+        int index = pathfinder.getBuildingIndexAt(gx, gy);
+        if (isAliveWall(index)) return index;
+    }
+
+    // 方法2：线性扫描，步长半格，确保经过的每个格子都被检查
+    Vec2 startGrid = GridMapUtils::pixelToGrid(startPixel);
+    Vec2 endGrid = GridMapUtils::pixelToGrid(endPixel);
+    Vec2 diff = endGrid - startGrid;
+
+    float maxDiff = std::max(std::abs(diff.x), std::abs(diff.y));
+    int steps = static_cast<int>(std::ceil(maxDiff)) * 2;
+    if (steps < 1) steps = 1;
+
+    Vec2 direction = diff / static_cast<float>(steps);
+    Vec2 current = startGrid;
+    std::set<std::pair<int, int>> checkedGrids;
+
+    for (int i = 0; i <= steps; ++i) {
+        int gx = static_cast<int>(std::floor(current.x));
+        int gy = static_cast<int>(std::floor(current.y));
+
+        if (checkedGrids.insert(std::make_pair(gx, gy)).second) {
+            int index = pathfinder.getBuildingIndexAt(gx, gy);
+            if (isAliveWall(index)) return index;
+        }
+        current += direction;
+    }
+
+    // 方法3：遍历所有城墙，检查到线段的距离
+    int minX = static_cast<int>(std::min(startGrid.x, endGrid.x)) - 1;
+    int maxX = static_cast<int>(std::max(startGrid.x, endGrid.x)) + 1;
+    int minY = static_cast<int>(std::min(startGrid.y, endGrid.y)) - 1;
+    int maxY = static_cast<int>(std::max(startGrid.y, endGrid.y)) + 1;
+
+    Vec2 lineDir = endGrid - startGrid;
+    float lineLen = lineDir.length();
+    if (lineLen <= 0.01f) return -1;
+    lineDir.normalize();
+
+    for (int i = 0; i < buildings.size(); ++i) {
+        if (!isAliveWall(i)) continue;
+
+        const auto& b = buildings.getInfo(i);
+        if (b.gridX < minX || b.gridX > maxX || b.gridY < minY || b.gridY > maxY) continue;
+
+        Vec2 wallPos(b.gridX + 0.5f, b.gridY + 0.5f);
+        float proj = (wallPos - startGrid).dot(lineDir);
+        if (proj < 0 || proj > lineLen) continue;
+
+        // 距离小于1.5格认为城墙在路径上
+        Vec2 projPoint = startGrid + lineDir * proj;
+        if (wallPos.distance(projPoint) < 1.5f) return i;
+    }
+
+    return -1;
+}
+
+bool BattleRules::shouldAbandonWall(const BattleBuildingStore& buildings, FindPathUtil& pathfinder,
+                                    UnitTypeID type, const Vec2& unitPixel) {
+    int best = findTarget(buildings, type, unitPixel);
+    if (best < 0) return false;
+
+    const auto& b = buildings.getInfo(best);
+    std::vector<Vec2> pathAround = pathfinder.findPathToAttackBuilding(
+        unitPixel, b.gridX, b.gridY, b.gridWidth, b.gridHeight, getAttackRange(type));
+    if (pathAround.empty()) return false;
+
+    Vec2 targetCenter = GridMapUtils::gridToPixelCenter(b.gridX, b.gridY);
+    return isDetourAcceptable(calculatePathLength(pathAround), unitPixel.distance(targetCenter));
+}
+
+// ==========================================
+// 结算
+// ==========================================
+
+int BattleRules::applyUnitAttack(BattleBuildingStore& buildings, int index, UnitTypeID type, int baseDamage) {
+    int damage = baseDamage;
+    if (type == UnitTypeID::WALL_BREAKER && buildings.getInfo(index).isWall) {
+        damage *= WALL_BREAKER_WALL_MULTIPLIER;
+    }
+    return buildings.applyDamage(index, damage);
+}
+
+int BattleRules::findNearestUnitInRange(const BattleBuildingStore& buildings, int building,
+                                        const BattleUnitStore& units) {
+    const auto& b = buildings.getInfo(building);
+
+    // 建筑中心网格坐标
+    int centerX = b.gridX + b.gridWidth / 2;
+    int centerY = b.gridY + b.gridHeight / 2;
+
+    int nearest = -1;
+    int minGridDistance = INT_MAX;
+
+    for (int i = 0; i < units.size(); ++i) {
+        if (units.isDead(i)) continue;
+
+        // 飞行单位只有箭塔能攻击
+        if (!b.hitsAir && units.hasFlag(i, BattleUnitStore::FLAG_FLYING)) continue;
+
+        // 网格距离（切比雪夫距离）
+        int gridDistance = std::max(
+            std::abs(static_cast<int>(units.getGridX(i)) - centerX),
+            std::abs(static_cast<int>(units.getGridY(i)) - centerY));
+
+        if (gridDistance <= b.attackRange && gridDistance < minGridDistance) {
+            minGridDistance = gridDistance;
+            nearest = i;
+        }
+    }
+
+    return nearest;
+}
+
+void BattleRules::updateDefense(BattleBuildingStore& buildings, BattleUnitStore& units, float deltaTime,
+                                std::vector<DefenseShot>& shots, std::vector<uint8_t>& targeted) {
+    targeted.assign(units.size(), 0);
+
+    for (int b = 0; b < buildings.size(); ++b) {
+        const auto& info = buildings.getInfo(b);
+        if (!info.isDefense || !info.active || !buildings.isAlive(b)) continue;
+
+        // 目标有效性检查：句柄失效、已死亡或离开射程都清除锁定
+        UnitHandle targetHandle = buildings.getTarget(b);
+        int targetIndex = units.resolve(targetHandle);
+
+        if (!targetHandle.isNull()) {
+            bool targetValid = targetIndex >= 0 && !units.isDead(targetIndex);
+            if (targetValid) {
+                int centerX = info.gridX + info.gridWidth / 2;
+                int centerY = info.gridY + info.gridHeight / 2;
+                int gridDistance = std::max(
+                    std::abs(static_cast<int>(units.getGridX(targetIndex)) - centerX),
+                    std::abs(static_cast<int>(units.getGridY(targetIndex)) - centerY));
+                targetValid = gridDistance <= info.attackRange;
+            }
+
+            if (!targetValid) {
+                buildings.setTarget(b, UnitHandle());
+                targetIndex = -1;
+            }
+        }
+
+        // 寻找新目标，锁定后立即开火
+        if (targetIndex < 0) {
+            targetIndex = findNearestUnitInRange(buildings, b, units);
+            if (targetIndex >= 0) {
+                buildings.setTarget(b, units.getHandle(targetIndex));
+                buildings.setCooldown(b, 0.0f);
+            }
+        }
+
+        if (targetIndex < 0) continue;
+        targeted[targetIndex] = 1;
+
+        float cooldown = buildings.getCooldown(b) - deltaTime;
+        buildings.setCooldown(b, cooldown);
+        if (cooldown > 0.0f) continue;
+
+        int damagePerShot = static_cast<int>(info.damagePerSecond * info.attackSpeed);
+        units.applyDamage(targetIndex, damagePerShot);
+        buildings.setCooldown(b, info.attackSpeed);
+
+        bool killed = units.isDead(targetIndex);
+        if (killed) {
+            buildings.setTarget(b, UnitHandle());
+            targeted[targetIndex] = 0;
+        }
+        shots.push_back({ b, targetIndex, damagePerShot, killed });
+    }
+}
+
+bool BattleRules::isCellInTrapRange(const BattleBuildingInfo& trap, float gridX, float gridY) {
+    int unitGridX = static_cast<int>(std::floor(gridX));
+    int unitGridY = static_cast<int>(std::floor(gridY));
+
+    // 炸弹（401）：1x1格子
+    if (trap.type == 401) {
+        return unitGridX == trap.gridX && unitGridY == trap.gridY;
+    }
+    // 巨型炸弹（404）：2x2格子
+    if (trap.type == 404) {
+        return unitGridX >= trap.gridX && unitGridX <= trap.gridX + 1 &&
+               unitGridY >= trap.gridY && unitGridY <= trap.gridY + 1;
+    }
+    return false;
+}
+
+void BattleRules::updateTraps(BattleBuildingStore& buildings, BattleUnitStore& units,
+                              std::map<int, float>& trapTimers, float deltaTime,
+                              std::vector<TrapEvent>& events) {
+    if (units.empty()) return;
+
+    for (int b = 0; b < buildings.size(); ++b) {
+        const auto& trap = buildings.getInfo(b);
+
+        // 只处理陷阱（401: 炸弹, 404: 巨型炸弹）
+        if (trap.type != 401 && trap.type != 404) continue;
+        if (!buildings.isAlive(b)) continue;
+
+        // 已触发：倒计时结束后爆炸，对范围内的地面单位造成伤害
+        auto timer = trapTimers.find(trap.id);
+        if (timer != trapTimers.end()) {
+            timer->second -= deltaTime;
+            if (timer->second > 0.0f) continue;
+
+            // 先标记为已摧毁，爆炸时投递的摧毁事件按最新状态统计
+            buildings.destroy(b);
+            trapTimers.erase(timer);
+
+            for (int i = 0; i < units.size(); ++i) {
+                if (units.isDead(i)) continue;
+                if (units.hasFlag(i, BattleUnitStore::FLAG_FLYING)) continue;
+                if (!isCellInTrapRange(trap, units.getGridX(i), units.getGridY(i))) continue;
+
+                units.applyDamage(i, trap.damagePerSecond);
+                events.push_back({ TrapEvent::Kind::UNIT_HIT, b, i, units.isDead(i) });
+            }
+            events.push_back({ TrapEvent::Kind::EXPLODED, b, -1, false });
+            continue;
+        }
+
+        // 未触发：地面单位进入范围后开始倒计时（飞行单位不触发）
+        for (int i = 0; i < units.size(); ++i) {
+            if (units.isDead(i)) continue;
+            if (units.hasFlag(i, BattleUnitStore::FLAG_FLYING)) continue;
+
+            if (isCellInTrapRange(trap, units.getGridX(i), units.getGridY(i))) {
+                trapTimers[trap.id] = TRAP_DELAY;
+                events.push_back({ TrapEvent::Kind::TRIGGERED, b, i, false });
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+﻿// BattleRules.h
+// 战斗规则声明：目标选择、接近路线、射程、伤害、防御建筑和陷阱的结算，实时战斗与无界面模拟共用
+
+#ifndef __BATTLE_RULES_H__
+#define __BATTLE_RULES_H__
+
+#include "cocos2d.h"
+#include "../Model/BattleBuildingStore.h"
+#include "../Model/BattleUnitStore.h"
+#include "../Manager/AnimationManager.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class FindPathUtil;
+
+// 战斗规则
+// 职责：只读写传入的建筑状态表、单位数据和寻路实例，不访问任何单例，也不处理动画、音效和事件
+// 实时战斗（BattleProcessController / DefenseSystem / TrapSystem）按结果驱动精灵表现，
+// HeadlessBattleSim 在自己的状态表副本上调用同一套函数推演
+class BattleRules {
+public:
+    static constexpr float UNIT_MOVE_SPEED = 100.0f;        // 兵种行走速度（像素/秒）
+    static constexpr float DETOUR_THRESHOLD = 800.0f;       // 绕路比直线多出的最大长度（像素），超过则破墙
+    static constexpr float TRAP_DELAY = 0.5f;               // 陷阱触发到爆炸的延迟（秒）
+    static constexpr int WALL_BREAKER_WALL_MULTIPLIER = 10; // 炸弹兵对城墙的伤害倍数
+
+    // 接近目标的路线
+    struct Route {
+        std::vector<cocos2d::Vec2> path;    // 像素坐标路径点，破墙时为到城墙的路径（可能为空）
+        int forcedWall = -1;                // 需要先攻击的城墙下标，-1 表示直接攻击目标
+    };
+
+    // 防御建筑的一次射击
+    struct DefenseShot {
+        int building;
+        int unit;
+        int damage;
+        bool killed;
+    };
+
+    // 陷阱事件（同一次爆炸的 UNIT_HIT 排在 EXPLODED 之前）
+    struct TrapEvent {
+        enum class Kind : uint8_t { TRIGGERED, UNIT_HIT, EXPLODED };
+        Kind kind;
+        int trap;
+        int unit;       // TRIGGERED 为踩中陷阱的单位，UNIT_HIT 为受伤单位，EXPLODED 为 -1
+        bool killed;
+    };
+
+    // ========== 兵种参数 ==========
+
+    // 攻击范围（格）
+    static int getAttackRange(UnitTypeID type);
+
+    // 一次攻击的时长（攻击动画帧数 x 帧间隔，气球为投弹延迟），攻击在结束时结算
+    static float getAttackDuration(UnitTypeID type, AnimationType animType);
+
+    // 按攻击方向选择攻击动画和水平翻转（八方向）
+    static void selectAttackAnimation(const cocos2d::Vec2& direction, AnimationType& outAnimType, bool& outFlipX);
+
+    // ========== 目标与路线 ==========
+
+    // 选择攻击目标，返回建筑下标，没有目标返回 -1
+    // 炸弹兵找最近的城墙，哥布林资源优先，巨人/气球防御优先，其余兵种找最近的建筑
+    static int findTarget(const BattleBuildingStore& buildings, UnitTypeID type, const cocos2d::Vec2& unitPixel);
+    static int findNearestWall(const BattleBuildingStore& buildings, const cocos2d::Vec2& unitPixel);
+
+    // 单位是否在目标的攻击范围内（气球按像素距离，其余按到建筑矩形的格子距离）
+    static bool isInAttackRange(const BattleBuildingStore& buildings, int index,
+                                UnitTypeID type, const cocos2d::Vec2& unitPixel);
+
+    // 选定目标后的接近路线：绕路可接受时绕路，否则破开直线上的第一面城墙，都不行时直线前进
+    static Route planRoute(const BattleBuildingStore& buildings, FindPathUtil& pathfinder,
+                           UnitTypeID type, const cocos2d::Vec2& unitPixel, int target);
+
+    // 走到目标攻击范围内的路径，寻路失败时直线前往目标
+    static std::vector<cocos2d::Vec2> planApproach(const BattleBuildingStore& buildings, FindPathUtil& pathfinder,
+                                                   UnitTypeID type, const cocos2d::Vec2& unitPixel, int target);
+
+    // 两点连线上第一面存活的城墙，没有返回 -1
+    static int findFirstWallInLine(const BattleBuildingStore& buildings, FindPathUtil& pathfinder,
+                                   const cocos2d::Vec2& startPixel, const cocos2d::Vec2& endPixel);
+
+    // 正在破墙的单位是否已有可接受的绕路路线
+    static bool shouldAbandonWall(const BattleBuildingStore& buildings, FindPathUtil& pathfinder,
+                                  UnitTypeID type, const cocos2d::Vec2& unitPixel);
+
+    // ========== 结算 ==========
+
+    // 兵种攻击建筑一次，返回实际伤害（炸弹兵对城墙按倍数计算）
+    static int applyUnitAttack(BattleBuildingStore& buildings, int index, UnitTypeID type, int baseDamage);
+
+    // 防御建筑锁定和射击；targeted 输出本步被锁定的单位（按单位下标）
+    static void updateDefense(BattleBuildingStore& buildings, BattleUnitStore& units, float deltaTime,
+                              std::vector<DefenseShot>& shots, std::vector<uint8_t>& targeted);
+
+    // 陷阱触发和爆炸；trapTimers 为已触发陷阱ID -> 剩余延迟
+    static void updateTraps(BattleBuildingStore& buildings, BattleUnitStore& units,
+                            std::map<int, float>& trapTimers, float deltaTime,
+                            std::vector<TrapEvent>& events);
+
+    // 防御建筑射程内最近的单位下标，没有返回 -1
+    static int findNearestUnitInRange(const BattleBuildingStore& buildings, int building, const BattleUnitStore& units);
+
+    // 网格坐标是否落在陷阱范围内（炸弹 1x1，巨型炸弹 2x2）
+    static bool isCellInTrapRange(const BattleBuildingInfo& trap, float gridX, float gridY);
+};
+
+#endif // __BATTLE_RULES_H__
@@ -5,40 +5,31 @@
 #define __DEFENSE_SYSTEM_H__
 
 #include "cocos2d.h"
+#include "BattleRules.h"
 #include <vector>
-#include <set>
 
-class BattleUnitSprite;
 class BattleTroopLayer;
-struct BuildingInstance;
 
 // 建筑防御系统类
 // 职责：防御建筑自动锁定目标、攻击逻辑、播放攻击动画
+// 锁定和伤害结算由 BattleRules::updateDefense 完成，这里按射击结果驱动精灵表现
 class DefenseSystem {
 public:
     static DefenseSystem* getInstance();
     static void destroyInstance();
     
-    // 更新建筑防御（每帧调用）
-    void updateBuildingDefense(BattleTroopLayer* troopLayer);
-    
-    // 查找攻击范围内最近的兵种
-    BattleUnitSprite* findNearestUnitInRange(
-        const BuildingInstance& building, 
-        float attackRange, 
-        BattleTroopLayer* troopLayer);
-    
-    // 获取攻击范围内所有兵种
-    std::vector<BattleUnitSprite*> getAllUnitsInRange(
-        const BuildingInstance& building, 
-        float attackRange, 
-        BattleTroopLayer* troopLayer);
+    // 更新建筑防御（每帧调用，deltaTime 为战斗时钟步长，倍速回放时已放大）
+    void updateBuildingDefense(BattleTroopLayer* troopLayer, float deltaTime);
 
 private:
     DefenseSystem() = default;
     ~DefenseSystem() = default;
     
     static DefenseSystem* _instance;
+
+    // 每帧复用的结算缓冲
+    std::vector<BattleRules::DefenseShot> _shots;
+    std::vector<uint8_t> _targeted;
 };
 
 #endif // __DEFENSE_SYSTEM_H__
@@ -2,9 +2,11 @@
 // 摧毁进度追踪系统实现，管理战斗中建筑摧毁进度和星级判定
 
 #include "DestructionTracker.h"
+#include "BattleEventBus.h"
 #include "../Manager/VillageDataManager.h"
 #include "../Model/BuildingConfig.h"
 #include "../Model/VillageData.h"
+#include <algorithm>
 
 USING_NS_CC;
 
@@ -26,12 +28,30 @@ void DestructionTracker::destroyInstance() {
 
 void DestructionTracker::reset() {
     _totalBuildingHP = 0;
+    _remainingBuildingHP = 0;
+    _trackedBuildingCount = 0;
+    _aliveBuildingIds.clear();
+    _lastReportedPercent = -1;
     _currentStars = 0;
     _townHallDestroyed = false;
+    _starTownHallAwarded = false;
     _star50Awarded = false;
     _star100Awarded = false;
 }
 
+bool DestructionTracker::isTrackedBuilding(const BuildingInstance& building) {
+    // 跳过城墙（type == 303）
+    if (building.type == 303) return false;
+
+    // 跳过陷阱（type >= 400 && type < 500）
+    if (building.type >= 400 && building.type < 500) return false;
+
+    // 跳过未建造完成的建筑
+    if (building.state != BuildingInstance::State::BUILT) return false;
+
+    return true;
+}
+
 // ==========================================
 // 初始化摧毁追踪
 // ==========================================
@@ -40,13 +60,47 @@ void DestructionTracker::initTracking() {
     // 重置所有追踪变量
     reset();
 
-    // 计算总血量
-    _totalBuildingHP = calculateTotalBuildingHP();
+    // 订阅战斗事件（只订阅一次）
+    if (_busSubscriptionId == 0) {
+        _busSubscriptionId = BattleEventBus::getInstance()->subscribe(
+            BattleEventBus::maskOf(BattleEventType::BUILDING_DAMAGED) |
+            BattleEventBus::maskOf(BattleEventType::BUILDING_DESTROYED),
+            [this](const BattleEvent& event) { onBattleEvent(event); });
+    }
+
+    // 唯一一次全量扫描：建立总血量、剩余血量和存活建筑集合
+    auto dataManager = VillageDataManager::getInstance();
+    const auto& buildings = dataManager->getBattleBuildings();
+    const auto& battleState = dataManager->getBattleState();
+
+    for (int i = 0; i < battleState.size(); ++i) {
+        const auto& building = buildings[i];
+        if (!isTrackedBuilding(building)) continue;
+
+        auto config = BuildingConfig::getInstance()->getConfig(building.type);
+        if (!config || config->hitPoints <= 0) continue;
+
+        _totalBuildingHP += config->hitPoints;
+        _trackedBuildingCount++;
+
+        if (battleState.isAlive(i)) {
+            _remainingBuildingHP += battleState.getHP(i);
+            _aliveBuildingIds.insert(building.id);
+        } else if (building.type == 1) {
+            _townHallDestroyed = true;
+            _starTownHallAwarded = true;
+        }
+    }
+
+    // 从战斗中途的状态初始化（回放跳转）时，已满足的星级条件直接计入，不重复投递星星事件
+    _star50Awarded = getProgress() >= 50.0f;
+    _star100Awarded = areAllBuildingsDestroyed();
+    _currentStars = (_star50Awarded ? 1 : 0) + (_townHallDestroyed ? 1 : 0) + (_star100Awarded ? 1 : 0);
 
-    CCLOG("========================================");
-    CCLOG("DestructionTracker: Destruction tracking initialized");
-    CCLOG("Total Building HP: %d (excluding walls and traps)", _totalBuildingHP);
-    CCLOG("========================================");
+    _lastReportedPercent = static_cast<int>(getProgress());
+
+    CCLOG("DestructionTracker: Tracking %d buildings, Total HP=%d, Remaining HP=%d",
+          _trackedBuildingCount, _totalBuildingHP, _remainingBuildingHP);
 }
 
 // ==========================================
@@ -55,113 +109,78 @@ void DestructionTracker::initTracking() {
 
 int DestructionTracker::calculateTotalBuildingHP() {
     auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
+    const auto& buildings = dataManager->getBattleBuildings();
 
     int totalHP = 0;
-    int buildingCount = 0;
 
     for (const auto& building : buildings) {
-        // 跳过城墙（type == 303）
-        if (building.type == 303) continue;
-
-        // 跳过陷阱（type >= 400 && type < 500）
-        if (building.type >= 400 && building.type < 500) continue;
+        if (!isTrackedBuilding(building)) continue;
 
-        // 跳过未建造完成的建筑
-        if (building.state != BuildingInstance::State::BUILT) continue;
-
-        // 获取建筑配置
         auto config = BuildingConfig::getInstance()->getConfig(building.type);
-        if (!config) continue;
-
-        // 累加血量
-        int maxHP = config->hitPoints;
-        if (maxHP > 0) {
-            totalHP += maxHP;
-            buildingCount++;
-
-            CCLOG("  [%d] Type=%d, HP=%d", building.id, building.type, maxHP);
+        if (config && config->hitPoints > 0) {
+            totalHP += config->hitPoints;
         }
     }
 
-    CCLOG("DestructionTracker: Total %d buildings tracked, Total HP=%d",
-          buildingCount, totalHP);
-
     return totalHP;
 }
 
 // ==========================================
-// 更新摧毁进度
+// 增量更新
 // ==========================================
 
-void DestructionTracker::updateProgress() {
-    // 如果总血量为0，说明没有初始化或没有建筑
-    if (_totalBuildingHP <= 0) {
-        CCLOG("DestructionTracker: Total HP is 0, skipping progress update");
-        return;
+void DestructionTracker::onBattleEvent(const BattleEvent& event) {
+    if (event.type == BattleEventType::BUILDING_DAMAGED) {
+        onBuildingDamaged(event.buildingId, event.value);
+    } else if (event.type == BattleEventType::BUILDING_DESTROYED) {
+        onBuildingDestroyed(event.buildingId, event.buildingType);
     }
+}
 
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
+void DestructionTracker::onBuildingDamaged(int buildingId, int damage) {
+    if (damage <= 0) return;
+    if (_aliveBuildingIds.find(buildingId) == _aliveBuildingIds.end()) return;
 
-    // 计算当前剩余血量
-    int currentTotalHP = 0;
-    bool townHallDestroyed = false;
+    _remainingBuildingHP = std::max(0, _remainingBuildingHP - damage);
 
-    for (const auto& building : buildings) {
-        // 使用与 calculateTotalBuildingHP 相同的过滤逻辑
-        if (building.type == 303) continue;
-        if (building.type >= 400 && building.type < 500) continue;
-        if (building.state != BuildingInstance::State::BUILT) continue;
-
-        // 检查大本营状态（type == 1）
-        if (building.type == 1 && building.isDestroyed) {
-            townHallDestroyed = true;
-        }
+    // 按伤害推进进度，整数百分比变化时才刷新UI和星级
+    if (static_cast<int>(getProgress()) != _lastReportedPercent) {
+        updateProgress();
+    }
+}
 
-        // 累加当前血量
-        if (!building.isDestroyed && building.currentHP > 0) {
-            currentTotalHP += building.currentHP;
-        }
+void DestructionTracker::onBuildingDestroyed(int buildingId, int buildingType) {
+    if (_aliveBuildingIds.erase(buildingId) == 0) return;
+
+    if (buildingType == 1) {
+        _townHallDestroyed = true;
     }
 
-    // 计算摧毁进度
-    float progress = ((_totalBuildingHP - currentTotalHP) / (float)_totalBuildingHP) * 100.0f;
+    updateProgress();
+}
 
-    // 限制在 0-100 范围内
-    if (progress < 0.0f) progress = 0.0f;
-    if (progress > 100.0f) progress = 100.0f;
+// ==========================================
+// 更新摧毁进度
+// ==========================================
 
-    CCLOG("========================================");
-    CCLOG("DestructionTracker: Progress Updated");
-    CCLOG("  Total HP: %d", _totalBuildingHP);
-    CCLOG("  Current HP: %d", currentTotalHP);
-    CCLOG("  Destroyed HP: %d", _totalBuildingHP - currentTotalHP);
-    CCLOG("  Progress: %.1f%%", progress);
-    CCLOG("  Town Hall Destroyed: %s", townHallDestroyed ? "YES" : "NO");
-    CCLOG("========================================");
-
-    // 先检查星级条件（此时 _townHallDestroyed 还是旧值）
-    checkStarConditions(progress, townHallDestroyed);
-
-    // 然后再更新大本营状态（放在检查之后）
-    _townHallDestroyed = townHallDestroyed;
-
-    // 发送进度更新事件
-    DestructionProgressEventData eventData;
-    eventData.progress = progress;
-    eventData.stars = _currentStars;
-
-    EventCustom event("EVENT_DESTRUCTION_PROGRESS_UPDATED");
-    event.setUserData(&eventData);
-    Director::getInstance()->getEventDispatcher()->dispatchEvent(&event);
+void DestructionTracker::updateProgress() {
+    // 如果总血量为0，说明没有初始化或没有建筑
+    if (_totalBuildingHP <= 0) return;
+
+    float progress = getProgress();
+    _lastReportedPercent = static_cast<int>(progress);
+
+    checkStarConditions(progress);
+
+    // 投递进度更新事件
+    BattleEventBus::getInstance()->postProgress(progress, _currentStars);
 }
 
 // ==========================================
 // 检查星级条件
 // ==========================================
 
-void DestructionTracker::checkStarConditions(float progress, bool townHallDestroyed) {
+void DestructionTracker::checkStarConditions(float progress) {
     int oldStars = _currentStars;
 
     // 三个条件独立累加，每个条件各加1颗星
@@ -170,75 +189,45 @@ void DestructionTracker::checkStarConditions(float progress, bool townHallDestro
     // ========== 第1颗星：摧毁进度 >= 50% ==========
     if (progress >= 50.0f) {
         newStars++;
-        
+
         if (!_star50Awarded) {
             _star50Awarded = true;
-            
-            CCLOG("*** STAR AWARDED! ***");
-            CCLOG("  Reason: 50%% Destruction");
-            CCLOG("  Progress: %.1f%%", progress);
-
-            // 发送星星获得事件
-            StarAwardedEventData starData;
-            starData.starIndex = 0;  // 第1颗星（索引0）
-            starData.reason = "50%";
-
-            EventCustom event("EVENT_STAR_AWARDED");
-            event.setUserData(&starData);
-            Director::getInstance()->getEventDispatcher()->dispatchEvent(&event);
+
+            // 投递星星获得事件
+            BattleEventBus::getInstance()->postStarAwarded(0);  // 第1颗星（索引0）
         }
     }
 
     // ========== 第2颗星：大本营被摧毁 ==========
-    if (townHallDestroyed) {
+    if (_townHallDestroyed) {
         newStars++;
-        
-        if (!_townHallDestroyed) {
-            CCLOG("*** STAR AWARDED! ***");
-            CCLOG("  Reason: Town Hall Destroyed");
-
-            // 发送星星获得事件
-            StarAwardedEventData starData;
-            starData.starIndex = 1;  // 第2颗星（索引1）
-            starData.reason = "townhall";
-
-            EventCustom event("EVENT_STAR_AWARDED");
-            event.setUserData(&starData);
-            Director::getInstance()->getEventDispatcher()->dispatchEvent(&event);
+
+        if (!_starTownHallAwarded) {
+            _starTownHallAwarded = true;
+
+            // 投递星星获得事件
+            BattleEventBus::getInstance()->postStarAwarded(1);  // 第2颗星（索引1）
         }
     }
 
-    // ========== 第3颗星：摧毁进度 == 100% ==========
-    if (progress >= 99.9f) {  // 使用 99.9 避免浮点误差
+    // ========== 第3颗星：全部摧毁 ==========
+    if (areAllBuildingsDestroyed()) {
         newStars++;
-        
+
         if (!_star100Awarded) {
             _star100Awarded = true;
 
-            CCLOG("*** STAR AWARDED! ***");
-            CCLOG("  Reason: 100%% Destruction");
-            CCLOG("  Progress: %.1f%%", progress);
-
-            // 发送星星获得事件
-            StarAwardedEventData starData;
-            starData.starIndex = 2;  // 第3颗星（索引2）
-            starData.reason = "100%";
-
-            EventCustom event("EVENT_STAR_AWARDED");
-            event.setUserData(&starData);
-            Director::getInstance()->getEventDispatcher()->dispatchEvent(&event);
+            // 投递星星获得事件
+            BattleEventBus::getInstance()->postStarAwarded(2);  // 第3颗星（索引2）
         }
     }
 
     // 更新星数
     _currentStars = newStars;
 
-    // 如果星数发生变化，输出日志
     if (_currentStars != oldStars) {
-        CCLOG("DestructionTracker: Stars updated: %d -> %d", oldStars, _currentStars);
-        CCLOG("  - 50%% progress: %s", progress >= 50.0f ? "YES" : "NO");
-        CCLOG("  - Town Hall destroyed: %s", townHallDestroyed ? "YES" : "NO");
-        CCLOG("  - 100%% progress: %s", progress >= 99.9f ? "YES" : "NO");
+        CCLOG("DestructionTracker: Stars %d -> %d (progress %.1f%%, alive %zu/%d)",
+              oldStars, _currentStars, progress, _aliveBuildingIds.size(), _trackedBuildingCount);
     }
 }
 
@@ -246,25 +235,11 @@ void DestructionTracker::checkStarConditions(float progress, bool townHallDestro
 // 获取当前进度
 // ==========================================
 
-float DestructionTracker::getProgress() {
+float DestructionTracker::getProgress() const {
     if (_totalBuildingHP <= 0) return 0.0f;
+    if (areAllBuildingsDestroyed()) return 100.0f;
 
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
-
-    int currentTotalHP = 0;
-
-    for (const auto& building : buildings) {
-        if (building.type == 303) continue;
-        if (building.type >= 400 && building.type < 500) continue;
-        if (building.state != BuildingInstance::State::BUILT) continue;
-
-        if (!building.isDestroyed && building.currentHP > 0) {
-            currentTotalHP += building.currentHP;
-        }
-    }
-
-    float progress = ((_totalBuildingHP - currentTotalHP) / (float)_totalBuildingHP) * 100.0f;
+    float progress = ((_totalBuildingHP - _remainingBuildingHP) / (float)_totalBuildingHP) * 100.0f;
 
     if (progress < 0.0f) progress = 0.0f;
     if (progress > 100.0f) progress = 100.0f;
@@ -272,6 +247,10 @@ float DestructionTracker::getProgress() {
     return progress;
 }
 
-int DestructionTracker::getStars() {
+int DestructionTracker::getStars() const {
     return _currentStars;
 }
+
+bool DestructionTracker::areAllBuildingsDestroyed() const {
+    return _trackedBuildingCount > 0 && _aliveBuildingIds.empty();
+}
@@ -5,59 +5,75 @@
 #define __DESTRUCTION_TRACKER_H__
 
 #include "cocos2d.h"
-#include <string>
+#include <unordered_set>
+
+struct BuildingInstance;
+struct BattleEvent;
 
 // 摧毁进度追踪系统类
-// 职责：计算总血量、追踪摧毁进度、检查和发送星级事件
+// 职责：维护剩余血量/存活建筑计数、追踪摧毁进度、检查和发送星级事件
+// 战斗开始时扫描一次建筑，之后只根据战斗事件总线上的伤害/摧毁事件增量更新（O(1)）
 class DestructionTracker {
 public:
     static DestructionTracker* getInstance();
     static void destroyInstance();
-    
-    // 初始化摧毁追踪（战斗开始时调用）
+
+    // 初始化摧毁追踪（战斗开始或更换对手时调用）
     void initTracking();
-    
+
     // 计算总血量（排除城墙和陷阱）
     int calculateTotalBuildingHP();
-    
-    // 更新摧毁进度（建筑被摧毁时调用）
+
+    // 建筑受到伤害时调用（damage 为实际扣除的血量）
+    void onBuildingDamaged(int buildingId, int damage);
+
+    // 建筑被摧毁时调用
+    void onBuildingDestroyed(int buildingId, int buildingType);
+
+    // 根据当前计数重新判定星级并投递进度事件
     void updateProgress();
-    
+
     // 获取当前摧毁进度百分比 (0.0-100.0)
-    float getProgress();
-    
+    float getProgress() const;
+
     // 获取当前星数 (0-3)
-    int getStars();
-    
+    int getStars() const;
+
+    // 所有计入进度的建筑是否都已被摧毁
+    bool areAllBuildingsDestroyed() const;
+
+    // 剩余存活的计入进度建筑数量
+    int getAliveBuildingCount() const { return static_cast<int>(_aliveBuildingIds.size()); }
+
     // 重置追踪状态
     void reset();
 
+    // 是否计入摧毁进度（排除城墙、陷阱和未建造完成的建筑）
+    static bool isTrackedBuilding(const BuildingInstance& building);
+
 private:
     DestructionTracker() = default;
     ~DestructionTracker() = default;
-    
+
     static DestructionTracker* _instance;
-    
-    // 检查星级条件并发送事件
-    void checkStarConditions(float progress, bool townHallDestroyed);
-    
-    int _totalBuildingHP = 0;        // 总血量（不含城墙和陷阱）
-    int _currentStars = 0;           // 当前星数
-    bool _townHallDestroyed = false; // 大本营是否已摧毁
-    bool _star50Awarded = false;     // 50%星是否已获得
-    bool _star100Awarded = false;    // 100%星是否已获得
-};
 
-// 摧毁进度更新事件数据
-struct DestructionProgressEventData {
-    float progress;  // 进度百分比 (0.0-100.0)
-    int stars;       // 当前星数 (0-3)
-};
+    // 战斗事件总线回调
+    void onBattleEvent(const BattleEvent& event);
+    int _busSubscriptionId = 0;
+
+    // 检查星级条件并发送事件
+    void checkStarConditions(float progress);
 
-// 星星获得事件数据
-struct StarAwardedEventData {
-    int starIndex;          // 获得的星星索引 (0/1/2)
-    std::string reason;     // 获得原因 ("50%", "townhall", "100%")
+    int _totalBuildingHP = 0;            // 总血量（不含城墙和陷阱）
+    int _remainingBuildingHP = 0;        // 剩余血量
+    int _trackedBuildingCount = 0;       // 计入进度的建筑总数
+    std::unordered_set<int> _aliveBuildingIds;  // 存活的计入进度建筑ID
+    int _lastReportedPercent = -1;       // 上次发送进度事件时的整数百分比
+    int _currentStars = 0;               // 当前星数
+    bool _townHallDestroyed = false;     // 大本营是否已摧毁
+    bool _starTownHallAwarded = false;   // 大本营星是否已获得
+    bool _star50Awarded = false;         // 50%星是否已获得
+    bool _star100Awarded = false;        // 100%星是否已获得
 };
 
 #endif // __DESTRUCTION_TRACKER_H__
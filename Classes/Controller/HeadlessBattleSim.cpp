@@ -0,0 +1,644 @@
+﻿// HeadlessBattleSim.cpp
+// 无界面战斗模拟器实现，按固定步长推演兵种AI、防御建筑和陷阱，战斗规则与实时战斗共用 BattleRules
+
+#include "HeadlessBattleSim.h"
+#include "../Model/BattleMapData.h"
+#include "Model/ReplayData.h"
+#include "../Model/TroopConfig.h"
+#include "../Util/FindPathUtil.h"
+#include "../Util/GridMapUtils.h"
+#include "BattleRules.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+const int GRID_W = GridMapUtils::GRID_WIDTH;
+const int GRID_H = GridMapUtils::GRID_HEIGHT;
+
+// 状态哈希采样间隔（推演步数）
+const int HASH_SAMPLE_TICKS = static_cast<int>(BattleStateHasher::SAMPLE_INTERVAL / HeadlessBattleSim::TICK + 0.5f);
+
+// followPath 没有有效移动时的最短延迟，以及目标被摧毁后切换目标的保护时间（与 BattleProcessController 一致）
+const float MIN_MOVE_DELAY = 0.1f;
+const float CHANGE_TARGET_DELAY = 0.1f;
+
+// 单位当前的动作完成后要执行的流程
+enum class SimNext : uint8_t {
+    NONE,
+    COMBAT,             // startCombatLoop
+    COMBAT_FORCED,      // startCombatLoopWithForcedTarget
+    EXECUTE,            // executeAttack（普通目标）
+    EXECUTE_FORCED      // executeAttack（强制攻击的城墙）
+};
+
+// 单位AI状态（对应精灵上正在执行的移动/攻击动作）
+struct SimUnit {
+    UnitTypeID type;
+    int troopId;
+    int damage;
+    cocos2d::Vec2 pos;                  // 像素坐标
+    std::vector<cocos2d::Vec2> path;    // 剩余路径点（已去掉与当前位置重合的点）
+    size_t pathIndex = 0;
+    float timer = 0.0f;                 // 攻击动画或最短延迟的剩余时间
+    float changingTimer = 0.0f;         // 切换目标保护的剩余时间
+    int targetId = -1;                  // 攻击动作结算的目标建筑ID
+    SimNext next = SimNext::NONE;
+};
+
+// 一场模拟的运行状态，流程函数与 BattleProcessController 一一对应
+class SimBattle {
+public:
+    SimBattle(const HeadlessBattleSetup& setup, SimResult& result)
+        : _setup(setup), _result(result), _buildings(setup.buildings) {
+        _pathfinder.updatePathfindingMap(_buildings);
+    }
+
+    void deploy(const SimDeployment& d) {
+        const SimTroopInfo& info = _setup.troops.at(d.troopId);
+        SimUnit unit;
+        unit.type = static_cast<UnitTypeID>(d.troopId);
+        unit.troopId = d.troopId;
+        unit.damage = info.damage;
+        unit.pos = GridMapUtils::gridToPixelCenter(d.gridX, d.gridY);
+
+        int index = _units.add(unit.type, info.hitpoints, static_cast<float>(d.gridX), static_cast<float>(d.gridY), nullptr);
+        _sim.push_back(unit);
+        startUnitAI(index);
+    }
+
+    // 推进所有单位的动作，返回是否还有单位在行动
+    bool updateUnits(float dt) {
+        bool anyActive = false;
+        for (int i = 0; i < _units.size(); ++i) {
+            if (_units.isDead(i)) continue;
+            SimUnit& u = _sim[i];
+
+            if (u.changingTimer > 0.0f) {
+                u.changingTimer -= dt;
+                if (u.changingTimer <= 0.0f) _units.setFlag(i, BattleUnitStore::FLAG_CHANGING_TARGET, false);
+            }
+
+            if (u.next == SimNext::NONE) continue;
+            anyActive = true;
+
+            if (u.pathIndex < u.path.size()) {
+                // 沿路径点匀速移动，到达一个路径点后剩余时间继续走下一段
+                float step = BattleRules::UNIT_MOVE_SPEED * dt;
+                while (step > 0.0f && u.pathIndex < u.path.size()) {
+                    const cocos2d::Vec2& waypoint = u.path[u.pathIndex];
+                    float distance = u.pos.distance(waypoint);
+                    if (distance <= step) {
+                        u.pos = waypoint;
+                        step -= distance;
+                        u.pathIndex++;
+                    } else {
+                        u.pos += (waypoint - u.pos) * (step / distance);
+                        step = 0.0f;
+                    }
+                }
+                if (u.pathIndex < u.path.size()) continue;
+            } else {
+                u.timer -= dt;
+                if (u.timer > 0.0f) continue;
+            }
+
+            SimNext next = u.next;
+            u.next = SimNext::NONE;
+            u.path.clear();
+            u.pathIndex = 0;
+            complete(i, next);
+        }
+
+        // 与 BattleUnitSprite::update 一样按像素位置回写网格坐标
+        for (int i = 0; i < _units.size(); ++i) {
+            if (_units.isDead(i)) continue;
+            cocos2d::Vec2 grid = GridMapUtils::pixelToGrid(_sim[i].pos);
+            _units.setGridPosition(i, grid.x, grid.y);
+        }
+        return anyActive;
+    }
+
+    void updateDefense(float dt) {
+        _shots.clear();
+        BattleRules::updateDefense(_buildings, _units, dt, _shots, _targeted);
+        for (int i = 0; i < _units.size(); ++i) {
+            if (!_units.isDead(i)) _units.setFlag(i, BattleUnitStore::FLAG_TARGETED, _targeted[i] != 0);
+        }
+    }
+
+    void updateTraps(float dt) {
+        _trapEvents.clear();
+        BattleRules::updateTraps(_buildings, _units, _trapTimers, dt, _trapEvents);
+    }
+
+    const BattleBuildingStore& getBuildings() const { return _buildings; }
+    const BattleUnitStore& getUnits() const { return _units; }
+
+private:
+    const HeadlessBattleSetup& _setup;
+    SimResult& _result;
+    BattleBuildingStore _buildings;
+    BattleUnitStore _units;             // 阵亡单位保留在表中（下标不变），各规则函数按 isDead 跳过
+    std::vector<SimUnit> _sim;          // 与 _units 下标一致
+    FindPathUtil _pathfinder;
+    std::map<int, float> _trapTimers;
+
+    std::vector<BattleRules::DefenseShot> _shots;
+    std::vector<uint8_t> _targeted;
+    std::vector<BattleRules::TrapEvent> _trapEvents;
+
+    void complete(int i, SimNext next) {
+        const SimUnit& u = _sim[i];
+        switch (next) {
+            case SimNext::COMBAT:         startCombatLoop(i); break;
+            case SimNext::COMBAT_FORCED:  startCombatLoopWithForcedTarget(i, _units.getForcedTargetId(i)); break;
+            case SimNext::EXECUTE:        executeAttack(i, u.targetId, false); break;
+            case SimNext::EXECUTE_FORCED: executeAttack(i, u.targetId, true); break;
+            case SimNext::NONE:           break;
+        }
+    }
+
+    // BattleUnitSprite::followPath：跳过与当前位置重合的路径点，没有有效移动时等待最短延迟
+    void followPath(int i, const std::vector<cocos2d::Vec2>& path, SimNext next) {
+        SimUnit& u = _sim[i];
+        if (path.empty()) {
+            complete(i, next);
+            return;
+        }
+
+        u.path.clear();
+        u.pathIndex = 0;
+        cocos2d::Vec2 current = u.pos;
+        for (const auto& waypoint : path) {
+            if (current.distance(waypoint) < 0.1f) continue;
+            u.path.push_back(waypoint);
+            current = waypoint;
+        }
+        u.timer = u.path.empty() ? MIN_MOVE_DELAY : 0.0f;
+        u.next = next;
+    }
+
+    // BattleUnitSprite::attackTowardPosition：按攻击方向选择的动画时长结束后结算
+    void attackTowardPosition(int i, const cocos2d::Vec2& targetPos, int targetId, bool forced) {
+        SimUnit& u = _sim[i];
+        cocos2d::Vec2 direction = targetPos - u.pos;
+        if (direction.length() < 0.1f) direction = cocos2d::Vec2(1, 0);
+
+        AnimationType animType;
+        bool flipX;
+        BattleRules::selectAttackAnimation(direction, animType, flipX);
+
+        u.path.clear();
+        u.pathIndex = 0;
+        u.timer = BattleRules::getAttackDuration(u.type, animType);
+        u.targetId = targetId;
+        u.next = forced ? SimNext::EXECUTE_FORCED : SimNext::EXECUTE;
+    }
+
+    void startUnitAI(int i) {
+        SimUnit& u = _sim[i];
+        _units.setForcedTargetId(i, -1);
+
+        int target = BattleRules::findTarget(_buildings, u.type, u.pos);
+        if (target < 0) {
+            u.next = SimNext::NONE;     // 原地待机
+            return;
+        }
+        _units.setTargetBuildingId(i, _buildings.getInfo(target).id);
+
+        BattleRules::Route route = BattleRules::planRoute(_buildings, _pathfinder, u.type, u.pos, target);
+        if (route.forcedWall >= 0) {
+            int wallId = _buildings.getInfo(route.forcedWall).id;
+            _units.setForcedTargetId(i, wallId);
+            if (route.path.empty()) {
+                startCombatLoopWithForcedTarget(i, wallId);
+            } else {
+                followPath(i, route.path, SimNext::COMBAT_FORCED);
+            }
+            return;
+        }
+        followPath(i, route.path, SimNext::COMBAT);
+    }
+
+    void startCombatLoop(int i) {
+        SimUnit& u = _sim[i];
+        int target = BattleRules::findTarget(_buildings, u.type, u.pos);
+        if (target < 0) {
+            u.next = SimNext::NONE;
+            return;
+        }
+        if (!BattleRules::isInAttackRange(_buildings, target, u.type, u.pos)) {
+            startUnitAI(i);
+            return;
+        }
+
+        const auto& b = _buildings.getInfo(target);
+        _units.setTargetBuildingId(i, b.id);
+        attackTowardPosition(i, GridMapUtils::gridToPixelCenter(b.gridX, b.gridY), b.id, false);
+    }
+
+    void startCombatLoopWithForcedTarget(int i, int targetId) {
+        SimUnit& u = _sim[i];
+        _units.setForcedTargetId(i, targetId);
+
+        int target = _buildings.indexOf(targetId);
+        if (target < 0 || !_buildings.isAlive(target)) {
+            startUnitAI(i);
+            return;
+        }
+
+        const auto& b = _buildings.getInfo(target);
+        if (b.isWall && BattleRules::shouldAbandonWall(_buildings, _pathfinder, u.type, u.pos)) {
+            startUnitAI(i);
+            return;
+        }
+        if (!b.active) {
+            startUnitAI(i);
+            return;
+        }
+
+        if (!BattleRules::isInAttackRange(_buildings, target, u.type, u.pos)) {
+            followPath(i, BattleRules::planApproach(_buildings, _pathfinder, u.type, u.pos, target),
+                       SimNext::COMBAT_FORCED);
+            return;
+        }
+        attackTowardPosition(i, GridMapUtils::gridToPixelCenter(b.gridX, b.gridY), targetId, true);
+    }
+
+    void continueForcedAttack(int i, int targetId) {
+        SimUnit& u = _sim[i];
+        int target = _buildings.indexOf(targetId);
+        if (target < 0 || !_buildings.isAlive(target)) {
+            startUnitAI(i);
+            return;
+        }
+        if (_buildings.getInfo(target).isWall &&
+            BattleRules::shouldAbandonWall(_buildings, _pathfinder, u.type, u.pos)) {
+            startUnitAI(i);
+        } else {
+            startCombatLoopWithForcedTarget(i, targetId);
+        }
+    }
+
+    void executeAttack(int i, int targetId, bool forced) {
+        SimUnit& u = _sim[i];
+
+        // 防止重复处理（动作停止，与实时战斗相同）
+        if (_units.hasFlag(i, BattleUnitStore::FLAG_CHANGING_TARGET)) return;
+
+        int target = _buildings.indexOf(targetId);
+        if (target < 0 || !_buildings.isAlive(target)) {
+            _units.setFlag(i, BattleUnitStore::FLAG_CHANGING_TARGET, true);
+            u.changingTimer = CHANGE_TARGET_DELAY;
+            startUnitAI(i);
+            return;
+        }
+
+        int dealt = BattleRules::applyUnitAttack(_buildings, target, u.type, u.damage);
+        int troopIndex = u.troopId - SimResult::FIRST_TROOP_ID;
+        if (troopIndex >= 0 && troopIndex < SimResult::TROOP_TYPE_COUNT) {
+            _result.troopDamage[troopIndex] += dealt;
+        }
+
+        bool destroyed = _buildings.isDestroyed(target);
+        if (destroyed) _pathfinder.updatePathfindingMap(_buildings);
+
+        // 炸弹兵自爆
+        if (u.type == UnitTypeID::WALL_BREAKER) {
+            _units.applyDamage(i, _units.getHP(i));
+            u.next = SimNext::NONE;
+            return;
+        }
+
+        if (destroyed) {
+            startUnitAI(i);
+        } else if (forced) {
+            continueForcedAttack(i, targetId);
+        } else {
+            startCombatLoop(i);
+        }
+    }
+};
+
+} // namespace
+
+bool HeadlessBattleSetup::canDeployAt(int gridX, int gridY) const {
+    if (gridX < 0 || gridY < 0 || gridX >= GRID_W || gridY >= GRID_H) return false;
+    if (deployBlocked.empty()) return true;
+    return deployBlocked[gridY * GRID_W + gridX] == 0;
+}
+
+// ==========================================
+// 构建模拟快照
+// ==========================================
+
+HeadlessBattleSetup HeadlessBattleSim::buildSetup(const BattleMapData& mapData) {
+    return buildSetup(mapData.buildings, mapData.lootableGold, mapData.lootableElixir);
+}
+
+HeadlessBattleSetup HeadlessBattleSim::buildSetup(const BattleReplayData& replay) {
+    return buildSetup(replay.getInitialBuildings(), 0, 0);
+}
+
+HeadlessBattleSetup HeadlessBattleSim::buildSetup(const std::vector<BuildingInstance>& buildings,
+                                                  int lootableGold, int lootableElixir) {
+    HeadlessBattleSetup setup;
+    setup.deployBlocked.assign(GRID_W * GRID_H, 0);
+    setup.minX = GRID_W;
+    setup.minY = GRID_H;
+    setup.maxX = 0;
+    setup.maxY = 0;
+
+    setup.buildings.reset(buildings);
+    int goldStorages = 0;
+    int elixirStorages = 0;
+
+    for (int i = 0; i < setup.buildings.size(); ++i) {
+        const auto& info = setup.buildings.getInfo(i);
+
+        // 与 DestructionTracker::initTracking 一致：总血量取配置满血量
+        if (info.isTracked && info.maxHP > 0) setup.totalTrackedHP += info.maxHP;
+        if (!info.active) continue;
+        if (info.type == 204) goldStorages++;
+        if (info.type == 205) elixirStorages++;
+
+        // 与 BattleScene::tryDeployTroopAt 相同的禁放区域（陷阱不可见，不产生禁区）
+        if (!info.isTrap) {
+            int x0 = std::max(0, info.gridX - 1);
+            int x1 = std::min(GRID_W - 1, info.gridX + info.gridWidth);
+            int y0 = std::max(0, info.gridY - 1);
+            int y1 = std::min(GRID_H - 1, info.gridY + info.gridHeight);
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    setup.deployBlocked[y * GRID_W + x] = 1;
+                }
+            }
+            setup.minX = std::min(setup.minX, x0);
+            setup.minY = std::min(setup.minY, y0);
+            setup.maxX = std::max(setup.maxX, x1);
+            setup.maxY = std::max(setup.maxY, y1);
+        }
+    }
+
+    if (setup.minX > setup.maxX) {
+        setup.minX = setup.minY = 0;
+        setup.maxX = GRID_W - 1;
+        setup.maxY = GRID_H - 1;
+    }
+
+    setup.goldPerStorage = goldStorages > 0 ? lootableGold / goldStorages : 0;
+    setup.elixirPerStorage = elixirStorages > 0 ? lootableElixir / elixirStorages : 0;
+    setup.totalLootable = setup.goldPerStorage * goldStorages + setup.elixirPerStorage * elixirStorages;
+
+    auto troopConfig = TroopConfig::getInstance();
+    for (int troopId = 1001; troopId <= 1006; ++troopId) {
+        TroopInfo troop = troopConfig->getTroopById(troopId);
+        SimTroopInfo info;
+        info.troopId = troopId;
+        info.hitpoints = troop.hitpoints;
+        info.damage = troop.damagePerSecond;
+        setup.troops[troopId] = info;
+    }
+
+    return setup;
+}
+
+std::vector<SimDeployment> HeadlessBattleSim::deploymentsFromReplay(const BattleReplayData& replay) {
+    std::vector<SimDeployment> deployments;
+    deployments.reserve(replay.troopEvents.size());
+    for (const auto& e : replay.troopEvents) {
+        deployments.push_back({ e.timestamp, e.troopId, e.gridX, e.gridY });
+    }
+    return deployments;
+}
+
+// ==========================================
+// 推演
+// ==========================================
+
+SimResult HeadlessBattleSim::run(const HeadlessBattleSetup& setup,
+                                 const std::vector<SimDeployment>& deployments,
+                                 uint32_t seed,
+                                 bool applyJitter,
+                                 std::vector<StateHashSample>* hashTrace) {
+    SimResult result;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> offsetDist(-1, 1);
+    std::uniform_real_distribution<float> timeDist(-0.2f, 0.2f);
+
+    // 部署扰动：同一方案在不同种子下的落点和时间略有差异
+    std::vector<SimDeployment> queue;
+    queue.reserve(deployments.size());
+    for (const auto& d : deployments) {
+        if (setup.troops.find(d.troopId) == setup.troops.end()) continue;
+        SimDeployment jittered = d;
+        if (!applyJitter) {
+            queue.push_back(jittered);
+            continue;
+        }
+        int jx = d.gridX + offsetDist(rng);
+        int jy = d.gridY + offsetDist(rng);
+        if (setup.canDeployAt(jx, jy)) {
+            jittered.gridX = jx;
+            jittered.gridY = jy;
+        }
+        jittered.time = std::max(0.0f, d.time + timeDist(rng));
+        queue.push_back(jittered);
+    }
+    std::stable_sort(queue.begin(), queue.end(),
+                     [](const SimDeployment& a, const SimDeployment& b) { return a.time < b.time; });
+
+    SimBattle battle(setup, result);
+    size_t nextDeploy = 0;
+    float time = 0.0f;
+    int tickCount = 0;
+
+    while (time < BATTLE_TIME) {
+        // 1. 部署（放下后立即启动AI）
+        while (nextDeploy < queue.size() && queue[nextDeploy].time <= time) {
+            battle.deploy(queue[nextDeploy++]);
+        }
+
+        // 2. 兵种移动和攻击结算
+        bool anyActive = battle.updateUnits(TICK);
+
+        // 3. 防御建筑和陷阱（与 BattleScene::updateBattleSystems 顺序一致）
+        battle.updateDefense(TICK);
+        battle.updateTraps(TICK);
+
+        time += TICK;
+        tickCount++;
+
+        if (hashTrace && tickCount % HASH_SAMPLE_TICKS == 0) {
+            hashTrace->push_back(BattleStateHasher::sample(battle.getBuildings(), battle.getUnits(),
+                                                           tickCount / HASH_SAMPLE_TICKS));
+        }
+
+        // 所有计入进度的建筑都被摧毁，或兵已放完且没有单位在行动
+        const auto& buildings = battle.getBuildings();
+        bool anyTrackedAlive = false;
+        for (int i = 0; i < buildings.size() && !anyTrackedAlive; ++i) {
+            const auto& info = buildings.getInfo(i);
+            anyTrackedAlive = info.isTracked && info.maxHP > 0 && buildings.isAlive(i);
+        }
+        if (!anyTrackedAlive) break;
+        if (nextDeploy >= queue.size() && !anyActive) break;
+    }
+
+    // 与 DestructionTracker 一致的进度和星级判定，战利品按被摧毁的储存建筑计算
+    const auto& buildings = battle.getBuildings();
+    int trackedCount = 0;
+    int aliveCount = 0;
+    int remainingHP = 0;
+    bool townHallDestroyed = false;
+    for (int i = 0; i < buildings.size(); ++i) {
+        const auto& info = buildings.getInfo(i);
+        bool destroyedInBattle = setup.buildings.isAlive(i) && !buildings.isAlive(i);
+        if (destroyedInBattle && info.active) {
+            if (info.type == 204) result.lootedGold += setup.goldPerStorage;
+            if (info.type == 205) result.lootedElixir += setup.elixirPerStorage;
+        }
+
+        if (!info.isTracked || info.maxHP <= 0) continue;
+        trackedCount++;
+        if (buildings.isAlive(i)) {
+            aliveCount++;
+            remainingHP += buildings.getHP(i);
+        } else if (info.type == 1) {
+            townHallDestroyed = true;
+        }
+    }
+
+    bool allDestroyed = trackedCount > 0 && aliveCount == 0;
+    if (setup.totalTrackedHP > 0) {
+        float progress = allDestroyed
+            ? 100.0f
+            : ((setup.totalTrackedHP - remainingHP) / (float)setup.totalTrackedHP) * 100.0f;
+        result.destruction = std::min(100.0f, std::max(0.0f, progress));
+    }
+    result.stars = (townHallDestroyed ? 1 : 0)
+                 + (result.destruction >= 50.0f ? 1 : 0)
+                 + (allDestroyed ? 1 : 0);
+    result.duration = time;
+    return result;
+}
+
+// ==========================================
+// 并行执行
+// ==========================================
+
+namespace {
+
+// 常驻工作线程池：首次使用时创建 getWorkerCount() - 1 个线程，之后每轮 parallelFor 只提交任务，
+// 程序退出时随静态对象析构唤醒并回收线程
+class SimWorkerPool {
+public:
+    static SimWorkerPool& getInstance() {
+        static SimWorkerPool pool;
+        return pool;
+    }
+
+    // 执行 task(0..count-1)，调用线程也参与，全部完成后返回；多个线程同时提交时逐轮排队
+    void run(int count, const std::function<void(int)>& task) {
+        std::lock_guard<std::mutex> submitLock(_submitMutex);
+        if (count == 1 || _threads.empty()) {
+            for (int i = 0; i < count; ++i) task(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task = &task;
+            _count = count;
+            _next = 0;
+            _busy = static_cast<int>(_threads.size());
+            ++_generation;
+        }
+        _wake.notify_all();
+
+        drain(task, count);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this]() { return _busy == 0; });
+        _task = nullptr;
+    }
+
+private:
+    SimWorkerPool() {
+        int threads = HeadlessBattleSim::getWorkerCount() - 1;
+        _threads.reserve(threads);
+        for (int i = 0; i < threads; ++i) {
+            _threads.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~SimWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (auto& t : _threads) {
+            t.join();
+        }
+    }
+
+    SimWorkerPool(const SimWorkerPool&) = delete;
+    SimWorkerPool& operator=(const SimWorkerPool&) = delete;
+
+    void drain(const std::function<void(int)>& task, int count) {
+        for (int i = _next++; i < count; i = _next++) {
+            task(i);
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        while (true) {
+            const std::function<void(int)>* task = nullptr;
+            int count = 0;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+                if (_stop) return;
+                seen = _generation;
+                task = _task;
+                count = _count;
+            }
+
+            drain(*task, count);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_busy == 0) _done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _submitMutex;            // 串行化并发提交
+    std::mutex _mutex;
+    std::condition_variable _wake;      // 新一轮任务或退出
+    std::condition_variable _done;      // 本轮所有工作线程已完成
+    const std::function<void(int)>* _task = nullptr;
+    int _count = 0;
+    std::atomic<int> _next{ 0 };
+    int _busy = 0;                      // 本轮尚未完成的工作线程数
+    uint64_t _generation = 0;           // 每轮递增，工作线程据此判断是否有新任务
+    bool _stop = false;
+};
+
+} // namespace
+
+int HeadlessBattleSim::getWorkerCount() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count > 0 ? static_cast<int>(count) : 1;
+}
+
+void HeadlessBattleSim::parallelFor(int count, const std::function<void(int)>& task) {
+    if (count <= 0) return;
+    SimWorkerPool::getInstance().run(count, task);
+}
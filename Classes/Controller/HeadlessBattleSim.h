@@ -0,0 +1,107 @@
+﻿// HeadlessBattleSim.h
+// 无界面战斗模拟器声明，在网格坐标上快速推演一场战斗，供进攻规划和性能测试使用
+
+#ifndef __HEADLESS_BATTLE_SIM_H__
+#define __HEADLESS_BATTLE_SIM_H__
+
+#include "../Model/BattleStateHash.h"
+#include "../Model/BattleBuildingStore.h"
+#include "../Model/VillageData.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+struct BattleMapData;
+struct BattleReplayData;
+
+// 模拟用兵种数据（由主线程从 TroopConfig 拷贝）
+struct SimTroopInfo {
+    int troopId = 0;
+    int hitpoints = 0;
+    int damage = 0;             // 每次攻击伤害
+};
+
+// 模拟初始状态（只读快照，可被多个线程同时使用）
+struct HeadlessBattleSetup {
+    BattleBuildingStore buildings;      // 开战时的建筑状态表，每场模拟拷贝一份推演
+    std::map<int, SimTroopInfo> troops;
+    int totalTrackedHP = 0;
+    int goldPerStorage = 0;
+    int elixirPerStorage = 0;
+    int totalLootable = 0;
+
+    // 边界框（放兵点生成用）
+    int minX = 0, minY = 0, maxX = 0, maxY = 0;
+
+    // 禁止放兵的格子（建筑及其外围一圈），按 y * GRID_WIDTH + x 存储
+    std::vector<uint8_t> deployBlocked;
+
+    bool canDeployAt(int gridX, int gridY) const;
+};
+
+// 单次部署指令
+struct SimDeployment {
+    float time;       // 部署时刻（秒）
+    int troopId;
+    int gridX;
+    int gridY;
+};
+
+// 单次模拟结果
+struct SimResult {
+    static constexpr int FIRST_TROOP_ID = 1001;
+    static constexpr int TROOP_TYPE_COUNT = 6;
+
+    int stars = 0;
+    float destruction = 0.0f;   // 摧毁百分比 0-100
+    int lootedGold = 0;
+    int lootedElixir = 0;
+    float duration = 0.0f;      // 战斗用时（秒）
+
+    // 各兵种对建筑造成的伤害，下标为 troopId - FIRST_TROOP_ID
+    std::array<int, TROOP_TYPE_COUNT> troopDamage{};
+};
+
+// 无界面战斗模拟器
+// 按固定步长推演，单位AI流程与 BattleProcessController 相同：目标选择、绕路/破墙寻路、射程、伤害、
+// 防御建筑和陷阱都调用 BattleRules，寻路使用每场模拟自己的 FindPathUtil 实例
+// 兵种行走和攻击的时长按实时战斗的移动速度和攻击动画时长推演，不创建精灵和动作
+// 不访问任何单例，可在工作线程中并行运行
+class HeadlessBattleSim {
+public:
+    static constexpr float TICK = 0.1f;             // 推演步长（秒）
+    static constexpr float BATTLE_TIME = 180.0f;    // 战斗时限（秒）
+
+    // 从战斗地图构建模拟快照（读取配置单例，只能在主线程调用）
+    static HeadlessBattleSetup buildSetup(const BattleMapData& mapData);
+
+    // 从回放的初始布局构建模拟快照（读取配置单例，只能在主线程调用）
+    static HeadlessBattleSetup buildSetup(const BattleReplayData& replay);
+
+    // 回放的部署序列
+    static std::vector<SimDeployment> deploymentsFromReplay(const BattleReplayData& replay);
+
+    // 推演一场战斗；seed 用于部署位置和时间的随机扰动，相同输入结果完全一致
+    // applyJitter 为 false 时严格按部署指令推演（回放重算用）
+    // hashTrace 非空时每隔 BattleStateHasher::SAMPLE_INTERVAL 记录一次状态哈希
+    static SimResult run(const HeadlessBattleSetup& setup,
+                         const std::vector<SimDeployment>& deployments,
+                         uint32_t seed,
+                         bool applyJitter = true,
+                         std::vector<StateHashSample>* hashTrace = nullptr);
+
+    // 工作线程数（硬件并发数）
+    static int getWorkerCount();
+
+    // 在常驻工作线程池上并行执行 task(0..count-1)，当前线程也参与执行，全部完成后返回
+    // 线程池首次调用时创建，之后每次调用只提交任务；task 内不能再调用 parallelFor
+    static void parallelFor(int count, const std::function<void(int)>& task);
+
+private:
+    static HeadlessBattleSetup buildSetup(const std::vector<BuildingInstance>& buildings,
+                                          int lootableGold, int lootableElixir);
+};
+
+#endif // __HEADLESS_BATTLE_SIM_H__
@@ -3,6 +3,7 @@
 
 #include "MoveMapController.h"
 #include "../proj.win32/Constants.h"
+#include "../Manager/AnimationManager.h"
 #include <iostream>
 
 USING_NS_CC;
@@ -82,6 +83,7 @@ void MoveMapController::initializeMapTransform() {
 
   // 设置初始缩放为最小缩放
   _villageLayer->setScale(_currentScale);
+  AnimationManager::getInstance()->setDisplayScale(_currentScale);
 
   // 将地图中心放在屏幕中心
   float initialX = (visibleSize.width - mapSize.width * _currentScale) / 2;
@@ -400,6 +402,7 @@ void MoveMapController::applyZoomAroundPoint(const Vec2& zoomPoint, float newSca
   // 应用新缩放
   _villageLayer->setScale(newScale);
   _currentScale = newScale;
+  AnimationManager::getInstance()->setDisplayScale(newScale);
 
   // 将Layer内部点转回屏幕坐标
   Vec2 newPointOnScreen = _villageLayer->convertToWorldSpace(pointInLayer);
@@ -13,6 +13,7 @@ enum class UnitTypeID;
  * 战斗目标查找器类
  * 
  * 职责：为不同兵种找到合适的攻击目标、根据优先级选择目标
+ * 选择规则在 BattleRules 中，这里只在实时战斗的建筑状态表上调用并返回布局中的建筑
  */
 class TargetFinder {
 public:
@@ -24,12 +25,6 @@ public:
     // 通用入口：根据兵种类型自动选择策略
     const BuildingInstance* findTarget(const cocos2d::Vec2& unitWorldPos, UnitTypeID unitType);
 
-    // 资源优先查找（哥布林等）
-    const BuildingInstance* findTargetWithResourcePriority(const cocos2d::Vec2& unitWorldPos, UnitTypeID unitType);
-    
-    // 防御优先查找（巨人、气球等）
-    const BuildingInstance* findTargetWithDefensePriority(const cocos2d::Vec2& unitWorldPos, UnitTypeID unitType);
-    
     // 查找最近城墙（炸弹兵专用）
     const BuildingInstance* findNearestWall(const cocos2d::Vec2& unitWorldPos);
 
@@ -2,9 +2,10 @@
 // 陷阱系统实现，管理陷阱的触发检测和爆炸逻辑
 
 #include "TrapSystem.h"
+#include "BattleEventBus.h"
 #include "../Layer/BattleTroopLayer.h"
 #include "../Manager/VillageDataManager.h"
-#include "../Model/BuildingConfig.h"
+#include "../Manager/BattleEffectPool.h"
 #include "../Util/GridMapUtils.h"
 #include "../Sprite/BattleUnitSprite.h"
 
@@ -27,175 +28,95 @@ void TrapSystem::destroyInstance() {
 }
 
 void TrapSystem::reset() {
-    _triggeredTraps.clear();
     _trapTimers.clear();
 }
 
-bool TrapSystem::isUnitInTrapRange(const BuildingInstance& trap, BattleUnitSprite* unit) {
-    if (!unit || unit->isDead()) return false;
-    
-    // 获取兵种网格位置
-    Vec2 unitGridPos = unit->getGridPosition();
-    int unitGridX = static_cast<int>(std::floor(unitGridPos.x));
-    int unitGridY = static_cast<int>(std::floor(unitGridPos.y));
-    
-    int trapX = trap.gridX;
-    int trapY = trap.gridY;
-    
-    // 炸弹（401）：1x1格子
-    if (trap.type == 401) {
-        return (unitGridX == trapX && unitGridY == trapY);
-    }
-    // 巨型炸弹（404）：2x2格子
-    else if (trap.type == 404) {
-        return (unitGridX >= trapX && unitGridX <= trapX + 1 &&
-                unitGridY >= trapY && unitGridY <= trapY + 1);
-    }
-    
-    return false;
+float TrapSystem::getTrapTimer(int trapId) const {
+    auto it = _trapTimers.find(trapId);
+    return it != _trapTimers.end() ? it->second : -1.0f;
 }
 
-void TrapSystem::updateTrapDetection(BattleTroopLayer* troopLayer) {
+void TrapSystem::restoreTrapTimer(int trapId, float remaining) {
+    _trapTimers[trapId] = remaining;
+}
+
+void TrapSystem::updateTrapDetection(BattleTroopLayer* troopLayer, float deltaTime) {
     if (!troopLayer) return;
-    
+
     auto dataManager = VillageDataManager::getInstance();
-    auto& buildings = const_cast<std::vector<BuildingInstance>&>(dataManager->getAllBuildings());
-    float deltaTime = Director::getInstance()->getDeltaTime();
-    
-    auto allUnits = troopLayer->getAllUnits();
-    if (allUnits.empty()) return;
-    
-    // 遍历所有陷阱
-    for (auto& building : buildings) {
-        // 只处理陷阱（401: 炸弹, 404: 巨型炸弹）
-        if (building.type != 401 && building.type != 404) continue;
-        
-        // 跳过已摧毁或已触发的陷阱
-        if (building.isDestroyed || building.currentHP <= 0) continue;
-        
-        int trapId = building.id;
-        
-        // 检查陷阱是否已触发（正在倒计时）
-        if (_triggeredTraps.find(trapId) != _triggeredTraps.end()) {
-            // 更新计时器
-            _trapTimers[trapId] -= deltaTime;
-            
-            if (_trapTimers[trapId] <= 0.0f) {
-                // 时间到，执行爆炸
-                CCLOG("TrapSystem: Trap %d exploding!", trapId);
-                explodeTrap(&building, troopLayer);
-                
-                // 清除触发状态
-                _triggeredTraps.erase(trapId);
-                _trapTimers.erase(trapId);
-            }
-            continue;
-        }
-        
-        // 检查是否有兵种进入陷阱范围
-        for (auto unit : allUnits) {
-            if (!unit || unit->isDead()) continue;
-            
-            // 气球兵是飞行单位，不会触发地面陷阱
-            if (unit->getUnitTypeID() == UnitTypeID::BALLOON) continue;
-            
-            if (isUnitInTrapRange(building, unit)) {
-                // 触发陷阱，开始0.5秒倒计时
+    const auto& buildings = dataManager->getBattleBuildings();
+    auto& battleState = dataManager->getBattleState();
+    auto& store = troopLayer->getUnitStore();
+
+    _events.clear();
+    BattleRules::updateTraps(battleState, store, _trapTimers, deltaTime, _events);
+
+    // 按事件播放表现（本帧没有单位被移除，下标仍然有效）
+    for (const auto& event : _events) {
+        const auto& trap = buildings[event.trap];
+
+        switch (event.kind) {
+            case BattleRules::TrapEvent::Kind::TRIGGERED: {
                 CCLOG("TrapSystem: Trap %d (type=%d) triggered by unit at grid(%d, %d)!",
-                      trapId, building.type,
-                      static_cast<int>(unit->getGridPosition().x),
-                      static_cast<int>(unit->getGridPosition().y));
-                
-                _triggeredTraps.insert(trapId);
-                _trapTimers[trapId] = 0.5f;
-                
+                      trap.id, trap.type,
+                      static_cast<int>(store.getGridX(event.unit)),
+                      static_cast<int>(store.getGridY(event.unit)));
+
                 // 显示陷阱
                 auto mapLayer = troopLayer->getParent();
                 if (mapLayer) {
-                    std::string spriteName = "Building_" + std::to_string(trapId);
-                    auto trapSprite = mapLayer->getChildByName(spriteName);
+                    auto trapSprite = mapLayer->getChildByName("Building_" + std::to_string(trap.id));
                     if (trapSprite) {
                         trapSprite->setVisible(true);
-                        CCLOG("TrapSystem: Trap %d now VISIBLE!", trapId);
                     }
                 }
-                
                 break;
             }
+
+            case BattleRules::TrapEvent::Kind::UNIT_HIT: {
+                BattleUnitSprite* unit = store.getView(event.unit);
+                unit->updateHealthBar();
+                CCLOG("TrapSystem: Unit %s hit by trap %d, HP: %d",
+                      unit->getUnitType().c_str(), trap.id, unit->getCurrentHP());
+
+                if (event.killed) {
+                    unit->stopAllActions();
+                    unit->playDeathAnimation([troopLayer, unit]() {
+                        troopLayer->removeUnit(unit);
+                    });
+                }
+                break;
+            }
+
+            case BattleRules::TrapEvent::Kind::EXPLODED:
+                playExplosion(trap, troopLayer);
+                break;
         }
     }
 }
 
-void TrapSystem::explodeTrap(BuildingInstance* trap, BattleTroopLayer* troopLayer) {
-    if (!trap || !troopLayer) return;
-    
-    auto config = BuildingConfig::getInstance()->getConfig(trap->type);
-    if (!config) return;
-    
-    int damage = config->damagePerSecond;
-    
-    CCLOG("TrapSystem: Trap %d (type=%d) exploding with %d damage!",
-          trap->id, trap->type, damage);
-    
-    // 获取所有在范围内的兵种
-    auto allUnits = troopLayer->getAllUnits();
-    std::vector<BattleUnitSprite*> affectedUnits;
-    
-    for (auto unit : allUnits) {
-        if (!unit || unit->isDead()) continue;
-        
-        // 气球兵不受地面陷阱伤害
-        if (unit->getUnitTypeID() == UnitTypeID::BALLOON) continue;
-        
-        if (isUnitInTrapRange(*trap, unit)) {
-            affectedUnits.push_back(unit);
-        }
-    }
-    
-    CCLOG("TrapSystem: %zu units affected by trap explosion", affectedUnits.size());
-    
-    // 对范围内的所有兵种造成伤害
-    for (auto unit : affectedUnits) {
-        unit->takeDamage(damage);
-        CCLOG("TrapSystem: Unit %s took %d damage from trap, HP: %d",
-              unit->getUnitType().c_str(), damage, unit->getCurrentHP());
-        
-        // 检查是否死亡
-        if (unit->isDead()) {
-            unit->stopAllActions();
-            unit->playDeathAnimation([troopLayer, unit]() {
-                troopLayer->removeUnit(unit);
-            });
-        }
-    }
-    
+void TrapSystem::playExplosion(const BuildingInstance& trap, BattleTroopLayer* troopLayer) {
+    CCLOG("TrapSystem: Trap %d (type=%d) exploded", trap.id, trap.type);
+
     // 播放爆炸特效
-    Vec2 trapPixelPos = GridMapUtils::gridToPixelCenter(trap->gridX, trap->gridY);
+    Vec2 trapPixelPos = GridMapUtils::gridToPixelCenter(trap.gridX, trap.gridY);
     
     // 巨型炸弹爆炸位置在2x2中心
-    if (trap->type == 404) {
-        trapPixelPos = GridMapUtils::gridToPixelCenter(trap->gridX, trap->gridY + 1);
+    if (trap.type == 404) {
+        trapPixelPos = GridMapUtils::gridToPixelCenter(trap.gridX, trap.gridY + 1);
     }
     
-    auto explosion = ParticleExplosion::create();
-    explosion->setPosition(trapPixelPos);
-    explosion->setDuration(0.3f);
-    
-    // 巨型炸弹爆炸更大
-    float scale = (trap->type == 404) ? 0.6f : 0.3f;
-    explosion->setScale(scale);
-    explosion->setAutoRemoveOnFinish(true);
-    troopLayer->getParent()->addChild(explosion, 1000);
-    
-    // 标记陷阱为已摧毁
-    trap->isDestroyed = true;
-    trap->currentHP = 0;
-    
-    // 发送陷阱摧毁事件
-    Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(
-        "EVENT_BUILDING_DESTROYED",
-        static_cast<void*>(trap)
-    );
+    auto explosion = BattleEffectPool::getInstance()->acquireParticle(
+        BattleEffectPool::EffectType::EXPLOSION, troopLayer->getParent(), 1000);
+    if (explosion) {
+        explosion->setPosition(trapPixelPos);
+        explosion->setDuration(0.3f);
+
+        // 巨型炸弹爆炸更大
+        float scale = (trap.type == 404) ? 0.6f : 0.3f;
+        explosion->setScale(scale);
+    }
     
-    CCLOG("TrapSystem: Trap %d destroyed after explosion", trap->id);
+    // 投递陷阱摧毁事件
+    BattleEventBus::getInstance()->postBuildingDestroyed(trap.id, trap.type);
 }
@@ -5,41 +5,47 @@
 #define __TRAP_SYSTEM_H__
 
 #include "cocos2d.h"
-#include <set>
+#include "BattleRules.h"
 #include <map>
+#include <vector>
 
-class BattleUnitSprite;
 class BattleTroopLayer;
 struct BuildingInstance;
 
 // 陷阱系统类
 // 职责：检测兵种是否踩到陷阱、管理触发延迟、执行爆炸逻辑
+// 触发和爆炸结算由 BattleRules::updateTraps 完成，这里按事件显示陷阱、播放特效和投递摧毁事件
 class TrapSystem {
 public:
     static TrapSystem* getInstance();
     static void destroyInstance();
     
-    // 更新陷阱检测（每帧调用）
-    void updateTrapDetection(BattleTroopLayer* troopLayer);
+    // 更新陷阱检测（每帧调用，deltaTime 为战斗时钟步长）
+    void updateTrapDetection(BattleTroopLayer* troopLayer, float deltaTime);
     
     // 重置陷阱状态（战斗开始时调用）
     void reset();
 
+    // 陷阱剩余引爆延迟，未触发返回 -1（回放关键帧录制使用）
+    float getTrapTimer(int trapId) const;
+
+    // 恢复陷阱的触发倒计时（回放跳转时使用）
+    void restoreTrapTimer(int trapId, float remaining);
+
 private:
     TrapSystem() = default;
     ~TrapSystem() = default;
     
     static TrapSystem* _instance;
     
-    // 陷阱触发追踪
-    std::set<int> _triggeredTraps;       // 已触发的陷阱ID
-    std::map<int, float> _trapTimers;    // 陷阱ID -> 剩余延迟时间
-    
-    // 检查兵种是否在陷阱范围内
-    bool isUnitInTrapRange(const BuildingInstance& trap, BattleUnitSprite* unit);
-    
-    // 执行陷阱爆炸
-    void explodeTrap(BuildingInstance* trap, BattleTroopLayer* troopLayer);
+    // 已触发陷阱ID -> 剩余延迟时间
+    std::map<int, float> _trapTimers;
+
+    // 每帧复用的事件缓冲
+    std::vector<BattleRules::TrapEvent> _events;
+
+    // 播放爆炸特效并投递摧毁事件
+    void playExplosion(const BuildingInstance& trap, BattleTroopLayer* troopLayer);
 };
 
 #endif // __TRAP_SYSTEM_H__
@@ -3,8 +3,11 @@
 
 #pragma execution_character_set("utf-8")
 #include "BattleHUDLayer.h"
+#include "Manager/AtlasManager.h"
 #include "Manager/VillageDataManager.h"
 #include "Model/TroopConfig.h"
+#include "Util/HudFont.h"
+#include <algorithm>
 
 USING_NS_CC;
 using namespace ui;
@@ -30,13 +33,13 @@ void BattleHUDLayer::initTopInfo() {
     timerBg->setPosition(visibleSize.width / 2 - 60, visibleSize.height - 50);
     this->addChild(timerBg);
 
-    _timerLabel = Label::createWithTTF("30s", FONT_PATH, 24);
+    _timerLabel = HudFont::createLabel("30s", HudFont::Face::SIMHEI, 24, false);
     _timerLabel->setPosition(60, 20);
     timerBg->addChild(_timerLabel);
 
     // 资源掠夺信息 - 图标+数值格式
     // 金币图标
-    _goldIcon = Sprite::create("ImageElements/coin_icon.png");
+    _goldIcon = AtlasManager::getInstance()->createSprite("ImageElements/coin_icon.png");
     if (_goldIcon) {
         _goldIcon->setScale(0.4f);
         _goldIcon->setAnchorPoint(Vec2(1, 0.5f));
@@ -45,15 +48,14 @@ void BattleHUDLayer::initTopInfo() {
     }
     
     // 金币数值标签
-    _goldLabel = Label::createWithTTF("0/0", "fonts/Marker Felt.ttf", 22);
+    _goldLabel = HudFont::createLabel("0/0", HudFont::Face::MARKER_FELT, 22);
     _goldLabel->setAnchorPoint(Vec2(0, 0.5f));
     _goldLabel->setPosition(Vec2(origin.x + 55, origin.y + visibleSize.height - 30));
     _goldLabel->setColor(Color3B(255, 215, 0));
-    _goldLabel->enableOutline(Color4B::BLACK, 2);
     this->addChild(_goldLabel);
 
     // 圣水图标
-    _elixirIcon = Sprite::create("ImageElements/elixir_icon.png");
+    _elixirIcon = AtlasManager::getInstance()->createSprite("ImageElements/elixir_icon.png");
     if (_elixirIcon) {
         _elixirIcon->setScale(0.4f);
         _elixirIcon->setAnchorPoint(Vec2(1, 0.5f));
@@ -62,11 +64,10 @@ void BattleHUDLayer::initTopInfo() {
     }
     
     // 圣水数值标签
-    _elixirLabel = Label::createWithTTF("0/0", "fonts/Marker Felt.ttf", 22);
+    _elixirLabel = HudFont::createLabel("0/0", HudFont::Face::MARKER_FELT, 22);
     _elixirLabel->setAnchorPoint(Vec2(0, 0.5f));
     _elixirLabel->setPosition(Vec2(origin.x + 205, origin.y + visibleSize.height - 30));
     _elixirLabel->setColor(Color3B(255, 0, 255));
-    _elixirLabel->enableOutline(Color4B::BLACK, 2);
     this->addChild(_elixirLabel);
 }
 
@@ -74,7 +75,7 @@ void BattleHUDLayer::initBottomButtons() {
     auto visibleSize = Director::getInstance()->getVisibleSize();
 
     // [寻找对手]按钮 - 右下角
-    _btnNext = Button::create("UI/battle/battle-prepare/next-icon.png");
+    _btnNext = AtlasManager::getInstance()->createButton("UI/battle/battle-prepare/next-icon.png");
     _btnNext->setScale(0.6f);
     _btnNext->setAnchorPoint(Vec2(1, 0));
     _btnNext->setPosition(Vec2(visibleSize.width - 20, 20));
@@ -88,7 +89,7 @@ void BattleHUDLayer::initBottomButtons() {
     this->addChild(_btnNext);
 
     // [回营]按钮（绿色）- 侦查阶段使用，左下角
-    _btnReturn = Button::create("UI/battle/battle-prepare/back.png");
+    _btnReturn = AtlasManager::getInstance()->createButton("UI/battle/battle-prepare/back.png");
     _btnReturn->setScale(0.5f);
     _btnReturn->setAnchorPoint(Vec2(0, 0));
     _btnReturn->setPosition(Vec2(20, 20));
@@ -99,7 +100,7 @@ void BattleHUDLayer::initBottomButtons() {
     this->addChild(_btnReturn);
 
     // [结束战斗]按钮（红色）- 战斗阶段使用，左下角，初始隐藏
-    _btnEnd = Button::create("UI/battle/battle-prepare/finishbattle.png");
+    _btnEnd = AtlasManager::getInstance()->createButton("UI/battle/battle-prepare/finishbattle.png");
     _btnEnd->setScale(0.3f);
     _btnEnd->setAnchorPoint(Vec2(0, 0));
     _btnEnd->setPosition(Vec2(20, 20));
@@ -109,6 +110,20 @@ void BattleHUDLayer::initBottomButtons() {
         if (auto scene = getBattleScene()) scene->onEndBattleClicked();
         });
     this->addChild(_btnEnd);
+
+    // [推荐方案]按钮 - 侦查阶段使用，右下角"寻找对手"上方
+    _btnSuggest = Button::create();
+    _btnSuggest->setTitleText("[ 推荐进攻方案 ]");
+    _btnSuggest->setTitleFontName(FONT_PATH);
+    _btnSuggest->setTitleFontSize(22);
+    _btnSuggest->setTitleColor(Color3B(0, 255, 255));
+    _btnSuggest->setAnchorPoint(Vec2(1, 0));
+    _btnSuggest->setPosition(Vec2(visibleSize.width - 20, 160));
+
+    _btnSuggest->addClickEventListener([this](Ref*) {
+        if (auto scene = getBattleScene()) scene->onSuggestAttackClicked();
+        });
+    this->addChild(_btnSuggest);
 }
 
 void BattleHUDLayer::initTroopBar() {
@@ -138,7 +153,7 @@ void BattleHUDLayer::initTroopBar() {
         auto info = TroopConfig::getInstance()->getTroopById(troopId);
 
         // 使用Button替代普通精灵
-        auto btn = ui::Button::create(info.iconPath);
+        auto btn = AtlasManager::getInstance()->createButton(info.iconPath);
         if (btn) {
             btn->setScale(0.5f);
   btn->setPosition(Vec2(startX, 60));
@@ -211,6 +226,7 @@ void BattleHUDLayer::updatePhase(BattleScene::BattleState state) {
         // 侦查阶段
         if (_btnNext) _btnNext->setVisible(true);
         if (_btnReturn) _btnReturn->setVisible(true);
+        if (_btnSuggest) _btnSuggest->setVisible(true);
         if (_btnEnd) _btnEnd->setVisible(false);
         if (_timerLabel) _timerLabel->setColor(Color3B::WHITE);
     }
@@ -218,6 +234,7 @@ void BattleHUDLayer::updatePhase(BattleScene::BattleState state) {
         // 战斗阶段
         if (_btnNext) _btnNext->setVisible(false);
         if (_btnReturn) _btnReturn->setVisible(false);
+        if (_btnSuggest) _btnSuggest->setVisible(false);
         if (_btnEnd) _btnEnd->setVisible(true);
         if (_timerLabel) _timerLabel->setColor(Color3B::RED);
     }
@@ -225,8 +242,12 @@ void BattleHUDLayer::updatePhase(BattleScene::BattleState state) {
         // 结算阶段
         if (_btnNext) _btnNext->setVisible(false);
         if (_btnReturn) _btnReturn->setVisible(false);
+        if (_btnSuggest) _btnSuggest->setVisible(false);
         if (_btnEnd) _btnEnd->setVisible(false);
         if (_troopBarNode) _troopBarNode->setVisible(false);
+        if (_btnReplaySpeed) _btnReplaySpeed->setVisible(false);
+        if (_btnReplaySkip) _btnReplaySkip->setVisible(false);
+        if (_replayProgressBg) _replayProgressBg->setVisible(false);
     }
 }
 
@@ -234,6 +255,7 @@ void BattleHUDLayer::setButtonsEnabled(bool enabled) {
     if (_btnNext) _btnNext->setEnabled(enabled);
     if (_btnEnd) _btnEnd->setEnabled(enabled);
     if (_btnReturn) _btnReturn->setEnabled(enabled);
+    if (_btnSuggest) _btnSuggest->setEnabled(enabled);
 }
 
 void BattleHUDLayer::updateTimer(int seconds) {
@@ -317,6 +339,10 @@ void BattleHUDLayer::hideReplayControls() {
         CCLOG("BattleHUDLayer: End battle button hidden");
     }
 
+    if (_btnSuggest) {
+        _btnSuggest->setVisible(false);
+    }
+
     // 显示"回放中"标识
     auto visibleSize = Director::getInstance()->getVisibleSize();
     auto replayLabel = Label::createWithTTF("回放中...", "fonts/simhei.ttf", 32);
@@ -328,3 +354,112 @@ void BattleHUDLayer::hideReplayControls() {
 
     CCLOG("BattleHUDLayer: Replay controls hidden successfully");
 }
+
+void BattleHUDLayer::showReplayPlaybackControls(float speed) {
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+
+    // [倍速]按钮 - 右下角，点击循环切换 1x/2x/4x/8x/0.5x
+    if (!_btnReplaySpeed) {
+        _btnReplaySpeed = Button::create();
+        _btnReplaySpeed->setTitleFontName(FONT_PATH);
+        _btnReplaySpeed->setTitleFontSize(28);
+        _btnReplaySpeed->setTitleColor(Color3B::YELLOW);
+        _btnReplaySpeed->setAnchorPoint(Vec2(1, 0));
+        _btnReplaySpeed->setPosition(Vec2(visibleSize.width - 20, 80));
+
+        _btnReplaySpeed->addClickEventListener([this](Ref*) {
+            if (auto scene = getBattleScene()) scene->onReplaySpeedClicked();
+            });
+        this->addChild(_btnReplaySpeed);
+    }
+
+    // [跳到结尾]按钮 - 倍速按钮下方
+    if (!_btnReplaySkip) {
+        _btnReplaySkip = Button::create();
+        _btnReplaySkip->setTitleText("[ 跳到结尾 ]");
+        _btnReplaySkip->setTitleFontName(FONT_PATH);
+        _btnReplaySkip->setTitleFontSize(24);
+        _btnReplaySkip->setTitleColor(Color3B(0, 255, 255));
+        _btnReplaySkip->setAnchorPoint(Vec2(1, 0));
+        _btnReplaySkip->setPosition(Vec2(visibleSize.width - 20, 30));
+
+        _btnReplaySkip->addClickEventListener([this](Ref*) {
+            if (auto scene = getBattleScene()) scene->onReplaySkipClicked();
+            });
+        this->addChild(_btnReplaySkip);
+    }
+
+    if (!_replayProgressBg) {
+        initReplayProgressBar();
+    }
+
+    _btnReplaySpeed->setVisible(true);
+    _btnReplaySkip->setVisible(true);
+    _replayProgressBg->setVisible(true);
+    updateReplaySpeed(speed);
+    updateReplayProgress(0.0f);
+}
+
+void BattleHUDLayer::initReplayProgressBar() {
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+    const float barWidth = 500.0f;
+    const float barHeight = 14.0f;
+
+    // 进度条 - 底部居中（回放时兵种条已隐藏）
+    _replayProgressBg = LayerColor::create(Color4B(0, 0, 0, 160), barWidth, barHeight);
+    _replayProgressBg->setPosition(Vec2((visibleSize.width - barWidth) / 2, 40));
+    this->addChild(_replayProgressBg, 100);
+
+    _replayProgressFill = LayerColor::create(Color4B(0, 255, 255, 220), 0, barHeight);
+    _replayProgressBg->addChild(_replayProgressFill);
+
+    // 拖动时只预览进度，松手后再跳转（跳转需要恢复关键帧并快进）
+    auto listener = EventListenerTouchOneByOne::create();
+    listener->setSwallowTouches(true);
+    listener->onTouchBegan = [this](Touch* touch, Event*) {
+        if (!_replayProgressBg->isVisible()) return false;
+
+        Vec2 local = _replayProgressBg->convertToNodeSpace(touch->getLocation());
+        Size size = _replayProgressBg->getContentSize();
+        // 纵向放宽触摸区域，细进度条也容易点中
+        if (local.x < 0 || local.x > size.width || local.y < -20 || local.y > size.height + 20) {
+            return false;
+        }
+
+        _isScrubbing = true;
+        _replayProgressFill->changeWidth(touchToReplayFraction(touch) * size.width);
+        return true;
+    };
+    listener->onTouchMoved = [this](Touch* touch, Event*) {
+        _replayProgressFill->changeWidth(touchToReplayFraction(touch) * _replayProgressBg->getContentSize().width);
+    };
+    listener->onTouchEnded = [this](Touch* touch, Event*) {
+        _isScrubbing = false;
+        if (auto scene = getBattleScene()) scene->onReplaySeek(touchToReplayFraction(touch));
+    };
+    listener->onTouchCancelled = [this](Touch*, Event*) {
+        _isScrubbing = false;
+    };
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, _replayProgressBg);
+}
+
+float BattleHUDLayer::touchToReplayFraction(Touch* touch) const {
+    Vec2 local = _replayProgressBg->convertToNodeSpace(touch->getLocation());
+    float width = _replayProgressBg->getContentSize().width;
+    if (width <= 0.0f) return 0.0f;
+
+    return std::max(0.0f, std::min(local.x / width, 1.0f));
+}
+
+void BattleHUDLayer::updateReplayProgress(float fraction) {
+    if (!_replayProgressBg || !_replayProgressFill || _isScrubbing) return;
+
+    fraction = std::max(0.0f, std::min(fraction, 1.0f));
+    _replayProgressFill->changeWidth(fraction * _replayProgressBg->getContentSize().width);
+}
+
+void BattleHUDLayer::updateReplaySpeed(float speed) {
+    if (_btnReplaySpeed) {
+        _btnReplaySpeed->setTitleText(StringUtils::format("[ %gx ]", speed));
+    }
+}
@@ -35,6 +35,11 @@ public:
     void initLootDisplay(int totalGold, int totalElixir);
     void updateLootDisplay(int lootedGold, int lootedElixir, int totalGold, int totalElixir);
     void hideReplayControls();  // 隐藏回放模式下的UI控件
+
+    // 回放播放控制（倍速、跳到结尾、进度条拖动跳转）
+    void showReplayPlaybackControls(float speed);
+    void updateReplaySpeed(float speed);
+    void updateReplayProgress(float fraction);  // 回放进度（0-1），拖动进度条时不覆盖
     
 private:
     // UI元素
@@ -42,6 +47,12 @@ private:
     cocos2d::ui::Button* _btnNext;     // 寻找对手
     cocos2d::ui::Button* _btnEnd;      // 红色结束战斗
     cocos2d::ui::Button* _btnReturn;   // 绿色回营
+    cocos2d::ui::Button* _btnSuggest;  // 推荐进攻方案
+    cocos2d::ui::Button* _btnReplaySpeed = nullptr;  // 回放倍速切换
+    cocos2d::ui::Button* _btnReplaySkip = nullptr;   // 回放跳到结尾
+    cocos2d::LayerColor* _replayProgressBg = nullptr;    // 回放进度条背景（可拖动跳转）
+    cocos2d::LayerColor* _replayProgressFill = nullptr;  // 回放进度条填充
+    bool _isScrubbing = false;                           // 是否正在拖动进度条
     cocos2d::Node* _troopBarNode;      // 底部兵种条容器
 
     // 资源显示UI
@@ -59,6 +70,10 @@ private:
     void initTopInfo();
     void initBottomButtons();
     void initTroopBar();
+    void initReplayProgressBar();
+
+    // 触摸点对应的回放进度（0-1）
+    float touchToReplayFraction(cocos2d::Touch* touch) const;
 
     BattleScene* getBattleScene();
 };
@@ -5,11 +5,20 @@
 #include "Manager/BuildingManager.h"
 #include "Manager/VillageDataManager.h"
 #include "Controller/MoveMapController.h"
+#include "Component/HealthBarBatch.h"
+#include "Controller/BattleEventBus.h"
+#include "Sprite/TiledMapBackground.h"
 #include "Util/GridMapUtils.h"
 
 USING_NS_CC;
 
 BattleMapLayer::~BattleMapLayer() {
+    // 取消战斗事件订阅
+    if (_targetLockedSubscription != 0) {
+        BattleEventBus::getInstance()->unsubscribe(_targetLockedSubscription);
+        _targetLockedSubscription = 0;
+    }
+
     // 清理MoveMapController
     if (_inputController) {
         delete _inputController;
@@ -30,7 +39,7 @@ bool BattleMapLayer::init() {
 
     // 创建地图背景
     _mapSprite = createMapSprite();
-    this->addChild(_mapSprite);
+    this->addChild(_mapSprite, -1);
 
     // 设置Layer大小与地图一致
     if (_mapSprite) {
@@ -38,6 +47,9 @@ bool BattleMapLayer::init() {
         this->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
     }
 
+    // 血条批量渲染节点（建筑和单位的血条统一在此绘制）
+    this->addChild(HealthBarBatch::create(), HealthBarBatch::Z_ORDER);
+
     // 初始化建筑管理器（战斗场景模式）
     _buildingManager = new BuildingManager(this, true);
 
@@ -51,18 +63,17 @@ bool BattleMapLayer::init() {
     // 启动定时更新
     this->scheduleUpdate();
 
-    // 监听目标锁定事件
-    auto listener = EventListenerCustom::create("EVENT_UNIT_TARGET_LOCKED", [this](EventCustom* event) {
+    // 订阅目标锁定事件
+    _targetLockedSubscription = BattleEventBus::getInstance()->subscribe(
+        BattleEventBus::maskOf(BattleEventType::UNIT_TARGET_LOCKED),
+        [this](const BattleEvent& event) {
         if (!_buildingManager) return;
-        intptr_t rawId = reinterpret_cast<intptr_t>(event->getUserData());
-        int targetID = static_cast<int>(rawId);
 
-        BuildingSprite* b = _buildingManager->getBuildingSprite(targetID);
+        BuildingSprite* b = _buildingManager->getBuildingSprite(event.buildingId);
         if (b) {
             b->showTargetBeacon();
         }
     });
-    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
 
     return true;
 }
@@ -97,7 +108,7 @@ void BattleMapLayer::reloadMap() {
     logBuildingLayout("RELOAD MAP");
 
     CCLOG("BattleMapLayer: Map reloaded with %zu buildings",
-          dataManager->getBattleMapData().buildings.size());
+          dataManager->getBattleBuildings().size());
 }
 
 void BattleMapLayer::logBuildingLayout(const std::string& context) {
@@ -178,7 +189,7 @@ void BattleMapLayer::logBuildingLayout(const std::string& context) {
     CCLOG("========================================\n");
 }
 
-Sprite* BattleMapLayer::createMapSprite() {
+TiledMapBackground* BattleMapLayer::createMapSprite() {
     // 从4张地图中随机选择一张
     static const std::vector<std::string> mapImages = {
         "Scene/VillageScene.png",
@@ -191,7 +202,7 @@ Sprite* BattleMapLayer::createMapSprite() {
     const std::string& selectedMap = mapImages[randomIndex];
     CCLOG("BattleMapLayer: Selected random map: %s", selectedMap.c_str());
     
-    auto mapSprite = Sprite::create(selectedMap);
+    auto mapSprite = TiledMapBackground::create(selectedMap);
     if (!mapSprite) {
         CCLOG("Error: Failed to load map image: %s", selectedMap.c_str());
         return nullptr;
@@ -226,5 +237,5 @@ void BattleMapLayer::reloadMapFromData() {
 
     auto dataManager = VillageDataManager::getInstance();
     CCLOG("BattleMapLayer: Replay map reloaded with %zu buildings",
-          dataManager->getBattleMapData().buildings.size());
+          dataManager->getBattleBuildings().size());
 }
@@ -6,11 +6,13 @@
 #define __BATTLE_MAP_LAYER_H__
 
 #include "cocos2d.h"
+#include "IsoDepthLayer.h"
 
 class BuildingManager;
 class MoveMapController;
+class TiledMapBackground;
 
-class BattleMapLayer : public cocos2d::Layer {
+class BattleMapLayer : public IsoDepthLayer {
 public:
     virtual bool init() override;
     virtual ~BattleMapLayer();
@@ -26,12 +28,13 @@ public:
     void reloadMapFromData();  // 从现有数据重建（回放模式）
     
 private:
-    cocos2d::Sprite* _mapSprite;
+    TiledMapBackground* _mapSprite;
     BuildingManager* _buildingManager;
     MoveMapController* _inputController;
+    int _targetLockedSubscription = 0;  // 目标锁定事件订阅ID
 
     void initializeMap();
-    cocos2d::Sprite* createMapSprite();
+    TiledMapBackground* createMapSprite();
 
     // 输出建筑布局信息
     void logBuildingLayout(const std::string& context);
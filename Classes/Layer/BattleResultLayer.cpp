@@ -3,6 +3,7 @@
 
 #pragma execution_character_set("utf-8")
 #include "BattleResultLayer.h"
+#include "../Manager/AtlasManager.h"
 #include "../Scene/BattleScene.h"
 #include "../Model/TroopConfig.h"
 #include "../Manager/AudioManager.h"
@@ -73,7 +74,7 @@ bool BattleResultLayer::initWithData(
     this->addChild(lootTitleLabel);
     
     // 金币图标
-    auto goldIcon = Sprite::create("ImageElements/coin_icon.png");
+    auto goldIcon = AtlasManager::getInstance()->createSprite("ImageElements/coin_icon.png");
     if (goldIcon) {
         goldIcon->setScale(0.4f);
         goldIcon->setPosition(centerX - 30, lootY);
@@ -89,7 +90,7 @@ bool BattleResultLayer::initWithData(
     this->addChild(goldLabel);
     
     // 圣水图标
-    auto elixirIcon = Sprite::create("ImageElements/elixir_icon.png");
+    auto elixirIcon = AtlasManager::getInstance()->createSprite("ImageElements/elixir_icon.png");
     if (elixirIcon) {
         elixirIcon->setScale(0.4f);
         elixirIcon->setPosition(centerX + 120, lootY);
@@ -108,7 +109,7 @@ bool BattleResultLayer::initWithData(
     createTroopCards();
 
     // [回营]按钮
-    auto btnReturn = Button::create("UI/battle/battle-prepare/back.png");
+    auto btnReturn = AtlasManager::getInstance()->createButton("UI/battle/battle-prepare/back.png");
     btnReturn->setScale(0.4f);
     btnReturn->setPosition(Vec2(visibleSize.width / 2, visibleSize.height / 2 - 160));
     btnReturn->addClickEventListener([this](Ref*) {
@@ -229,7 +230,7 @@ void BattleResultLayer::createTroopCards() {
         auto troopInfo = TroopConfig::getInstance()->getTroopById(troopId);
         
         // 卡片背景（使用图标）
-        auto iconSprite = Sprite::create(troopInfo.iconPath);
+        auto iconSprite = AtlasManager::getInstance()->createSprite(troopInfo.iconPath);
         if (iconSprite) {
             iconSprite->setScale(0.55f);
             iconSprite->setPosition(startX, 0);
@@ -3,7 +3,9 @@
 
 #include "BattleTroopLayer.h"
 #include "../Manager/AnimationManager.h"
+#include "../Manager/BattleEffectPool.h"
 #include "../Util/GridMapUtils.h"
+#include "../Model/TroopConfig.h"
 
 USING_NS_CC;
 
@@ -44,6 +46,14 @@ BattleUnitSprite* BattleTroopLayer::spawnUnit(const std::string& unitType, int g
         return nullptr;
     }
     
+    // 登记战斗数据（生命值来自兵种配置，未知兵种按野蛮人处理）
+    int troopId = static_cast<int>(unit->getUnitTypeID());
+    if (unit->getUnitTypeID() == UnitTypeID::UNKNOWN) {
+        troopId = static_cast<int>(UnitTypeID::BARBARIAN);
+    }
+    int maxHP = TroopConfig::getInstance()->getTroopById(troopId).hitpoints;
+    _unitStore.add(unit->getUnitTypeID(), maxHP, static_cast<float>(gridX), static_cast<float>(gridY), unit);
+
     // 设置位置
     unit->teleportToGrid(gridX, gridY);
     unit->playIdleAnimation();
@@ -65,7 +75,6 @@ BattleUnitSprite* BattleTroopLayer::spawnUnit(const std::string& unitType, int g
         // Fallback：如果还没加到MapLayer，就加到自己身上
         this->addChild(unit, zOrder); 
     }
-    _units.push_back(unit);
     
     CCLOG("BattleTroopLayer: Spawned %s at grid(%d, %d)", unitType.c_str(), gridX, gridY);
     return unit;
@@ -86,10 +95,13 @@ void BattleTroopLayer::spawnUnitsGrid(const std::string& unitType, int spacing)
 }
 
 void BattleTroopLayer::removeAllUnits() {
-    for (auto unit : _units) {
-        this->removeChild(unit);
+    // 先复制视图列表，清空存储会解除绑定
+    std::vector<BattleUnitSprite*> units = _unitStore.getViews();
+    _unitStore.clear();
+    for (auto unit : units) {
+        // 单位挂在地图层上（与建筑统一Z序），从实际父节点移除并停止动作
+        unit->removeFromParent();
     }
-    _units.clear();
     CCLOG("BattleTroopLayer: Removed all units");
 }
 
@@ -108,12 +120,12 @@ void BattleTroopLayer::removeUnit(BattleUnitSprite* unit) {
           unitType.c_str(), posX, posY);
     
     // 从列表中移除
-    auto it = std::find(_units.begin(), _units.end(), unit);
-    if (it != _units.end()) {
-        _units.erase(it);
-        CCLOG("BattleTroopLayer::removeUnit - Unit removed from _units vector (size now: %zu)", _units.size());
+    int index = unit->getStoreIndex();
+    if (index >= 0 && _unitStore.getView(index) == unit) {
+        _unitStore.remove(index);
+        CCLOG("BattleTroopLayer::removeUnit - Unit removed from unit store (size now: %d)", _unitStore.size());
     } else {
-        CCLOG("BattleTroopLayer::removeUnit - WARNING: Unit not found in _units vector!");
+        CCLOG("BattleTroopLayer::removeUnit - WARNING: Unit not found in unit store!");
     }
     
     // 从显示树移除
@@ -143,15 +155,14 @@ void BattleTroopLayer::removeUnit(BattleUnitSprite* unit) {
 }
 
 void BattleTroopLayer::spawnTombstone(const Vec2& position, UnitTypeID unitType) {
-    CCLOG("===== TOMBSTONE DEBUG START =====");
     CCLOG("BattleTroopLayer::spawnTombstone - Creating tombstone at (%.1f, %.1f)", position.x, position.y);
 
-    Sprite* tombstone = nullptr;
-
-    // 根据兵种类型加载墓碑图片
+    // 根据兵种类型确定墓碑图片
+    Texture2D* texture = nullptr;
+    SpriteFrame* frame = nullptr;
     if (unitType == UnitTypeID::BALLOON) {
         // 气球兵使用独立墓碑图片
-        tombstone = Sprite::create("Animation/troop/balloon/balloon_death.png");
+        texture = Director::getInstance()->getTextureCache()->addImage("Animation/troop/balloon/balloon_death.png");
     } else {
         // 其他兵种从精灵图集获取墓碑帧
         std::string frameName;
@@ -175,18 +186,30 @@ void BattleTroopLayer::spawnTombstone(const Vec2& position, UnitTypeID unitType)
                 frameName = "barbarian175.0.png";
                 break;
         }
+        frame = SpriteFrameCache::getInstance()->getSpriteFrameByName(frameName);
+    }
 
-        auto frame = SpriteFrameCache::getInstance()->getSpriteFrameByName(frameName);
-        if (frame) {
-            tombstone = Sprite::createWithSpriteFrame(frame);
-        }
+    if (!texture && !frame) {
+        CCLOG("BattleTroopLayer::spawnTombstone - ERROR: Failed to load tombstone image!");
+        return;
     }
 
+    // 从特效池取精灵，添加到地图层与建筑统一排序
+    Node* parent = this->getParent() ? this->getParent() : this;
+    auto tombstone = BattleEffectPool::getInstance()->acquireSprite(
+        BattleEffectPool::EffectType::TOMBSTONE, parent, 100);
     if (!tombstone) {
         CCLOG("BattleTroopLayer::spawnTombstone - ERROR: Failed to create tombstone sprite!");
         return;
     }
 
+    if (frame) {
+        tombstone->setSpriteFrame(frame);
+    } else {
+        tombstone->setTexture(texture);
+        tombstone->setTextureRect(Rect(Vec2::ZERO, texture->getContentSize()));
+    }
+
     // 设置位置
     tombstone->setPosition(position);
     tombstone->setAnchorPoint(Vec2(0.5f, 0.0f));
@@ -200,29 +223,11 @@ void BattleTroopLayer::spawnTombstone(const Vec2& position, UnitTypeID unitType)
         case UnitTypeID::GIANT: scale = 1.2f; break;
         case UnitTypeID::WALL_BREAKER: scale = 0.65f; break;
         case UnitTypeID::BALLOON: scale = 1.0f; break;
+        default: break;
     }
     tombstone->setScale(scale);
 
-    // 强制设置为白色（防止继承兵种的红色）
-    tombstone->setColor(Color3B::WHITE);
-    tombstone->setOpacity(255);
-
-    CCLOG("BattleTroopLayer::spawnTombstone - Tombstone color set to WHITE");
-
-    // 添加到地图层
-    auto mapLayer = this->getParent();
-    CCLOG("BattleTroopLayer::spawnTombstone - MapLayer: %p", mapLayer);
-
-    if (mapLayer) {
-        CCLOG("BattleTroopLayer::spawnTombstone - Adding to MapLayer with Z-order 100...");
-        mapLayer->addChild(tombstone, 100);
-        CCLOG("BattleTroopLayer::spawnTombstone - Tombstone added successfully");
-    } else {
-        CCLOG("BattleTroopLayer::spawnTombstone - WARNING: No MapLayer, adding to TroopLayer...");
-        this->addChild(tombstone, 100);
-    }
-
-    // 墓碑自动消失：停留3秒后淡出
+    // 墓碑自动消失：停留3秒后淡出，离开父节点后由特效池回收
     auto sequence = Sequence::create(
         DelayTime::create(3.0f),
         FadeOut::create(1.0f),
@@ -230,22 +235,9 @@ void BattleTroopLayer::spawnTombstone(const Vec2& position, UnitTypeID unitType)
         nullptr
     );
     tombstone->runAction(sequence);
-
-    CCLOG("BattleTroopLayer::spawnTombstone - COMPLETE: Tombstone created and will fade out after 3s");
-    CCLOG("===== TOMBSTONE DEBUG END =====");
 }
 
 void BattleTroopLayer::clearAllTombstones() {
-    auto mapLayer = this->getParent();
-    
-    for (auto tombstone : _tombstones) {
-        if (mapLayer && tombstone->getParent() == mapLayer) {
-            mapLayer->removeChild(tombstone);
-        } else {
-            this->removeChild(tombstone);
-        }
-    }
-    
-    _tombstones.clear();
+    BattleEffectPool::getInstance()->recycleAll(BattleEffectPool::EffectType::TOMBSTONE);
     CCLOG("BattleTroopLayer: Cleared all tombstones");
 }
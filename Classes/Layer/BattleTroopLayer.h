@@ -5,6 +5,7 @@
 
 #include "cocos2d.h"
 #include "../Sprite/BattleUnitSprite.h"
+#include "../Model/BattleUnitStore.h"
 #include <vector>
 
 USING_NS_CC;
@@ -31,7 +32,11 @@ public:
     void removeAllUnits();
     
     // 获取所有单位
-    const std::vector<BattleUnitSprite*>& getAllUnits() const { return _units; }
+    const std::vector<BattleUnitSprite*>& getAllUnits() const { return _unitStore.getViews(); }
+
+    // 获取单位数据存储（防御/陷阱等系统按下标遍历）
+    BattleUnitStore& getUnitStore() { return _unitStore; }
+    const BattleUnitStore& getUnitStore() const { return _unitStore; }
     
     // 移除指定单位（死亡时调用）
     void removeUnit(BattleUnitSprite* unit);
@@ -43,8 +48,7 @@ public:
     void clearAllTombstones();
     
 private:
-    std::vector<BattleUnitSprite*> _units;  // 所有单位列表
-    std::vector<Node*> _tombstones;         // 墓碑列表
+    BattleUnitStore _unitStore;             // 所有单位的战斗数据（精灵为显示视图）
     
     static const int GRID_WIDTH = 44;
     static const int GRID_HEIGHT = 44;
@@ -6,6 +6,7 @@
 #include "../Util/DebugHelper.h"
 #include "../Manager/VillageDataManager.h"
 #include "../Layer/VillageLayer.h"
+#include "../Controller/AttackPlanner.h"
 
 USING_NS_CC;
 using namespace ui;
@@ -276,11 +277,20 @@ void DebugLayer::initBattleMapSection() {
     // 生成随机地图按钮
     auto randomMapBtn = Button::create();
     randomMapBtn->setTitleText("[ 🎲 生成随机战斗地图 ]");
-    randomMapBtn->setPosition(Vec2(300, 40));
+    randomMapBtn->setPosition(Vec2(150, 40));
     randomMapBtn->setTitleFontSize(16);
     randomMapBtn->setTitleColor(Color3B(0, 255, 255));
     randomMapBtn->addClickEventListener([this](Ref*) { this->onGenerateRandomMap(); });
     _panel->addChild(randomMapBtn);
+
+    // 无界面战斗模拟性能测试
+    auto benchmarkBtn = Button::create();
+    benchmarkBtn->setTitleText("[ ⏱ 模拟性能测试 ]");
+    benchmarkBtn->setPosition(Vec2(450, 40));
+    benchmarkBtn->setTitleFontSize(16);
+    benchmarkBtn->setTitleColor(Color3B(0, 255, 255));
+    benchmarkBtn->addClickEventListener([this](Ref*) { this->onRunSimulationBenchmark(); });
+    _panel->addChild(benchmarkBtn);
 }
 
 void DebugLayer::onGenerateRandomMap() {
@@ -297,3 +307,30 @@ void DebugLayer::onGenerateRandomMap() {
     
     CCLOG("DebugLayer: Generated random battle map");
 }
+
+void DebugLayer::onRunSimulationBenchmark() {
+    auto dataManager = VillageDataManager::getInstance();
+    if (!dataManager->hasBattleMapData()) {
+        dataManager->generateRandomBattleMap(0);
+    }
+
+    // 军队为空时用一支默认军队测试
+    std::map<int, int> army = dataManager->getAllTroops();
+    bool hasTroops = false;
+    for (const auto& pair : army) {
+        if (pair.second > 0) hasTroops = true;
+    }
+    if (!hasTroops) {
+        army = { { 1001, 20 }, { 1002, 20 }, { 1004, 4 }, { 1005, 4 } };
+    }
+
+    const int SIMULATIONS = 2000;
+    auto result = AttackPlanner::getInstance()->runBenchmark(
+        dataManager->getBattleMapData(), army, SIMULATIONS);
+
+    std::string msg = StringUtils::format("模拟 %d 次：单线程 %.0f 次/秒，%d 线程 %.0f 次/秒",
+                                          result.simulations, result.singleThreadSimsPerSecond,
+                                          result.threads, result.parallelSimsPerSecond);
+    _selectedBuildingLabel->setString(msg);
+    _selectedBuildingLabel->setColor(Color3B(0, 255, 255));
+}
@@ -43,6 +43,7 @@ private:
     // 战斗地图回调
     void initBattleMapSection();
     void onGenerateRandomMap();
+    void onRunSimulationBenchmark();
 
     // UI成员
     cocos2d::Node* _panel;
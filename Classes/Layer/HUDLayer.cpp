@@ -3,6 +3,7 @@
 
 #pragma execution_character_set("utf-8")
 #include "HUDLayer.h"
+#include "Manager/AtlasManager.h"
 #include "Layer/ShopLayer.h"
 #include "Manager/VillageDataManager.h"
 #include "Manager/BuildingUpgradeManager.h"
@@ -16,6 +17,7 @@
 #include "DebugLayer.h"
 #include "Layer/LaboratoryLayer.h"
 #include "Layer/ThemeSwitchLayer.h" 
+#include "Util/HudFont.h"
 
 USING_NS_CC;
 using namespace ui;
@@ -61,7 +63,7 @@ bool HUDLayer::init() {
   Vec2 origin = Director::getInstance()->getVisibleOrigin();
 
   // 金币：图标+文字
-    auto goldIcon = Sprite::create("ImageElements/coin_icon.png");
+    auto goldIcon = AtlasManager::getInstance()->createSprite("ImageElements/coin_icon.png");
   if (goldIcon) {
     goldIcon->setScale(0.5f);
     goldIcon->setAnchorPoint(Vec2(1, 0.5f));
@@ -69,16 +71,15 @@ bool HUDLayer::init() {
     this->addChild(goldIcon);
   }
    
-  _goldLabel = Label::createWithTTF("0", "fonts/Marker Felt.ttf", 24);
+  _goldLabel = HudFont::createLabel("0", HudFont::Face::MARKER_FELT, 24);
   _goldLabel->setAnchorPoint(Vec2(0, 0.5f));
   _goldLabel->setPosition(Vec2(origin.x + 75, origin.y + visibleSize.height - 30));
   _goldLabel->setColor(Color3B(255, 215, 0));
-  _goldLabel->enableOutline(Color4B::BLACK, 2);
   _goldLabel->enableShadow(Color4B(0, 0, 0, 150), Size(2, -2));
   this->addChild(_goldLabel);
 
   // 圣水：图标+文字
-  auto elixirIcon = Sprite::create("ImageElements/elixir_icon.png");
+  auto elixirIcon = AtlasManager::getInstance()->createSprite("ImageElements/elixir_icon.png");
   if (elixirIcon) {
     elixirIcon->setScale(0.5f);
     elixirIcon->setAnchorPoint(Vec2(1, 0.5f));
@@ -86,16 +87,15 @@ bool HUDLayer::init() {
     this->addChild(elixirIcon);
   }
 
-  _elixirLabel = Label::createWithTTF("0", "fonts/Marker Felt.ttf", 24);
+  _elixirLabel = HudFont::createLabel("0", HudFont::Face::MARKER_FELT, 24);
   _elixirLabel->setAnchorPoint(Vec2(0, 0.5f));
   _elixirLabel->setPosition(Vec2(origin.x + 275, origin.y + visibleSize.height - 30));
   _elixirLabel->setColor(Color3B(255, 0, 255));
-  _elixirLabel->enableOutline(Color4B::BLACK, 2);
   _elixirLabel->enableShadow(Color4B(0, 0, 0, 150), Size(2, -2));
   this->addChild(_elixirLabel);
 
   // 宝石：图标+文字
-  auto gemIcon = Sprite::create("ImageElements/gem_icon.png");
+  auto gemIcon = AtlasManager::getInstance()->createSprite("ImageElements/gem_icon.png");
   if (gemIcon) {
     gemIcon->setScale(0.5f);
     gemIcon->setAnchorPoint(Vec2(1, 0.5f));
@@ -103,16 +103,15 @@ bool HUDLayer::init() {
     this->addChild(gemIcon);
   }
 
-  _gemLabel = Label::createWithTTF("0", "fonts/Marker Felt.ttf", 24);
+  _gemLabel = HudFont::createLabel("0", HudFont::Face::MARKER_FELT, 24);
   _gemLabel->setAnchorPoint(Vec2(0, 0.5f));
   _gemLabel->setPosition(Vec2(origin.x + 465, origin.y + visibleSize.height - 30));
   _gemLabel->setColor(Color3B(0, 255, 0));
-  _gemLabel->enableOutline(Color4B::BLACK, 2);
   _gemLabel->enableShadow(Color4B(0, 0, 0, 150), Size(2, -2));
   this->addChild(_gemLabel);
 
   // 工人：图标+文字
-  auto workerIcon = Sprite::create("ImageElements/worker_icon.png");
+  auto workerIcon = AtlasManager::getInstance()->createSprite("ImageElements/worker_icon.png");
   if (workerIcon) {
     workerIcon->setScale(0.5f);
     workerIcon->setAnchorPoint(Vec2(1, 0.5f));
@@ -120,11 +119,10 @@ bool HUDLayer::init() {
     this->addChild(workerIcon);
   }
 
-  _workerLabel = Label::createWithTTF("1/1", "fonts/Marker Felt.ttf", 24);
+  _workerLabel = HudFont::createLabel("1/1", HudFont::Face::MARKER_FELT, 24);
   _workerLabel->setAnchorPoint(Vec2(0, 0.5f));
   _workerLabel->setPosition(Vec2(origin.x + 625, origin.y + visibleSize.height - 30));
   _workerLabel->setColor(COLOR_CYAN);
-  _workerLabel->enableOutline(Color4B::BLACK, 2);
   _workerLabel->enableShadow(Color4B(0, 0, 0, 150), Size(2, -2));
   this->addChild(_workerLabel);
 
@@ -153,7 +151,7 @@ bool HUDLayer::init() {
   this->scheduleUpdate();
 
   // 商店入口按钮
-  auto shopBtn = ui::Button::create("UI/Shop/Shop-button.png");
+  auto shopBtn = AtlasManager::getInstance()->createButton("UI/Shop/Shop-button.png");
   shopBtn->setAnchorPoint(Vec2(1, 0));
   shopBtn->setPosition(Vec2(origin.x + visibleSize.width - 20, origin.y + 20));
   shopBtn->addClickEventListener([this](Ref* sender) {
@@ -211,7 +209,7 @@ bool HUDLayer::init() {
   });
 
   // 进攻按钮
-  auto battleBtn = ui::Button::create("UI/battle/battle-icon/battle-icon.png");
+  auto battleBtn = AtlasManager::getInstance()->createButton("UI/battle/battle-icon/battle-icon.png");
   if (battleBtn) {
     battleBtn->setAnchorPoint(Vec2(0, 0));
     battleBtn->setPosition(Vec2(origin.x + 20, origin.y + 20));
@@ -463,7 +461,7 @@ void HUDLayer::initActionMenu() {
   std::string imgPath = "UI/training-camp/building-icon/";
 
   // 信息按钮
-  _btnInfo = Button::create(imgPath + "info.png");
+  _btnInfo = AtlasManager::getInstance()->createButton(imgPath + "info.png");
   _btnInfo->ignoreContentAdaptWithSize(false);
   _btnInfo->setContentSize(Size(btnSize, btnSize));
   _btnInfo->addClickEventListener([this](Ref*) {
@@ -472,7 +470,7 @@ void HUDLayer::initActionMenu() {
   _actionMenuNode->addChild(_btnInfo);
 
   // 升级按钮
-  _btnUpgrade = Button::create(imgPath + "upgrade.png");
+  _btnUpgrade = AtlasManager::getInstance()->createButton(imgPath + "upgrade.png");
   _btnUpgrade->ignoreContentAdaptWithSize(false);
   _btnUpgrade->setContentSize(Size(btnSize, btnSize));
   _btnUpgrade->addClickEventListener([this](Ref*) {
@@ -553,7 +551,7 @@ void HUDLayer::initActionMenu() {
   _btnUpgrade->addChild(_upgradeCostLabel);
 
   // 训练按钮
-  _btnTrain = Button::create(imgPath + "training.png");
+  _btnTrain = AtlasManager::getInstance()->createButton(imgPath + "training.png");
   _btnTrain->ignoreContentAdaptWithSize(false);
   _btnTrain->setContentSize(Size(btnSize, btnSize));
   _btnTrain->addClickEventListener([this](Ref*) {
@@ -564,7 +562,7 @@ void HUDLayer::initActionMenu() {
   _actionMenuNode->addChild(_btnTrain);
 
   // 加速按钮
-  _btnSpeedup = Button::create("UI/Village/Speedup_button.png");
+  _btnSpeedup = AtlasManager::getInstance()->createButton("UI/Village/Speedup_button.png");
   _btnSpeedup->ignoreContentAdaptWithSize(false);
   _btnSpeedup->setContentSize(Size(btnSize, btnSize));
   _btnSpeedup->setVisible(false);
@@ -576,7 +574,7 @@ void HUDLayer::initActionMenu() {
   _actionMenuNode->addChild(_btnSpeedup);
 
   // 研究按钮（实验室专用）
-  _btnResearch = Button::create("UI/laboratory/research.png");
+  _btnResearch = AtlasManager::getInstance()->createButton("UI/laboratory/research.png");
   _btnResearch->ignoreContentAdaptWithSize(false);
   _btnResearch->setContentSize(Size(btnSize, btnSize));
   _btnResearch->setVisible(false);
@@ -588,7 +586,7 @@ void HUDLayer::initActionMenu() {
   _actionMenuNode->addChild(_btnResearch);
 
   // 切换场景按钮（大本营专用）
-  _btnThemeSwitch = Button::create("UI/Village/change_bg_btn.png");
+  _btnThemeSwitch = AtlasManager::getInstance()->createButton("UI/Village/change_bg_btn.png");
   _btnThemeSwitch->ignoreContentAdaptWithSize(false);
   _btnThemeSwitch->setContentSize(Size(btnSize, btnSize));
   _btnThemeSwitch->setVisible(false);
@@ -0,0 +1,189 @@
+﻿// IsoDepthLayer.cpp
+// 等轴测深度分桶层实现
+
+#include "IsoDepthLayer.h"
+#include <climits>
+
+USING_NS_CC;
+
+bool IsoDepthLayer::isDepthZOrder(int zOrder) {
+    return bucketFor(zOrder) >= 0;
+}
+
+int IsoDepthLayer::bucketFor(int zOrder) {
+    if (zOrder >= GROUND_Z_BEGIN && zOrder < GROUND_Z_BEGIN + DEPTH_COUNT) {
+        return zOrder - GROUND_Z_BEGIN;
+    }
+    if (zOrder >= AIR_Z_BEGIN && zOrder < AIR_Z_BEGIN + DEPTH_COUNT) {
+        return DEPTH_COUNT + zOrder - AIR_Z_BEGIN;
+    }
+    return -1;
+}
+
+int IsoDepthLayer::zOrderOfBucket(int bucket) {
+    return bucket < DEPTH_COUNT ? GROUND_Z_BEGIN + bucket : AIR_Z_BEGIN + bucket - DEPTH_COUNT;
+}
+
+// ========== 子节点管理 ==========
+
+void IsoDepthLayer::addChild(Node* child, int localZOrder, int tag) {
+    Layer::addChild(child, localZOrder, tag);
+    if (child && child->getParent() == this) {
+        insertIntoBucket(child, localZOrder);
+    }
+}
+
+void IsoDepthLayer::addChild(Node* child, int localZOrder, const std::string& name) {
+    Layer::addChild(child, localZOrder, name);
+    if (child && child->getParent() == this) {
+        insertIntoBucket(child, localZOrder);
+    }
+}
+
+void IsoDepthLayer::removeChild(Node* child, bool cleanup) {
+    removeFromBucket(child);
+    Layer::removeChild(child, cleanup);
+}
+
+void IsoDepthLayer::removeAllChildrenWithCleanup(bool cleanup) {
+    for (auto& bucket : _buckets) {
+        bucket.clear();
+    }
+    _slots.clear();
+    Layer::removeAllChildrenWithCleanup(cleanup);
+}
+
+void IsoDepthLayer::reorderChild(Node* child, int localZOrder) {
+    CCASSERT(child != nullptr, "Child must be non-nil");
+
+    bool culled = removeFromBucket(child);
+
+    if (bucketFor(localZOrder) < 0) {
+        // 移出深度区间：交给引擎排序，恢复裁剪状态
+        if (culled) {
+            if (auto cullable = dynamic_cast<IsoCullable*>(child)) cullable->setCulled(false);
+        }
+        Layer::reorderChild(child, localZOrder);
+        return;
+    }
+
+    // 深度区间内只在桶之间移动，不标记重排序
+    child->updateOrderOfArrival();
+    child->_setLocalZOrder(localZOrder);
+    insertIntoBucket(child, localZOrder, culled);
+}
+
+void IsoDepthLayer::insertIntoBucket(Node* child, int zOrder, bool culled) {
+    int bucket = bucketFor(zOrder);
+    if (bucket < 0) return;
+
+    Entry entry;
+    entry.node = child;
+    entry.cullable = dynamic_cast<IsoCullable*>(child);
+    entry.cullByBounds = dynamic_cast<Sprite*>(child) || dynamic_cast<ParticleSystem*>(child);
+    entry.culled = culled;
+
+    auto& entries = _buckets[bucket];
+    _slots[child] = { bucket, static_cast<int>(entries.size()) };
+    entries.push_back(entry);
+}
+
+bool IsoDepthLayer::removeFromBucket(Node* child) {
+    auto it = _slots.find(child);
+    if (it == _slots.end()) return false;
+
+    // 按序删除：桶内保持加入顺序（与引擎同Z序按到达顺序绘制一致），后面的节点下标前移
+    auto& entries = _buckets[it->second.bucket];
+    int index = it->second.index;
+    bool culled = entries[index].culled;
+    entries.erase(entries.begin() + index);
+    for (int i = index; i < static_cast<int>(entries.size()); ++i) {
+        _slots[entries[i].node].index = i;
+    }
+    _slots.erase(it);
+    return culled;
+}
+
+// ========== 绘制 ==========
+
+void IsoDepthLayer::updateCullRect() {
+    auto director = Director::getInstance();
+    Rect visibleRect(director->getVisibleOrigin(), director->getVisibleSize());
+
+    // 屏幕可见区域变换到本层坐标（缩放、平移后的地图层）
+    Mat4 worldToNode = getNodeToWorldTransform().getInversed();
+    _cullRect = RectApplyTransform(visibleRect, worldToNode);
+    _cullRect.origin -= Vec2(CULL_MARGIN, CULL_MARGIN);
+    _cullRect.size = _cullRect.size + Size(CULL_MARGIN * 2, CULL_MARGIN * 2);
+}
+
+void IsoDepthLayer::visitEntry(Entry& entry, Renderer* renderer, uint32_t flags) {
+    Node* node = entry.node;
+
+    if (entry.cullByBounds) {
+        bool culled = !_cullRect.intersectsRect(node->getBoundingBox());
+        if (culled != entry.culled) {
+            entry.culled = culled;
+            if (entry.cullable) entry.cullable->setCulled(culled);
+
+            // 裁剪期间地图可能移动过，节点缓存的变换已过时，重新出现时强制刷新
+            flags |= FLAGS_TRANSFORM_DIRTY;
+        }
+        if (culled) {
+            ++_culledCount;
+            return;
+        }
+    }
+
+    node->visit(renderer, _modelViewTransform, flags);
+}
+
+void IsoDepthLayer::visitBucketsBelow(int zOrder, int& nextBucket, Renderer* renderer, uint32_t flags) {
+    for (; nextBucket < DEPTH_COUNT * 2 && zOrderOfBucket(nextBucket) < zOrder; ++nextBucket) {
+        for (auto& entry : _buckets[nextBucket]) {
+            visitEntry(entry, renderer, flags);
+        }
+    }
+}
+
+void IsoDepthLayer::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags) {
+    if (!_visible) {
+        return;
+    }
+
+    uint32_t flags = processParentFlags(parentTransform, parentFlags);
+
+    _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+
+    bool visibleByCamera = isVisitableByVisitingCamera();
+    bool selfDrawn = false;
+    int nextBucket = 0;
+
+    updateCullRect();
+    _culledCount = 0;
+
+    // 只有深度区间外的子节点增删或换序时才真正排序；桶内节点的Z序变化不会标记重排序，
+    // 它们在 _children 中的位置可能过时，这里直接跳过，改由桶按顺序绘制
+    sortAllChildren();
+
+    for (auto child : _children) {
+        int zOrder = child->getLocalZOrder();
+        if (isDepthZOrder(zOrder)) continue;
+
+        if (!selfDrawn && zOrder >= 0) {
+            if (visibleByCamera) this->draw(renderer, _modelViewTransform, flags);
+            selfDrawn = true;
+        }
+
+        visitBucketsBelow(zOrder, nextBucket, renderer, flags);
+        child->visit(renderer, _modelViewTransform, flags);
+    }
+
+    if (!selfDrawn && visibleByCamera) {
+        this->draw(renderer, _modelViewTransform, flags);
+    }
+    visitBucketsBelow(INT_MAX, nextBucket, renderer, flags);
+
+    _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+}
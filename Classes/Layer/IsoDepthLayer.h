@@ -0,0 +1,91 @@
+﻿// IsoDepthLayer.h
+// 等轴测深度分桶层声明，按深度值分桶管理建筑和单位，移动时不再触发全体子节点重排序，并裁剪视口外的节点
+
+#pragma once
+#ifndef __ISO_DEPTH_LAYER_H__
+#define __ISO_DEPTH_LAYER_H__
+
+#include "cocos2d.h"
+#include <unordered_map>
+#include <vector>
+
+// 需要感知视口裁剪的节点实现此接口（如离屏时暂停循环帧动画）
+class IsoCullable {
+public:
+    virtual ~IsoCullable() {}
+
+    // 进入/离开视口时由 IsoDepthLayer 调用
+    virtual void setCulled(bool culled) = 0;
+};
+
+// 等轴测深度分桶层
+// 功能：
+// 1. Z序落在深度区间内的子节点（GridMapUtils::calculateZOrder 的地面区间和 +1000 的飞行区间）
+//    按Z序放入对应的桶，setLocalZOrder/reorderChild 只是把节点从一个桶移到另一个桶，O(1)
+// 2. 其余子节点（地图背景、血条等）仍按引擎原有方式排序，数量少且很少变动
+// 3. visit 时按Z序把桶和其余子节点归并绘制，绘制顺序与全体排序一致
+// 4. 桶内的精灵和粒子（建筑、单位、墓碑、爆炸特效）按包围盒与当前视口求交，视口外的跳过 visit；
+//    容器节点（兵种层、提示节点等）的内容不在自身包围盒内，不参与裁剪
+// 同一深度内按进入桶的先后绘制（与引擎同Z序按加入先后排序的规则相同）
+// 节点仍是本层的直接子节点，getChildByName、坐标转换等用法不变
+class IsoDepthLayer : public cocos2d::Layer {
+public:
+    // 深度区间：[GROUND_Z_BEGIN, GROUND_Z_BEGIN + DEPTH_COUNT) 和 [AIR_Z_BEGIN, AIR_Z_BEGIN + DEPTH_COUNT)
+    // 地面区间包含 gridX - gridY + 45 的取值范围（0~90）和墓碑层（100）
+    static const int DEPTH_COUNT = 128;
+    static const int GROUND_Z_BEGIN = 0;
+    static const int AIR_Z_BEGIN = 1000;    // 飞行单位的Z序偏移
+
+    // 裁剪时视口向外扩展的距离（本层坐标），容纳超出包围盒的子节点和粒子
+    static constexpr float CULL_MARGIN = 128.0f;
+
+    static bool isDepthZOrder(int zOrder);
+
+    virtual void addChild(cocos2d::Node* child, int localZOrder, int tag) override;
+    virtual void addChild(cocos2d::Node* child, int localZOrder, const std::string& name) override;
+    virtual void removeChild(cocos2d::Node* child, bool cleanup = true) override;
+    virtual void removeAllChildrenWithCleanup(bool cleanup) override;
+    virtual void reorderChild(cocos2d::Node* child, int localZOrder) override;
+    virtual void visit(cocos2d::Renderer* renderer, const cocos2d::Mat4& parentTransform, uint32_t parentFlags) override;
+
+    using cocos2d::Layer::addChild;
+
+    // 上一帧被裁剪的节点数量（调试用）
+    int getCulledCount() const { return _culledCount; }
+
+private:
+    // 桶内的一个节点
+    struct Entry {
+        cocos2d::Node* node;
+        IsoCullable* cullable;  // 实现了裁剪回调时非空
+        bool cullByBounds;      // 是否按包围盒裁剪
+        bool culled;
+    };
+
+    // 节点所在的桶和桶内下标
+    struct Slot {
+        int bucket;
+        int index;
+    };
+
+    std::vector<Entry> _buckets[DEPTH_COUNT * 2];
+    std::unordered_map<cocos2d::Node*, Slot> _slots;
+
+    cocos2d::Rect _cullRect;    // 本帧视口（本层坐标，已外扩）
+    int _culledCount = 0;
+
+    static int bucketFor(int zOrder);
+    static int zOrderOfBucket(int bucket);
+
+    void insertIntoBucket(cocos2d::Node* child, int zOrder, bool culled = false);
+    // 返回节点移出前的裁剪状态
+    bool removeFromBucket(cocos2d::Node* child);
+
+    void updateCullRect();
+
+    // 依次绘制Z序小于 zOrder 的桶，nextBucket 为下一个待绘制的桶
+    void visitBucketsBelow(int zOrder, int& nextBucket, cocos2d::Renderer* renderer, uint32_t flags);
+    void visitEntry(Entry& entry, cocos2d::Renderer* renderer, uint32_t flags);
+};
+
+#endif // __ISO_DEPTH_LAYER_H__
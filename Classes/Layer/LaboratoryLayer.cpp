@@ -3,9 +3,11 @@
 
 #pragma execution_character_set("utf-8")
 #include "LaboratoryLayer.h"
+#include "Manager/AtlasManager.h"
 #include "Manager/VillageDataManager.h"
 #include "Model/TroopUpgradeConfig.h"
 #include "Model/BuildingConfig.h"
+#include "Util/HudFont.h"
 
 USING_NS_CC;
 using namespace ui;
@@ -61,7 +63,7 @@ void LaboratoryLayer::initBackground() {
     this->addChild(_bgNode);
 
     // 背景图片
-    auto bgSprite = Sprite::create("UI/laboratory/backgroud.png");
+    auto bgSprite = AtlasManager::getInstance()->createSprite("UI/laboratory/backgroud.png");
     if (bgSprite) {
         // 按比例缩放
         float scaleX = BG_WIDTH / bgSprite->getContentSize().width;
@@ -106,7 +108,7 @@ void LaboratoryLayer::initBackground() {
         _instantFinishBtn->addChild(btnBg, -1);
         
         // 钻石图标
-        auto gemIcon = Sprite::create("ImageElements/gem_icon.png");
+        auto gemIcon = AtlasManager::getInstance()->createSprite("ImageElements/gem_icon.png");
         if (gemIcon) {
             gemIcon->setScale(0.28f);
             gemIcon->setPosition(90, 20);
@@ -243,7 +245,7 @@ Widget* LaboratoryLayer::createTroopCard(const TroopInfo& info, CardState state,
     widget->addChild(bg);
 
     // 兵种头像
-    auto sprite = Sprite::create(info.iconPath);
+    auto sprite = AtlasManager::getInstance()->createSprite(info.iconPath);
     if (sprite) {
         float scale = (CARD_WIDTH - 30) / sprite->getContentSize().width;
         sprite->setScale(scale);
@@ -274,7 +276,7 @@ Widget* LaboratoryLayer::createTroopCard(const TroopInfo& info, CardState state,
     levelBg->addChild(lvlLabel);
 
     // 右上角info按钮
-    auto infoBtn = Button::create("UI/training-camp/troop-cards/info_btn.png");
+    auto infoBtn = AtlasManager::getInstance()->createButton("UI/training-camp/troop-cards/info_btn.png");
     if (infoBtn) {
         infoBtn->setPosition(Vec2(CARD_WIDTH - 22, CARD_HEIGHT - 22));
         infoBtn->setScale(0.12f);
@@ -301,7 +303,7 @@ Widget* LaboratoryLayer::createTroopCard(const TroopInfo& info, CardState state,
             costBg->addChild(costLabel);
 
             // 圣水图标
-            auto elixirIcon = Sprite::create("ImageElements/elixir_icon.png");
+            auto elixirIcon = AtlasManager::getInstance()->createSprite("ImageElements/elixir_icon.png");
             if (elixirIcon) {
                 elixirIcon->setScale(0.22f);
                 elixirIcon->setPosition(CARD_WIDTH - 40, 16);
@@ -331,8 +333,7 @@ Widget* LaboratoryLayer::createTroopCard(const TroopInfo& info, CardState state,
             timeBg->setPosition(8, 8);
             widget->addChild(timeBg);
 
-            auto timeLabel = Label::createWithTTF(formatTime(remaining), LAB_FONT, 20);
-            if (!timeLabel) timeLabel = Label::createWithSystemFont(formatTime(remaining), "Arial", 20);
+            auto timeLabel = HudFont::createLabel(formatTime(remaining), HudFont::Face::SIMHEI, 20, false);
             timeLabel->setPosition((CARD_WIDTH - 16) / 2, 32);
             timeLabel->setName("timeLabel");
             timeBg->addChild(timeLabel);
@@ -453,7 +454,7 @@ void LaboratoryLayer::showUpgradePopup(int troopId) {
     bg->addChild(closeBtn);
 
     // 左侧：兵种大图
-    auto sprite = Sprite::create(info.iconPath);
+    auto sprite = AtlasManager::getInstance()->createSprite(info.iconPath);
     if (sprite) {
         sprite->setScale(1.5f);
         sprite->setPosition(popupW * 0.25f, popupH * 0.55f);
@@ -522,7 +523,7 @@ void LaboratoryLayer::showUpgradePopup(int troopId) {
         btnBg->setTouchEnabled(false);
         upgradeBtn->addChild(btnBg, -1);
 
-        auto elixirIcon = Sprite::create("ImageElements/elixir_icon.png");
+        auto elixirIcon = AtlasManager::getInstance()->createSprite("ImageElements/elixir_icon.png");
         if (elixirIcon) {
             elixirIcon->setScale(0.25f);
             elixirIcon->setPosition(30, 25);
@@ -4,6 +4,7 @@
 #pragma execution_character_set("utf-8")
 
 #include "ReplayListLayer.h"
+#include "Manager/AtlasManager.h"
 #include "Manager/ReplayManager.h"
 #include "Scene/BattleScene.h"
 
@@ -28,7 +29,7 @@ bool ReplayListLayer::init() {
     _eventDispatcher->addEventListenerWithSceneGraphPriority(bgListener, bgMask);
 
     // 主面板背景
-    auto panel = ui::Scale9Sprite::create("UI/replay/replay_list_bg.png");
+    auto panel = AtlasManager::getInstance()->createScale9Sprite("UI/replay/replay_list_bg.png");
     panel->setPosition(Vec2(visibleSize.width / 2 + origin.x,
                        visibleSize.height / 2 + origin.y));
     this->addChild(panel);
@@ -38,7 +39,7 @@ bool ReplayListLayer::init() {
     CCLOG("ReplayListLayer: Panel size = %.0f x %.0f", panelSize.width, panelSize.height);
 
     // 关闭按钮
-    auto closeBtn = ui::Button::create("UI/replay/close_btn.png");
+    auto closeBtn = AtlasManager::getInstance()->createButton("UI/replay/close_btn.png");
     closeBtn->setPosition(Vec2(panelSize.width - 60, panelSize.height - 40));
     closeBtn->setScale(0.8f);
     closeBtn->addClickEventListener([this](Ref*) {
@@ -67,34 +68,107 @@ bool ReplayListLayer::init() {
     CCLOG("ReplayListLayer: ScrollView created at (%.0f, %.0f) with size (%.0f x %.0f)",
           scrollX, scrollY, scrollWidth, scrollHeight);
 
+    // 滚动时按可见区域创建/回收卡片
+    _scrollView->addEventListener([this](Ref*, ui::ScrollView::EventType type) {
+        if (type == ui::ScrollView::EventType::CONTAINER_MOVED) {
+            refreshVisibleCards();
+        }
+    });
+
     // 创建内容容器
     _contentNode = Node::create();
     _scrollView->addChild(_contentNode);
 
-    // 加载回放列表
-    loadReplayList();
+    createSortButtons(panel);
+
+    // 加载回放列表（索引仍在后台读取时等待读完）
+    auto replayManager = ReplayManager::getInstance();
+    if (replayManager->isIndexReady()) {
+        loadReplayList();
+    } else {
+        _emptyLabel = Label::createWithTTF("加载中...", FONT_PATH, 36);
+        _emptyLabel->setPosition(_scrollView->getContentSize() / 2);
+        _emptyLabel->setColor(Color3B::GRAY);
+        _scrollView->addChild(_emptyLabel);
+
+        this->retain();
+        replayManager->whenIndexReady([this]() {
+            if (this->getParent()) {
+                loadReplayList();
+            }
+            this->release();
+        });
+    }
 
     return true;
 }
 
+void ReplayListLayer::createSortButtons(Node* panel) {
+    Size panelSize = panel->getContentSize();
+    const std::pair<ReplayQuery::SortBy, const char*> tabs[] = {
+        { ReplayQuery::SortBy::DATE, "最新" },
+        { ReplayQuery::SortBy::STARS, "星数" },
+        { ReplayQuery::SortBy::LOOT, "掠夺" }
+    };
+
+    float tabX = 100.0f;
+    for (const auto& tab : tabs) {
+        ReplayQuery::SortBy sortBy = tab.first;
+        auto button = ui::Button::create();
+        button->setTitleText(tab.second);
+        button->setTitleFontName(FONT_PATH);
+        button->setTitleFontSize(28);
+        button->setPosition(Vec2(tabX, panelSize.height - 40));
+        button->addClickEventListener([this, sortBy](Ref*) {
+            onSortClicked(sortBy);
+        });
+        panel->addChild(button, 100);
+        _sortButtons.push_back(std::make_pair(sortBy, button));
+        tabX += 120.0f;
+    }
+    onSortClicked(_sortBy);
+}
+
+void ReplayListLayer::onSortClicked(ReplayQuery::SortBy sortBy) {
+    for (const auto& entry : _sortButtons) {
+        entry.second->setTitleColor(entry.first == sortBy ? Color3B::YELLOW : Color3B::WHITE);
+    }
+    if (_sortBy == sortBy) return;
+
+    _sortBy = sortBy;
+    if (ReplayManager::getInstance()->isIndexReady()) {
+        loadReplayList();
+    }
+}
+
 void ReplayListLayer::loadReplayList() {
-    auto replayList = ReplayManager::getInstance()->getReplayList();
+    // 只查询索引中的元数据，不读取回放文件
+    ReplayQuery query;
+    query.sortBy = _sortBy;
+    _replays = ReplayManager::getInstance()->queryReplays(query);
+
+    _contentNode->removeAllChildren();
+    _visibleCards.clear();
+    if (_emptyLabel) {
+        _emptyLabel->removeFromParent();
+        _emptyLabel = nullptr;
+    }
 
-    if (replayList.empty()) {
+    if (_replays.empty()) {
         // 空状态提示
-        auto emptyLabel = Label::createWithTTF(
+        _emptyLabel = Label::createWithTTF(
             "暂无战斗回放\n去打一场战斗吧！",
             FONT_PATH, 36
         );
-        emptyLabel->setPosition(_scrollView->getContentSize() / 2);
-        emptyLabel->setColor(Color3B::GRAY);
-        emptyLabel->setAlignment(TextHAlignment::CENTER);
-        _scrollView->addChild(emptyLabel);
+        _emptyLabel->setPosition(_scrollView->getContentSize() / 2);
+        _emptyLabel->setColor(Color3B::GRAY);
+        _emptyLabel->setAlignment(TextHAlignment::CENTER);
+        _scrollView->addChild(_emptyLabel);
         return;
     }
 
     // 计算总高度
-    float contentHeight = replayList.size() * (CARD_HEIGHT + CARD_SPACING);
+    float contentHeight = _replays.size() * (CARD_HEIGHT + CARD_SPACING);
     float scrollHeight = _scrollView->getContentSize().height;
 
     // 确保内容高度至少等于ScrollView高度
@@ -104,31 +178,55 @@ void ReplayListLayer::loadReplayList() {
     _scrollView->setInnerContainerSize(Size(_scrollView->getContentSize().width, totalHeight));
 
     CCLOG("ReplayListLayer: Content height = %.0f, ScrollView height = %.0f, Total height = %.0f for %zu replays",
-          contentHeight, scrollHeight, totalHeight, replayList.size());
+          contentHeight, scrollHeight, totalHeight, _replays.size());
 
+    // 强制滚动到顶部，并创建首屏卡片
+    _scrollView->jumpToTop();
+    refreshVisibleCards();
+}
+
+float ReplayListLayer::getRowY(int row) const {
     // 第一张卡片顶部对齐到内容区域顶部
-    float yPos = totalHeight - CARD_HEIGHT / 2;
+    return _contentNode->getContentSize().height - CARD_HEIGHT / 2 - row * (CARD_HEIGHT + CARD_SPACING);
+}
 
-    for (auto it = replayList.rbegin(); it != replayList.rend(); ++it) {
-        createReplayCard(*it, yPos);
-        yPos -= (CARD_HEIGHT + CARD_SPACING);
-    }
+void ReplayListLayer::refreshVisibleCards() {
+    if (_replays.empty()) return;
 
-    CCLOG("ReplayListLayer: Loaded %zu replay cards (newest at top)", replayList.size());
+    // 可见区域在内容坐标系中的上下边界
+    float rowStride = CARD_HEIGHT + CARD_SPACING;
+    float totalHeight = _contentNode->getContentSize().height;
+    float viewBottom = -_scrollView->getInnerContainerPosition().y;
+    float viewTop = viewBottom + _scrollView->getContentSize().height;
 
-    // 强制滚动到顶部
-    _scrollView->jumpToTop();
+    int lastRow = static_cast<int>(_replays.size()) - 1;
+    int firstVisible = std::max(0, static_cast<int>((totalHeight - viewTop) / rowStride) - 1);
+    int lastVisible = std::min(lastRow, static_cast<int>((totalHeight - viewBottom) / rowStride) + 1);
+
+    // 回收移出可见范围的卡片
+    for (auto it = _visibleCards.begin(); it != _visibleCards.end();) {
+        if (it->first < firstVisible || it->first > lastVisible) {
+            it->second->removeFromParent();
+            it = _visibleCards.erase(it);
+        } else {
+            ++it;
+        }
+    }
 
-    CCLOG("ReplayListLayer: ScrollView jumped to top");
+    for (int row = firstVisible; row <= lastVisible; ++row) {
+        if (_visibleCards.count(row) == 0) {
+            _visibleCards[row] = createReplayCard(_replays[row], getRowY(row));
+        }
+    }
 }
 
-void ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosition) {
+Node* ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosition) {
     // 获取滚动视图的宽度，卡片自动适配
     float scrollWidth = _scrollView->getContentSize().width;
     float cardWidth = scrollWidth - 20;
 
     // 卡片背景
-    auto cardBg = ui::Scale9Sprite::create("UI/replay/card_bg.png");
+    auto cardBg = AtlasManager::getInstance()->createScale9Sprite("UI/replay/card_bg.png");
     cardBg->setContentSize(Size(cardWidth, CARD_HEIGHT));
     cardBg->setPosition(Vec2(scrollWidth / 2, yPosition));
     _contentNode->addChild(cardBg);
@@ -146,7 +244,7 @@ void ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosi
             starIcon = "UI/battle/battle-prepare/victory_star_bg.png";
         }
 
-        auto star = Sprite::create(starIcon);
+        auto star = AtlasManager::getInstance()->createSprite(starIcon);
         star->setScale(0.3f);
         star->setPosition(Vec2(leftX + i * 40, topY));
         cardBg->addChild(star);
@@ -165,7 +263,7 @@ void ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosi
     float midX = 280;
 
     // 金币图标
-    auto goldIcon = Sprite::create("ImageElements/coin_icon.png");
+    auto goldIcon = AtlasManager::getInstance()->createSprite("ImageElements/coin_icon.png");
     goldIcon->setScale(0.5f);
     goldIcon->setPosition(Vec2(midX, topY));
     cardBg->addChild(goldIcon);
@@ -181,7 +279,7 @@ void ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosi
     cardBg->addChild(goldLabel);
 
     // 圣水图标
-    auto elixirIcon = Sprite::create("ImageElements/elixir_icon.png");
+    auto elixirIcon = AtlasManager::getInstance()->createSprite("ImageElements/elixir_icon.png");
     elixirIcon->setScale(0.5f);
     elixirIcon->setPosition(Vec2(midX + 140, topY));
     cardBg->addChild(elixirIcon);
@@ -197,7 +295,7 @@ void ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosi
     cardBg->addChild(elixirLabel);
 
     // 奖杯图标
-    auto trophyIcon = Sprite::create("ImageElements/trophy_icon.png");
+    auto trophyIcon = AtlasManager::getInstance()->createSprite("ImageElements/trophy_icon.png");
     trophyIcon->setScale(0.5f);
     trophyIcon->setPosition(Vec2(midX + 280, topY));
     cardBg->addChild(trophyIcon);
@@ -231,7 +329,7 @@ void ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosi
 
         // 兵种图标
         std::string iconPath = getTroopIconPath(troopId);
-        auto troopIcon = Sprite::create(iconPath);
+        auto troopIcon = AtlasManager::getInstance()->createSprite(iconPath);
         if (troopIcon) {
             troopIcon->setScale(0.4f);
             troopIcon->setPosition(Vec2(troopStartX + troopIndex * 80, troopY));
@@ -252,7 +350,7 @@ void ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosi
     }
 
     // 右侧：回放按钮
-    auto replayBtn = ui::Button::create("UI/replay/replay_btn.png");
+    auto replayBtn = AtlasManager::getInstance()->createButton("UI/replay/replay_btn.png");
     replayBtn->setScale(0.6f);
     replayBtn->setPosition(Vec2(cardWidth - 80, CARD_HEIGHT / 2));
     replayBtn->addClickEventListener([this, replay](Ref*) {
@@ -261,29 +359,40 @@ void ReplayListLayer::createReplayCard(const ReplayMetadata& replay, float yPosi
     cardBg->addChild(replayBtn);
 
     // 右上角：删除按钮
-    auto deleteBtn = ui::Button::create("UI/replay/close_btn.png");
+    auto deleteBtn = AtlasManager::getInstance()->createButton("UI/replay/close_btn.png");
     deleteBtn->setScale(0.4f);
     deleteBtn->setPosition(Vec2(cardWidth - 30, CARD_HEIGHT - 25));
     deleteBtn->addClickEventListener([this, replay](Ref*) {
         onDeleteClicked(replay.replayId);
     });
     cardBg->addChild(deleteBtn);
+
+    return cardBg;
 }
 
 void ReplayListLayer::onWatchClicked(int replayId) {
     CCLOG("ReplayListLayer: Watching replay #%d", replayId);
 
-    // 加载回放数据
-    auto replayData = ReplayManager::getInstance()->loadReplay(replayId);
+    if (_isLoadingReplay) return;
+    _isLoadingReplay = true;
 
-    if (replayData.troopEvents.empty()) {
-        CCLOG("ReplayListLayer: ERROR - Failed to load replay data");
-        return;
-    }
+    // 后台加载回放数据，加载期间保持本层存活
+    this->retain();
+    ReplayManager::getInstance()->loadReplayAsync(replayId,
+        [this](bool success, const BattleReplayData& replayData) {
+        _isLoadingReplay = false;
+
+        if (!success || replayData.troopEvents.empty() || !this->getParent()) {
+            CCLOG("ReplayListLayer: ERROR - Failed to load replay data");
+            this->release();
+            return;
+        }
 
-    // 创建回放场景
-    auto replayScene = BattleScene::createReplayScene(replayData);
-    Director::getInstance()->replaceScene(TransitionFade::create(0.5f, replayScene));
+        // 创建回放场景
+        auto replayScene = BattleScene::createReplayScene(replayData);
+        Director::getInstance()->replaceScene(TransitionFade::create(0.5f, replayScene));
+        this->release();
+    });
 }
 
 void ReplayListLayer::onDeleteClicked(int replayId) {
@@ -301,18 +410,17 @@ void ReplayListLayer::onDeleteClicked(int replayId) {
     confirmBg->addChild(confirmLabel);
 
     // 确认按钮
-    auto yesBtn = ui::Button::create("UI/common/btn_yes.png");
+    auto yesBtn = AtlasManager::getInstance()->createButton("UI/common/btn_yes.png");
     yesBtn->setPosition(Director::getInstance()->getVisibleSize() / 2 + Size(-100, -40));
     yesBtn->addClickEventListener([this, replayId, confirmBg](Ref*) {
         ReplayManager::getInstance()->deleteReplay(replayId);
         confirmBg->removeFromParent();
-        _contentNode->removeAllChildren();
         loadReplayList();
     });
     confirmBg->addChild(yesBtn);
 
     // 取消按钮
-    auto noBtn = ui::Button::create("UI/common/btn_no.png");
+    auto noBtn = AtlasManager::getInstance()->createButton("UI/common/btn_no.png");
     noBtn->setPosition(Director::getInstance()->getVisibleSize() / 2 + Size(100, -40));
     noBtn->addClickEventListener([confirmBg](Ref*) {
         confirmBg->removeFromParent();
@@ -6,10 +6,13 @@
 
 #include "cocos2d.h"
 #include "ui/CocosGUI.h"
+#include "Manager/ReplayManager.h"
 #include "Model/ReplayData.h"
+#include <map>
 #include <vector>
 #include <string>
 
+// 回放列表只为可见行（上下各多一行）创建卡片，滚动时回收，回放数量不影响打开速度
 class ReplayListLayer : public cocos2d::Layer {
 public:
     CREATE_FUNC(ReplayListLayer);
@@ -18,15 +21,26 @@ public:
 private:
     cocos2d::ui::ScrollView* _scrollView;
     cocos2d::Node* _contentNode;
+    cocos2d::Label* _emptyLabel = nullptr;
+    bool _isLoadingReplay = false;    // 回放正在后台加载，忽略重复点击
+
+    std::vector<ReplayMetadata> _replays;                       // 当前排序下的回放列表
+    std::map<int, cocos2d::Node*> _visibleCards;                // 行号 -> 已创建的卡片
+    ReplayQuery::SortBy _sortBy = ReplayQuery::SortBy::DATE;
+    std::vector<std::pair<ReplayQuery::SortBy, cocos2d::ui::Button*>> _sortButtons;
 
     // UI创建方法
+    void createSortButtons(cocos2d::Node* panel);
     void loadReplayList();
-    void createReplayCard(const ReplayMetadata& replay, float yPosition);
+    void refreshVisibleCards();                                 // 按滚动位置创建/回收卡片
+    float getRowY(int row) const;
+    cocos2d::Node* createReplayCard(const ReplayMetadata& replay, float yPosition);
 
     // 事件处理
     void onWatchClicked(int replayId);
     void onDeleteClicked(int replayId);
     void onCloseClicked();
+    void onSortClicked(ReplayQuery::SortBy sortBy);
 
     // 辅助方法
     std::string getTimeAgo(time_t timestamp);
@@ -5,6 +5,7 @@
 #pragma execution_character_set("utf-8")
 
 #include "Manager/VillageDataManager.h"
+#include "Manager/AtlasManager.h"
 #include "Layer/VillageLayer.h"
 #include "ShopLayer.h"
 #include "Manager/BuildingManager.h" 
@@ -288,7 +289,7 @@ void ShopLayer::addShopItem(const ShopItemData& data, int index) {
   }
 
   // 建筑图片
-  auto sprite = Sprite::create(data.imagePath);
+  auto sprite = AtlasManager::getInstance()->createSprite(data.imagePath);
   if (sprite) {
     float maxImgSize = 130;
     float scale = maxImgSize / std::max(sprite->getContentSize().width, sprite->getContentSize().height);
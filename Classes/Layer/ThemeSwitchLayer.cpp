@@ -3,6 +3,7 @@
 
 #pragma execution_character_set("utf-8")
 #include "Layer/ThemeSwitchLayer.h"
+#include "Manager/AtlasManager.h"
 #include "Manager/VillageDataManager.h"
 #include "Layer/VillageLayer.h"
 #include "Scene/VillageScene.h"
@@ -55,7 +56,7 @@ void ThemeSwitchLayer::initBackground() {
     float panelH = 500;
 
     // 尝试加载背景图片
-    auto panelBg = Sprite::create("UI/Village/change_bg_card.png");
+    auto panelBg = AtlasManager::getInstance()->createSprite("UI/Village/change_bg_card.png");
     if (panelBg) {
         panelBg->setAnchorPoint(Vec2(0.5f, 0.5f));
         panelBg->setPosition(Vec2(0, 0));
@@ -79,7 +80,7 @@ void ThemeSwitchLayer::initBackground() {
     }
 
     // 关闭按钮
-    auto closeBtn = Button::create("ImageElements/close_btn.png");
+    auto closeBtn = AtlasManager::getInstance()->createButton("ImageElements/close_btn.png");
     if (closeBtn) {
         closeBtn->setScale(0.8f);
         closeBtn->setPosition(Vec2(panelW / 2 - 40, panelH / 2 - 20));
@@ -318,7 +319,7 @@ void ThemeSwitchLayer::updateBottomButton() {
             // 可购买
             CCLOG("ThemeSwitchLayer: Loading purchase button image...");
 
-            auto purchaseBtn = Sprite::create("UI/Village/spend_100_gem_btn.png");
+            auto purchaseBtn = AtlasManager::getInstance()->createSprite("UI/Village/spend_100_gem_btn.png");
             if (purchaseBtn) {
                 purchaseBtn->setScale(1.0f);
                 purchaseBtn->setAnchorPoint(Vec2(0.5f, 0.5f));
@@ -369,7 +370,7 @@ void ThemeSwitchLayer::updateBottomButton() {
         // 已解锁
         CCLOG("ThemeSwitchLayer: Theme is purchased, showing check icon");
 
-        auto checkIcon = Sprite::create("ImageElements/right.png");
+        auto checkIcon = AtlasManager::getInstance()->createSprite("ImageElements/right.png");
         if (checkIcon) {
             checkIcon->setScale(0.5f);
             checkIcon->setAnchorPoint(Vec2(0.5f, 0.5f));
@@ -3,6 +3,7 @@
 
 #pragma execution_character_set("utf-8")
 #include "TrainingLayer.h"
+#include "Manager/AtlasManager.h"
 #include "Model/TroopConfig.h"
 #include "Manager/VillageDataManager.h"
 #include "Manager/BuildingManager.h"
@@ -222,7 +223,7 @@ Widget* TrainingLayer::createArmyUnitCell(int troopId, int count) {
     widget->addChild(bg);
 
     // 兵种头像
-    auto sprite = Sprite::create(config.iconPath);
+    auto sprite = AtlasManager::getInstance()->createSprite(config.iconPath);
     if (sprite) {
         float scale = (cellSize - 10) / sprite->getContentSize().width;
         sprite->setScale(scale);
@@ -400,7 +401,7 @@ Widget* TrainingLayer::createTroopCard(const TroopInfo& info, bool isUnlocked) {
     widget->addChild(bg);
 
     // 兵种头像
-    auto sprite = Sprite::create(info.iconPath);
+    auto sprite = AtlasManager::getInstance()->createSprite(info.iconPath);
     if (sprite) {
         float scale = (CARD_WIDTH - 10) / sprite->getContentSize().width;
         sprite->setScale(scale);
@@ -435,7 +436,7 @@ Widget* TrainingLayer::createTroopCard(const TroopInfo& info, bool isUnlocked) {
     spaceBg->addChild(spaceLabel);
 
     // 右上角：信息按钮
-    auto infoBtn = Button::create("UI/training-camp/troop-cards/info_btn.png");
+    auto infoBtn = AtlasManager::getInstance()->createButton("UI/training-camp/troop-cards/info_btn.png");
     if (infoBtn) {
         infoBtn->setPosition(Vec2(CARD_WIDTH - 15, CARD_HEIGHT - 15));
         infoBtn->setScale(0.1f);
@@ -556,7 +557,7 @@ void TrainingLayer::onInfoClicked(int troopId) {
     bg->addChild(closeBtn);
 
     // 左侧：兵种大图
-    auto sprite = Sprite::create(info.iconPath);
+    auto sprite = AtlasManager::getInstance()->createSprite(info.iconPath);
     if (sprite) {
         sprite->setScale(1.5f);
         sprite->setPosition(popupW * 0.25f, popupH * 0.55f);
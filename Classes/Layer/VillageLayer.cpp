@@ -9,6 +9,7 @@
 #include "Manager/BuildingManager.h"
 #include "Manager/VillageDataManager.h"
 #include "Sprite/BattleUnitSprite.h"
+#include "Sprite/TiledMapBackground.h"
 #include "Sprite/BuildingSprite.h"   
 #include "Model/BuildingConfig.h"      
 #include "ui/CocosGUI.h"
@@ -27,7 +28,7 @@ bool VillageLayer::init() {
   if (!_mapSprite) {
     return false;
   }
-  this->addChild(_mapSprite);
+  this->addChild(_mapSprite, -1);
 
   // 初始化基本属性
   initializeBasicProperties();
@@ -209,8 +210,8 @@ void VillageLayer::initializeBasicProperties() {
   CCLOG("  Map size: %.0fx%.0f", mapSize.width, mapSize.height);
 }
 
-Sprite* VillageLayer::createMapSprite() {
-  auto mapSprite = Sprite::create("Scene/Map_Crossover.png");
+TiledMapBackground* VillageLayer::createMapSprite() {
+  auto mapSprite = TiledMapBackground::create("Scene/Map_Crossover.png");
   if (!mapSprite) {
     CCLOG("Error: Failed to load map image");
     return nullptr;
@@ -449,7 +450,7 @@ void VillageLayer::switchMapBackground(int themeId) {
         cocos2d::Vec2 oldPos = _mapSprite->getPosition();
         _mapSprite->removeFromParent();
 
-        _mapSprite = cocos2d::Sprite::create(mapPath);
+        _mapSprite = TiledMapBackground::create(mapPath);
         if (_mapSprite) {
             _mapSprite->setAnchorPoint(cocos2d::Vec2::ANCHOR_BOTTOM_LEFT);
             _mapSprite->setPosition(oldPos);
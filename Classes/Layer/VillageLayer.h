@@ -3,14 +3,16 @@
 
 #pragma once
 #include "cocos2d.h"
+#include "IsoDepthLayer.h"
 #include "../Model/VillageData.h"
 
 class BuildingManager;
 class MoveMapController;
 class MoveBuildingController;
 class BuildingSprite;
+class TiledMapBackground;
 
-class VillageLayer : public cocos2d::Layer {
+class VillageLayer : public IsoDepthLayer {
 public:
     virtual bool init();
     virtual void cleanup() override;
@@ -29,13 +31,13 @@ public:
     int getSelectedBuildingId() const;
 
 private:
-    cocos2d::Sprite* createMapSprite();
+    TiledMapBackground* createMapSprite();
     void initializeBasicProperties();
     void setupInputCallbacks();
     BuildingSprite* getBuildingAtScreenPos(const cocos2d::Vec2& screenPos);
 
 private:
-    cocos2d::Sprite* _mapSprite;
+    TiledMapBackground* _mapSprite;
     BuildingManager* _buildingManager;
     MoveMapController* _inputController;
     MoveBuildingController* _moveBuildingController;
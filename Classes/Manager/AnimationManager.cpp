@@ -2,16 +2,37 @@
 // 动画管理器实现，负责加载和创建战斗单位的动画
 
 #include "AnimationManager.h"
+#include <algorithm>
+#include <cmath>
 
 USING_NS_CC;
 
 AnimationManager* AnimationManager::_instance = nullptr;
 
+static const char* LOOP_CLOCK_KEY = "AnimationManager.loopClocks";
+
 AnimationManager::AnimationManager() {
+    // 未单独配置的兵种：正常缩放全帧，缩小后隔帧
+    _defaultLOD = { { 0.6f, 1 }, { 0.45f, 2 }, { 0.0f, 3 } };
+
+    // 共享时钟随场景时间推进（与动作一样受时间缩放和暂停影响）
+    Director::getInstance()->getScheduler()->schedule(
+        [this](float dt) { updateLoopClocks(dt); }, this, 0.0f, false, LOOP_CLOCK_KEY);
+
     CCLOG("AnimationManager: Initialized");
 }
 
 AnimationManager::~AnimationManager() {
+    Director::getInstance()->getScheduler()->unschedule(LOOP_CLOCK_KEY, this);
+    for (auto& pair : _loopClocks) {
+        CC_SAFE_RELEASE(pair.second.animation);
+    }
+    _loopClocks.clear();
+    _loopSlots.clear();
+    for (int key = 0; key < static_cast<int>(_animations.size()); ++key) {
+        releaseCachedAnimation(key);
+    }
+
     for (const auto& plist : _loadedPlists) {
         SpriteFrameCache::getInstance()->removeSpriteFramesFromFile(plist);
     }
@@ -67,6 +88,20 @@ void AnimationManager::preloadBattleAnimations() {
 
 void AnimationManager::unloadSpriteFrames(const std::string& plistFile) {
     SpriteFrameCache::getInstance()->removeSpriteFramesFromFile(plistFile);
+
+    // 缓存的动画持有精灵帧，一并丢弃（仍有单位在播放的循环动画由时钟持有，保留到单位停止）
+    for (auto it = _loopClocks.begin(); it != _loopClocks.end();) {
+        if (it->second.entries.empty()) {
+            CC_SAFE_RELEASE(it->second.animation);
+            it = _loopClocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (int key = 0; key < static_cast<int>(_animations.size()); ++key) {
+        releaseCachedAnimation(key);
+    }
+
     auto it = std::find(_loadedPlists.begin(), _loadedPlists.end(), plistFile);
     if (it != _loadedPlists.end()) {
         _loadedPlists.erase(it);
@@ -74,9 +109,24 @@ void AnimationManager::unloadSpriteFrames(const std::string& plistFile) {
     }
 }
 
-Animation* AnimationManager::createAnimation(const std::string& unitType, AnimationType animType) {
-    std::string key = getConfigKey(unitType, animType);
-    auto it = _animConfigs.find(key);
+// ========== 动画缓存 ==========
+
+int AnimationManager::getUnitAnimationId(const std::string& unitType) {
+    auto it = _unitIds.find(unitType);
+    if (it != _unitIds.end()) {
+        return it->second;
+    }
+
+    int unitId = static_cast<int>(_unitNames.size());
+    _unitIds[unitType] = unitId;
+    _unitNames.push_back(unitType);
+    _lodLevels.emplace_back();
+    return unitId;
+}
+
+Animation* AnimationManager::buildAnimation(int unitId, AnimationType animType) const {
+    std::string key = getConfigKey(unitId, animType);
+    auto it = _animConfigs.find(animationKey(unitId, animType));
 
     if (it == _animConfigs.end()) {
         CCLOG("AnimationManager: Config not found for %s", key.c_str());
@@ -92,8 +142,6 @@ Animation* AnimationManager::createAnimation(const std::string& unitType, Animat
     // 支持两种模式
     if (config.isNonContinuous()) {
         // 模式2: 非连续帧
-        CCLOG("AnimationManager: Creating animation '%s' with non-continuous frames", key.c_str());
-
         for (int frameIndex : config.frameIndices) {
             std::string frameName = config.framePrefix + StringUtils::format("%d.0.png", frameIndex);
             SpriteFrame* frame = cache->getSpriteFrameByName(frameName);
@@ -105,7 +153,7 @@ Animation* AnimationManager::createAnimation(const std::string& unitType, Animat
             }
         }
 
-        CCLOG("AnimationManager: Loaded %d non-continuous frames", (int)frames.size());
+        CCLOG("AnimationManager: Built animation '%s' with %d non-continuous frames", key.c_str(), (int)frames.size());
     } else {
         // 模式1: 连续帧
         for (int i = 0; i < config.frameCount; ++i) {
@@ -121,7 +169,7 @@ Animation* AnimationManager::createAnimation(const std::string& unitType, Animat
             }
         }
 
-        CCLOG("AnimationManager: Created animation '%s' with %d frames (frames %d-%d)",
+        CCLOG("AnimationManager: Built animation '%s' with %d frames (frames %d-%d)",
               key.c_str(), (int)frames.size(), config.startFrame, config.startFrame + config.frameCount - 1);
     }
 
@@ -130,40 +178,268 @@ Animation* AnimationManager::createAnimation(const std::string& unitType, Animat
         return nullptr;
     }
 
-    Animation* animation = Animation::createWithSpriteFrames(frames, config.frameDelay);
-    return animation;
+    return Animation::createWithSpriteFrames(frames, config.frameDelay);
 }
 
-RepeatForever* AnimationManager::createLoopAnimate(const std::string& unitType, AnimationType animType) {
-    Animation* animation = createAnimation(unitType, animType);
+Animation* AnimationManager::getAnimation(int unitId, AnimationType animType, int frameStep) {
+    if (unitId < 0) return nullptr;
+
+    int key = animationKey(unitId, animType);
+    if (key >= static_cast<int>(_animations.size())) {
+        _animations.resize(key + 1);
+    }
+
+    CachedAnimation& cached = _animations[key];
+    if (!cached.built) {
+        // 找不到配置或帧时也记为已构建，避免每次调用都重新查找
+        cached.built = true;
+        cached.byStep[0] = buildAnimation(unitId, animType);
+        CC_SAFE_RETAIN(cached.byStep[0]);
+    }
+
+    Animation* full = cached.byStep[0];
+    if (!full) return nullptr;
+
+    frameStep = std::max(1, std::min(frameStep, static_cast<int>(MAX_FRAME_STEP)));
+    Animation*& decimated = cached.byStep[frameStep - 1];
+    if (!decimated) {
+        decimated = decimateAnimation(full, frameStep);
+        decimated->retain();
+    }
+    return decimated;
+}
+
+void AnimationManager::releaseCachedAnimation(int key) {
+    if (key >= static_cast<int>(_animations.size())) return;
+
+    CachedAnimation& cached = _animations[key];
+    for (auto& animation : cached.byStep) {
+        CC_SAFE_RELEASE_NULL(animation);
+    }
+    cached.built = false;
+}
+
+void AnimationManager::preloadAnimationCache() {
+    int count = 0;
+    for (const auto& pair : _animConfigs) {
+        int unitId = pair.first / ANIMATION_TYPE_COUNT;
+        auto animType = static_cast<AnimationType>(pair.first % ANIMATION_TYPE_COUNT);
+        if (getAnimation(unitId, animType)) {
+            ++count;
+        }
+    }
+    CCLOG("AnimationManager: Animation cache built (%d animations)", count);
+}
+
+Animation* AnimationManager::createAnimation(const std::string& unitType, AnimationType animType) {
+    return getAnimation(getUnitAnimationId(unitType), animType);
+}
+
+RepeatForever* AnimationManager::createLoopAnimate(int unitId, AnimationType animType) {
+    Animation* animation = getAnimation(unitId, animType, getFrameStep(unitId));
     if (!animation) {
-        CCLOG("AnimationManager: Failed to create loop animation for %s_%s",
-              unitType.c_str(), animTypeToString(animType).c_str());
+        CCLOG("AnimationManager: Failed to create loop animation for %s", getConfigKey(unitId, animType).c_str());
         return nullptr;
     }
 
-    Animate* animate = Animate::create(animation);
-    return RepeatForever::create(animate);
+    return RepeatForever::create(Animate::create(animation));
 }
 
-Animate* AnimationManager::createOnceAnimate(const std::string& unitType, AnimationType animType) {
-    Animation* animation = createAnimation(unitType, animType);
+Animate* AnimationManager::createOnceAnimate(int unitId, AnimationType animType) {
+    Animation* animation = getAnimation(unitId, animType, getFrameStep(unitId));
     if (!animation) {
-        CCLOG("AnimationManager: Failed to create once animation for %s_%s",
-              unitType.c_str(), animTypeToString(animType).c_str());
+        CCLOG("AnimationManager: Failed to create once animation for %s", getConfigKey(unitId, animType).c_str());
         return nullptr;
     }
 
     return Animate::create(animation);
 }
 
+RepeatForever* AnimationManager::createLoopAnimate(const std::string& unitType, AnimationType animType) {
+    return createLoopAnimate(getUnitAnimationId(unitType), animType);
+}
+
+Animate* AnimationManager::createOnceAnimate(const std::string& unitType, AnimationType animType) {
+    return createOnceAnimate(getUnitAnimationId(unitType), animType);
+}
+
+Animation* AnimationManager::decimateAnimation(Animation* animation, int frameStep) {
+    const auto& frames = animation->getFrames();
+    int frameCount = static_cast<int>(frames.size());
+    if (frameStep <= 1 || frameCount <= 1) {
+        return animation;
+    }
+
+    // 保留每组的第一帧，时长取整组之和
+    Vector<AnimationFrame*> kept;
+    for (int i = 0; i < frameCount; i += frameStep) {
+        float delayUnits = 0.0f;
+        for (int j = i; j < std::min(i + frameStep, frameCount); ++j) {
+            delayUnits += frames.at(j)->getDelayUnits();
+        }
+        kept.pushBack(AnimationFrame::create(frames.at(i)->getSpriteFrame(), delayUnits, frames.at(i)->getUserInfo()));
+    }
+
+    return Animation::create(kept, animation->getDelayPerUnit(), animation->getLoops());
+}
+
+// ========== 循环动画共享时钟 ==========
+
+bool AnimationManager::playLoop(Sprite* sprite, int unitId, AnimationType animType) {
+    stopLoop(sprite);
+
+    int key = animationKey(unitId, animType);
+    auto it = _loopClocks.find(key);
+    if (it == _loopClocks.end()) {
+        Animation* animation = getAnimation(unitId, animType);
+        if (!animation) {
+            CCLOG("AnimationManager: Failed to create loop animation for %s", getConfigKey(unitId, animType).c_str());
+            return false;
+        }
+
+        LoopClock& clock = _loopClocks[key];
+        clock.unitId = unitId;
+        clock.animation = animation;
+        clock.animation->retain();
+        clock.frameStep = getFrameStep(unitId);
+        it = _loopClocks.find(key);
+    }
+
+    LoopClock& clock = it->second;
+    _loopSlots[sprite] = { &clock, static_cast<int>(clock.entries.size()) };
+    clock.entries.push_back({ sprite, false });
+
+    // 直接显示时钟当前帧，与同状态的单位保持一致
+    if (clock.shownFrame < 0) {
+        clock.shownFrame = currentClockFrame(clock);
+    }
+    applyClockFrame(clock, sprite);
+    return true;
+}
+
+bool AnimationManager::playLoop(Sprite* sprite, const std::string& unitType, AnimationType animType) {
+    return playLoop(sprite, getUnitAnimationId(unitType), animType);
+}
+
+void AnimationManager::stopLoop(Sprite* sprite) {
+    auto it = _loopSlots.find(sprite);
+    if (it == _loopSlots.end()) return;
+
+    // 与末尾交换后删除
+    auto& entries = it->second.clock->entries;
+    int index = it->second.index;
+    int last = static_cast<int>(entries.size()) - 1;
+    if (index != last) {
+        entries[index] = entries[last];
+        _loopSlots[entries[index].sprite].index = index;
+    }
+    entries.pop_back();
+    _loopSlots.erase(sprite);
+}
+
+void AnimationManager::setLoopFrozen(Sprite* sprite, bool frozen) {
+    auto it = _loopSlots.find(sprite);
+    if (it == _loopSlots.end()) return;
+
+    LoopClock& clock = *it->second.clock;
+    clock.entries[it->second.index].frozen = frozen;
+
+    // 解冻时立即跟上时钟
+    if (!frozen) {
+        applyClockFrame(clock, sprite);
+    }
+}
+
+int AnimationManager::currentClockFrame(const LoopClock& clock) const {
+    int frameCount = static_cast<int>(clock.animation->getFrames().size());
+    float delay = clock.animation->getDelayPerUnit();
+    if (frameCount <= 1 || delay <= 0.0f) return 0;
+
+    int frame = static_cast<int>(clock.elapsed / delay) % frameCount;
+    return frame - frame % clock.frameStep;
+}
+
+void AnimationManager::applyClockFrame(LoopClock& clock, Sprite* sprite) {
+    if (clock.shownFrame < 0) return;
+    sprite->setSpriteFrame(clock.animation->getFrames().at(clock.shownFrame)->getSpriteFrame());
+}
+
+void AnimationManager::updateLoopClocks(float dt) {
+    for (auto& pair : _loopClocks) {
+        LoopClock& clock = pair.second;
+        if (clock.entries.empty()) continue;
+
+        float period = clock.animation->getDuration();
+        clock.elapsed += dt;
+        if (period > 0.0f && clock.elapsed >= period) {
+            clock.elapsed = std::fmod(clock.elapsed, period);
+        }
+
+        int frame = currentClockFrame(clock);
+        if (frame == clock.shownFrame) continue;
+
+        clock.shownFrame = frame;
+        for (const auto& entry : clock.entries) {
+            if (!entry.frozen) {
+                applyClockFrame(clock, entry.sprite);
+            }
+        }
+    }
+}
+
+// ========== 动画 LOD ==========
+
+void AnimationManager::registerAnimationLOD(const std::string& unitType, const std::vector<AnimationLOD>& levels) {
+    int unitId = getUnitAnimationId(unitType);
+
+    auto sorted = levels;
+    std::sort(sorted.begin(), sorted.end(), [](const AnimationLOD& a, const AnimationLOD& b) {
+        return a.minScale > b.minScale;
+    });
+    _lodLevels[unitId] = sorted;
+
+    for (auto& pair : _loopClocks) {
+        if (pair.second.unitId == unitId) {
+            pair.second.frameStep = getFrameStep(unitId);
+        }
+    }
+}
+
+void AnimationManager::setDisplayScale(float scale) {
+    if (scale == _displayScale) return;
+    _displayScale = scale;
+
+    // 下一次推进时钟时按新步长对齐帧
+    for (auto& pair : _loopClocks) {
+        pair.second.frameStep = getFrameStep(pair.second.unitId);
+    }
+}
+
+int AnimationManager::getFrameStep(int unitId) const {
+    bool configured = unitId >= 0 && unitId < static_cast<int>(_lodLevels.size()) && !_lodLevels[unitId].empty();
+    const auto& levels = configured ? _lodLevels[unitId] : _defaultLOD;
+    if (levels.empty()) return 1;
+
+    for (const auto& level : levels) {
+        if (_displayScale >= level.minScale) {
+            return std::max(1, level.frameStep);
+        }
+    }
+    return std::max(1, levels.back().frameStep);
+}
+
 void AnimationManager::registerAnimationConfig(
     const std::string& unitType,
     AnimationType animType,
     const AnimationConfig& config
 ) {
-    std::string key = getConfigKey(unitType, animType);
-    _animConfigs[key] = config;
+    int unitId = getUnitAnimationId(unitType);
+    int animKey = animationKey(unitId, animType);
+    _animConfigs[animKey] = config;
+
+    // 重新注册时丢弃旧的缓存，下次使用时按新配置构建
+    releaseCachedAnimation(animKey);
+    std::string key = getConfigKey(unitId, animType);
 
     if (config.isNonContinuous()) {
         CCLOG("AnimationManager: Registered config: %s (non-continuous frames: %zu frames)",
@@ -382,10 +658,16 @@ void AnimationManager::initializeDefaultConfigs() {
         "wall_breaker", 49, 8, 0.08f, false
     });
 
+    // 动画 LOD：巨人体型大、帧间隔长，缩小后仍较醒目；哥布林和炸弹兵帧率高、体型小，更早降帧
+    registerAnimationLOD("Giant", { { 0.5f, 1 }, { 0.0f, 2 } });
+    registerAnimationLOD("Goblin", { { 0.7f, 1 }, { 0.5f, 2 }, { 0.0f, 4 } });
+    registerAnimationLOD("Wall_Breaker", { { 0.7f, 1 }, { 0.5f, 2 }, { 0.0f, 4 } });
+
     CCLOG("AnimationManager: Default configs initialized (including Wall_Breaker)");
 }
 
-std::string AnimationManager::getConfigKey(const std::string& unitType, AnimationType animType) const {
+std::string AnimationManager::getConfigKey(int unitId, AnimationType animType) const {
+    const std::string& unitType = (unitId >= 0 && unitId < static_cast<int>(_unitNames.size())) ? _unitNames[unitId] : "";
     return unitType + "_" + animTypeToString(animType);
 }
 
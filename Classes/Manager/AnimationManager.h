@@ -7,6 +7,7 @@
 #include "cocos2d.h"
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 USING_NS_CC;
 
@@ -69,22 +70,55 @@ struct AnimationConfig {
   }
 };
 
+// 动画 LOD 级别
+// 地图缩放不低于 minScale 时使用该级别：每 frameStep 帧只显示一帧，被跳过的帧时长并入前一帧，
+// 动画总时长不变（一次性动画的回调时机不受缩放影响）
+struct AnimationLOD {
+  float minScale;
+  int frameStep;
+};
+
 // 动画管理器（单例）
+// 每个（兵种, 动画类型）的 Animation 在预加载或首次使用时构建一次并常驻，以整数键索引；
+// 战斗中创建动作只是用缓存的 Animation 生成新的 Animate，不再格式化帧名或查询 SpriteFrameCache
 class AnimationManager {
 public:
   static AnimationManager* getInstance();
   static void destroyInstance();
 
+  static const int ANIMATION_TYPE_COUNT = static_cast<int>(AnimationType::HURT) + 1;
+  static const int MAX_FRAME_STEP = 8;
+
   // 资源加载
   void loadSpriteFrames(const std::string& plistFile);
   void preloadBattleAnimations();
   void unloadSpriteFrames(const std::string& plistFile);
 
-  // 动画创建
+  // 兵种动画ID：单位初始化时查询一次并保存，之后的动画调用都用整数ID
+  int getUnitAnimationId(const std::string& unitType);
+
+  // 动画获取（返回缓存的共享实例，调用方不得修改；frameStep 为 LOD 抽帧步长）
+  Animation* getAnimation(int unitId, AnimationType animType, int frameStep = 1);
   Animation* createAnimation(const std::string& unitType, AnimationType animType);
+
+  // 动作创建（按当前 LOD 抽帧）
+  RepeatForever* createLoopAnimate(int unitId, AnimationType animType);
+  Animate* createOnceAnimate(int unitId, AnimationType animType);
   RepeatForever* createLoopAnimate(const std::string& unitType, AnimationType animType);
   Animate* createOnceAnimate(const std::string& unitType, AnimationType animType);
 
+  // 循环动画（共享时钟）
+  // 同兵种同动作的单位共用一个时钟，由管理器统一推进并同步换帧，单位自身不运行帧动画 Action
+  bool playLoop(Sprite* sprite, int unitId, AnimationType animType);
+  bool playLoop(Sprite* sprite, const std::string& unitType, AnimationType animType);
+  void stopLoop(Sprite* sprite);
+  void setLoopFrozen(Sprite* sprite, bool frozen);   // 冻结后不再换帧（如离开视口的单位）
+
+  // 动画 LOD：按兵种配置缩放阈值，地图缩放变化时由 MoveMapController 通知
+  void registerAnimationLOD(const std::string& unitType, const std::vector<AnimationLOD>& levels);
+  void setDisplayScale(float scale);
+  int getFrameStep(int unitId) const;
+
   // 配置管理
   void registerAnimationConfig(
     const std::string& unitType,
@@ -94,6 +128,9 @@ public:
 
   void initializeDefaultConfigs();
 
+  // 构建所有已注册配置的动画（精灵帧加载之后调用）
+  void preloadAnimationCache();
+
   // 辅助方法
   std::string animTypeToString(AnimationType type) const;
 
@@ -103,13 +140,68 @@ private:
 
   static AnimationManager* _instance;
 
-  // 动画配置缓存: <"Barbarian_WALK", AnimationConfig>
-  std::unordered_map<std::string, AnimationConfig> _animConfigs;
+  // 兵种名 <-> 整数ID
+  std::unordered_map<std::string, int> _unitIds;
+  std::vector<std::string> _unitNames;
+
+  // 动画配置: <animationKey, AnimationConfig>
+  std::unordered_map<int, AnimationConfig> _animConfigs;
+
+  // 已构建的动画，下标为 animationKey；byStep[i] 为步长 i+1 的抽帧版本（持有引用）
+  struct CachedAnimation {
+    bool built = false;
+    Animation* byStep[MAX_FRAME_STEP] = {};
+  };
+  std::vector<CachedAnimation> _animations;
 
   // 已加载的 .plist 文件列表
   std::vector<std::string> _loadedPlists;
 
-  std::string getConfigKey(const std::string& unitType, AnimationType animType) const;
+  // 共享时钟上的一个单位
+  struct LoopEntry {
+    Sprite* sprite;
+    bool frozen;
+  };
+
+  // 循环动画共享时钟: <animationKey, LoopClock>
+  struct LoopClock {
+    int unitId = -1;
+    Animation* animation = nullptr;   // 缓存中的全帧动画（时钟另持有引用）
+    float elapsed = 0.0f;
+    int frameStep = 1;
+    int shownFrame = -1;              // 当前显示的帧下标（已按 LOD 对齐）
+    std::vector<LoopEntry> entries;
+  };
+
+  // 单位所在的时钟和下标
+  struct LoopSlot {
+    LoopClock* clock;
+    int index;
+  };
+
+  std::unordered_map<int, LoopClock> _loopClocks;
+  std::unordered_map<Sprite*, LoopSlot> _loopSlots;
+
+  // 每个兵种的 LOD 级别（按 minScale 从大到小），下标为兵种ID
+  std::vector<std::vector<AnimationLOD>> _lodLevels;
+  std::vector<AnimationLOD> _defaultLOD;
+  float _displayScale = 1.0f;
+
+  static int animationKey(int unitId, AnimationType animType) {
+    return unitId * ANIMATION_TYPE_COUNT + static_cast<int>(animType);
+  }
+  std::string getConfigKey(int unitId, AnimationType animType) const;
+
+  // 按配置格式化帧名并从 SpriteFrameCache 取帧（只在构建缓存时调用）
+  Animation* buildAnimation(int unitId, AnimationType animType) const;
+  void releaseCachedAnimation(int key);
+
+  void updateLoopClocks(float dt);
+  int currentClockFrame(const LoopClock& clock) const;
+  static void applyClockFrame(LoopClock& clock, Sprite* sprite);
+
+  // 按 LOD 抽帧，保持每帧时长之和不变
+  static Animation* decimateAnimation(Animation* animation, int frameStep);
 };
 
 #endif // __ANIMATION_MANAGER_H__
@@ -0,0 +1,113 @@
+﻿// AtlasManager.cpp
+// 图集管理器实现，加载图集清单并按路径解析图集帧
+
+#include "AtlasManager.h"
+
+USING_NS_CC;
+
+namespace {
+    const char* ATLAS_MANIFEST = "atlas/atlases.plist";
+}
+
+AtlasManager* AtlasManager::_instance = nullptr;
+
+AtlasManager* AtlasManager::getInstance() {
+    if (!_instance) {
+        _instance = new AtlasManager();
+    }
+    return _instance;
+}
+
+void AtlasManager::destroyInstance() {
+    if (_instance) {
+        delete _instance;
+        _instance = nullptr;
+    }
+}
+
+void AtlasManager::loadAtlases() {
+    if (_loaded) return;
+    _loaded = true;
+
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(ATLAS_MANIFEST)) {
+        CCLOG("AtlasManager: No atlas manifest, using loose images");
+        return;
+    }
+
+    ValueMap manifest = fileUtils->getValueMapFromFile(ATLAS_MANIFEST);
+    auto atlasesIt = manifest.find("atlases");
+    if (atlasesIt == manifest.end() || atlasesIt->second.getType() != Value::Type::VECTOR) {
+        CCLOG("AtlasManager: WARNING - Invalid atlas manifest");
+        return;
+    }
+
+    auto frameCache = SpriteFrameCache::getInstance();
+    for (const auto& entry : atlasesIt->second.asValueVector()) {
+        const std::string plist = entry.asString();
+
+        ValueMap dict = fileUtils->getValueMapFromFile(plist);
+        auto framesIt = dict.find("frames");
+        if (framesIt == dict.end() || framesIt->second.getType() != Value::Type::MAP) {
+            CCLOG("AtlasManager: WARNING - Skipped invalid atlas %s", plist.c_str());
+            continue;
+        }
+
+        frameCache->addSpriteFramesWithFile(plist);
+        for (const auto& frame : framesIt->second.asValueMap()) {
+            _frameNames.insert(frame.first);
+        }
+        _atlasCount++;
+    }
+
+    CCLOG("AtlasManager: Loaded %d atlas pages with %zu frames", _atlasCount, _frameNames.size());
+}
+
+bool AtlasManager::hasFrame(const std::string& path) const {
+    return _frameNames.count(path) > 0;
+}
+
+SpriteFrame* AtlasManager::getFrame(const std::string& path) const {
+    // 先查自己的帧名表，避免未打包的路径在 SpriteFrameCache 中查找时输出警告
+    if (!hasFrame(path)) return nullptr;
+    return SpriteFrameCache::getInstance()->getSpriteFrameByName(path);
+}
+
+Sprite* AtlasManager::createSprite(const std::string& path) const {
+    auto frame = getFrame(path);
+    return frame ? Sprite::createWithSpriteFrame(frame) : Sprite::create(path);
+}
+
+bool AtlasManager::setSpriteImage(Sprite* sprite, const std::string& path) const {
+    if (!sprite) return false;
+
+    auto frame = getFrame(path);
+    if (frame) {
+        sprite->setSpriteFrame(frame);
+        return true;
+    }
+
+    auto texture = Director::getInstance()->getTextureCache()->addImage(path);
+    if (!texture) return false;
+
+    sprite->setTexture(texture);
+    sprite->setTextureRect(Rect(Vec2::ZERO, texture->getContentSize()));
+    return true;
+}
+
+ui::Scale9Sprite* AtlasManager::createScale9Sprite(const std::string& path) const {
+    auto frame = getFrame(path);
+    return frame ? ui::Scale9Sprite::createWithSpriteFrame(frame) : ui::Scale9Sprite::create(path);
+}
+
+ui::Button* AtlasManager::createButton(const std::string& normalImage) const {
+    return ui::Button::create(normalImage, "", "", getResType(normalImage));
+}
+
+ui::Widget::TextureResType AtlasManager::getResType(const std::string& path) const {
+    // 控件按帧名从 SpriteFrameCache 取帧，帧被清理时只能回退散图
+    if (hasFrame(path) && SpriteFrameCache::getInstance()->getSpriteFrameByName(path)) {
+        return ui::Widget::TextureResType::PLIST;
+    }
+    return ui::Widget::TextureResType::LOCAL;
+}
@@ -0,0 +1,62 @@
+﻿// AtlasManager.h
+// 图集管理器头文件，把逻辑图片路径解析为构建时打包的图集帧，找不到时回退为散图
+
+#pragma once
+
+#include "cocos2d.h"
+#include "ui/CocosGUI.h"
+#include <string>
+#include <unordered_set>
+
+USING_NS_CC;
+
+// 图集管理器
+// 职责：
+// 1. 启动时加载 atlas/atlases.plist 列出的所有图集页（由构建步骤 AtlasPacker 生成）
+// 2. 帧名即资源相对路径，调用方继续使用原来的图片路径
+// 3. 图集不存在（移动平台、未打包）或帧被清理时，自动回退为按路径加载散图
+// 同一图集页中的精灵共用一张纹理，渲染器可以自动合批
+class AtlasManager {
+public:
+    static AtlasManager* getInstance();
+    static void destroyInstance();
+
+    // 加载图集清单，重复调用无副作用
+    void loadAtlases();
+
+    // 路径是否已打包进图集
+    bool hasFrame(const std::string& path) const;
+
+    // 获取图集帧，未打包或已被清理时返回 nullptr
+    SpriteFrame* getFrame(const std::string& path) const;
+
+    // 创建精灵（优先图集帧）
+    Sprite* createSprite(const std::string& path) const;
+
+    // 替换精灵图片（优先图集帧），失败返回 false
+    bool setSpriteImage(Sprite* sprite, const std::string& path) const;
+
+    // 创建九宫格精灵（优先图集帧）
+    ui::Scale9Sprite* createScale9Sprite(const std::string& path) const;
+
+    // 创建按钮（优先图集帧）
+    ui::Button* createButton(const std::string& normalImage) const;
+
+    // 控件加载纹理时使用的资源类型
+    ui::Widget::TextureResType getResType(const std::string& path) const;
+
+    int getAtlasCount() const { return _atlasCount; }
+
+private:
+    AtlasManager() = default;
+    ~AtlasManager() = default;
+
+    AtlasManager(const AtlasManager&) = delete;
+    AtlasManager& operator=(const AtlasManager&) = delete;
+
+    static AtlasManager* _instance;
+
+    std::unordered_set<std::string> _frameNames;   // 所有图集帧名（资源相对路径）
+    bool _loaded = false;
+    int _atlasCount = 0;
+};
@@ -0,0 +1,177 @@
+﻿// BattleEffectPool.cpp
+// 战斗特效对象池实现，节点的预分配、回收和超限淘汰
+
+#include "BattleEffectPool.h"
+
+USING_NS_CC;
+
+BattleEffectPool* BattleEffectPool::_instance = nullptr;
+
+BattleEffectPool::BattleEffectPool() {
+    _pools[static_cast<int>(EffectType::EXPLOSION)].capacity = 24;
+    _pools[static_cast<int>(EffectType::EXPLOSION)].prewarmCount = 8;
+    _pools[static_cast<int>(EffectType::MUZZLE_FLASH)].capacity = 16;
+    _pools[static_cast<int>(EffectType::MUZZLE_FLASH)].prewarmCount = 4;
+    _pools[static_cast<int>(EffectType::TOMBSTONE)].capacity = 48;
+    _pools[static_cast<int>(EffectType::TOMBSTONE)].prewarmCount = 16;
+
+    CCLOG("BattleEffectPool: Initialized");
+}
+
+BattleEffectPool::~BattleEffectPool() {
+    for (auto& pool : _pools) {
+        for (auto node : pool.active) {
+            node->removeFromParentAndCleanup(true);
+            node->release();
+        }
+        for (auto node : pool.idle) {
+            node->release();
+        }
+        pool.active.clear();
+        pool.idle.clear();
+        pool.total = 0;
+    }
+    CCLOG("BattleEffectPool: Destroyed");
+}
+
+BattleEffectPool* BattleEffectPool::getInstance() {
+    if (!_instance) {
+        _instance = new BattleEffectPool();
+    }
+    return _instance;
+}
+
+void BattleEffectPool::destroyInstance() {
+    if (_instance) {
+        delete _instance;
+        _instance = nullptr;
+    }
+}
+
+void BattleEffectPool::prewarm() {
+    for (int type = 0; type < static_cast<int>(EffectType::COUNT); ++type) {
+        auto& pool = _pools[type];
+        while (pool.total < pool.prewarmCount) {
+            auto node = createNode(static_cast<EffectType>(type));
+            if (!node) break;
+
+            node->retain();
+            pool.idle.push_back(node);
+            ++pool.total;
+        }
+    }
+}
+
+ParticleSystemQuad* BattleEffectPool::acquireParticle(EffectType type, Node* parent, int zOrder) {
+    auto particle = dynamic_cast<ParticleSystemQuad*>(acquire(type, parent, zOrder));
+    if (particle) {
+        particle->setAutoRemoveOnFinish(true);
+        particle->resetSystem();
+    }
+    return particle;
+}
+
+Sprite* BattleEffectPool::acquireSprite(EffectType type, Node* parent, int zOrder) {
+    auto sprite = dynamic_cast<Sprite*>(acquire(type, parent, zOrder));
+    if (sprite) {
+        sprite->setColor(Color3B::WHITE);
+        sprite->setFlippedX(false);
+    }
+    return sprite;
+}
+
+void BattleEffectPool::recycleAll(EffectType type) {
+    auto& pool = _pools[static_cast<int>(type)];
+    for (auto node : pool.active) {
+        node->removeFromParentAndCleanup(true);
+        pool.idle.push_back(node);
+    }
+    pool.active.clear();
+}
+
+int BattleEffectPool::getActiveCount(EffectType type) {
+    auto& pool = _pools[static_cast<int>(type)];
+    reclaimFinished(pool);
+    return static_cast<int>(pool.active.size());
+}
+
+Node* BattleEffectPool::acquire(EffectType type, Node* parent, int zOrder) {
+    if (!parent) return nullptr;
+
+    auto& pool = _pools[static_cast<int>(type)];
+    reclaimFinished(pool);
+
+    Node* node = nullptr;
+    if (!pool.idle.empty()) {
+        node = pool.idle.back();
+        pool.idle.pop_back();
+    } else if (pool.total < pool.capacity) {
+        node = createNode(type);
+        if (!node) return nullptr;
+        node->retain();
+        ++pool.total;
+    } else {
+        // 达到上限：淘汰最早播放的特效
+        node = pool.active.front();
+        pool.active.pop_front();
+        node->removeFromParentAndCleanup(true);
+    }
+
+    // 父节点随场景销毁的特效没有经过 cleanup，暂停的动作仍留在 ActionManager，
+    // 不停止的话 addChild 后会恢复执行（如上一场战斗墓碑的淡出和 RemoveSelf）
+    node->stopAllActions();
+    node->setOpacity(255);
+    node->setPosition(Vec2::ZERO);
+    node->setScale(1.0f);
+    node->setRotation(0.0f);
+    node->setAnchorPoint(Vec2::ANCHOR_MIDDLE);
+    node->setVisible(true);
+    parent->addChild(node, zOrder);
+
+    pool.active.push_back(node);
+    return node;
+}
+
+Node* BattleEffectPool::createNode(EffectType type) const {
+    switch (type) {
+        case EffectType::EXPLOSION:
+            return ParticleExplosion::create();
+
+        case EffectType::MUZZLE_FLASH: {
+            // 短促的小型火光，粒子数远少于爆炸
+            auto flash = ParticleExplosion::createWithTotalParticles(40);
+            if (flash) {
+                flash->setDuration(0.05f);
+                flash->setLife(0.12f);
+                flash->setLifeVar(0.04f);
+                flash->setSpeed(80.0f);
+                flash->setSpeedVar(30.0f);
+                flash->setStartSize(10.0f);
+                flash->setStartSizeVar(4.0f);
+                flash->setEndSize(2.0f);
+                flash->setStartColor(Color4F(1.0f, 0.9f, 0.4f, 1.0f));
+                flash->setStartColorVar(Color4F(0.0f, 0.1f, 0.1f, 0.0f));
+                flash->setEndColor(Color4F(1.0f, 0.4f, 0.0f, 0.0f));
+                flash->setEndColorVar(Color4F(0.0f, 0.0f, 0.0f, 0.0f));
+            }
+            return flash;
+        }
+
+        case EffectType::TOMBSTONE:
+            return Sprite::create();
+
+        default:
+            return nullptr;
+    }
+}
+
+void BattleEffectPool::reclaimFinished(Pool& pool) {
+    for (auto it = pool.active.begin(); it != pool.active.end();) {
+        if (!(*it)->getParent()) {
+            pool.idle.push_back(*it);
+            it = pool.active.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+﻿// BattleEffectPool.h
+// 战斗特效对象池声明，复用爆炸、炮口火焰粒子和墓碑精灵
+
+#ifndef __BATTLE_EFFECT_POOL_H__
+#define __BATTLE_EFFECT_POOL_H__
+
+#include "cocos2d.h"
+#include <deque>
+#include <vector>
+
+USING_NS_CC;
+
+// 战斗特效对象池
+// 功能：
+// 1. 按特效类型预分配粒子系统/精灵，池持有引用，节点在不同战斗场景间复用
+// 2. 特效播放结束后自行离开父节点（粒子 autoRemoveOnFinish，精灵动作末尾 RemoveSelf），
+//    下次取用时发现已无父节点即回收；父节点被销毁时同样会回收
+// 3. 每种特效有数量上限，超出时移除最早播放的一个复用，连锁爆炸和大规模战斗不再分配节点，粒子总数有上界
+class BattleEffectPool {
+public:
+    enum class EffectType {
+        EXPLOSION,      // 陷阱/炸弹兵爆炸（粒子）
+        MUZZLE_FLASH,   // 炮口火焰（粒子）
+        TOMBSTONE,      // 墓碑（精灵）
+        COUNT
+    };
+
+    static BattleEffectPool* getInstance();
+    static void destroyInstance();
+
+    // 预分配各类型的初始节点
+    void prewarm();
+
+    // 取一个粒子特效并加入 parent，已重置为从头播放
+    // 调用方设置位置、缩放和持续时间，播放结束后自动回收
+    ParticleSystemQuad* acquireParticle(EffectType type, Node* parent, int zOrder);
+
+    // 取一个精灵并加入 parent，颜色/透明度/缩放已重置
+    // 调用方设置纹理和动作，动作末尾需 RemoveSelf 以便回收
+    Sprite* acquireSprite(EffectType type, Node* parent, int zOrder);
+
+    // 立即回收某类型的所有特效（如战斗结束清除墓碑）
+    void recycleAll(EffectType type);
+
+    // 正在播放的数量
+    int getActiveCount(EffectType type);
+
+private:
+    BattleEffectPool();
+    ~BattleEffectPool();
+
+    BattleEffectPool(const BattleEffectPool&) = delete;
+    BattleEffectPool& operator=(const BattleEffectPool&) = delete;
+
+    // 同一类型的节点（都被池 retain）
+    struct Pool {
+        int capacity = 0;               // 上限
+        int prewarmCount = 0;           // 预分配数量
+        int total = 0;                  // 已创建数量
+        std::vector<Node*> idle;
+        std::deque<Node*> active;       // 按播放先后排列，队首最旧
+    };
+
+    Node* acquire(EffectType type, Node* parent, int zOrder);
+    Node* createNode(EffectType type) const;
+
+    // 把已离开父节点的特效移回空闲列表
+    void reclaimFinished(Pool& pool);
+
+    static BattleEffectPool* _instance;
+
+    Pool _pools[static_cast<int>(EffectType::COUNT)];
+};
+
+#endif // __BATTLE_EFFECT_POOL_H__
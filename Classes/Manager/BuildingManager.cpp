@@ -58,13 +58,13 @@ void BuildingManager::loadBuildingsFromData() {
 
 void BuildingManager::loadFromBattleMapData() {
     auto dataManager = VillageDataManager::getInstance();
-    const auto& mapData = dataManager->getBattleMapData();
-    
-    for (const auto& building : mapData.buildings) {
+
+    // 运行时建筑（对手地图或回放布局实例化而来）
+    for (const auto& building : dataManager->getBattleBuildings()) {
         addBuilding(building);
     }
     CCLOG("BuildingManager: Loaded %zu buildings from battle map (difficulty=%d)", 
-          _buildings.size(), mapData.difficulty);
+          _buildings.size(), dataManager->getBattleMapData().difficulty);
 }
 
 BuildingSprite* BuildingManager::addBuilding(const BuildingInstance& building) {
@@ -84,6 +84,7 @@ BuildingSprite* BuildingManager::addBuilding(const BuildingInstance& building) {
     _parentLayer->addChild(sprite, zOrder);
 
     _buildings[building.id] = sprite;
+    _lastConstructionTick = 0;
 
     // 陷阱特殊处理：战斗场景中初始不可见
     if (_isBattleScene && building.type >= 400 && building.type < 500) {
@@ -178,13 +179,16 @@ DefenseBuildingAnimation* BuildingManager::getDefenseAnimation(int buildingId) c
 void BuildingManager::updateBuilding(int buildingId, const BuildingInstance& building) {
   auto sprite = getBuildingSprite(buildingId);
   if (sprite) {
+    // 状态可能切换到建造中，下一帧立即刷新倒计时
+    _lastConstructionTick = 0;
+
     sprite->updateBuilding(building);
 
     Vec2 worldPos = GridMapUtils::gridToPixel(building.gridX, building.gridY);
     Vec2 finalPos = worldPos + sprite->getVisualOffset();
     sprite->setPosition(finalPos);
 
-    // 计算Z-Order并重新排序
+    // 计算Z-Order并移动到对应深度
     int zOrder = calculateZOrder(building.gridX, building.gridY);
     _parentLayer->reorderChild(sprite, zOrder);
 
@@ -249,9 +253,22 @@ BuildingSprite* BuildingManager::getBuildingAtWorldPos(const Vec2& worldPos) con
 }
 
 void BuildingManager::update(float dt) {
+  if (_isBattleScene) {
+    syncDirtyBattleBuildings();
+    return;
+  }
+
+  // 倒计时以秒为单位，同一秒内不重复刷新
+  long long currentTime = time(nullptr);
+  if (currentTime == _lastConstructionTick) return;
+  _lastConstructionTick = currentTime;
+
+  updateConstructions(currentTime);
+}
+
+void BuildingManager::updateConstructions(long long currentTime) {
   auto dataManager = VillageDataManager::getInstance();
   const auto& buildings = dataManager->getAllBuildings();
-  long long currentTime = time(nullptr);
 
   for (auto& building : buildings) {
     if (building.state == BuildingInstance::State::CONSTRUCTING) {
@@ -300,27 +317,35 @@ void BuildingManager::update(float dt) {
         sprite->updateConstructionProgress(progress);
       }
     }
+  }
+}
 
-    // 只在战斗场景才处理HP状态
-    if (_isBattleScene) {
-      for (const auto& b : buildings) {
-        auto s = getBuildingSprite(b.id);
-        if (!s) continue;
+void BuildingManager::syncDirtyBattleBuildings() {
+  auto dataManager = VillageDataManager::getInstance();
+  auto& battleState = dataManager->getBattleState();
+  if (battleState.getDirty().empty()) return;
 
-        if (b.isDestroyed) {
-          s->showDestroyedRubble();
-        } else {
-          s->setColor(Color3B::WHITE);
-          s->setOpacity(255);
-          
-          // 更新血条显示
-          auto config = BuildingConfig::getInstance()->getConfig(b.type);
-          int maxHP = (config && config->hitPoints > 0) ? config->hitPoints : 100;
-          s->updateHealthBar(b.currentHP, maxHP);
-        }
-      }
+  const auto& battleBuildings = dataManager->getBattleBuildings();
+  for (int i : battleState.getDirty()) {
+    if (i >= static_cast<int>(battleBuildings.size())) continue;
+
+    const auto& b = battleBuildings[i];
+    auto s = getBuildingSprite(b.id);
+    if (!s) continue;
+
+    if (battleState.isDestroyed(i)) {
+      s->showDestroyedRubble();
+    } else {
+      s->setColor(Color3B::WHITE);
+      s->setOpacity(255);
+
+      // 更新血条显示
+      auto config = BuildingConfig::getInstance()->getConfig(b.type);
+      int maxHP = (config && config->hitPoints > 0) ? config->hitPoints : 100;
+      s->updateHealthBar(battleState.getHP(i), maxHP);
     }
   }
+  battleState.clearDirty();
 }
 
 void BuildingManager::removeBuildingSprite(int buildingId) {
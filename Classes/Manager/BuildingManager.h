@@ -72,6 +72,15 @@ private:
   }
 
   void createDefenseAnimation(BuildingSprite* sprite, const BuildingInstance& building);
+
+  // 战斗场景：只同步状态表脏集合中的建筑精灵（摧毁废墟、血条）
+  void syncDirtyBattleBuildings();
+
+  // 村庄场景：检查建造完成并刷新倒计时（每跨过一个整秒执行一次）
+  void updateConstructions(long long currentTime);
+
+  // 上次刷新建造倒计时的时间（秒），置 0 强制下一帧刷新
+  long long _lastConstructionTick = 0;
 };
 
 #endif
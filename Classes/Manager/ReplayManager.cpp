@@ -2,13 +2,96 @@
 // 回放管理器实现，处理战斗回放的保存、加载和管理
 
 #include "ReplayManager.h"
-#include "json/document.h"
-#include "json/writer.h"
-#include "json/stringbuffer.h"
+#include "Model/ReplayCodec.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
 
 USING_NS_CC;
 
 ReplayManager* ReplayManager::_instance = nullptr;
+const int ReplayManager::MAX_REPLAY_LIMIT;
+
+namespace {
+
+const char* MAX_REPLAYS_KEY = "replay_max_count";
+
+// 优先读取二进制回放，不存在时回退到旧版 plist 文件
+bool loadReplayFile(const std::string& binaryPath, const std::string& legacyPath, BattleReplayData& out) {
+    auto fileUtils = FileUtils::getInstance();
+    if (fileUtils->isFileExist(binaryPath)) {
+        return ReplayCodec::loadFromFile(binaryPath, out);
+    }
+    if (fileUtils->isFileExist(legacyPath)) {
+        return ReplayCodec::loadFromFile(legacyPath, out);
+    }
+    return false;
+}
+
+// IO 线程读取的索引
+struct LoadedIndex {
+    std::vector<ReplayMetadata> entries;
+    int nextReplayId = 1;
+    bool needsSave = false;         // 从旧格式迁移或重建得到，需要写出新索引
+};
+
+bool readIndexFile(const std::string& path, LoadedIndex& out) {
+    Data data = FileUtils::getInstance()->getDataFromFile(path);
+    if (data.isNull()) return false;
+    return ReplayCodec::decodeIndex(data.getBytes(), static_cast<size_t>(data.getSize()),
+                                    out.entries, out.nextReplayId);
+}
+
+// 旧版 plist 元数据文件
+bool readLegacyMetadata(const std::string& path, LoadedIndex& out) {
+    ValueMap metaMap = FileUtils::getInstance()->getValueMapFromFile(path);
+    if (metaMap.empty()) return false;
+
+    if (metaMap.find("nextReplayId") != metaMap.end()) {
+        out.nextReplayId = metaMap["nextReplayId"].asInt();
+    }
+    if (metaMap.find("replays") != metaMap.end()) {
+        for (const auto& replayValue : metaMap["replays"].asValueVector()) {
+            out.entries.push_back(ReplayMetadata::fromValueMap(replayValue.asValueMap()));
+        }
+    }
+    return true;
+}
+
+// 索引丢失时扫描回放文件重建（二进制回放只解析头部）
+void rebuildIndexFromFiles(const std::string& replayDir, LoadedIndex& out) {
+    auto fileUtils = FileUtils::getInstance();
+    const std::string binaryExt = ReplayCodec::FILE_EXTENSION;
+
+    for (const auto& path : fileUtils->listFiles(replayDir)) {
+        std::string name = path.substr(path.find_last_of("/\\") + 1);
+        if (name.compare(0, 7, "replay_") != 0) continue;
+
+        bool isBinary = name.size() > binaryExt.size() &&
+                        name.compare(name.size() - binaryExt.size(), binaryExt.size(), binaryExt) == 0;
+        ReplayMetadata meta;
+        if (isBinary) {
+            Data data = fileUtils->getDataFromFile(path);
+            if (data.isNull() || !ReplayCodec::decodeMetadata(data.getBytes(), static_cast<size_t>(data.getSize()), meta)) {
+                continue;
+            }
+        } else if (name.size() > 5 && name.compare(name.size() - 5, 5, ".json") == 0) {
+            BattleReplayData replay;
+            if (!ReplayCodec::loadFromFile(path, replay)) continue;
+            meta = replay.toMetadata();
+        } else {
+            continue;
+        }
+        out.entries.push_back(meta);
+    }
+}
+
+int64_t totalLoot(const ReplayMetadata& meta) {
+    return static_cast<int64_t>(meta.lootedGold) + meta.lootedElixir;
+}
+
+} // namespace
 
 ReplayManager* ReplayManager::getInstance() {
     if (!_instance) {
@@ -30,12 +113,16 @@ ReplayManager::ReplayManager() : _nextReplayId(1) {
         CCLOG("ReplayManager: Created replay directory at %s", replayDir.c_str());
     }
 
-    // 加载元数据
-    loadMetadata();
+    int savedLimit = UserDefault::getInstance()->getIntegerForKey(MAX_REPLAYS_KEY, DEFAULT_MAX_REPLAYS);
+    _maxReplays = std::max(1, std::min(savedLimit, MAX_REPLAY_LIMIT));
+
+    // 后台读取索引
+    loadIndexAsync();
 }
 
 ReplayManager::~ReplayManager() {
-    saveMetadata();
+    // 索引在每次变更时都已排队写入，这里只需等待写完
+    waitForPendingWrites();
 }
 
 std::string ReplayManager::getReplayDirectory() {
@@ -43,123 +130,232 @@ std::string ReplayManager::getReplayDirectory() {
 }
 
 std::string ReplayManager::getReplayFilePath(int replayId) {
+    return getReplayDirectory() + "replay_" + std::to_string(replayId) + ReplayCodec::FILE_EXTENSION;
+}
+
+std::string ReplayManager::getLegacyReplayFilePath(int replayId) {
     return getReplayDirectory() + "replay_" + std::to_string(replayId) + ".json";
 }
 
-std::string ReplayManager::getMetadataFilePath() {
+std::string ReplayManager::getIndexFilePath() {
+    return getReplayDirectory() + "index.bin";
+}
+
+std::string ReplayManager::getLegacyMetadataFilePath() {
     return getReplayDirectory() + "metadata.json";
 }
 
 void ReplayManager::saveReplay(const BattleReplayData& data) {
-    // 分配回放ID
-    BattleReplayData saveData = data;
-    saveData.replayId = _nextReplayId++;
-
-    // 保存完整回放数据到独立文件
-    ValueMap replayMap = saveData.toValueMap();
-    std::string filePath = getReplayFilePath(saveData.replayId);
-
-    if (FileUtils::getInstance()->writeValueMapToFile(replayMap, filePath)) {
-        CCLOG("ReplayManager: Saved replay #%d to %s", saveData.replayId, filePath.c_str());
-    } else {
-        CCLOG("ReplayManager: ERROR - Failed to save replay #%d", saveData.replayId);
+    if (!_indexReady) {
+        // 回放ID要在索引读完后分配
+        auto pendingData = std::make_shared<BattleReplayData>(data);
+        _pendingUntilReady.push_back([this, pendingData]() {
+            saveReplay(*pendingData);
+        });
         return;
     }
 
-    // 添加元数据
-    ReplayMetadata meta;
-    meta.replayId = saveData.replayId;
-    meta.timestamp = saveData.timestamp;
-    meta.defenderName = saveData.defenderName;
-    meta.finalStars = saveData.finalStars;
-    meta.destructionPercentage = saveData.destructionPercentage;
-    meta.lootedGold = saveData.lootedGold;
-    meta.lootedElixir = saveData.lootedElixir;
-    meta.usedTroops = saveData.usedTroops;
-    meta.battleDuration = saveData.battleDuration;
-
-    addMetadata(meta);
+    // 分配回放ID
+    auto replayData = std::make_shared<BattleReplayData>(data);
+    replayData->replayId = _nextReplayId++;
+
+    // 编码和写盘在IO线程完成
+    std::string filePath = getReplayFilePath(replayData->replayId);
+    runOnIOThread([replayData, filePath]() {
+        if (ReplayCodec::saveToFile(filePath, *replayData)) {
+            CCLOG("ReplayManager: Saved replay #%d to %s", replayData->replayId, filePath.c_str());
+        } else {
+            CCLOG("ReplayManager: ERROR - Failed to save replay #%d", replayData->replayId);
+        }
+    });
 
-    // 强制执行10场限制
+    addMetadata(replayData->toMetadata());
     enforceReplayLimit();
-
-    // 保存元数据
-    saveMetadata();
+    saveIndex();
 }
 
 BattleReplayData ReplayManager::loadReplay(int replayId) {
-    std::string filePath = getReplayFilePath(replayId);
-    ValueMap replayMap = FileUtils::getInstance()->getValueMapFromFile(filePath);
-
-    if (replayMap.empty()) {
+    BattleReplayData data;
+    if (!loadReplayFile(getReplayFilePath(replayId), getLegacyReplayFilePath(replayId), data)) {
         CCLOG("ReplayManager: ERROR - Failed to load replay #%d", replayId);
         return BattleReplayData();
     }
-
-    return BattleReplayData::fromValueMap(replayMap);
+    return data;
 }
 
-std::vector<ReplayMetadata> ReplayManager::getReplayList() {
-    return _metadataList;
+void ReplayManager::loadReplayAsync(int replayId, LoadCallback callback) {
+    std::string binaryPath = getReplayFilePath(replayId);
+    std::string legacyPath = getLegacyReplayFilePath(replayId);
+    auto data = std::make_shared<BattleReplayData>();
+    auto success = std::make_shared<bool>(false);
+
+    // 与写入使用同一个IO线程，刚保存的回放一定能读到
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO,
+        [replayId, data, success, callback](void*) {
+            if (!*success) {
+                CCLOG("ReplayManager: ERROR - Failed to load replay #%d", replayId);
+            }
+            if (callback) {
+                callback(*success, *data);
+            }
+        },
+        nullptr,
+        [binaryPath, legacyPath, data, success]() {
+            *success = loadReplayFile(binaryPath, legacyPath, *data);
+        });
 }
 
 void ReplayManager::deleteReplay(int replayId) {
-    // 删除文件
-    std::string filePath = getReplayFilePath(replayId);
-    if (FileUtils::getInstance()->removeFile(filePath)) {
-        CCLOG("ReplayManager: Deleted replay file #%d", replayId);
+    if (!_indexReady) {
+        _pendingUntilReady.push_back([this, replayId]() {
+            deleteReplay(replayId);
+        });
+        return;
     }
 
-    // 移除元数据
+    deleteReplayFiles(replayId);
     removeMetadata(replayId);
-
-    // 保存元数据
-    saveMetadata();
+    saveIndex();
 }
 
-void ReplayManager::loadMetadata() {
-    std::string metaPath = getMetadataFilePath();
-    if (!FileUtils::getInstance()->isFileExist(metaPath)) {
-        CCLOG("ReplayManager: No metadata file found, starting fresh");
-        return;
+void ReplayManager::whenIndexReady(std::function<void()> callback) {
+    if (_indexReady) {
+        callback();
+    } else {
+        _pendingUntilReady.push_back(callback);
     }
+}
 
-    ValueMap metaMap = FileUtils::getInstance()->getValueMapFromFile(metaPath);
-    if (metaMap.empty()) return;
+std::vector<ReplayMetadata> ReplayManager::getReplayList() {
+    return _metadataList;
+}
 
-    // 读取nextReplayId
-    if (metaMap.find("nextReplayId") != metaMap.end()) {
-        _nextReplayId = metaMap["nextReplayId"].asInt();
+std::vector<ReplayMetadata> ReplayManager::queryReplays(const ReplayQuery& query) const {
+    std::vector<ReplayMetadata> result;
+    for (const auto& meta : _metadataList) {
+        if (query.fromTime > 0 && meta.timestamp < query.fromTime) continue;
+        if (query.toTime > 0 && meta.timestamp > query.toTime) continue;
+        if (meta.finalStars < query.minStars) continue;
+        if (totalLoot(meta) < query.minLoot) continue;
+        result.push_back(meta);
     }
 
-    // 读取replays数组
-    if (metaMap.find("replays") != metaMap.end()) {
-        ValueVector replaysVec = metaMap["replays"].asValueVector();
-        for (const auto& replayValue : replaysVec) {
-            ReplayMetadata meta = ReplayMetadata::fromValueMap(replayValue.asValueMap());
-            _metadataList.push_back(meta);
+    // 排序键相同时按ID（即保存顺序）排列
+    auto less = [&query](const ReplayMetadata& a, const ReplayMetadata& b) {
+        switch (query.sortBy) {
+        case ReplayQuery::SortBy::STARS:
+            if (a.finalStars != b.finalStars) return a.finalStars < b.finalStars;
+            if (a.destructionPercentage != b.destructionPercentage) return a.destructionPercentage < b.destructionPercentage;
+            break;
+        case ReplayQuery::SortBy::LOOT:
+            if (totalLoot(a) != totalLoot(b)) return totalLoot(a) < totalLoot(b);
+            break;
+        case ReplayQuery::SortBy::DATE:
+            if (a.timestamp != b.timestamp) return a.timestamp < b.timestamp;
+            break;
         }
+        return a.replayId < b.replayId;
+    };
+    if (query.descending) {
+        std::sort(result.begin(), result.end(),
+                  [&less](const ReplayMetadata& a, const ReplayMetadata& b) { return less(b, a); });
+    } else {
+        std::sort(result.begin(), result.end(), less);
     }
 
-    CCLOG("ReplayManager: Loaded %zu replays, nextId=%d", _metadataList.size(), _nextReplayId);
+    // 分页
+    size_t begin = std::min(result.size(), static_cast<size_t>(std::max(query.offset, 0)));
+    size_t end = query.limit > 0 ? std::min(result.size(), begin + query.limit) : result.size();
+    return std::vector<ReplayMetadata>(result.begin() + begin, result.begin() + end);
 }
 
-void ReplayManager::saveMetadata() {
-    ValueMap metaMap;
-    metaMap["nextReplayId"] = _nextReplayId;
+void ReplayManager::setMaxReplays(int maxReplays) {
+    _maxReplays = std::max(1, std::min(maxReplays, MAX_REPLAY_LIMIT));
+    UserDefault::getInstance()->setIntegerForKey(MAX_REPLAYS_KEY, _maxReplays);
+    CCLOG("ReplayManager: Replay limit set to %d", _maxReplays);
 
-    ValueVector replaysVec;
-    for (const auto& meta : _metadataList) {
-        replaysVec.push_back(Value(meta.toValueMap()));
+    // 调低上限时立即删除多出的回放；索引未就绪时读完后会统一检查
+    if (_indexReady && static_cast<int>(_metadataList.size()) > _maxReplays) {
+        enforceReplayLimit();
+        saveIndex();
     }
-    metaMap["replays"] = replaysVec;
+}
 
-    std::string metaPath = getMetadataFilePath();
-    if (FileUtils::getInstance()->writeValueMapToFile(metaMap, metaPath)) {
-        CCLOG("ReplayManager: Saved metadata (%zu replays)", _metadataList.size());
-    } else {
-        CCLOG("ReplayManager: ERROR - Failed to save metadata");
-    }
+void ReplayManager::loadIndexAsync() {
+    auto loaded = std::make_shared<LoadedIndex>();
+    std::string indexPath = getIndexFilePath();
+    std::string legacyPath = getLegacyMetadataFilePath();
+    std::string replayDir = getReplayDirectory();
+
+    _pendingWrites++;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO,
+        [this, loaded](void*) {
+            _metadataList = std::move(loaded->entries);
+            _nextReplayId = loaded->nextReplayId;
+            _indexReady = true;
+            CCLOG("ReplayManager: Loaded index with %zu replays, nextId=%d", _metadataList.size(), _nextReplayId);
+
+            size_t countBefore = _metadataList.size();
+            enforceReplayLimit();
+            if (loaded->needsSave || _metadataList.size() != countBefore) {
+                saveIndex();
+            }
+
+            // 执行索引就绪前排队的操作
+            std::vector<std::function<void()>> pending;
+            pending.swap(_pendingUntilReady);
+            for (auto& task : pending) {
+                task();
+            }
+        },
+        nullptr,
+        [this, loaded, indexPath, legacyPath, replayDir]() {
+            auto fileUtils = FileUtils::getInstance();
+            if (fileUtils->isFileExist(indexPath) && readIndexFile(indexPath, *loaded)) {
+                // 正常路径
+            } else if (fileUtils->isFileExist(legacyPath) && readLegacyMetadata(legacyPath, *loaded)) {
+                loaded->needsSave = true;
+                CCLOG("ReplayManager: Migrating legacy metadata.json to index");
+            } else {
+                rebuildIndexFromFiles(replayDir, *loaded);
+                loaded->needsSave = !loaded->entries.empty();
+                if (loaded->needsSave) {
+                    CCLOG("ReplayManager: Rebuilt index from %zu replay files", loaded->entries.size());
+                }
+            }
+
+            std::sort(loaded->entries.begin(), loaded->entries.end(),
+                      [](const ReplayMetadata& a, const ReplayMetadata& b) { return a.replayId < b.replayId; });
+            if (!loaded->entries.empty()) {
+                loaded->nextReplayId = std::max(loaded->nextReplayId, loaded->entries.back().replayId + 1);
+            }
+            _pendingWrites--;
+        });
+}
+
+void ReplayManager::saveIndex() {
+    // 在主线程编码快照，IO线程写临时文件后重命名
+    auto bytes = std::make_shared<std::vector<uint8_t>>(ReplayCodec::encodeIndex(_metadataList, _nextReplayId));
+    std::string indexPath = getIndexFilePath();
+    std::string legacyPath = getLegacyMetadataFilePath();
+    size_t count = _metadataList.size();
+    runOnIOThread([bytes, indexPath, legacyPath, count]() {
+        auto fileUtils = FileUtils::getInstance();
+        std::string tempPath = indexPath + ".tmp";
+
+        Data data;
+        data.copy(bytes->data(), static_cast<ssize_t>(bytes->size()));
+        if (!fileUtils->writeDataToFile(data, tempPath) || !fileUtils->renameFile(tempPath, indexPath)) {
+            CCLOG("ReplayManager: ERROR - Failed to save index");
+            return;
+        }
+        CCLOG("ReplayManager: Saved index (%zu replays, %zu bytes)", count, bytes->size());
+
+        // 迁移完成后删除旧版元数据，避免索引丢失时读到过期数据
+        if (fileUtils->isFileExist(legacyPath)) {
+            fileUtils->removeFile(legacyPath);
+        }
+    });
 }
 
 void ReplayManager::addMetadata(const ReplayMetadata& meta) {
@@ -175,17 +371,54 @@ void ReplayManager::removeMetadata(int replayId) {
 }
 
 void ReplayManager::enforceReplayLimit() {
-    while (_metadataList.size() > MAX_REPLAYS) {
+    while (static_cast<int>(_metadataList.size()) > _maxReplays) {
         // 找到最旧的回放
         auto oldestIt = std::min_element(_metadataList.begin(), _metadataList.end(),
                                          [](const ReplayMetadata& a, const ReplayMetadata& b) {
             return a.timestamp < b.timestamp;
         });
 
-        if (oldestIt != _metadataList.end()) {
-            int oldestId = oldestIt->replayId;
-            CCLOG("ReplayManager: Deleting oldest replay #%d to maintain limit", oldestId);
-            deleteReplay(oldestId);
+        int oldestId = oldestIt->replayId;
+        CCLOG("ReplayManager: Deleting oldest replay #%d to maintain limit of %d", oldestId, _maxReplays);
+        deleteReplayFiles(oldestId);
+        _metadataList.erase(oldestIt);
+    }
+}
+
+void ReplayManager::deleteReplayFiles(int replayId) {
+    // 删除文件（排在写入之后，避免删掉正在写的文件后又被写回）
+    std::string filePath = getReplayFilePath(replayId);
+    std::string legacyPath = getLegacyReplayFilePath(replayId);
+    runOnIOThread([replayId, filePath, legacyPath]() {
+        auto fileUtils = FileUtils::getInstance();
+        bool removed = false;
+        if (fileUtils->isFileExist(filePath)) removed = fileUtils->removeFile(filePath) || removed;
+        if (fileUtils->isFileExist(legacyPath)) removed = fileUtils->removeFile(legacyPath) || removed;
+        if (removed) {
+            CCLOG("ReplayManager: Deleted replay file #%d", replayId);
         }
+    });
+}
+
+void ReplayManager::runOnIOThread(std::function<void()> task) {
+    _pendingWrites++;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO,
+        [](void*) {},
+        nullptr,
+        [this, task]() {
+            task();
+            _pendingWrites--;
+        });
+}
+
+void ReplayManager::waitForPendingWrites() {
+    // IO线程池已销毁时任务不会再执行，最多等待3秒
+    const int maxWaitMs = 3000;
+    for (int waited = 0; _pendingWrites > 0 && waited < maxWaitMs; ++waited) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (_pendingWrites > 0) {
+        CCLOG("ReplayManager: WARNING - %d pending replay writes dropped", _pendingWrites.load());
     }
 }
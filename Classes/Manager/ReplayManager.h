@@ -6,20 +6,64 @@
 
 #include "cocos2d.h"
 #include "Model/ReplayData.h"
+#include <atomic>
+#include <ctime>
+#include <functional>
 #include <vector>
 #include <string>
 
+// 回放列表查询条件，只使用索引中的元数据，不打开回放文件
+struct ReplayQuery {
+    enum class SortBy {
+        DATE,       // 战斗时间
+        STARS,      // 星数，相同星数按摧毁率
+        LOOT        // 掠夺金币 + 圣水
+    };
+
+    SortBy sortBy = SortBy::DATE;
+    bool descending = true;
+    time_t fromTime = 0;            // 时间范围，0 表示不限
+    time_t toTime = 0;
+    int minStars = 0;
+    int minLoot = 0;
+    int offset = 0;
+    int limit = 0;                  // 0 表示不限
+};
+
+// 回放管理器
+// 回放文件为二进制格式（见 ReplayCodec），编码和磁盘读写在 IO 线程执行，不阻塞主线程
+// - 所有回放的元数据保存在紧凑的索引文件（index.bin）中，启动时在 IO 线程读取
+//   没有索引时依次尝试旧版 metadata.json、扫描回放文件头部重建
+// - 索引读完之前的保存/删除会排队到读完后执行，列表页用 whenIndexReady 等待
+// - 完整回放只在观看时通过 loadReplayAsync 读取
+// 旧版 plist 回放文件（replay_N.json）仍可加载
 class ReplayManager {
 public:
+    using LoadCallback = std::function<void(bool success, const BattleReplayData& data)>;
+
+    static const int DEFAULT_MAX_REPLAYS = 10;
+    static const int MAX_REPLAY_LIMIT = 500;                // 保留上限的可配置范围
+
     static ReplayManager* getInstance();
     static void destroyInstance();
 
     // 回放操作
-    void saveReplay(const BattleReplayData& data);          // 保存回放
-    BattleReplayData loadReplay(int replayId);              // 加载完整回放数据
-    std::vector<ReplayMetadata> getReplayList();            // 获取回放列表（元数据）
+    void saveReplay(const BattleReplayData& data);          // 保存回放（后台写入）
+    BattleReplayData loadReplay(int replayId);              // 同步加载完整回放数据
+    void loadReplayAsync(int replayId, LoadCallback callback);  // 后台加载，回调在主线程执行
     void deleteReplay(int replayId);                        // 删除回放
 
+    // 索引查询（主线程，不读磁盘）
+    bool isIndexReady() const { return _indexReady; }
+    void whenIndexReady(std::function<void()> callback);    // 索引已就绪时立即调用，否则读完后在主线程调用
+    std::vector<ReplayMetadata> getReplayList();            // 获取回放列表（按ID升序）
+    std::vector<ReplayMetadata> queryReplays(const ReplayQuery& query) const;
+    int getReplayCount() const { return static_cast<int>(_metadataList.size()); }
+
+    // 保留上限（超出时删除最旧的回放），保存在 UserDefault 中
+    int getMaxReplays() const { return _maxReplays; }
+    void setMaxReplays(int maxReplays);
+
 private:
     ReplayManager();
     ~ReplayManager();
@@ -29,19 +73,28 @@ private:
     // 文件路径管理
     std::string getReplayDirectory();                       // 获取回放目录
     std::string getReplayFilePath(int replayId);           // 获取回放文件路径
-    std::string getMetadataFilePath();                      // 获取元数据文件路径
+    std::string getLegacyReplayFilePath(int replayId);     // 获取旧版 plist 回放文件路径
+    std::string getIndexFilePath();                         // 获取索引文件路径
+    std::string getLegacyMetadataFilePath();                // 获取旧版元数据文件路径
 
-    // 元数据管理
-    void loadMetadata();                                    // 加载元数据
-    void saveMetadata();                                    // 保存元数据
+    // 索引管理
+    void loadIndexAsync();                                  // 后台读取索引
+    void saveIndex();                                       // 编码索引并排队写入
     void addMetadata(const ReplayMetadata& meta);          // 添加元数据
     void removeMetadata(int replayId);                     // 移除元数据
-    void enforceReplayLimit();                              // 强制执行10场限制
+    void enforceReplayLimit();                              // 删除超出保留上限的最旧回放
+    void deleteReplayFiles(int replayId);                   // 排队删除回放文件
 
-    std::vector<ReplayMetadata> _metadataList;             // 缓存的元数据列表
-    int _nextReplayId;                                      // 下一个回放ID
+    // 后台读写
+    void runOnIOThread(std::function<void()> task);         // 投递到 IO 线程（同类任务按顺序执行）
+    void waitForPendingWrites();                            // 等待未完成的写入（退出前调用）
 
-    const int MAX_REPLAYS = 10;                             // 最多保存10场
+    std::vector<ReplayMetadata> _metadataList;             // 索引（按ID升序）
+    int _nextReplayId;                                      // 下一个回放ID
+    int _maxReplays;                                        // 保留上限
+    bool _indexReady = false;
+    std::vector<std::function<void()>> _pendingUntilReady;  // 索引就绪前排队的操作
+    std::atomic<int> _pendingWrites{ 0 };                   // 排队中的读写/删除任务数
 };
 
 #endif
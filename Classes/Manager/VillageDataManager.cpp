@@ -2,14 +2,13 @@
 // 村庄数据管理器，负责游戏核心数据的存储、读取和状态管理
 
 #include "VillageDataManager.h"
+#include "VillageSaveService.h"
 #include "../Util/GridMapUtils.h"
 #include "../Model/BuildingConfig.h"
 #include "../Model/BuildingRequirements.h"
 #include <algorithm>
+#include "../Model/VillageSaveCodec.h"
 #include "cocos2d.h"
-#include "json/document.h"
-#include "json/writer.h"
-#include "json/stringbuffer.h"
 
 USING_NS_CC;
 
@@ -212,7 +211,7 @@ int VillageDataManager::getTroopCount(int troopId) const {
 void VillageDataManager::addTroop(int troopId, int count) {
     if (count <= 0) return;
     _data.troops[troopId] += count;
-    saveToFile("village.json");
+    requestSave();
 }
 
 bool VillageDataManager::removeTroop(int troopId, int count) {
@@ -228,41 +227,45 @@ bool VillageDataManager::removeTroop(int troopId, int count) {
         _data.troops.erase(it);
     }
 
-    saveToFile("village.json");
+    requestSave();
     return true;
 }
 
 const std::vector<BuildingInstance>& VillageDataManager::getAllBuildings() const {
   if (_inBattleMode) {
-    return _battleMapData.buildings;
+    return getBattleBuildings();
   }
   return _data.buildings;
 }
 
 BuildingInstance* VillageDataManager::getBuildingById(int id) {
   if (_inBattleMode) {
-    for (auto& building : _battleMapData.buildings) {
-      if (building.id == id) {
-        return &building;
-      }
-    }
-  } else {
-    for (auto& building : _data.buildings) {
-      if (building.id == id) {
-        return &building;
-      }
+    // 战斗布局只读，战斗系统通过 getBattleBuilding 和状态表访问
+    CCLOG("VillageDataManager: WARNING - getBuildingById(%d) called in battle mode", id);
+    return nullptr;
+  }
+  for (auto& building : _data.buildings) {
+    if (building.id == id) {
+      return &building;
     }
   }
   return nullptr;
 }
 
-BuildingInstance* VillageDataManager::getBuildingAtGrid(int gridX, int gridY) {
+const BuildingInstance* VillageDataManager::getBuildingAtGrid(int gridX, int gridY) const {
   if (gridX < 0 || gridY < 0 || gridX >= GridMapUtils::GRID_WIDTH || gridY >= GridMapUtils::GRID_HEIGHT) return nullptr;
   
   const auto& occupancy = _inBattleMode ? _battleGridOccupancy : _gridOccupancy;
   int occupyingId = occupancy[gridX][gridY];
   if (occupyingId == 0) return nullptr;
-  return getBuildingById(occupyingId);
+  if (_inBattleMode) return getBattleBuilding(occupyingId);
+
+  for (const auto& building : _data.buildings) {
+    if (building.id == occupyingId) {
+      return &building;
+    }
+  }
+  return nullptr;
 }
 
 int VillageDataManager::addBuilding(int type, int level, int gridX, int gridY,
@@ -324,7 +327,7 @@ void VillageDataManager::setBuildingPosition(int id, int gridX, int gridY) {
 
     CCLOG("VillageDataManager: Building ID=%d moved to grid(%d, %d)", id, gridX, gridY);
     
-    saveToFile("village.json");
+    requestSave();
   }
 }
 
@@ -386,7 +389,7 @@ bool VillageDataManager::startUpgradeBuilding(int id) {
   CCLOG("VillageDataManager: Started upgrade for building %d (level %d → %d), finish at %lld",
         id, building->level, building->level + 1, finishTime);
 
-  saveToFile("village.json");
+  requestSave();
 
   // 触发建造开始事件
   EventCustom event("EVENT_CONSTRUCTION_STARTED");
@@ -412,7 +415,7 @@ void VillageDataManager::finishNewBuildingConstruction(int id) {
 
   CCLOG("VillageDataManager: New building %d construction complete (level=%d)", id, building->level);
 
-  saveToFile("village.json");
+  requestSave();
 
   // 仓库建筑完成需刷新资源显示
   if (building->type == 204 || building->type == 205) {
@@ -450,7 +453,7 @@ void VillageDataManager::finishUpgradeBuilding(int id) {
     notifyResourceChanged();
   }
 
-  saveToFile("village.json");
+  requestSave();
 
   Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(
     "EVENT_BUILDING_UPGRADED", &id);
@@ -474,7 +477,7 @@ bool VillageDataManager::startConstructionAfterPlacement(int buildingId) {
 
     building->state = BuildingInstance::State::BUILT;
     building->finishTime = 0;
-    saveToFile("village.json");
+    requestSave();
 
     EventCustom event("EVENT_BUILDING_UPGRADED");
     int* data = new int(buildingId);
@@ -495,7 +498,7 @@ bool VillageDataManager::startConstructionAfterPlacement(int buildingId) {
   building->state = BuildingInstance::State::CONSTRUCTING;
   building->finishTime = time(nullptr) + config->buildTimeSeconds;
 
-  saveToFile("village.json");
+  requestSave();
 
   EventCustom event("EVENT_CONSTRUCTION_STARTED");
   int* data = new int(buildingId);
@@ -606,88 +609,37 @@ void VillageDataManager::checkAndFinishConstructions() {
 }
 
 void VillageDataManager::saveToFile(const std::string& filename) {
-    rapidjson::Document doc;
-    doc.SetObject();
-    auto& allocator = doc.GetAllocator();
-
-    // 保存基础资源
-    doc.AddMember("gold", _data.gold, allocator);
-    doc.AddMember("elixir", _data.elixir, allocator);
-    doc.AddMember("gem", _data.gem, allocator);
-
-    // 保存当前场景
-    doc.AddMember("currentTheme", _currentThemeId, allocator);
-
-    // 保存已购买的场景列表
-    rapidjson::Value purchasedArr(rapidjson::kArrayType);
-    for (int id : _purchasedThemes) {
-        purchasedArr.PushBack(id, allocator);
-    }
-    doc.AddMember("purchasedThemes", purchasedArr, allocator);
-
-    // 保存军队数据
-    rapidjson::Value troopsArray(rapidjson::kArrayType);
-    for (const auto& pair : _data.troops) {
-        rapidjson::Value troopObj(rapidjson::kObjectType);
-        troopObj.AddMember("id", pair.first, allocator);
-        troopObj.AddMember("count", pair.second, allocator);
-        troopsArray.PushBack(troopObj, allocator);
-    }
-    doc.AddMember("troops", troopsArray, allocator);
-
-    // 保存建筑数据
-    rapidjson::Value buildingsArray(rapidjson::kArrayType);
-    for (const auto& building : _data.buildings) {
-        rapidjson::Value buildingObj(rapidjson::kObjectType);
-        buildingObj.AddMember("id", building.id, allocator);
-        buildingObj.AddMember("type", building.type, allocator);
-        buildingObj.AddMember("level", building.level, allocator);
-        buildingObj.AddMember("gridX", building.gridX, allocator);
-        buildingObj.AddMember("gridY", building.gridY, allocator);
-        buildingObj.AddMember("state", (int)building.state, allocator);
-        buildingObj.AddMember("finishTime", building.finishTime, allocator);
-        buildingObj.AddMember("isInitialConstruction", building.isInitialConstruction, allocator);
-        buildingObj.AddMember("currentHP", building.currentHP, allocator);
-        buildingsArray.PushBack(buildingObj, allocator);
-    }
-    doc.AddMember("buildings", buildingsArray, allocator);
-
-    // 保存兵种研究等级
-    rapidjson::Value troopLevelsArray(rapidjson::kArrayType);
-    for (const auto& pair : _data.troopLevels) {
-        rapidjson::Value levelObj(rapidjson::kObjectType);
-        levelObj.AddMember("id", pair.first, allocator);
-        levelObj.AddMember("level", pair.second, allocator);
-        troopLevelsArray.PushBack(levelObj, allocator);
-    }
-    doc.AddMember("troopLevels", troopLevelsArray, allocator);
-
-    // 保存研究状态
-    doc.AddMember("researchingTroopId", _data.researchingTroopId, allocator);
-    doc.AddMember("researchFinishTime", _data.researchFinishTime, allocator);
-
-    // 序列化为JSON字符串并写入文件
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    doc.Accept(writer);
+  // 主存档交给写回服务，保证和后台写入的先后顺序
+  if (filename == VillageSaveService::SAVE_FILE) {
+    VillageSaveService::getInstance()->saveNow();
+    return;
+  }
 
-    auto fileUtils = FileUtils::getInstance();
-    std::string writablePath = fileUtils->getWritablePath();
-    std::string fullPath = writablePath + filename;
+  std::string fullPath = FileUtils::getInstance()->getWritablePath() + filename;
+  if (VillageSaveService::writeAtomically(fullPath, VillageSaveCodec::write(createSaveSnapshot(), 0))) {
+    CCLOG("VillageDataManager: Saved to %s", fullPath.c_str());
+  } else {
+    CCLOG("VillageDataManager: ERROR - Failed to save");
+  }
+}
 
-    bool success = fileUtils->writeStringToFile(buffer.GetString(), fullPath);
+void VillageDataManager::requestSave() {
+  VillageSaveService::getInstance()->markDirty();
+}
 
-    if (success) {
-        CCLOG("VillageDataManager: Saved to %s", fullPath.c_str());
-    } else {
-        CCLOG("VillageDataManager: ERROR - Failed to save");
-    }
+VillageSaveSnapshot VillageDataManager::createSaveSnapshot() const {
+  VillageSaveSnapshot snapshot;
+  snapshot.data = _data;
+  snapshot.currentThemeId = _currentThemeId;
+  snapshot.purchasedThemes.assign(_purchasedThemes.begin(), _purchasedThemes.end());
+  return snapshot;
 }
 
 void VillageDataManager::loadFromFile(const std::string& filename) {
   auto fileUtils = FileUtils::getInstance();
   std::string writablePath = fileUtils->getWritablePath();
   std::string fullPath = writablePath + filename;
+  VillageSaveService::recoverInterruptedSave(fullPath);
 
   // 如果存档不存在，初始化默认游戏
   if (!fileUtils->isFileExist(fullPath)) {
@@ -734,123 +686,42 @@ void VillageDataManager::loadFromFile(const std::string& filename) {
   }
 
   // 读取存档文件
-  std::string content = fileUtils->getStringFromFile(fullPath);
-  if (content.empty()) {
+  Data content = fileUtils->getDataFromFile(fullPath);
+  if (content.isNull()) {
     CCLOG("VillageDataManager: Failed to read save file");
     return;
   }
 
-  rapidjson::Document doc;
-  doc.Parse(content.c_str());
-
-  if (doc.HasParseError()) {
+  // 流式解析，直接填充快照
+  VillageSaveSnapshot snapshot = createSaveSnapshot();
+  uint64_t journalGeneration = 0;
+  if (!VillageSaveCodec::read(reinterpret_cast<const char*>(content.getBytes()), content.getSize(),
+                              snapshot, journalGeneration)) {
     CCLOG("VillageDataManager: JSON parse error");
     return;
   }
+  content.clear();
 
-  // 加载资源数据
-  if (doc.HasMember("gold") && doc["gold"].IsInt()) {
-    _data.gold = doc["gold"].GetInt();
-  }
-  if (doc.HasMember("elixir") && doc["elixir"].IsInt()) {
-    _data.elixir = doc["elixir"].GetInt();
-  }
-  if (doc.HasMember("gem") && doc["gem"].IsInt()) {
-    _data.gem = doc["gem"].GetInt();  
-  }
-
-  // 加载场景配置
-  if (doc.HasMember("currentTheme") && doc["currentTheme"].IsInt()) {
-      _currentThemeId = doc["currentTheme"].GetInt();
-  }
+  // 在快照上回放存档日志
+  auto saveService = VillageSaveService::getInstance();
+  saveService->replayJournal(journalGeneration, snapshot);
 
-  // 加载已购买的场景
-  _purchasedThemes.clear();
-  if (doc.HasMember("purchasedThemes") && doc["purchasedThemes"].IsArray()) {
-      const auto& arr = doc["purchasedThemes"];
-      for (rapidjson::SizeType i = 0; i < arr.Size(); i++) {
-          _purchasedThemes.insert(arr[i].GetInt());
-      }
-  }
-
-  // 加载军队数据
-  _data.troops.clear();
-  if (doc.HasMember("troops") && doc["troops"].IsArray()) {
-      const auto& troopsArray = doc["troops"];
-      for (rapidjson::SizeType i = 0; i < troopsArray.Size(); i++) {
-          const auto& obj = troopsArray[i];
-          int id = obj["id"].GetInt();
-          int count = obj["count"].GetInt();
-          _data.troops[id] = count;
-      }
-  }
-
-  // 加载建筑数据
-  _data.buildings.clear();
-  if (doc.HasMember("buildings") && doc["buildings"].IsArray()) {
-    const auto& buildingsArray = doc["buildings"];
-    for (rapidjson::SizeType i = 0; i < buildingsArray.Size(); i++) {
-      const auto& buildingObj = buildingsArray[i];
-
-      BuildingInstance building;
-      building.id = buildingObj["id"].GetInt();
-      building.type = buildingObj["type"].GetInt();
-      building.level = buildingObj["level"].GetInt();
-      building.gridX = buildingObj["gridX"].GetInt();
-      building.gridY = buildingObj["gridY"].GetInt();
-      building.state = (BuildingInstance::State)buildingObj["state"].GetInt();
-      building.finishTime = buildingObj["finishTime"].GetInt64();
-      
-      // 加载建造标识
-      if (buildingObj.HasMember("isInitialConstruction")) {
-        building.isInitialConstruction = buildingObj["isInitialConstruction"].GetBool();
-      } else {
-        building.isInitialConstruction = false;
-      }
-
-      // 加载或初始化生命值
-      if (buildingObj.HasMember("currentHP") && buildingObj["currentHP"].IsInt()) {
-        building.currentHP = buildingObj["currentHP"].GetInt();
-      } else {
-        auto cfg = BuildingConfig::getInstance()->getConfig(building.type);
-        building.currentHP = (cfg && cfg->hitPoints > 0) ? cfg->hitPoints : 100;
-      }
-
-      building.isDestroyed = false;
-
-      _data.buildings.push_back(building);
-
-      // 更新建筑ID计数器
-      if (building.id >= _nextBuildingId) {
-        _nextBuildingId = building.id + 1;
-      }
+  // 旧存档没有生命值，按配置补满
+  for (auto& building : snapshot.data.buildings) {
+    if (building.currentHP == VillageSaveCodec::MISSING_HP) {
+      auto cfg = BuildingConfig::getInstance()->getConfig(building.type);
+      building.currentHP = (cfg && cfg->hitPoints > 0) ? cfg->hitPoints : 100;
     }
   }
+  saveService->setBaseSnapshot(snapshot);
 
-  // 读取兵种研究等级
-  _data.troopLevels.clear();
-  if (doc.HasMember("troopLevels") && doc["troopLevels"].IsArray()) {
-    const auto& levelsArray = doc["troopLevels"];
-    for (rapidjson::SizeType i = 0; i < levelsArray.Size(); i++) {
-      const auto& obj = levelsArray[i];
-      int id = obj["id"].GetInt();
-      int level = obj["level"].GetInt();
-      _data.troopLevels[id] = level;
-    }
-    CCLOG("VillageDataManager: Loaded %lu troop levels", _data.troopLevels.size());
-  }
-
-  // 读取研究状态
-  if (doc.HasMember("researchingTroopId") && doc["researchingTroopId"].IsInt()) {
-    _data.researchingTroopId = doc["researchingTroopId"].GetInt();
-  } else {
-    _data.researchingTroopId = -1;
-  }
+  _data = std::move(snapshot.data);
+  _currentThemeId = snapshot.currentThemeId;
+  _purchasedThemes = std::set<int>(snapshot.purchasedThemes.begin(), snapshot.purchasedThemes.end());
 
-  if (doc.HasMember("researchFinishTime") && doc["researchFinishTime"].IsInt64()) {
-    _data.researchFinishTime = doc["researchFinishTime"].GetInt64();
-  } else {
-    _data.researchFinishTime = 0;
+  // 更新建筑ID计数器
+  for (const auto& building : _data.buildings) {
+    _nextBuildingId = std::max(_nextBuildingId, building.id + 1);
   }
 
   updateGridOccupancy();
@@ -1058,7 +929,7 @@ bool VillageDataManager::startTroopUpgrade(int troopId) {
   CCLOG("VillageDataManager: Started research for troop %d (level %d -> %d), cost=%d, time=%d",
         troopId, currentLevel, currentLevel + 1, cost, time);
   
-  saveToFile("village.json");
+  requestSave();
   
   Director::getInstance()->getEventDispatcher()->dispatchCustomEvent("EVENT_RESEARCH_STARTED");
   
@@ -1084,7 +955,7 @@ void VillageDataManager::finishTroopUpgrade() {
   CCLOG("VillageDataManager: Troop %d research complete! Level %d -> %d",
         troopId, oldLevel, newLevel);
   
-  saveToFile("village.json");
+  requestSave();
   
   Director::getInstance()->getEventDispatcher()->dispatchCustomEvent("EVENT_RESEARCH_COMPLETE");
 }
@@ -1130,23 +1001,41 @@ void VillageDataManager::finishResearchImmediately() {
 
 #include "../Util/RandomBattleMapGenerator.h"
 
-void VillageDataManager::setBattleMapData(const BattleMapData& data) {
-  _battleMapData = data;
-  CCLOG("VillageDataManager: Battle map data set with %zu buildings", data.buildings.size());
+void VillageDataManager::setBattleMapData(BattleMapSnapshot map) {
+  _battleMap = std::move(map);
+  // 布局指针与地图共享同一块内存，录制时直接引用，不复制建筑列表
+  _battleLayout = _battleMap ? BattleLayout(_battleMap, &_battleMap->buildings) : nullptr;
+  resetBattleState();
+  CCLOG("VillageDataManager: Battle map data set with %zu buildings", getBattleBuildings().size());
 }
 
 const BattleMapData& VillageDataManager::getBattleMapData() const {
-  return _battleMapData;
+  static const BattleMapData empty;
+  return _battleMap ? *_battleMap : empty;
 }
 
 void VillageDataManager::generateRandomBattleMap(int difficulty) {
-  _battleMapData = RandomBattleMapGenerator::generate(difficulty);
+  setBattleMapData(std::make_shared<BattleMapData>(RandomBattleMapGenerator::generate(difficulty)));
   CCLOG("VillageDataManager: Generated random battle map (difficulty=%d, buildings=%zu)",
-        _battleMapData.difficulty, _battleMapData.buildings.size());
+        _battleMap->difficulty, _battleMap->buildings.size());
 }
 
 bool VillageDataManager::hasBattleMapData() const {
-  return !_battleMapData.buildings.empty();
+  return !getBattleBuildings().empty();
+}
+
+const std::vector<BuildingInstance>& VillageDataManager::getBattleBuildings() const {
+  static const std::vector<BuildingInstance> empty;
+  return _battleLayout ? *_battleLayout : empty;
+}
+
+const BuildingInstance* VillageDataManager::getBattleBuilding(int id) const {
+  int index = _battleState.indexOf(id);
+  return index >= 0 ? &getBattleBuildings()[index] : nullptr;
+}
+
+void VillageDataManager::resetBattleState() {
+  _battleState.reset(getBattleBuildings());
 }
 
 void VillageDataManager::setInBattleMode(bool inBattle) {
@@ -1155,9 +1044,15 @@ void VillageDataManager::setInBattleMode(bool inBattle) {
   _inBattleMode = inBattle;
   
   if (inBattle) {
+    // 上一场战斗结束时状态表已丢弃，按当前布局重新创建
+    if (_battleState.size() != static_cast<int>(getBattleBuildings().size())) {
+      resetBattleState();
+    }
     updateBattleGridOccupancy();
-    CCLOG("VillageDataManager: Entered BATTLE MODE (buildings=%zu)", _battleMapData.buildings.size());
+    CCLOG("VillageDataManager: Entered BATTLE MODE (buildings=%zu)", getBattleBuildings().size());
   } else {
+    _battleState.clear();
+
     // 清空战斗网格占用状态
     for (auto& row : _battleGridOccupancy) {
       std::fill(row.begin(), row.end(), 0);
@@ -1177,8 +1072,10 @@ void VillageDataManager::updateBattleGridOccupancy() {
   }
   
   // 标记战斗地图中所有建筑占用的网格
-  for (const auto& building : _battleMapData.buildings) {
-    if (building.isDestroyed) {
+  const auto& buildings = getBattleBuildings();
+  for (size_t i = 0; i < buildings.size(); ++i) {
+    const auto& building = buildings[i];
+    if (_battleState.isDestroyed(static_cast<int>(i))) {
       continue;
     }
     
@@ -1198,23 +1095,13 @@ void VillageDataManager::updateBattleGridOccupancy() {
   CCLOG("VillageDataManager: Battle grid occupancy updated");
 }
 
-void VillageDataManager::clearBattleMap() {
-    if (_inBattleMode) {
-        _battleMapData.buildings.clear();
-        CCLOG("VillageDataManager: Battle map cleared (%zu buildings removed)",
-              _battleMapData.buildings.size());
-    } else {
-        CCLOG("VillageDataManager: WARNING - clearBattleMap called but not in battle mode");
-    }
-}
-
-void VillageDataManager::addBattleBuildingFromReplay(const BuildingInstance& building) {
+void VillageDataManager::loadBattleLayout(const BattleLayout& layout) {
     if (_inBattleMode) {
-        _battleMapData.buildings.push_back(building);
-        CCLOG("VillageDataManager: Added replay building ID=%d, type=%d to battle map (total: %zu)",
-              building.id, building.type, _battleMapData.buildings.size());
+        _battleLayout = layout;
+        resetBattleState();
+        CCLOG("VillageDataManager: Loaded replay layout with %zu buildings", getBattleBuildings().size());
     } else {
-        CCLOG("VillageDataManager: WARNING - addBattleBuildingFromReplay called but not in battle mode");
+        CCLOG("VillageDataManager: WARNING - loadBattleLayout called but not in battle mode");
     }
 }
 
@@ -1224,7 +1111,7 @@ int VillageDataManager::getCurrentThemeId() const {
 
 void VillageDataManager::setCurrentTheme(int themeId) {
     _currentThemeId = themeId;
-    saveToFile("village.json");  
+    requestSave();
     CCLOG("VillageDataManager: Theme switched to %d", themeId);
 }
 
@@ -1234,6 +1121,6 @@ bool VillageDataManager::isThemePurchased(int themeId) const {
 
 void VillageDataManager::purchaseTheme(int themeId) {
     _purchasedThemes.insert(themeId);
-    saveToFile("village.json");  
+    requestSave();
     CCLOG("VillageDataManager: Theme %d purchased", themeId);
 }
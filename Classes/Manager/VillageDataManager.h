@@ -4,6 +4,7 @@
 #pragma once
 #include "../Model/VillageData.h"
 #include "../Model/BattleMapData.h"
+#include "../Model/BattleBuildingStore.h"
 #include <functional>
 #include <ctime>
 #include "../Model/TroopConfig.h"
@@ -29,10 +30,10 @@ public:
 
   void checkAndFinishConstructions();
 
-  // 建筑接口
+  // 建筑接口（战斗模式下返回只读的战斗布局，实时状态见 getBattleState）
   const std::vector<BuildingInstance>& getAllBuildings() const;
-  BuildingInstance* getBuildingById(int id);
-  BuildingInstance* getBuildingAtGrid(int gridX, int gridY);
+  BuildingInstance* getBuildingById(int id);                     // 只用于村庄，战斗中返回 nullptr
+  const BuildingInstance* getBuildingAtGrid(int gridX, int gridY) const;
 
   int addBuilding(int type, int level, int gridX, int gridY,
                   BuildingInstance::State state,
@@ -55,7 +56,9 @@ public:
 
   // 存档/读档
   void loadFromFile(const std::string& filename);
-  void saveToFile(const std::string& filename);
+  void saveToFile(const std::string& filename);     // 立即同步写入
+  void requestSave();                               // 标记有修改，由 VillageSaveService 合并后在后台写入
+  VillageSaveSnapshot createSaveSnapshot() const;   // 拷贝当前存档状态
 
   // 军队与兵营接口
   int getTownHallLevel() const;
@@ -97,8 +100,15 @@ public:
   void addGems(int amount) { addGem(amount); }
 
   // 战斗地图
-  void setBattleMapData(const BattleMapData& data);
+  // 地图和布局是共享的只读快照；战斗中的 HP/摧毁/冷却/锁定目标在状态表中，与布局按下标对应
+  void setBattleMapData(BattleMapSnapshot map);
   const BattleMapData& getBattleMapData() const;
+  BattleLayout getBattleLayout() const { return _battleLayout; }
+  const std::vector<BuildingInstance>& getBattleBuildings() const;
+  const BuildingInstance* getBattleBuilding(int id) const;
+  BattleBuildingStore& getBattleState() { return _battleState; }
+  const BattleBuildingStore& getBattleState() const { return _battleState; }
+  void resetBattleState();                                      // 按布局重建状态表
   void generateRandomBattleMap(int difficulty = 0);
   bool hasBattleMapData() const;
   
@@ -107,9 +117,8 @@ public:
   bool isInBattleMode() const;
   void updateBattleGridOccupancy();
 
-  // 回放相关方法
-  void clearBattleMap();
-  void addBattleBuildingFromReplay(const BuildingInstance& building);
+  // 回放相关方法：切换到回放的初始布局并重建状态表
+  void loadBattleLayout(const BattleLayout& layout);
 
   // 场景管理
   int getCurrentThemeId() const;
@@ -132,7 +141,9 @@ private:
 
   ResourceCallback _resourceCallback;
   
-  BattleMapData _battleMapData;
+  BattleMapSnapshot _battleMap;                     // 当前对手（只读快照）
+  BattleLayout _battleLayout;                       // 当前布局（对手地图或回放）
+  BattleBuildingStore _battleState;                 // 战斗状态表（战斗期间存在）
   bool _inBattleMode = false;
 
   int _currentThemeId;
@@ -0,0 +1,281 @@
+﻿// VillageSaveService.cpp
+// 村庄存档写回服务实现
+
+#include "VillageSaveService.h"
+#include "VillageDataManager.h"
+#include "Model/VillageJournal.h"
+#include "Model/VillageSaveCodec.h"
+#include "cocos2d.h"
+#include <chrono>
+#include <thread>
+
+USING_NS_CC;
+
+VillageSaveService* VillageSaveService::_instance = nullptr;
+const char* VillageSaveService::SAVE_FILE = "village.json";
+
+namespace {
+
+const char* COMMIT_SCHEDULE_KEY = "VillageSaveService::commit";
+const char* TEMP_SUFFIX = ".tmp";
+
+} // namespace
+
+VillageSaveService* VillageSaveService::getInstance() {
+    if (!_instance) {
+        _instance = new VillageSaveService();
+    }
+    return _instance;
+}
+
+void VillageSaveService::destroyInstance() {
+    CC_SAFE_DELETE(_instance);
+}
+
+VillageSaveService::VillageSaveService() {
+    // 导演重置（程序退出）时先于 FileUtils / AsyncTaskPool 销毁触发，此时写入最后的修改
+    _resetListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(
+        Director::EVENT_RESET, [this](EventCustom*) {
+            flush();
+        });
+}
+
+VillageSaveService::~VillageSaveService() {
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_resetListener);
+    flush();
+
+    // 已被 flush 写过的 IO 任务只会空跑，等待它们结束后再释放
+    const int maxWaitMs = 3000;
+    for (int waited = 0; _pendingWrites > 0 && waited < maxWaitMs; ++waited) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void VillageSaveService::markDirty() {
+    _dirty = true;
+    if (_commitScheduled) return;
+
+    // 只在首次修改时计时，连续修改不会无限推迟写入
+    _commitScheduled = true;
+    Director::getInstance()->getScheduler()->schedule(
+        [this](float) {
+            _commitScheduled = false;
+            commit();
+        },
+        this, 0, 0, SAVE_DELAY, false, COMMIT_SCHEDULE_KEY);
+}
+
+void VillageSaveService::flush() {
+    cancelScheduledCommit();
+
+    if (_dirty) {
+        auto pending = takeSnapshot();
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        _pending = pending;
+    }
+
+    // 在当前线程写完最新快照，IO 线程上的旧快照随后会被丢弃
+    writePending();
+}
+
+void VillageSaveService::saveNow() {
+    {
+        std::lock_guard<std::mutex> lock(_fileMutex);
+        _needsCompaction = true;
+    }
+    _dirty = true;
+    flush();
+}
+
+void VillageSaveService::discard() {
+    cancelScheduledCommit();
+    _dirty = false;
+
+    {
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        _pending.reset();
+    }
+
+    // 等待正在进行的写入完成，并让已排队的快照全部失效
+    std::lock_guard<std::mutex> lock(_fileMutex);
+    _writtenSequence = _nextSequence;
+}
+
+void VillageSaveService::deleteSaveFiles() {
+    discard();
+
+    std::lock_guard<std::mutex> lock(_fileMutex);
+    auto fileUtils = FileUtils::getInstance();
+    for (const std::string& path : { getSavePath(), getSavePath() + TEMP_SUFFIX,
+                                     getJournalPath(), getJournalPath() + TEMP_SUFFIX }) {
+        if (fileUtils->isFileExist(path)) {
+            fileUtils->removeFile(path);
+            CCLOG("VillageSaveService: Deleted %s", path.c_str());
+        }
+    }
+
+    _base.reset();
+    _generation = 0;
+    _journalBytes = 0;
+    _needsCompaction = true;
+}
+
+int VillageSaveService::replayJournal(uint64_t generation, VillageSaveSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(_fileMutex);
+    _generation = generation;
+
+    std::string journalPath = getJournalPath();
+    auto result = VillageJournal::replayFile(journalPath, generation, snapshot);
+    _journalBytes = result.validBytes;
+
+    // 尾部损坏或日志属于旧快照时不能继续追加，下次写入先压缩
+    _needsCompaction = !result.headerValid || result.tornTail;
+
+    if (result.batchesApplied > 0) {
+        CCLOG("VillageSaveService: Replayed %d journal batches from %s", result.batchesApplied, journalPath.c_str());
+    }
+    if (result.tornTail) {
+        CCLOG("VillageSaveService: WARNING - Ignored incomplete journal tail (%zu bytes kept)", result.validBytes);
+    }
+    return result.batchesApplied;
+}
+
+void VillageSaveService::setBaseSnapshot(const VillageSaveSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(_fileMutex);
+    _base = std::make_shared<VillageSaveSnapshot>(snapshot);
+}
+
+void VillageSaveService::commit() {
+    if (!_dirty) return;
+
+    auto pending = takeSnapshot();
+
+    bool enqueueWriter = false;
+    {
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        _pending = pending;
+        enqueueWriter = !_writerQueued;
+        _writerQueued = true;
+    }
+
+    // IO 线程已有排队任务时只替换快照，由它写入最新状态
+    if (!enqueueWriter) return;
+
+    _pendingWrites++;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO,
+        [](void*) {},
+        nullptr,
+        [this]() {
+            writePending();
+            _pendingWrites--;
+        });
+}
+
+std::shared_ptr<VillageSaveService::PendingSave> VillageSaveService::takeSnapshot() {
+    auto pending = std::make_shared<PendingSave>();
+    pending->snapshot = std::make_shared<VillageSaveSnapshot>(VillageDataManager::getInstance()->createSaveSnapshot());
+    pending->sequence = ++_nextSequence;
+    _dirty = false;
+    return pending;
+}
+
+void VillageSaveService::writePending() {
+    std::shared_ptr<PendingSave> pending;
+    {
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        pending.swap(_pending);
+        _writerQueued = false;
+    }
+    if (!pending) return;
+
+    std::lock_guard<std::mutex> lock(_fileMutex);
+    if (pending->sequence <= _writtenSequence) return;
+
+    bool needsCompaction = _needsCompaction || !_base || _journalBytes >= JOURNAL_COMPACT_BYTES;
+    bool success = needsCompaction ? compact(*pending->snapshot) : appendJournal(*pending->snapshot);
+
+    // 追加失败时日志状态未知，改为写完整快照
+    if (!success && !needsCompaction) {
+        success = compact(*pending->snapshot);
+    }
+
+    if (success) {
+        _writtenSequence = pending->sequence;
+        _base = pending->snapshot;
+    } else {
+        CCLOG("VillageSaveService: ERROR - Failed to save %s", getSavePath().c_str());
+    }
+}
+
+bool VillageSaveService::appendJournal(const VillageSaveSnapshot& snapshot) {
+    std::vector<uint8_t> changes = VillageJournal::encodeChanges(*_base, snapshot);
+    if (changes.empty()) return true;
+
+    std::vector<uint8_t> batch = VillageJournal::encodeBatch(changes);
+    if (!VillageJournal::appendToFile(getJournalPath(), batch)) {
+        _needsCompaction = true;
+        return false;
+    }
+
+    _journalBytes += batch.size();
+    CCLOG("VillageSaveService: Appended %zu bytes to journal (%zu total)", batch.size(), _journalBytes);
+    return true;
+}
+
+bool VillageSaveService::compact(const VillageSaveSnapshot& snapshot) {
+    // 新快照带上新代数后旧日志自动失效，之后再换成空日志；两步之间中断也不会重复回放
+    uint64_t generation = _generation + 1;
+    std::string savePath = getSavePath();
+    if (!writeAtomically(savePath, VillageSaveCodec::write(snapshot, generation))) {
+        return false;
+    }
+    _generation = generation;
+
+    if (VillageJournal::resetFile(getJournalPath(), generation)) {
+        _journalBytes = VillageJournal::encodeHeader(generation).size();
+        _needsCompaction = false;
+    } else {
+        _needsCompaction = true;
+    }
+
+    CCLOG("VillageSaveService: Compacted save to %s (generation %llu)",
+          savePath.c_str(), static_cast<unsigned long long>(generation));
+    return true;
+}
+
+std::string VillageSaveService::getSavePath() {
+    return FileUtils::getInstance()->getWritablePath() + SAVE_FILE;
+}
+
+std::string VillageSaveService::getJournalPath() {
+    return getSavePath() + VillageJournal::FILE_SUFFIX;
+}
+
+void VillageSaveService::cancelScheduledCommit() {
+    if (!_commitScheduled) return;
+
+    Director::getInstance()->getScheduler()->unschedule(COMMIT_SCHEDULE_KEY, this);
+    _commitScheduled = false;
+}
+
+bool VillageSaveService::writeAtomically(const std::string& fullPath, const std::string& content) {
+    auto fileUtils = FileUtils::getInstance();
+    std::string tempPath = fullPath + TEMP_SUFFIX;
+
+    if (!fileUtils->writeStringToFile(content, tempPath)) {
+        return false;
+    }
+    return fileUtils->renameFile(tempPath, fullPath);
+}
+
+void VillageSaveService::recoverInterruptedSave(const std::string& fullPath) {
+    auto fileUtils = FileUtils::getInstance();
+    std::string tempPath = fullPath + TEMP_SUFFIX;
+
+    if (fileUtils->isFileExist(fullPath) || !fileUtils->isFileExist(tempPath)) return;
+
+    // 临时文件只在完整写入后才会被重命名，目标文件缺失说明重命名被中断
+    if (fileUtils->renameFile(tempPath, fullPath)) {
+        CCLOG("VillageSaveService: Recovered save from %s", tempPath.c_str());
+    }
+}
@@ -0,0 +1,88 @@
+﻿// VillageSaveService.h
+// 村庄存档写回服务头文件，合并短时间内的多次修改，在 IO 线程追加日志或原子写入存档
+
+#ifndef __VILLAGE_SAVE_SERVICE_H__
+#define __VILLAGE_SAVE_SERVICE_H__
+
+#include "Model/VillageData.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cocos2d { class EventListenerCustom; }
+
+// 村庄存档写回服务
+// - markDirty() 只置脏标记，SAVE_DELAY 秒后统一取一次快照，期间的修改合并为一次写入
+// - 写盘在 IO 线程执行：平时只把与上次写入的差异追加到日志（见 VillageJournal）
+// - 日志超过 JOURNAL_COMPACT_BYTES 时压缩：先写临时文件再重命名生成新快照，再换成空日志
+// - IO 线程忙时新快照覆盖还没写的旧快照，只写最新状态
+// - flush() 在主线程同步写入，进入后台和导演重置（退出）时自动调用
+class VillageSaveService {
+public:
+    static const char* SAVE_FILE;                   // "village.json"
+    static constexpr float SAVE_DELAY = 0.5f;       // 首次修改到写入的延迟（秒）
+    static const size_t JOURNAL_COMPACT_BYTES = 64 * 1024;  // 日志压缩阈值
+
+    static VillageSaveService* getInstance();
+    static void destroyInstance();
+
+    void markDirty();                               // 标记存档需要写入（主线程）
+    void flush();                                   // 同步写入所有未保存的修改
+    void saveNow();                                 // 立即同步写入完整快照并清空日志
+    void discard();                                 // 丢弃未写入的修改
+    void deleteSaveFiles();                         // 丢弃修改并删除快照和日志
+    bool isDirty() const { return _dirty; }
+
+    // 读档：在快照上回放代数匹配的日志，返回回放的批次数；读档完成后用 setBaseSnapshot 记录磁盘上的状态
+    int replayJournal(uint64_t generation, VillageSaveSnapshot& snapshot);
+    void setBaseSnapshot(const VillageSaveSnapshot& snapshot);
+
+    // 写临时文件后重命名覆盖目标文件
+    static bool writeAtomically(const std::string& fullPath, const std::string& content);
+
+    // 上次重命名前中断时目标文件可能已被删除，用临时文件恢复
+    static void recoverInterruptedSave(const std::string& fullPath);
+
+private:
+    VillageSaveService();
+    ~VillageSaveService();
+
+    static VillageSaveService* _instance;
+
+    struct PendingSave {
+        std::shared_ptr<const VillageSaveSnapshot> snapshot;
+        uint64_t sequence;
+    };
+
+    void commit();                                  // 取快照并投递到 IO 线程
+    std::shared_ptr<PendingSave> takeSnapshot();
+    void writePending();                            // 写入最新的待写快照（IO 线程或 flush 调用）
+    bool appendJournal(const VillageSaveSnapshot& snapshot);   // 调用方持有 _fileMutex
+    bool compact(const VillageSaveSnapshot& snapshot);         // 调用方持有 _fileMutex
+    static std::string getSavePath();
+    static std::string getJournalPath();
+    void cancelScheduledCommit();
+
+    bool _dirty = false;
+    bool _commitScheduled = false;
+    uint64_t _nextSequence = 0;                     // 只在主线程递增
+
+    std::mutex _pendingMutex;                       // 保护 _pending / _writerQueued
+    std::shared_ptr<PendingSave> _pending;          // 等待写入的最新快照
+    bool _writerQueued = false;
+
+    std::mutex _fileMutex;                          // 串行化磁盘写入，保护以下字段
+    uint64_t _writtenSequence = 0;                  // 已写入的最新快照序号，更旧的快照直接丢弃
+    std::shared_ptr<const VillageSaveSnapshot> _base;  // 磁盘上（快照 + 日志）的当前状态，日志差异的基准
+    uint64_t _generation = 0;                       // 当前快照和日志的代数
+    size_t _journalBytes = 0;                       // 当前日志大小
+    bool _needsCompaction = true;                   // 日志缺失、损坏或代数不匹配时下次写入必须压缩
+
+    std::atomic<int> _pendingWrites{ 0 };           // 排队中的 IO 任务数
+    cocos2d::EventListenerCustom* _resetListener = nullptr;
+};
+
+#endif // __VILLAGE_SAVE_SERVICE_H__
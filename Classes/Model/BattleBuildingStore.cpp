@@ -0,0 +1,105 @@
+﻿// BattleBuildingStore.cpp
+// 战斗建筑状态表实现
+
+#include "BattleBuildingStore.h"
+#include "BuildingConfig.h"
+#include <algorithm>
+
+void BattleBuildingStore::reset(const std::vector<BuildingInstance>& layout) {
+    size_t count = layout.size();
+    _info.resize(count);
+    _hp.resize(count);
+    _flags.assign(count, 0);
+    _cooldown.assign(count, 0.0f);
+    _target.assign(count, UnitHandle());
+
+    _indexById.clear();
+    _indexById.reserve(count);
+    _dirty.clear();
+    auto buildingConfig = BuildingConfig::getInstance();
+    for (size_t i = 0; i < count; ++i) {
+        const auto& building = layout[i];
+        auto config = buildingConfig->getConfig(building.type);
+
+        BattleBuildingInfo& info = _info[i];
+        info = BattleBuildingInfo();
+        info.id = building.id;
+        info.type = building.type;
+        info.gridX = building.gridX;
+        info.gridY = building.gridY;
+        info.active = config && building.state != BuildingInstance::State::PLACING;
+        info.isDefense = (building.type == 301 || building.type == 302);
+        info.isResource = (building.type == 1 || (building.type >= 202 && building.type <= 205));
+        info.isWall = (building.type == 303);
+        info.isTrap = (building.type >= 400 && building.type < 500);
+        info.hitsAir = (building.type == 302);
+        info.isTracked = !info.isWall && !info.isTrap && building.state == BuildingInstance::State::BUILT;
+        if (config) {
+            info.gridWidth = config->gridWidth;
+            info.gridHeight = config->gridHeight;
+            info.maxHP = config->hitPoints;
+            info.damagePerSecond = config->damagePerSecond;
+            info.attackRange = config->attackRange;
+            info.attackSpeed = config->attackSpeed;
+        }
+
+        _hp[i] = building.currentHP;
+        if (building.isDestroyed) _flags[i] |= FLAG_DESTROYED;
+        _indexById[building.id] = static_cast<int>(i);
+        markDirty(static_cast<int>(i));
+    }
+}
+
+void BattleBuildingStore::clear() {
+    _info.clear();
+    _hp.clear();
+    _flags.clear();
+    _cooldown.clear();
+    _target.clear();
+    _indexById.clear();
+    _dirty.clear();
+}
+
+int BattleBuildingStore::indexOf(int buildingId) const {
+    auto it = _indexById.find(buildingId);
+    return it != _indexById.end() ? it->second : -1;
+}
+
+int BattleBuildingStore::applyDamage(int i, int damage) {
+    if (!isAlive(i) || damage <= 0) return 0;
+
+    int dealt = std::min(damage, _hp[i]);
+    _hp[i] -= dealt;
+    markDirty(i);
+    if (_hp[i] <= 0) destroy(i);
+    return dealt;
+}
+
+void BattleBuildingStore::destroy(int i) {
+    _hp[i] = 0;
+    _flags[i] |= FLAG_DESTROYED;
+    _target[i] = UnitHandle();
+    markDirty(i);
+}
+
+void BattleBuildingStore::restore(int i, int hp, bool destroyed, float cooldown) {
+    _hp[i] = hp;
+    _flags[i] = (_flags[i] & FLAG_DIRTY) | (destroyed ? FLAG_DESTROYED : 0);
+    _cooldown[i] = cooldown;
+    _target[i] = UnitHandle();
+    markDirty(i);
+}
+
+void BattleBuildingStore::clearDirty() {
+    for (int i : _dirty) {
+        _flags[i] &= static_cast<uint8_t>(~FLAG_DIRTY);
+    }
+    _dirty.clear();
+}
+
+void BattleBuildingStore::markDirty(int i) {
+    if (_flags[i] & FLAG_DIRTY) return;
+
+    _flags[i] |= FLAG_DIRTY;
+    _dirty.push_back(i);
+}
@@ -0,0 +1,101 @@
+﻿// BattleBuildingStore.h
+// 战斗建筑状态表声明，以结构数组存放战斗中会变化的建筑字段（生命值、摧毁标志、冷却、锁定目标）及战斗规则用的静态数据
+
+#ifndef __BATTLE_BUILDING_STORE_H__
+#define __BATTLE_BUILDING_STORE_H__
+
+#include "VillageData.h"
+#include "BattleUnitStore.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 战斗规则用的建筑静态数据（开战时从布局和 BuildingConfig 拷贝，战斗中只读）
+// 实时战斗和无界面模拟都通过它访问建筑尺寸和攻防参数，不在每帧查询配置单例
+struct BattleBuildingInfo {
+    int id = 0;
+    int type = 0;
+    int gridX = 0;
+    int gridY = 0;
+    int gridWidth = 1;
+    int gridHeight = 1;
+    int maxHP = 0;              // 配置满血量（摧毁进度的分母）
+    int damagePerSecond = 0;
+    int attackRange = 0;
+    float attackSpeed = 1.0f;
+    bool active = false;        // 有配置且不在放置中，参与战斗
+    bool isDefense = false;     // 加农炮 / 箭塔
+    bool isResource = false;    // 大本营 / 资源建筑
+    bool isWall = false;
+    bool isTrap = false;
+    bool isTracked = false;     // 计入摧毁进度（与 DestructionTracker::isTrackedBuilding 一致）
+    bool hitsAir = false;       // 能攻击飞行单位
+};
+
+// 战斗建筑状态表
+// 职责：按下标与静态布局（BattleLayout 中的建筑列表）一一对应，开战时由布局创建，战斗结束后丢弃
+// 布局和存档中的 BuildingInstance 在战斗中不再被修改，各战斗系统只读写这张表
+// 建筑不会在战斗中增删，下标在整场战斗中保持不变
+// 生命值或摧毁状态变化的下标记入脏集合，显示层每帧只同步这些建筑的精灵
+class BattleBuildingStore {
+public:
+    // 状态标志位
+    enum Flag : uint8_t {
+        FLAG_DESTROYED = 1 << 0,            // 已被摧毁
+        FLAG_DIRTY = 1 << 1                 // 已在脏集合中（显示待同步）
+    };
+
+    // 按布局重建状态表（生命值取布局中的初始值），所有建筑标记为脏
+    // 同时从 BuildingConfig 拷贝静态数据，只能在主线程调用；工作线程使用已重建好的表的副本
+    void reset(const std::vector<BuildingInstance>& layout);
+
+    // 清空状态表
+    void clear();
+
+    int size() const { return static_cast<int>(_hp.size()); }
+    bool empty() const { return _hp.empty(); }
+
+    // 查找建筑ID对应的下标，不存在返回 -1
+    int indexOf(int buildingId) const;
+
+    // ========== 字段访问 ==========
+    const BattleBuildingInfo& getInfo(int i) const { return _info[i]; }
+
+    int getHP(int i) const { return _hp[i]; }
+    bool isDestroyed(int i) const { return (_flags[i] & FLAG_DESTROYED) != 0; }
+    bool isAlive(int i) const { return _hp[i] > 0 && (_flags[i] & FLAG_DESTROYED) == 0; }
+
+    // 扣除生命值，返回实际扣除量；生命值归零时标记为摧毁
+    int applyDamage(int i, int damage);
+
+    // 直接摧毁（陷阱触发后）
+    void destroy(int i);
+
+    // 恢复到指定状态（回放关键帧）
+    void restore(int i, int hp, bool destroyed, float cooldown);
+
+    float getCooldown(int i) const { return _cooldown[i]; }
+    void setCooldown(int i, float cooldown) { _cooldown[i] = cooldown; }
+
+    // 防御建筑锁定的单位句柄，无目标为空句柄（使用前经 BattleUnitStore::resolve 校验）
+    const UnitHandle& getTarget(int i) const { return _target[i]; }
+    void setTarget(int i, const UnitHandle& unit) { _target[i] = unit; }
+
+    // ========== 脏集合 ==========
+    // 自上次 clearDirty 以来生命值或摧毁状态变化过的下标（不重复）
+    const std::vector<int>& getDirty() const { return _dirty; }
+    void clearDirty();
+
+private:
+    std::vector<BattleBuildingInfo> _info;
+    std::vector<int> _hp;
+    std::vector<uint8_t> _flags;
+    std::vector<float> _cooldown;
+    std::vector<UnitHandle> _target;
+    std::unordered_map<int, int> _indexById;
+    std::vector<int> _dirty;
+
+    void markDirty(int i);
+};
+
+#endif // __BATTLE_BUILDING_STORE_H__
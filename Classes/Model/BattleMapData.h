@@ -2,6 +2,7 @@
 // 战斗地图数据结构，存储敌方阵型和奖励信息
 
 #pragma once
+#include <memory>
 #include <vector>
 #include "VillageData.h"
 
@@ -27,3 +28,8 @@ struct BattleMapData {
         , goldStorageCount(0)
         , elixirStorageCount(0) {}
 };
+
+// 只读共享的快照：生成后不再修改，战斗、录制、回放和"下一个对手"之间传递指针而不是深拷贝
+// 战斗中会变化的 HP/摧毁/冷却 在 VillageDataManager 的运行时建筑列表中，不写回快照
+using BattleMapSnapshot = std::shared_ptr<const BattleMapData>;
+using BattleLayout = std::shared_ptr<const std::vector<BuildingInstance>>;   // 只有建筑布局（回放只需要这部分）
@@ -0,0 +1,109 @@
+﻿// BattleStateHash.cpp
+// 战斗状态哈希实现
+
+#include "BattleStateHash.h"
+#include "BattleBuildingStore.h"
+#include "BattleUnitStore.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+void appendField(std::ostringstream& out, const char* name, int expected, int actual) {
+    if (expected == actual) return;
+    if (out.tellp() > 0) out << ", ";
+    out << name << ' ' << expected << " -> " << actual;
+}
+
+} // namespace
+
+uint64_t BattleStateHasher::mix(uint64_t hash, int64_t value) {
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (bits >> (i * 8)) & 0xFF;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+void BattleStateHasher::addBuilding(int id, int currentHP, bool isDestroyed) {
+    _buildingHash = mix(_buildingHash, id);
+    _buildingHash = mix(_buildingHash, currentHP);
+    _buildingHash = mix(_buildingHash, isDestroyed ? 1 : 0);
+
+    if (isDestroyed) {
+        _destroyedBuildings++;
+    } else {
+        _buildingHP += currentHP;
+    }
+}
+
+void BattleStateHasher::addUnit(int troopId, float gridX, float gridY, int currentHP) {
+    uint64_t unitHash = FNV_OFFSET;
+    unitHash = mix(unitHash, troopId);
+    unitHash = mix(unitHash, static_cast<int64_t>(std::floor(gridX)));
+    unitHash = mix(unitHash, static_cast<int64_t>(std::floor(gridY)));
+    unitHash = mix(unitHash, currentHP);
+    _unitHash += unitHash;
+
+    _aliveUnits++;
+    _unitHP += currentHP;
+}
+
+StateHashSample BattleStateHasher::finish(int tick) const {
+    StateHashSample sample;
+    sample.tick = tick;
+    sample.hash = mix(_buildingHash, static_cast<int64_t>(_unitHash));
+    sample.buildingHP = _buildingHP;
+    sample.destroyedBuildings = _destroyedBuildings;
+    sample.aliveUnits = _aliveUnits;
+    sample.unitHP = _unitHP;
+    return sample;
+}
+
+StateHashSample BattleStateHasher::sample(const BattleBuildingStore& buildings, const BattleUnitStore& units, int tick) {
+    BattleStateHasher hasher;
+    for (int i = 0; i < buildings.size(); ++i) {
+        hasher.addBuilding(buildings.getInfo(i).id, buildings.getHP(i), buildings.isDestroyed(i));
+    }
+    for (int i = 0; i < units.size(); ++i) {
+        if (units.isDead(i)) continue;
+        hasher.addUnit(static_cast<int>(units.getType(i)), units.getGridX(i), units.getGridY(i), units.getHP(i));
+    }
+    return hasher.finish(tick);
+}
+
+const StateHashSample* BattleStateHasher::findSample(const std::vector<StateHashSample>& samples, int tick) {
+    auto it = std::lower_bound(samples.begin(), samples.end(), tick,
+                               [](const StateHashSample& sample, int t) { return sample.tick < t; });
+    return (it != samples.end() && it->tick == tick) ? &*it : nullptr;
+}
+
+bool BattleStateHasher::matches(const std::vector<StateHashSample>& expected, const StateHashSample& actual) {
+    const StateHashSample* reference = findSample(expected, actual.tick);
+    return !reference || reference->hash == actual.hash;
+}
+
+int BattleStateHasher::findFirstDivergence(const std::vector<StateHashSample>& expected,
+                                           const std::vector<StateHashSample>& actual) {
+    for (size_t i = 0; i < actual.size(); ++i) {
+        if (!matches(expected, actual[i])) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+std::string BattleStateHasher::describeDiff(const StateHashSample& expected, const StateHashSample& actual) {
+    std::ostringstream out;
+    appendField(out, "buildingHP", expected.buildingHP, actual.buildingHP);
+    appendField(out, "destroyedBuildings", expected.destroyedBuildings, actual.destroyedBuildings);
+    appendField(out, "aliveUnits", expected.aliveUnits, actual.aliveUnits);
+    appendField(out, "unitHP", expected.unitHP, actual.unitHP);
+
+    // 摘要一致而哈希不同：差异在单位位置或建筑之间的血量分布
+    if (out.tellp() == 0) out << "unit positions or per-building HP differ";
+    return out.str();
+}
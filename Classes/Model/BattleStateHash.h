@@ -0,0 +1,64 @@
+﻿// BattleStateHash.h
+// 战斗状态哈希声明，按固定步长间隔对战斗状态取滚动哈希：实时战斗用于检测回放与录制是否一致，无界面模拟器用于检测重算结果与保存时的基准是否一致
+
+#ifndef __BATTLE_STATE_HASH_H__
+#define __BATTLE_STATE_HASH_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BattleBuildingStore;
+class BattleUnitStore;
+
+// 一次状态采样：哈希值加上少量摘要字段（哈希不一致时用摘要输出差异）
+struct StateHashSample {
+    int tick = 0;               // 采样序号（战斗时间 / SAMPLE_INTERVAL）
+    uint64_t hash = 0;          // 状态哈希
+    int buildingHP = 0;         // 建筑剩余血量合计
+    int destroyedBuildings = 0; // 已摧毁建筑数
+    int aliveUnits = 0;         // 存活单位数
+    int unitHP = 0;             // 存活单位血量合计
+};
+
+// 战斗状态哈希器（FNV-1a 64 位）
+// 建筑按传入顺序累加（建筑列表顺序固定）；单位各自哈希后相加，与单位在列表中的顺序无关
+// 单位位置按所在格子取整，避免浮点误差导致误报
+class BattleStateHasher {
+public:
+    static constexpr float SAMPLE_INTERVAL = 0.5f;   // 采样间隔（秒）
+
+    void addBuilding(int id, int currentHP, bool isDestroyed);
+    void addUnit(int troopId, float gridX, float gridY, int currentHP);
+
+    // 生成采样结果
+    StateHashSample finish(int tick) const;
+
+    // 对建筑状态表和存活单位取一次采样（实时战斗和无界面模拟共用同一套哈希方式）
+    static StateHashSample sample(const BattleBuildingStore& buildings, const BattleUnitStore& units, int tick);
+
+    // 在按序号排序的采样中查找指定序号，不存在返回 nullptr
+    static const StateHashSample* findSample(const std::vector<StateHashSample>& samples, int tick);
+
+    // 在 expected 中查找与 actual 同序号的采样并比较，序号不存在或一致返回 true
+    static bool matches(const std::vector<StateHashSample>& expected, const StateHashSample& actual);
+
+    // 第一个不一致的采样在 actual 中的下标，全部一致返回 -1（只比较两边都有的序号）
+    static int findFirstDivergence(const std::vector<StateHashSample>& expected,
+                                   const std::vector<StateHashSample>& actual);
+
+    // 描述两次采样的摘要差异，如 "buildingHP 5230 -> 5180, aliveUnits 12 -> 11"
+    static std::string describeDiff(const StateHashSample& expected, const StateHashSample& actual);
+
+private:
+    static uint64_t mix(uint64_t hash, int64_t value);
+
+    uint64_t _buildingHash = 14695981039346656037ULL;   // FNV 偏移基数
+    uint64_t _unitHash = 0;
+    int _buildingHP = 0;
+    int _destroyedBuildings = 0;
+    int _aliveUnits = 0;
+    int _unitHP = 0;
+};
+
+#endif // __BATTLE_STATE_HASH_H__
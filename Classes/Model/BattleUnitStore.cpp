@@ -0,0 +1,134 @@
+﻿// BattleUnitStore.cpp
+// 战斗单位数据存储实现，结构数组的增删和字段更新
+
+#include "BattleUnitStore.h"
+#include "../Sprite/BattleUnitSprite.h"
+#include <algorithm>
+
+int BattleUnitStore::add(UnitTypeID type, int maxHP, float gridX, float gridY, BattleUnitSprite* view) {
+    int index = size();
+
+    _gridX.push_back(gridX);
+    _gridY.push_back(gridY);
+    _hp.push_back(maxHP);
+    _maxHP.push_back(maxHP);
+    _type.push_back(type);
+    _flags.push_back(type == UnitTypeID::BALLOON ? FLAG_FLYING : 0);
+    _targetBuildingId.push_back(-1);
+    _forcedTargetId.push_back(-1);
+    _views.push_back(view);
+    _slot.push_back(allocateSlot(index));
+
+    if (view) view->bindStore(this, index);
+    return index;
+}
+
+void BattleUnitStore::remove(int index) {
+    if (index < 0 || index >= size()) return;
+
+    if (_views[index]) _views[index]->unbindStore();
+    releaseSlot(_slot[index]);
+
+    int last = size() - 1;
+    if (index != last) {
+        _gridX[index] = _gridX[last];
+        _gridY[index] = _gridY[last];
+        _hp[index] = _hp[last];
+        _maxHP[index] = _maxHP[last];
+        _type[index] = _type[last];
+        _flags[index] = _flags[last];
+        _targetBuildingId[index] = _targetBuildingId[last];
+        _forcedTargetId[index] = _forcedTargetId[last];
+        _views[index] = _views[last];
+        _slot[index] = _slot[last];
+        _handleSlots[_slot[index]].index = index;
+
+        if (_views[index]) _views[index]->bindStore(this, index);
+    }
+
+    _gridX.pop_back();
+    _gridY.pop_back();
+    _hp.pop_back();
+    _maxHP.pop_back();
+    _type.pop_back();
+    _flags.pop_back();
+    _targetBuildingId.pop_back();
+    _forcedTargetId.pop_back();
+    _views.pop_back();
+    _slot.pop_back();
+}
+
+void BattleUnitStore::clear() {
+    for (auto view : _views) {
+        if (view) view->unbindStore();
+    }
+    for (int slot : _slot) {
+        releaseSlot(slot);
+    }
+
+    _gridX.clear();
+    _gridY.clear();
+    _hp.clear();
+    _maxHP.clear();
+    _type.clear();
+    _flags.clear();
+    _targetBuildingId.clear();
+    _forcedTargetId.clear();
+    _views.clear();
+    _slot.clear();
+}
+
+int BattleUnitStore::indexOf(const BattleUnitSprite* view) const {
+    auto it = std::find(_views.begin(), _views.end(), view);
+    return it != _views.end() ? static_cast<int>(it - _views.begin()) : -1;
+}
+
+int BattleUnitStore::applyDamage(int i, int damage) {
+    if (_hp[i] <= 0 || damage <= 0) return 0;
+
+    int dealt = std::min(damage, _hp[i]);
+    _hp[i] -= dealt;
+    return dealt;
+}
+
+void BattleUnitStore::setFlag(int i, Flag flag, bool value) {
+    if (value) {
+        _flags[i] |= flag;
+    } else {
+        _flags[i] &= static_cast<uint8_t>(~flag);
+    }
+}
+
+UnitHandle BattleUnitStore::getHandle(int i) const {
+    UnitHandle handle;
+    handle.slot = _slot[i];
+    handle.generation = _handleSlots[handle.slot].generation;
+    return handle;
+}
+
+int BattleUnitStore::resolve(const UnitHandle& handle) const {
+    if (handle.slot < 0 || handle.slot >= static_cast<int>(_handleSlots.size())) return -1;
+
+    const HandleSlot& slot = _handleSlots[handle.slot];
+    return slot.generation == handle.generation ? slot.index : -1;
+}
+
+int BattleUnitStore::allocateSlot(int index) {
+    int slot;
+    if (!_freeSlots.empty()) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        slot = static_cast<int>(_handleSlots.size());
+        _handleSlots.push_back(HandleSlot());
+    }
+    _handleSlots[slot].index = index;
+    return slot;
+}
+
+void BattleUnitStore::releaseSlot(int slot) {
+    // 代数递增使指向该槽位的旧句柄失效
+    _handleSlots[slot].index = -1;
+    ++_handleSlots[slot].generation;
+    _freeSlots.push_back(slot);
+}
@@ -0,0 +1,119 @@
+﻿// BattleUnitStore.h
+// 战斗单位数据存储声明，以结构数组（SoA）连续存放所有单位的战斗状态
+
+#ifndef __BATTLE_UNIT_STORE_H__
+#define __BATTLE_UNIT_STORE_H__
+
+#include <cstdint>
+#include <vector>
+
+class BattleUnitSprite;
+
+// 单位类型枚举（数值与兵种ID一致）
+enum class UnitTypeID {
+    UNKNOWN = 0,
+    BARBARIAN = 1001,
+    ARCHER = 1002,
+    GOBLIN = 1003,
+    GIANT = 1004,
+    WALL_BREAKER = 1005,
+    BALLOON = 1006
+};
+
+// 单位句柄：槽位 + 代数，单位移除后代数递增，旧句柄随之失效
+// 其它系统需要跨帧引用单位时保存句柄而不是精灵指针或下标，使用前经 BattleUnitStore::resolve 取得当前下标
+struct UnitHandle {
+    int slot = -1;
+    uint32_t generation = 0;
+
+    bool isNull() const { return slot < 0; }
+};
+
+// 战斗单位数据存储类
+// 职责：持有单位的位置、生命值、类型、状态标志和目标建筑（含强制攻击的城墙），每个字段一个连续数组
+// 防御/陷阱/目标查找等系统按下标顺序遍历数组，精灵只作为显示视图
+// 移除单位时与末尾交换（下标会变化），被移动单位的精灵会同步更新下标
+class BattleUnitStore {
+public:
+    // 状态标志位
+    enum Flag : uint8_t {
+        FLAG_FLYING = 1 << 0,            // 飞行单位（地面陷阱和加农炮无效）
+        FLAG_TARGETED = 1 << 1,          // 被防御建筑锁定
+        FLAG_CHANGING_TARGET = 1 << 2    // 正在切换目标
+    };
+
+    // 添加单位，返回下标并绑定精灵视图
+    int add(UnitTypeID type, int maxHP, float gridX, float gridY, BattleUnitSprite* view);
+
+    // 移除单位（与末尾交换后弹出），并解除精灵绑定
+    void remove(int index);
+
+    // 清空所有单位
+    void clear();
+
+    int size() const { return static_cast<int>(_views.size()); }
+    bool empty() const { return _views.empty(); }
+
+    // 查找精灵对应的下标，不存在返回 -1
+    int indexOf(const BattleUnitSprite* view) const;
+
+    // ========== 字段访问 ==========
+    float getGridX(int i) const { return _gridX[i]; }
+    float getGridY(int i) const { return _gridY[i]; }
+    void setGridPosition(int i, float gridX, float gridY) { _gridX[i] = gridX; _gridY[i] = gridY; }
+
+    int getHP(int i) const { return _hp[i]; }
+    int getMaxHP(int i) const { return _maxHP[i]; }
+    bool isDead(int i) const { return _hp[i] <= 0; }
+
+    // 扣除生命值，返回实际扣除量
+    int applyDamage(int i, int damage);
+
+    UnitTypeID getType(int i) const { return _type[i]; }
+
+    bool hasFlag(int i, Flag flag) const { return (_flags[i] & flag) != 0; }
+    void setFlag(int i, Flag flag, bool value);
+
+    // 目标建筑ID，无目标为 -1
+    int getTargetBuildingId(int i) const { return _targetBuildingId[i]; }
+    void setTargetBuildingId(int i, int buildingId) { _targetBuildingId[i] = buildingId; }
+
+    // 绕路代价过高时强制攻击的城墙ID，无为 -1
+    int getForcedTargetId(int i) const { return _forcedTargetId[i]; }
+    void setForcedTargetId(int i, int buildingId) { _forcedTargetId[i] = buildingId; }
+
+    BattleUnitSprite* getView(int i) const { return _views[i]; }
+    const std::vector<BattleUnitSprite*>& getViews() const { return _views; }
+
+    // ========== 句柄 ==========
+    UnitHandle getHandle(int i) const;
+
+    // 句柄对应的当前下标，单位已移除返回 -1
+    int resolve(const UnitHandle& handle) const;
+
+private:
+    // 句柄槽位：单位当前下标和代数，空闲槽位下标为 -1
+    struct HandleSlot {
+        int index = -1;
+        uint32_t generation = 0;
+    };
+
+    std::vector<float> _gridX;
+    std::vector<float> _gridY;
+    std::vector<int> _hp;
+    std::vector<int> _maxHP;
+    std::vector<UnitTypeID> _type;
+    std::vector<uint8_t> _flags;
+    std::vector<int> _targetBuildingId;
+    std::vector<int> _forcedTargetId;
+    std::vector<BattleUnitSprite*> _views;
+    std::vector<int> _slot;                 // 每个单位的句柄槽位
+
+    std::vector<HandleSlot> _handleSlots;
+    std::vector<int> _freeSlots;
+
+    int allocateSlot(int index);
+    void releaseSlot(int slot);
+};
+
+#endif // __BATTLE_UNIT_STORE_H__
@@ -45,7 +45,7 @@ public:
   // 根据建筑类型获取配置
   const BuildingConfigData* getConfig(int buildingType) const;
 
-  // 获取建筑精灵路径（根据类型和等级）
+  // 获取建筑精灵路径（根据类型和等级），同时也是图集中的帧名
   std::string getSpritePath(int buildingType, int level) const;
 
   // 获取建筑升级费用
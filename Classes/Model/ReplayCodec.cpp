@@ -0,0 +1,485 @@
+﻿// ReplayCodec.cpp
+// 回放二进制格式编解码实现
+
+#include "ReplayCodec.h"
+#include "../Util/BinaryStream.h"
+#include <cmath>
+
+USING_NS_CC;
+
+const uint32_t ReplayCodec::MAGIC = 0x4C505243;   // 小端序 "CRPL"
+const uint32_t ReplayCodec::INDEX_MAGIC = 0x58505243;   // 小端序 "CRPX"
+const char* ReplayCodec::FILE_EXTENSION = ".rpl";
+
+namespace {
+
+// 兵种ID以 1000 为基准存差值，常见兵种只占 1 字节
+const int TROOP_ID_BASE = 1000;
+
+int64_t quantizeTime(float seconds) {
+    return static_cast<int64_t>(std::lround(seconds / ReplayCodec::TIME_QUANTUM));
+}
+
+float dequantizeTime(int64_t ticks) {
+    return static_cast<float>(ticks) * ReplayCodec::TIME_QUANTUM;
+}
+
+int64_t quantizePosition(float cells) {
+    return static_cast<int64_t>(std::lround(cells / ReplayCodec::POSITION_QUANTUM));
+}
+
+float dequantizePosition(int64_t value) {
+    return static_cast<float>(value) * ReplayCodec::POSITION_QUANTUM;
+}
+
+void writeTroopMap(BinaryWriter& writer, const std::map<int, int>& troops) {
+    writer.writeVarUInt(troops.size());
+    for (const auto& pair : troops) {
+        writer.writeVarInt(pair.first - TROOP_ID_BASE);
+        writer.writeVarInt(pair.second);
+    }
+}
+
+void readTroopMap(BinaryReader& reader, std::map<int, int>& troops) {
+    uint64_t count = reader.readVarUInt();
+    for (uint64_t i = 0; i < count && reader.isValid(); ++i) {
+        int troopId = static_cast<int>(reader.readVarInt()) + TROOP_ID_BASE;
+        int value = static_cast<int>(reader.readVarInt());
+        troops[troopId] = value;
+    }
+}
+
+// 元数据字段，回放文件头部和索引文件共用
+void writeMetadataFields(BinaryWriter& writer, const ReplayMetadata& meta) {
+    writer.writeVarInt(meta.replayId);
+    writer.writeVarInt(static_cast<int64_t>(meta.timestamp));
+    writer.writeString(meta.defenderName);
+    writer.writeVarInt(quantizeTime(meta.battleDuration));
+    writer.writeVarInt(meta.finalStars);
+    writer.writeVarInt(meta.destructionPercentage);
+    writer.writeVarInt(meta.lootedGold);
+    writer.writeVarInt(meta.lootedElixir);
+    writeTroopMap(writer, meta.usedTroops);
+}
+
+// 写入头部（元数据部分在前，与 ReplayMetadata 字段一一对应）
+void writeHeader(BinaryWriter& writer, const BattleReplayData& data) {
+    writeMetadataFields(writer, data.toMetadata());
+
+    writer.writeVarInt(data.battleMapSeed);
+    writeTroopMap(writer, data.troopLevels);
+}
+
+// 关键帧：时间存差值，建筑状态只含与初始布局不同的建筑
+void writeKeyframes(BinaryWriter& writer, const std::vector<BattleKeyframe>& keyframes) {
+    writer.writeVarUInt(keyframes.size());
+    int64_t lastTicks = 0;
+    for (const auto& keyframe : keyframes) {
+        int64_t ticks = quantizeTime(keyframe.time);
+        writer.writeVarInt(ticks - lastTicks);
+        writer.writeVarInt(keyframe.eventIndex);
+        writer.writeVarInt(keyframe.lootedGold);
+        writer.writeVarInt(keyframe.lootedElixir);
+        writer.writeVarInt(std::lround(keyframe.destructionProgress * 100.0f));
+        writer.writeVarInt(keyframe.stars);
+        lastTicks = ticks;
+
+        writer.writeVarUInt(keyframe.buildings.size());
+        int lastId = 0;
+        for (const auto& building : keyframe.buildings) {
+            writer.writeVarInt(building.id - lastId);
+            writer.writeVarInt(building.currentHP);
+            writer.writeU8(building.isDestroyed ? 1 : 0);
+            writer.writeVarInt(quantizeTime(building.attackCooldown));
+            writer.writeVarInt(building.trapTimer < 0.0f ? -1 : quantizeTime(building.trapTimer));
+            lastId = building.id;
+        }
+
+        writer.writeVarUInt(keyframe.units.size());
+        for (const auto& unit : keyframe.units) {
+            writer.writeVarInt(unit.troopId - TROOP_ID_BASE);
+            writer.writeVarInt(quantizePosition(unit.gridX));
+            writer.writeVarInt(quantizePosition(unit.gridY));
+            writer.writeVarInt(unit.currentHP);
+            writer.writeVarInt(unit.targetBuildingId);
+
+            writer.writeU8(static_cast<uint8_t>(unit.aiState));
+            writer.writeVarInt(unit.forcedTargetId);
+            writer.writeVarInt(quantizeTime(unit.attackCooldown));
+            writer.writeVarUInt(unit.path.size());
+            for (const auto& waypoint : unit.path) {
+                writer.writeVarInt(quantizePosition(waypoint.x));
+                writer.writeVarInt(quantizePosition(waypoint.y));
+            }
+        }
+    }
+}
+
+bool readKeyframes(BinaryReader& reader, int version, std::vector<BattleKeyframe>& keyframes) {
+    uint64_t count = reader.readVarUInt();
+    if (count > reader.remaining()) return false;
+    keyframes.reserve(static_cast<size_t>(count));
+
+    int64_t lastTicks = 0;
+    for (uint64_t i = 0; i < count && reader.isValid(); ++i) {
+        BattleKeyframe keyframe;
+        lastTicks += reader.readVarInt();
+        keyframe.time = dequantizeTime(lastTicks);
+        keyframe.eventIndex = static_cast<int>(reader.readVarInt());
+        keyframe.lootedGold = static_cast<int>(reader.readVarInt());
+        keyframe.lootedElixir = static_cast<int>(reader.readVarInt());
+        keyframe.destructionProgress = static_cast<float>(reader.readVarInt()) / 100.0f;
+        keyframe.stars = static_cast<int>(reader.readVarInt());
+
+        uint64_t buildingCount = reader.readVarUInt();
+        if (buildingCount > reader.remaining()) return false;
+        keyframe.buildings.reserve(static_cast<size_t>(buildingCount));
+
+        int lastId = 0;
+        for (uint64_t j = 0; j < buildingCount && reader.isValid(); ++j) {
+            BuildingKeyframe building;
+            building.id = lastId + static_cast<int>(reader.readVarInt());
+            building.currentHP = static_cast<int>(reader.readVarInt());
+            building.isDestroyed = reader.readU8() != 0;
+            building.attackCooldown = dequantizeTime(reader.readVarInt());
+            int64_t trapTicks = reader.readVarInt();
+            building.trapTimer = trapTicks < 0 ? -1.0f : dequantizeTime(trapTicks);
+            lastId = building.id;
+            keyframe.buildings.push_back(building);
+        }
+
+        uint64_t unitCount = reader.readVarUInt();
+        if (unitCount > reader.remaining()) return false;
+        keyframe.units.reserve(static_cast<size_t>(unitCount));
+
+        for (uint64_t j = 0; j < unitCount && reader.isValid(); ++j) {
+            UnitKeyframe unit;
+            unit.troopId = static_cast<int>(reader.readVarInt()) + TROOP_ID_BASE;
+            unit.gridX = dequantizePosition(reader.readVarInt());
+            unit.gridY = dequantizePosition(reader.readVarInt());
+            unit.currentHP = static_cast<int>(reader.readVarInt());
+            unit.targetBuildingId = static_cast<int>(reader.readVarInt());
+
+            // 版本 5 起保存 AI 状态，旧版恢复时重新选择目标
+            unit.aiState = UnitAIState::IDLE;
+            unit.forcedTargetId = -1;
+            unit.attackCooldown = 0.0f;
+            if (version >= 5) {
+                uint8_t aiState = reader.readU8();
+                if (aiState > static_cast<uint8_t>(UnitAIState::ATTACKING)) return false;
+                unit.aiState = static_cast<UnitAIState>(aiState);
+                unit.forcedTargetId = static_cast<int>(reader.readVarInt());
+                unit.attackCooldown = dequantizeTime(reader.readVarInt());
+
+                uint64_t pathCount = reader.readVarUInt();
+                if (pathCount > reader.remaining()) return false;
+                unit.path.reserve(static_cast<size_t>(pathCount));
+                for (uint64_t k = 0; k < pathCount && reader.isValid(); ++k) {
+                    float x = dequantizePosition(reader.readVarInt());
+                    float y = dequantizePosition(reader.readVarInt());
+                    unit.path.push_back(cocos2d::Vec2(x, y));
+                }
+            }
+            keyframe.units.push_back(std::move(unit));
+        }
+
+        keyframes.push_back(std::move(keyframe));
+    }
+
+    return reader.isValid();
+}
+
+void writeStateHashes(BinaryWriter& writer, const std::vector<StateHashSample>& samples) {
+    writer.writeVarUInt(samples.size());
+    int lastTick = 0;
+    for (const auto& sample : samples) {
+        writer.writeVarInt(sample.tick - lastTick);
+        writer.writeU64(sample.hash);
+        writer.writeVarInt(sample.buildingHP);
+        writer.writeVarInt(sample.destroyedBuildings);
+        writer.writeVarInt(sample.aliveUnits);
+        writer.writeVarInt(sample.unitHP);
+        lastTick = sample.tick;
+    }
+}
+
+bool readStateHashes(BinaryReader& reader, std::vector<StateHashSample>& samples) {
+    uint64_t count = reader.readVarUInt();
+    if (count > reader.remaining()) return false;
+    samples.reserve(static_cast<size_t>(count));
+
+    int lastTick = 0;
+    for (uint64_t i = 0; i < count && reader.isValid(); ++i) {
+        StateHashSample sample;
+        sample.tick = lastTick + static_cast<int>(reader.readVarInt());
+        sample.hash = reader.readU64();
+        sample.buildingHP = static_cast<int>(reader.readVarInt());
+        sample.destroyedBuildings = static_cast<int>(reader.readVarInt());
+        sample.aliveUnits = static_cast<int>(reader.readVarInt());
+        sample.unitHP = static_cast<int>(reader.readVarInt());
+        lastTick = sample.tick;
+        samples.push_back(sample);
+    }
+
+    return reader.isValid();
+}
+
+// 校验魔数和版本，输出版本号以及头部在数据中的偏移和长度（正文紧跟头部）
+bool openHeader(const uint8_t* bytes, size_t size, int& version, size_t& headerOffset, size_t& headerSize) {
+    if (!ReplayCodec::isBinary(bytes, size)) return false;
+
+    BinaryReader reader(bytes, size);
+    reader.readU32();
+    uint64_t fileVersion = reader.readVarUInt();
+    if (!reader.isValid() || fileVersion == 0 || fileVersion > static_cast<uint64_t>(ReplayCodec::VERSION)) {
+        CCLOG("ReplayCodec: Unsupported replay version %llu", static_cast<unsigned long long>(fileVersion));
+        return false;
+    }
+    version = static_cast<int>(fileVersion);
+
+    uint64_t length = reader.readVarUInt();
+    if (!reader.isValid() || length > reader.remaining()) return false;
+
+    headerOffset = reader.position();
+    headerSize = static_cast<size_t>(length);
+    return true;
+}
+
+void readMetadataFields(BinaryReader& reader, ReplayMetadata& meta) {
+    meta.replayId = static_cast<int>(reader.readVarInt());
+    meta.timestamp = static_cast<time_t>(reader.readVarInt());
+    meta.defenderName = reader.readString();
+    meta.battleDuration = dequantizeTime(reader.readVarInt());
+    meta.finalStars = static_cast<int>(reader.readVarInt());
+    meta.destructionPercentage = static_cast<int>(reader.readVarInt());
+    meta.lootedGold = static_cast<int>(reader.readVarInt());
+    meta.lootedElixir = static_cast<int>(reader.readVarInt());
+    meta.usedTroops.clear();
+    readTroopMap(reader, meta.usedTroops);
+}
+
+} // namespace
+
+std::vector<uint8_t> ReplayCodec::encode(const BattleReplayData& data) {
+    BinaryWriter header;
+    writeHeader(header, data);
+
+    BinaryWriter writer;
+    writer.writeU32(MAGIC);
+    writer.writeVarUInt(VERSION);
+    writer.writeVarUInt(header.size());
+    writer.writeBytes(header.getBuffer().data(), header.size());
+
+    // 建筑：只保存回放需要的字段，ID 存差值
+    const auto& buildings = data.getInitialBuildings();
+    writer.writeVarUInt(buildings.size());
+    int lastId = 0;
+    for (const auto& building : buildings) {
+        writer.writeVarInt(building.id - lastId);
+        writer.writeVarUInt(static_cast<uint64_t>(building.type));
+        writer.writeVarInt(building.level);
+        writer.writeVarInt(building.gridX);
+        writer.writeVarInt(building.gridY);
+        writer.writeVarInt(building.currentHP);
+        lastId = building.id;
+    }
+
+    // 部署事件：时间量化后存差值
+    writer.writeVarUInt(data.troopEvents.size());
+    int64_t lastTicks = 0;
+    for (const auto& event : data.troopEvents) {
+        int64_t ticks = quantizeTime(event.timestamp);
+        writer.writeVarInt(ticks - lastTicks);
+        writer.writeVarInt(event.troopId - TROOP_ID_BASE);
+        writer.writeVarInt(event.gridX);
+        writer.writeVarInt(event.gridY);
+        lastTicks = ticks;
+    }
+
+    writeKeyframes(writer, data.keyframes);
+    writeStateHashes(writer, data.simHashes);
+    writeStateHashes(writer, data.stateHashes);
+
+    return std::move(writer.getBuffer());
+}
+
+bool ReplayCodec::decode(const uint8_t* bytes, size_t size, BattleReplayData& out) {
+    int version = 0;
+    size_t headerOffset = 0;
+    size_t headerSize = 0;
+    if (!openHeader(bytes, size, version, headerOffset, headerSize)) return false;
+
+    BattleReplayData data;
+
+    // 头部
+    BinaryReader header(bytes + headerOffset, headerSize);
+    ReplayMetadata meta;
+    readMetadataFields(header, meta);
+    data.replayId = meta.replayId;
+    data.timestamp = meta.timestamp;
+    data.defenderName = meta.defenderName;
+    data.battleDuration = meta.battleDuration;
+    data.finalStars = meta.finalStars;
+    data.destructionPercentage = meta.destructionPercentage;
+    data.lootedGold = meta.lootedGold;
+    data.lootedElixir = meta.lootedElixir;
+    data.usedTroops = meta.usedTroops;
+    data.battleMapSeed = static_cast<int>(header.readVarInt());
+    readTroopMap(header, data.troopLevels);
+    if (!header.isValid()) return false;
+
+    // 正文（跳过头部中本版本不认识的字段）
+    size_t bodyOffset = headerOffset + headerSize;
+    BinaryReader reader(bytes + bodyOffset, size - bodyOffset);
+
+    uint64_t buildingCount = reader.readVarUInt();
+    if (buildingCount > reader.remaining()) return false;
+    auto buildings = std::make_shared<std::vector<BuildingInstance>>();
+    buildings->reserve(static_cast<size_t>(buildingCount));
+
+    int lastId = 0;
+    for (uint64_t i = 0; i < buildingCount && reader.isValid(); ++i) {
+        BuildingInstance building;
+        building.id = lastId + static_cast<int>(reader.readVarInt());
+        building.type = static_cast<int>(reader.readVarUInt());
+        building.level = static_cast<int>(reader.readVarInt());
+        building.gridX = static_cast<int>(reader.readVarInt());
+        building.gridY = static_cast<int>(reader.readVarInt());
+        building.currentHP = static_cast<int>(reader.readVarInt());
+        lastId = building.id;
+
+        // 与旧版读取一致，使用BUILT状态
+        building.state = BuildingInstance::State::BUILT;
+        building.isDestroyed = false;
+        building.finishTime = 0;
+        building.isInitialConstruction = false;
+
+        buildings->push_back(building);
+    }
+    data.initialBuildings = buildings;
+
+    uint64_t eventCount = reader.readVarUInt();
+    if (eventCount > reader.remaining()) return false;
+    data.troopEvents.reserve(static_cast<size_t>(eventCount));
+
+    int64_t lastTicks = 0;
+    for (uint64_t i = 0; i < eventCount && reader.isValid(); ++i) {
+        TroopDeployEvent event;
+        lastTicks += reader.readVarInt();
+        event.timestamp = dequantizeTime(lastTicks);
+        event.troopId = static_cast<int>(reader.readVarInt()) + TROOP_ID_BASE;
+        event.gridX = static_cast<int>(reader.readVarInt());
+        event.gridY = static_cast<int>(reader.readVarInt());
+        data.troopEvents.push_back(event);
+    }
+
+    if (version >= 2 && !readKeyframes(reader, version, data.keyframes)) return false;
+    if (version == 3) {
+        // 版本 3 的实时战斗哈希按可变帧长采样，与固定步长的采样不可比，不再使用
+        std::vector<StateHashSample> liveHashes;
+        if (!readStateHashes(reader, liveHashes)) return false;
+    }
+    if (version >= 3 && !readStateHashes(reader, data.simHashes)) return false;
+    if (version >= 6 && !readStateHashes(reader, data.stateHashes)) return false;
+
+    if (!reader.isValid()) return false;
+
+    out = std::move(data);
+    return true;
+}
+
+bool ReplayCodec::decodeMetadata(const uint8_t* bytes, size_t size, ReplayMetadata& out) {
+    int version = 0;
+    size_t headerOffset = 0;
+    size_t headerSize = 0;
+    if (!openHeader(bytes, size, version, headerOffset, headerSize)) return false;
+
+    BinaryReader header(bytes + headerOffset, headerSize);
+    ReplayMetadata meta;
+    readMetadataFields(header, meta);
+    if (!header.isValid()) return false;
+
+    out = std::move(meta);
+    return true;
+}
+
+std::vector<uint8_t> ReplayCodec::encodeIndex(const std::vector<ReplayMetadata>& entries, int nextReplayId) {
+    BinaryWriter writer;
+    writer.writeU32(INDEX_MAGIC);
+    writer.writeVarUInt(INDEX_VERSION);
+    writer.writeVarInt(nextReplayId);
+    writer.writeVarUInt(entries.size());
+    for (const auto& meta : entries) {
+        writeMetadataFields(writer, meta);
+    }
+    return std::move(writer.getBuffer());
+}
+
+bool ReplayCodec::decodeIndex(const uint8_t* bytes, size_t size, std::vector<ReplayMetadata>& entries, int& nextReplayId) {
+    BinaryReader reader(bytes, size);
+    if (reader.readU32() != INDEX_MAGIC) return false;
+    if (reader.readVarUInt() > INDEX_VERSION) return false;
+
+    int nextId = static_cast<int>(reader.readVarInt());
+    uint64_t count = reader.readVarUInt();
+    if (!reader.isValid() || count > reader.remaining()) return false;
+
+    std::vector<ReplayMetadata> result;
+    result.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count && reader.isValid(); ++i) {
+        ReplayMetadata meta;
+        readMetadataFields(reader, meta);
+        result.push_back(std::move(meta));
+    }
+    if (!reader.isValid()) return false;
+
+    entries = std::move(result);
+    nextReplayId = nextId;
+    return true;
+}
+
+bool ReplayCodec::isBinary(const uint8_t* bytes, size_t size) {
+    if (!bytes || size < 4) return false;
+
+    BinaryReader reader(bytes, size);
+    return reader.readU32() == MAGIC;
+}
+
+bool ReplayCodec::loadFromFile(const std::string& path, BattleReplayData& out) {
+    auto fileUtils = FileUtils::getInstance();
+    Data fileData = fileUtils->getDataFromFile(path);
+    if (fileData.isNull()) {
+        CCLOG("ReplayCodec: Failed to read %s", path.c_str());
+        return false;
+    }
+
+    const uint8_t* bytes = fileData.getBytes();
+    size_t size = static_cast<size_t>(fileData.getSize());
+
+    if (isBinary(bytes, size)) {
+        if (!decode(bytes, size, out)) {
+            CCLOG("ReplayCodec: Corrupted replay file %s", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // 旧版 plist 格式
+    ValueMap replayMap = fileUtils->getValueMapFromData(reinterpret_cast<const char*>(bytes),
+                                                        static_cast<int>(size));
+    if (replayMap.empty()) {
+        CCLOG("ReplayCodec: Unrecognized replay file %s", path.c_str());
+        return false;
+    }
+
+    out = BattleReplayData::fromValueMap(replayMap);
+    return true;
+}
+
+bool ReplayCodec::saveToFile(const std::string& path, const BattleReplayData& data) {
+    std::vector<uint8_t> bytes = encode(data);
+
+    Data fileData;
+    fileData.copy(bytes.data(), static_cast<ssize_t>(bytes.size()));
+    return FileUtils::getInstance()->writeDataToFile(fileData, path);
+}
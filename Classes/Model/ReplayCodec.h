@@ -0,0 +1,59 @@
+﻿// ReplayCodec.h
+// 回放二进制格式编解码声明，兼容读取旧版 plist 回放文件
+
+#ifndef __REPLAY_CODEC_H__
+#define __REPLAY_CODEC_H__
+
+#include "ReplayData.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 回放编解码器
+// 文件布局：魔数 "CRPL" | 版本号 | 头部长度 | 头部（ReplayMetadata、兵种等级、地图种子）| 正文（建筑、部署事件、关键帧、状态哈希）
+// - 所有整数为 varint，有符号字段用 zigzag
+// - 部署时间按 TIME_QUANTUM 量化后存与上一事件的差值
+// - 建筑ID存与上一建筑的差值，只保存回放需要的字段
+// - 关键帧（版本 2 起）中的小数按 TIME_QUANTUM / POSITION_QUANTUM 量化，版本 1 文件解码后没有关键帧
+// - 关键帧单位的 AI 状态（版本 5 起）：状态枚举、强制攻击的城墙、攻击剩余冷却、剩余路径点
+// - 模拟器基准哈希（版本 3 起）采样序号存差值，哈希值定长 8 字节；版本 3 文件在其前面另有一段按可变帧长采样的实时战斗哈希，读取时跳过
+// - 实时战斗哈希（版本 6 起）在模拟器基准哈希之后，编码相同
+// - 头部带长度前缀，列表页只解析头部即可拿到元数据，新版本追加的头部字段旧版本可跳过
+// 回放索引文件：魔数 "CRPX" | 版本号 | 下一个回放ID | 条目数 | 每条 ReplayMetadata（与回放头部字段编码相同）
+// 所有函数只访问传入数据（loadFromFile/saveToFile 另外使用 FileUtils），可在后台线程调用
+class ReplayCodec {
+public:
+    static const uint32_t MAGIC;                    // "CRPL"
+    static const int VERSION = 6;
+    static const uint32_t INDEX_MAGIC;              // "CRPX"
+    static const int INDEX_VERSION = 1;
+    static constexpr float TIME_QUANTUM = 0.01f;    // 时间量化精度（秒）
+    static constexpr float POSITION_QUANTUM = 0.01f; // 关键帧中单位网格坐标的量化精度（格）
+
+    // 二进制回放文件扩展名
+    static const char* FILE_EXTENSION;
+
+    // 编码完整回放
+    static std::vector<uint8_t> encode(const BattleReplayData& data);
+
+    // 解码完整回放，格式错误返回 false
+    static bool decode(const uint8_t* bytes, size_t size, BattleReplayData& out);
+
+    // 只解码头部元数据
+    static bool decodeMetadata(const uint8_t* bytes, size_t size, ReplayMetadata& out);
+
+    // 编解码回放索引（所有回放的元数据）
+    static std::vector<uint8_t> encodeIndex(const std::vector<ReplayMetadata>& entries, int nextReplayId);
+    static bool decodeIndex(const uint8_t* bytes, size_t size, std::vector<ReplayMetadata>& entries, int& nextReplayId);
+
+    // 是否为二进制格式（检查魔数）
+    static bool isBinary(const uint8_t* bytes, size_t size);
+
+    // 从文件加载，自动识别二进制格式和旧版 plist 格式
+    static bool loadFromFile(const std::string& path, BattleReplayData& out);
+
+    // 以二进制格式写入文件
+    static bool saveToFile(const std::string& path, const BattleReplayData& data);
+};
+
+#endif // __REPLAY_CODEC_H__
@@ -58,7 +58,7 @@ ValueMap BattleReplayData::toValueMap() const {
     // 地图快照
     map["battleMapSeed"] = battleMapSeed;
     ValueVector buildingsVec;
-    for (const auto& building : initialBuildings) {
+    for (const auto& building : getInitialBuildings()) {
         ValueMap buildingMap;
         buildingMap["id"] = building.id;
         buildingMap["type"] = building.type;
@@ -128,6 +128,8 @@ BattleReplayData BattleReplayData::fromValueMap(const ValueMap& map) {
     data.battleMapSeed = map.at("battleMapSeed").asInt();
     if (map.find("initialBuildings") != map.end()) {
         ValueVector buildingsVec = map.at("initialBuildings").asValueVector();
+        auto buildings = std::make_shared<std::vector<BuildingInstance>>();
+        buildings->reserve(buildingsVec.size());
         for (const auto& buildingValue : buildingsVec) {
             ValueMap buildingMap = buildingValue.asValueMap();
             BuildingInstance building;
@@ -144,8 +146,9 @@ BattleReplayData BattleReplayData::fromValueMap(const ValueMap& map) {
             building.finishTime = 0;
             building.isInitialConstruction = false;
 
-            data.initialBuildings.push_back(building);
+            buildings->push_back(building);
         }
+        data.initialBuildings = buildings;
     }
 
     // 兵种部署序列
@@ -160,6 +163,25 @@ BattleReplayData BattleReplayData::fromValueMap(const ValueMap& map) {
     return data;
 }
 
+const std::vector<BuildingInstance>& BattleReplayData::getInitialBuildings() const {
+    static const std::vector<BuildingInstance> empty;
+    return initialBuildings ? *initialBuildings : empty;
+}
+
+ReplayMetadata BattleReplayData::toMetadata() const {
+    ReplayMetadata meta;
+    meta.replayId = replayId;
+    meta.timestamp = timestamp;
+    meta.defenderName = defenderName;
+    meta.finalStars = finalStars;
+    meta.destructionPercentage = destructionPercentage;
+    meta.lootedGold = lootedGold;
+    meta.lootedElixir = lootedElixir;
+    meta.usedTroops = usedTroops;
+    meta.battleDuration = battleDuration;
+    return meta;
+}
+
 // ReplayMetadata 序列化
 ValueMap ReplayMetadata::toValueMap() const {
     ValueMap map;
@@ -6,6 +6,8 @@
 
 #include "cocos2d.h"
 #include "Model/VillageData.h"
+#include "Model/BattleMapData.h"
+#include "Model/BattleStateHash.h"
 #include <vector>
 #include <string>
 #include <ctime>
@@ -22,6 +24,49 @@ struct TroopDeployEvent {
     static TroopDeployEvent fromValueMap(const cocos2d::ValueMap& map);
 };
 
+// 关键帧中的单位 AI 状态
+enum class UnitAIState : uint8_t {
+    IDLE = 0,             // 没有进行中的移动或攻击，恢复后重新选择目标
+    MOVING = 1,           // 沿路径移动，恢复后走完剩余路径
+    ATTACKING = 2         // 攻击动作进行中，恢复后等剩余冷却结束再结算这一击
+};
+
+// 关键帧中的单位状态
+struct UnitKeyframe {
+    int troopId;          // 兵种ID
+    float gridX;          // 网格坐标（含小数，移动中的单位不在格子中心）
+    float gridY;
+    int currentHP;        // 当前生命值
+    int targetBuildingId; // AI 当前目标建筑，-1 表示无
+    UnitAIState aiState;  // AI 状态（版本 5 起，旧版文件为 IDLE）
+    int forcedTargetId;   // 强制攻击的城墙，-1 表示无
+    float attackCooldown; // 攻击中：距本次攻击结算的剩余时间（秒）
+    std::vector<cocos2d::Vec2> path;  // 移动中：剩余路径点（网格坐标，含小数）
+};
+
+// 关键帧中的建筑状态（只记录与初始布局不同的建筑）
+struct BuildingKeyframe {
+    int id;               // 建筑ID
+    int currentHP;        // 当前生命值
+    bool isDestroyed;     // 是否已摧毁
+    float attackCooldown; // 防御建筑攻击冷却
+    float trapTimer;      // 陷阱剩余引爆延迟，<0 表示未触发
+};
+
+// 战斗关键帧：某一时刻的完整战斗状态，回放跳转时从最近的关键帧恢复
+struct BattleKeyframe {
+    float time = 0.0f;                       // 战斗时间（秒）
+    int eventIndex = 0;                      // 已部署的事件数
+    int lootedGold = 0;                      // 已掠夺金币
+    int lootedElixir = 0;                    // 已掠夺圣水
+    float destructionProgress = 0.0f;        // 摧毁进度（0-100）
+    int stars = 0;                           // 当前星数
+    std::vector<BuildingKeyframe> buildings; // 与初始布局不同的建筑
+    std::vector<UnitKeyframe> units;         // 存活单位
+};
+
+struct ReplayMetadata;
+
 // 完整回放数据
 struct BattleReplayData {
     // 元数据
@@ -38,16 +83,31 @@ struct BattleReplayData {
     std::map<int, int> usedTroops;                  // 消耗的兵种（troopId -> count）
     std::map<int, int> troopLevels;                 // 兵种等级（troopId -> level）
 
-    // 地图快照
-    std::vector<BuildingInstance> initialBuildings; // 初始建筑布局
+    // 地图快照（与战斗地图、其他副本共享，只读）
+    BattleLayout initialBuildings;                   // 初始建筑布局
     int battleMapSeed;                               // 地图随机种子
 
     // 兵种部署序列
     std::vector<TroopDeployEvent> troopEvents;      // 按时间排序的兵种部署事件
 
+    // 关键帧（按时间排序，旧版回放为空）
+    std::vector<BattleKeyframe> keyframes;
+
+    // 状态哈希（按采样序号排序，旧版回放为空）
+    // stateHashes：录制时实时战斗在固定步长时钟上采样，回放播放时逐个比对，报告第一个不一致的采样
+    // simHashes：保存时无界面模拟器按部署序列推演得到，批量重算时比对，用于发现模拟器或配置改动造成的结果变化
+    std::vector<StateHashSample> stateHashes;
+    std::vector<StateHashSample> simHashes;
+
+    // 初始建筑列表，没有布局时为空
+    const std::vector<BuildingInstance>& getInitialBuildings() const;
+
     // JSON序列化
     cocos2d::ValueMap toValueMap() const;
     static BattleReplayData fromValueMap(const cocos2d::ValueMap& map);
+
+    // 提取列表显示用的元数据
+    ReplayMetadata toMetadata() const;
 };
 
 // 回放元数据（用于列表显示）
@@ -27,15 +27,9 @@ struct BuildingInstance {
   // 区分新建筑和升级
   bool isInitialConstruction;
 
-  // 战斗系统运行时数据
-  int currentHP;        // 当前生命值
+  // 存档/布局中的生命值；战斗中的实时生命值、摧毁标志、冷却和锁定目标在 BattleBuildingStore
+  int currentHP;        // 生命值（开战时的初始值）
   bool isDestroyed;     // 是否已被摧毁
-
-  // 防御建筑锁定目标
-  mutable void* lockedTarget = nullptr;  // 锁定的兵种指针（BattleUnitSprite*）
-
-  // 攻击冷却系统
-  float attackCooldown = 0.0f;  // 当前冷却时间（秒）
 };
 
 // 村庄数据
@@ -53,3 +47,10 @@ struct VillageData {
   int researchingTroopId = -1;       // 正在研究的兵种，-1表示无
   long long researchFinishTime = 0;  // 研究完成时间戳
 };
+
+// 存档快照：村庄数据加上场景配置，按值拷贝后交给 IO 线程序列化
+struct VillageSaveSnapshot {
+  VillageData data;
+  int currentThemeId = 1;
+  std::vector<int> purchasedThemes;
+};
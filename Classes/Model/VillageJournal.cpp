@@ -0,0 +1,308 @@
+﻿// VillageJournal.cpp
+// 村庄存档日志实现
+
+#include "VillageJournal.h"
+#include "../Util/BinaryStream.h"
+#include "cocos2d.h"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+USING_NS_CC;
+
+const uint32_t VillageJournal::MAGIC = 0x4C4A5643;   // 小端序 "CVJL"
+const char* VillageJournal::FILE_SUFFIX = ".journal";
+
+namespace {
+
+enum RecordType : uint8_t {
+    RECORD_RESOURCES = 1,       // 金币/圣水/钻石增量
+    RECORD_BUILDING = 2,        // 建筑新增或任意存档字段变化（移动、开始/完成升级等）
+    RECORD_BUILDING_REMOVED = 3,
+    RECORD_TROOP = 4,           // 兵种数量（0 表示删除）
+    RECORD_TROOP_LEVEL = 5,
+    RECORD_RESEARCH = 6,
+    RECORD_THEME = 7,           // 当前场景和已购买场景
+};
+
+uint32_t checksum(const uint8_t* bytes, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 只比较写入存档的字段，战斗运行时字段不影响存档
+bool sameSavedFields(const BuildingInstance& a, const BuildingInstance& b) {
+    return a.type == b.type && a.level == b.level &&
+           a.gridX == b.gridX && a.gridY == b.gridY &&
+           a.state == b.state && a.finishTime == b.finishTime &&
+           a.isInitialConstruction == b.isInitialConstruction &&
+           a.currentHP == b.currentHP;
+}
+
+void writeBuilding(BinaryWriter& writer, const BuildingInstance& building) {
+    writer.writeU8(RECORD_BUILDING);
+    writer.writeVarInt(building.id);
+    writer.writeVarInt(building.type);
+    writer.writeVarInt(building.level);
+    writer.writeVarInt(building.gridX);
+    writer.writeVarInt(building.gridY);
+    writer.writeVarUInt(static_cast<uint64_t>(building.state));
+    writer.writeVarInt(building.finishTime);
+    writer.writeU8(building.isInitialConstruction ? 1 : 0);
+    writer.writeVarInt(building.currentHP);
+}
+
+void writeMapChanges(BinaryWriter& writer, RecordType type,
+                     const std::map<int, int>& before, const std::map<int, int>& after) {
+    for (const auto& pair : after) {
+        auto it = before.find(pair.first);
+        if (it == before.end() || it->second != pair.second) {
+            writer.writeU8(type);
+            writer.writeVarInt(pair.first);
+            writer.writeVarInt(pair.second);
+        }
+    }
+    for (const auto& pair : before) {
+        if (after.find(pair.first) == after.end()) {
+            writer.writeU8(type);
+            writer.writeVarInt(pair.first);
+            writer.writeVarInt(0);
+        }
+    }
+}
+
+void applyMapRecord(std::map<int, int>& values, int id, int value) {
+    if (value == 0) {
+        values.erase(id);
+    } else {
+        values[id] = value;
+    }
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    Data data = FileUtils::getInstance()->getDataFromFile(path);
+    return std::vector<uint8_t>(data.getBytes(), data.getBytes() + data.getSize());
+}
+
+} // namespace
+
+std::vector<uint8_t> VillageJournal::encodeChanges(const VillageSaveSnapshot& before, const VillageSaveSnapshot& after) {
+    BinaryWriter writer;
+    const VillageData& oldData = before.data;
+    const VillageData& newData = after.data;
+
+    // 资源
+    if (oldData.gold != newData.gold || oldData.elixir != newData.elixir || oldData.gem != newData.gem) {
+        writer.writeU8(RECORD_RESOURCES);
+        writer.writeVarInt(static_cast<int64_t>(newData.gold) - oldData.gold);
+        writer.writeVarInt(static_cast<int64_t>(newData.elixir) - oldData.elixir);
+        writer.writeVarInt(static_cast<int64_t>(newData.gem) - oldData.gem);
+    }
+
+    // 建筑
+    std::unordered_map<int, const BuildingInstance*> oldBuildings;
+    oldBuildings.reserve(oldData.buildings.size());
+    for (const auto& building : oldData.buildings) {
+        oldBuildings[building.id] = &building;
+    }
+    for (const auto& building : newData.buildings) {
+        auto it = oldBuildings.find(building.id);
+        if (it == oldBuildings.end() || !sameSavedFields(*it->second, building)) {
+            writeBuilding(writer, building);
+        }
+        if (it != oldBuildings.end()) oldBuildings.erase(it);
+    }
+    for (const auto& building : oldData.buildings) {
+        if (oldBuildings.count(building.id)) {
+            writer.writeU8(RECORD_BUILDING_REMOVED);
+            writer.writeVarInt(building.id);
+        }
+    }
+
+    // 军队与研究
+    writeMapChanges(writer, RECORD_TROOP, oldData.troops, newData.troops);
+    writeMapChanges(writer, RECORD_TROOP_LEVEL, oldData.troopLevels, newData.troopLevels);
+    if (oldData.researchingTroopId != newData.researchingTroopId ||
+        oldData.researchFinishTime != newData.researchFinishTime) {
+        writer.writeU8(RECORD_RESEARCH);
+        writer.writeVarInt(newData.researchingTroopId);
+        writer.writeVarInt(newData.researchFinishTime);
+    }
+
+    // 场景
+    if (before.currentThemeId != after.currentThemeId || before.purchasedThemes != after.purchasedThemes) {
+        writer.writeU8(RECORD_THEME);
+        writer.writeVarInt(after.currentThemeId);
+        writer.writeVarUInt(after.purchasedThemes.size());
+        for (int id : after.purchasedThemes) {
+            writer.writeVarInt(id);
+        }
+    }
+
+    return std::move(writer.getBuffer());
+}
+
+bool VillageJournal::applyChanges(const uint8_t* bytes, size_t size, VillageSaveSnapshot& snapshot) {
+    // 先在副本上回放，格式错误时不留下半批修改
+    VillageSaveSnapshot result = snapshot;
+    VillageData& data = result.data;
+    BinaryReader reader(bytes, size);
+
+    while (reader.isValid() && reader.remaining() > 0) {
+        uint8_t type = reader.readU8();
+        switch (type) {
+        case RECORD_RESOURCES:
+            data.gold += static_cast<int>(reader.readVarInt());
+            data.elixir += static_cast<int>(reader.readVarInt());
+            data.gem += static_cast<int>(reader.readVarInt());
+            break;
+
+        case RECORD_BUILDING: {
+            BuildingInstance building;
+            building.id = static_cast<int>(reader.readVarInt());
+            building.type = static_cast<int>(reader.readVarInt());
+            building.level = static_cast<int>(reader.readVarInt());
+            building.gridX = static_cast<int>(reader.readVarInt());
+            building.gridY = static_cast<int>(reader.readVarInt());
+            building.state = static_cast<BuildingInstance::State>(reader.readVarUInt());
+            building.finishTime = reader.readVarInt();
+            building.isInitialConstruction = reader.readU8() != 0;
+            building.currentHP = static_cast<int>(reader.readVarInt());
+            building.isDestroyed = false;
+
+            auto it = std::find_if(data.buildings.begin(), data.buildings.end(),
+                                   [&building](const BuildingInstance& b) { return b.id == building.id; });
+            if (it != data.buildings.end()) {
+                *it = building;
+            } else {
+                data.buildings.push_back(building);
+            }
+            break;
+        }
+
+        case RECORD_BUILDING_REMOVED: {
+            int id = static_cast<int>(reader.readVarInt());
+            data.buildings.erase(std::remove_if(data.buildings.begin(), data.buildings.end(),
+                                                [id](const BuildingInstance& b) { return b.id == id; }),
+                                 data.buildings.end());
+            break;
+        }
+
+        case RECORD_TROOP: {
+            int id = static_cast<int>(reader.readVarInt());
+            applyMapRecord(data.troops, id, static_cast<int>(reader.readVarInt()));
+            break;
+        }
+
+        case RECORD_TROOP_LEVEL: {
+            int id = static_cast<int>(reader.readVarInt());
+            applyMapRecord(data.troopLevels, id, static_cast<int>(reader.readVarInt()));
+            break;
+        }
+
+        case RECORD_RESEARCH:
+            data.researchingTroopId = static_cast<int>(reader.readVarInt());
+            data.researchFinishTime = reader.readVarInt();
+            break;
+
+        case RECORD_THEME: {
+            result.currentThemeId = static_cast<int>(reader.readVarInt());
+            uint64_t count = reader.readVarUInt();
+            if (count > reader.remaining()) return false;
+            result.purchasedThemes.clear();
+            for (uint64_t i = 0; i < count; ++i) {
+                result.purchasedThemes.push_back(static_cast<int>(reader.readVarInt()));
+            }
+            break;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    if (!reader.isValid()) return false;
+
+    snapshot = std::move(result);
+    return true;
+}
+
+std::vector<uint8_t> VillageJournal::encodeHeader(uint64_t generation) {
+    BinaryWriter writer;
+    writer.writeU32(MAGIC);
+    writer.writeVarUInt(VERSION);
+    writer.writeVarUInt(generation);
+    return std::move(writer.getBuffer());
+}
+
+std::vector<uint8_t> VillageJournal::encodeBatch(const std::vector<uint8_t>& changes) {
+    BinaryWriter writer;
+    writer.writeVarUInt(changes.size());
+    writer.writeBytes(changes.data(), changes.size());
+    writer.writeU32(checksum(changes.data(), changes.size()));
+    return std::move(writer.getBuffer());
+}
+
+VillageJournal::ReplayResult VillageJournal::replay(const uint8_t* bytes, size_t size, uint64_t generation,
+                                                    VillageSaveSnapshot& snapshot) {
+    ReplayResult result;
+    BinaryReader reader(bytes, size);
+
+    if (reader.readU32() != MAGIC) return result;
+    uint64_t version = reader.readVarUInt();
+    uint64_t fileGeneration = reader.readVarUInt();
+    if (!reader.isValid() || version > VERSION || fileGeneration != generation) return result;
+
+    result.headerValid = true;
+    result.validBytes = reader.position();
+
+    while (reader.remaining() > 0) {
+        uint64_t length = reader.readVarUInt();
+        if (!reader.isValid() || length > reader.remaining()) break;
+
+        const uint8_t* changes = bytes + reader.position();
+        reader.skip(static_cast<size_t>(length));
+        uint32_t expected = reader.readU32();
+        if (!reader.isValid() || expected != checksum(changes, static_cast<size_t>(length))) break;
+        if (!applyChanges(changes, static_cast<size_t>(length), snapshot)) break;
+
+        result.batchesApplied++;
+        result.validBytes = reader.position();
+    }
+
+    result.tornTail = result.validBytes < size;
+    return result;
+}
+
+VillageJournal::ReplayResult VillageJournal::replayFile(const std::string& path, uint64_t generation,
+                                                        VillageSaveSnapshot& snapshot) {
+    if (!FileUtils::getInstance()->isFileExist(path)) return ReplayResult();
+
+    std::vector<uint8_t> bytes = readFile(path);
+    return replay(bytes.data(), bytes.size(), generation, snapshot);
+}
+
+bool VillageJournal::appendToFile(const std::string& path, const std::vector<uint8_t>& batch) {
+    FILE* file = fopen(FileUtils::getInstance()->getSuitableFOpen(path).c_str(), "ab");
+    if (!file) return false;
+
+    bool success = fwrite(batch.data(), 1, batch.size(), file) == batch.size();
+    success = fflush(file) == 0 && success;
+    fclose(file);
+    return success;
+}
+
+bool VillageJournal::resetFile(const std::string& path, uint64_t generation) {
+    auto fileUtils = FileUtils::getInstance();
+    std::string tempPath = path + ".tmp";
+
+    Data data;
+    std::vector<uint8_t> header = encodeHeader(generation);
+    data.copy(header.data(), header.size());
+    if (!fileUtils->writeDataToFile(data, tempPath)) return false;
+    return fileUtils->renameFile(tempPath, path);
+}
@@ -0,0 +1,55 @@
+﻿// VillageJournal.h
+// 村庄存档日志声明，把两次保存之间的变化编码为追加写入的小记录
+
+#ifndef __VILLAGE_JOURNAL_H__
+#define __VILLAGE_JOURNAL_H__
+
+#include "VillageData.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 村庄存档日志
+// 文件布局：魔数 "CVJL" | 版本号 | 代数 | 批次...
+// - 代数与 village.json 中的 journalGeneration 对应，不一致说明日志已被压缩进快照，读档时忽略
+// - 每次保存写一个批次：记录总长度 | 记录 | FNV-1a 校验和，整批要么全部生效要么全部丢弃
+// - 记录内容：资源增量、建筑新状态、建筑删除、兵种数量、兵种等级、研究状态、场景
+// - 写到一半中断的尾部批次校验失败，读档时只回放之前的完整批次
+class VillageJournal {
+public:
+    static const uint32_t MAGIC;                    // "CVJL"
+    static const int VERSION = 1;
+
+    // 日志文件扩展名（跟在存档文件名后面）
+    static const char* FILE_SUFFIX;
+
+    // 回放结果
+    struct ReplayResult {
+        bool headerValid = false;                   // 文件头有效且代数匹配
+        int batchesApplied = 0;                     // 回放的批次数
+        size_t validBytes = 0;                      // 最后一个完整批次结束的位置
+        bool tornTail = false;                      // 尾部有不完整或损坏的批次
+    };
+
+    // 比较两个快照，编码变化记录；没有变化返回空
+    static std::vector<uint8_t> encodeChanges(const VillageSaveSnapshot& before, const VillageSaveSnapshot& after);
+
+    // 把一批记录应用到快照，格式错误返回 false 且快照不变
+    static bool applyChanges(const uint8_t* bytes, size_t size, VillageSaveSnapshot& snapshot);
+
+    // 文件头
+    static std::vector<uint8_t> encodeHeader(uint64_t generation);
+
+    // 给一批记录加上长度前缀和校验和
+    static std::vector<uint8_t> encodeBatch(const std::vector<uint8_t>& changes);
+
+    // 在快照上回放日志中代数匹配的所有完整批次
+    static ReplayResult replay(const uint8_t* bytes, size_t size, uint64_t generation, VillageSaveSnapshot& snapshot);
+
+    // 文件操作（使用 FileUtils 和 fopen，可在 IO 线程调用）
+    static ReplayResult replayFile(const std::string& path, uint64_t generation, VillageSaveSnapshot& snapshot);
+    static bool appendToFile(const std::string& path, const std::vector<uint8_t>& batch);
+    static bool resetFile(const std::string& path, uint64_t generation);   // 原子地替换为只有文件头的新日志
+};
+
+#endif // __VILLAGE_JOURNAL_H__
@@ -0,0 +1,333 @@
+﻿// VillageSaveCodec.cpp
+// 村庄存档 JSON 编解码实现
+
+#include "VillageSaveCodec.h"
+#include "json/reader.h"
+#include "json/writer.h"
+#include "json/memorystream.h"
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// 存档中出现的字段名
+enum class Field {
+    UNKNOWN,
+    GOLD, ELIXIR, GEM,
+    CURRENT_THEME, PURCHASED_THEMES,
+    TROOPS, BUILDINGS, TROOP_LEVELS,
+    RESEARCHING_TROOP_ID, RESEARCH_FINISH_TIME,
+    JOURNAL_GENERATION,
+    // 数组元素内的字段
+    ID, COUNT, TYPE, LEVEL, GRID_X, GRID_Y, STATE, FINISH_TIME, IS_INITIAL_CONSTRUCTION, CURRENT_HP,
+};
+
+struct FieldName {
+    const char* name;
+    size_t length;
+    Field field;
+};
+
+#define FIELD_NAME(name, field) { name, sizeof(name) - 1, field }
+
+// 顶层对象和数组元素对象的字段分开查找，每个键最多比较十几次长度
+const FieldName TOP_FIELDS[] = {
+    FIELD_NAME("gold", Field::GOLD),
+    FIELD_NAME("elixir", Field::ELIXIR),
+    FIELD_NAME("gem", Field::GEM),
+    FIELD_NAME("currentTheme", Field::CURRENT_THEME),
+    FIELD_NAME("purchasedThemes", Field::PURCHASED_THEMES),
+    FIELD_NAME("troops", Field::TROOPS),
+    FIELD_NAME("buildings", Field::BUILDINGS),
+    FIELD_NAME("troopLevels", Field::TROOP_LEVELS),
+    FIELD_NAME("researchingTroopId", Field::RESEARCHING_TROOP_ID),
+    FIELD_NAME("researchFinishTime", Field::RESEARCH_FINISH_TIME),
+    FIELD_NAME("journalGeneration", Field::JOURNAL_GENERATION),
+};
+
+const FieldName ELEMENT_FIELDS[] = {
+    FIELD_NAME("id", Field::ID),
+    FIELD_NAME("count", Field::COUNT),
+    FIELD_NAME("type", Field::TYPE),
+    FIELD_NAME("level", Field::LEVEL),
+    FIELD_NAME("gridX", Field::GRID_X),
+    FIELD_NAME("gridY", Field::GRID_Y),
+    FIELD_NAME("state", Field::STATE),
+    FIELD_NAME("finishTime", Field::FINISH_TIME),
+    FIELD_NAME("isInitialConstruction", Field::IS_INITIAL_CONSTRUCTION),
+    FIELD_NAME("currentHP", Field::CURRENT_HP),
+};
+
+#undef FIELD_NAME
+
+template <size_t N>
+Field lookupField(const FieldName (&fields)[N], const char* name, size_t length) {
+    for (const auto& entry : fields) {
+        if (entry.length == length && std::memcmp(entry.name, name, length) == 0) {
+            return entry.field;
+        }
+    }
+    return Field::UNKNOWN;
+}
+
+// SAX 回调：按嵌套深度区分顶层字段（1）、数组元素（2）和元素对象内的字段（3），更深的内容忽略
+class SaveHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, SaveHandler> {
+public:
+    SaveHandler(VillageSaveSnapshot& out, uint64_t& generation) : _out(out), _generation(generation) {}
+
+    bool Default() { return true; }     // null、小数和字符串值都不是存档字段，忽略
+
+    bool Bool(bool value) {
+        if (_depth == 3 && _array == Field::BUILDINGS && _elementField == Field::IS_INITIAL_CONSTRUCTION) {
+            _building.isInitialConstruction = value;
+        }
+        return true;
+    }
+
+    bool Int(int value) { return number(value); }
+    bool Uint(unsigned value) { return number(value); }
+    bool Int64(int64_t value) { return number(value); }
+    bool Uint64(uint64_t value) {
+        if (_depth == 1 && _topField == Field::JOURNAL_GENERATION) {
+            _generation = value;
+            return true;
+        }
+        return number(static_cast<int64_t>(value));
+    }
+
+    bool Key(const char* name, rapidjson::SizeType length, bool) {
+        if (_depth == 1) {
+            _topField = lookupField(TOP_FIELDS, name, length);
+        } else if (_depth == 3) {
+            _elementField = lookupField(ELEMENT_FIELDS, name, length);
+        }
+        return true;
+    }
+
+    bool StartObject() {
+        ++_depth;
+        if (_depth == 3) beginElement();
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType) {
+        if (_depth == 3) commitElement();
+        --_depth;
+        return true;
+    }
+
+    bool StartArray() {
+        ++_depth;
+        if (_depth == 2) _array = _topField;
+        return true;
+    }
+
+    bool EndArray(rapidjson::SizeType) {
+        if (_depth == 2) _array = Field::UNKNOWN;
+        --_depth;
+        return true;
+    }
+
+private:
+    bool number(int64_t value) {
+        if (_depth == 1) {
+            setTopField(value);
+        } else if (_depth == 2 && _array == Field::PURCHASED_THEMES) {
+            _out.purchasedThemes.push_back(static_cast<int>(value));
+        } else if (_depth == 3) {
+            setElementField(value);
+        }
+        return true;
+    }
+
+    void setTopField(int64_t value) {
+        VillageData& data = _out.data;
+        switch (_topField) {
+        case Field::GOLD: data.gold = static_cast<int>(value); break;
+        case Field::ELIXIR: data.elixir = static_cast<int>(value); break;
+        case Field::GEM: data.gem = static_cast<int>(value); break;
+        case Field::CURRENT_THEME: _out.currentThemeId = static_cast<int>(value); break;
+        case Field::RESEARCHING_TROOP_ID: data.researchingTroopId = static_cast<int>(value); break;
+        case Field::RESEARCH_FINISH_TIME: data.researchFinishTime = value; break;
+        case Field::JOURNAL_GENERATION: _generation = static_cast<uint64_t>(value); break;
+        default: break;
+        }
+    }
+
+    void setElementField(int64_t value) {
+        int intValue = static_cast<int>(value);
+        if (_array == Field::BUILDINGS) {
+            switch (_elementField) {
+            case Field::ID: _building.id = intValue; break;
+            case Field::TYPE: _building.type = intValue; break;
+            case Field::LEVEL: _building.level = intValue; break;
+            case Field::GRID_X: _building.gridX = intValue; break;
+            case Field::GRID_Y: _building.gridY = intValue; break;
+            case Field::STATE: _building.state = static_cast<BuildingInstance::State>(intValue); break;
+            case Field::FINISH_TIME: _building.finishTime = value; break;
+            case Field::CURRENT_HP: _building.currentHP = intValue; break;
+            default: break;
+            }
+        } else if (_array == Field::TROOPS || _array == Field::TROOP_LEVELS) {
+            if (_elementField == Field::ID) _elementId = intValue;
+            else if (_elementField == (_array == Field::TROOPS ? Field::COUNT : Field::LEVEL)) _elementValue = intValue;
+        }
+    }
+
+    void beginElement() {
+        _elementField = Field::UNKNOWN;
+        _elementId = 0;
+        _elementValue = 0;
+
+        _building = BuildingInstance();
+        _building.id = 0;
+        _building.type = 0;
+        _building.level = 0;
+        _building.gridX = 0;
+        _building.gridY = 0;
+        _building.state = BuildingInstance::State::BUILT;
+        _building.finishTime = 0;
+        _building.isInitialConstruction = false;
+        _building.currentHP = VillageSaveCodec::MISSING_HP;
+        _building.isDestroyed = false;
+    }
+
+    void commitElement() {
+        switch (_array) {
+        case Field::BUILDINGS: _out.data.buildings.push_back(_building); break;
+        case Field::TROOPS: _out.data.troops[_elementId] = _elementValue; break;
+        case Field::TROOP_LEVELS: _out.data.troopLevels[_elementId] = _elementValue; break;
+        default: break;
+        }
+    }
+
+    VillageSaveSnapshot& _out;
+    uint64_t& _generation;
+
+    int _depth = 0;
+    Field _topField = Field::UNKNOWN;
+    Field _array = Field::UNKNOWN;          // 当前所在的顶层数组
+    Field _elementField = Field::UNKNOWN;
+
+    BuildingInstance _building;
+    int _elementId = 0;
+    int _elementValue = 0;
+};
+
+// rapidjson 输出流：直接追加到 std::string，省去 StringBuffer 再拷贝一次
+class StringOutputStream {
+public:
+    typedef char Ch;
+
+    explicit StringOutputStream(std::string& target) : _target(target) {}
+
+    void Put(char c) { _target.push_back(c); }
+    void Flush() {}
+
+private:
+    std::string& _target;
+};
+
+// 每座建筑约 125 字节，按略大的估计预留，写出过程中不再扩容
+const size_t BYTES_PER_BUILDING = 140;
+const size_t BYTES_PER_ENTRY = 24;
+const size_t BYTES_FIXED = 256;
+
+} // namespace
+
+std::string VillageSaveCodec::write(const VillageSaveSnapshot& snapshot, uint64_t generation) {
+    const VillageData& data = snapshot.data;
+
+    std::string json;
+    json.reserve(BYTES_FIXED + data.buildings.size() * BYTES_PER_BUILDING +
+                 (data.troops.size() + data.troopLevels.size() + snapshot.purchasedThemes.size()) * BYTES_PER_ENTRY);
+
+    StringOutputStream stream(json);
+    rapidjson::Writer<StringOutputStream> writer(stream);
+    writer.StartObject();
+
+    // 基础资源
+    writer.Key("gold"); writer.Int(data.gold);
+    writer.Key("elixir"); writer.Int(data.elixir);
+    writer.Key("gem"); writer.Int(data.gem);
+
+    // 场景
+    writer.Key("currentTheme"); writer.Int(snapshot.currentThemeId);
+    writer.Key("purchasedThemes");
+    writer.StartArray();
+    for (int id : snapshot.purchasedThemes) {
+        writer.Int(id);
+    }
+    writer.EndArray();
+
+    // 军队
+    writer.Key("troops");
+    writer.StartArray();
+    for (const auto& pair : data.troops) {
+        writer.StartObject();
+        writer.Key("id"); writer.Int(pair.first);
+        writer.Key("count"); writer.Int(pair.second);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    // 建筑
+    writer.Key("buildings");
+    writer.StartArray();
+    for (const auto& building : data.buildings) {
+        writer.StartObject();
+        writer.Key("id"); writer.Int(building.id);
+        writer.Key("type"); writer.Int(building.type);
+        writer.Key("level"); writer.Int(building.level);
+        writer.Key("gridX"); writer.Int(building.gridX);
+        writer.Key("gridY"); writer.Int(building.gridY);
+        writer.Key("state"); writer.Int(static_cast<int>(building.state));
+        writer.Key("finishTime"); writer.Int64(building.finishTime);
+        writer.Key("isInitialConstruction"); writer.Bool(building.isInitialConstruction);
+        writer.Key("currentHP"); writer.Int(building.currentHP);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    // 兵种研究等级
+    writer.Key("troopLevels");
+    writer.StartArray();
+    for (const auto& pair : data.troopLevels) {
+        writer.StartObject();
+        writer.Key("id"); writer.Int(pair.first);
+        writer.Key("level"); writer.Int(pair.second);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    // 研究状态
+    writer.Key("researchingTroopId"); writer.Int(data.researchingTroopId);
+    writer.Key("researchFinishTime"); writer.Int64(data.researchFinishTime);
+
+    // 日志代数，读档时只回放代数相同的日志
+    writer.Key("journalGeneration"); writer.Uint64(generation);
+
+    writer.EndObject();
+    return json;
+}
+
+bool VillageSaveCodec::read(const char* json, size_t size, VillageSaveSnapshot& out, uint64_t& generation) {
+    // 在副本上解析，出错时不留下一半数据
+    VillageSaveSnapshot result;
+    result.data.gold = out.data.gold;
+    result.data.elixir = out.data.elixir;
+    result.data.gem = out.data.gem;
+    result.currentThemeId = out.currentThemeId;
+    uint64_t parsedGeneration = 0;
+
+    SaveHandler handler(result, parsedGeneration);
+    rapidjson::MemoryStream stream(json, size);
+    rapidjson::Reader reader;
+    if (reader.Parse(stream, handler).IsError()) {
+        return false;
+    }
+
+    out = std::move(result);
+    generation = parsedGeneration;
+    return true;
+}
@@ -0,0 +1,30 @@
+﻿// VillageSaveCodec.h
+// 村庄存档 JSON 编解码声明，SAX 流式读取、Writer 流式写出，不构建 DOM
+
+#ifndef __VILLAGE_SAVE_CODEC_H__
+#define __VILLAGE_SAVE_CODEC_H__
+
+#include "VillageData.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 村庄存档编解码器（village.json）
+// - 读取用 rapidjson::Reader 的 SAX 回调，边解析边填充 BuildingInstance / 军队 / 兵种等级 / 场景，
+//   不生成 Document 树，峰值内存约为结果本身
+// - 写出用 rapidjson::Writer 直接写入预留好容量的字符串，字段顺序和格式与旧版 DOM 写法一致
+// 只访问传入数据，可在后台线程调用
+class VillageSaveCodec {
+public:
+    static const int MISSING_HP = -1;               // 旧存档没有 currentHP 字段，由调用方按建筑配置补满
+
+    // 写出完整存档，generation 为对应日志的代数
+    static std::string write(const VillageSaveSnapshot& snapshot, uint64_t generation);
+
+    // 解析存档到 out
+    // - 资源和当前场景只在存档中出现时覆盖 out 中的值，其余列表和研究状态以存档为准
+    // - 格式错误返回 false，out 保持不变
+    static bool read(const char* json, size_t size, VillageSaveSnapshot& out, uint64_t& generation);
+};
+
+#endif // __VILLAGE_SAVE_CODEC_H__
@@ -12,19 +12,36 @@
 #include "Controller/TrapSystem.h"
 #include "Controller/DefenseSystem.h"
 #include "Controller/DestructionTracker.h"
+#include "Controller/BattleEventBus.h"
+#include "Controller/AttackPlanner.h"
 #include "Manager/VillageDataManager.h"
 #include "Manager/BuildingManager.h"
 #include "Manager/AudioManager.h"
 #include "Model/BuildingConfig.h"
+#include "Model/TroopConfig.h"
 #include "UI/BattleProgressUI.h"
 #include "Util/FindPathUtil.h"
 #include "Util/GridMapUtils.h"
 #include "Util/RandomBattleMapGenerator.h"
 #include "Component/DefenseBuildingAnimation.h"
+#include <algorithm>
 #include <iostream>
 
 USING_NS_CC;
 
+namespace {
+
+// 跳到结尾/跳转时推进调度器的步长（秒）
+const float FAST_FORWARD_STEP = 1.0f / 30.0f;
+
+// 战斗阶段时长（秒）
+const float FIGHTING_TIME_LIMIT = 180.0f;
+
+// 回放结束后到进入结算的最长延迟（秒），覆盖 show_replay_result 和 auto_end_battle
+const float REPLAY_RESULT_DELAY = 2.0f;
+
+} // namespace
+
 Scene* BattleScene::createScene() {
     return BattleScene::create();
 }
@@ -83,7 +100,7 @@ bool BattleScene::init() {
     CCLOG("BattleScene: Entered battle mode");
 
     // 更新寻路地图
-    FindPathUtil::getInstance()->updatePathfindingMap();
+    FindPathUtil::getInstance()->updatePathfindingMap(VillageDataManager::getInstance()->getBattleState());
     CCLOG("BattleScene: Pathfinding map updated for battle");
 
     switchState(BattleState::PREPARE);
@@ -99,8 +116,8 @@ bool BattleScene::init() {
     // 开启触摸监听
     setupTouchListener();
 
-    // 设置建筑摧毁事件监听
-    setupBuildingDestroyedListener();
+    // 订阅战斗事件（建筑摧毁、进度、星星）
+    setupBattleEventSubscription();
 
     // 创建战斗进度UI
     _battleProgressUI = BattleProgressUI::create();
@@ -109,19 +126,6 @@ bool BattleScene::init() {
         CCLOG("BattleScene: Battle progress UI initialized");
     }
 
-    // 注册事件监听
-    auto dispatcher = Director::getInstance()->getEventDispatcher();
-
-    _progressListener = dispatcher->addCustomEventListener(
-        "EVENT_DESTRUCTION_PROGRESS_UPDATED",
-        CC_CALLBACK_1(BattleScene::onProgressUpdated, this)
-    );
-
-    _starListener = dispatcher->addCustomEventListener(
-        "EVENT_STAR_AWARDED",
-        CC_CALLBACK_1(BattleScene::onStarAwarded, this)
-    );
-
     return true;
 }
 
@@ -148,7 +152,6 @@ void BattleScene::onEnter() {
         // 正常模式：生成随机地图
         loadEnemyVillage();
         setupTouchListener();
-        setupBuildingDestroyedListener();
 
         // 初始化摧毁追踪（只在正常模式）
         DestructionTracker::getInstance()->initTracking();
@@ -158,6 +161,9 @@ void BattleScene::onEnter() {
 }
 
 void BattleScene::update(float dt) {
+    // 推进录制时钟（与帧率无关）
+    _recorder.updateRecording(dt);
+
     if (_currentState == BattleState::PREPARE || _currentState == BattleState::FIGHTING) {
         _stateTimer -= dt;
         if (_hudLayer) _hudLayer->updateTimer((int)_stateTimer);
@@ -174,20 +180,56 @@ void BattleScene::update(float dt) {
         
         // 建筑防御系统和陷阱系统自动更新
         if (_currentState == BattleState::FIGHTING) {
-            auto troopLayer = dynamic_cast<BattleTroopLayer*>(_mapLayer->getChildByTag(999));
-            if (troopLayer) {
-                DefenseSystem::getInstance()->updateBuildingDefense(troopLayer);
-                TrapSystem::getInstance()->updateTrapDetection(troopLayer);
-            }
+            updateBattleSystems(dt);
         }
     }
     
     // 回放播放逻辑
     if (_recorder.isReplayMode() && _currentState == BattleState::FIGHTING) {
         updateReplay(dt);
+
+        if (_hudLayer && _recorder.getReplayData().battleDuration > 0.0f) {
+            _hudLayer->updateReplayProgress(_recorder.getReplayTime() / _recorder.getReplayData().battleDuration);
+        }
+    }
+
+    // 按间隔保存关键帧（录制时写入回放；回放旧版文件时补录）
+    if (_currentState == BattleState::FIGHTING) {
+        auto troopLayer = dynamic_cast<BattleTroopLayer*>(_mapLayer->getChildByTag(999));
+        _recorder.captureKeyframeIfDue(troopLayer, _lootedGold, _lootedElixir);
+    }
+
+    // 每帧统一分发一次本帧产生的战斗事件
+    BattleEventBus::getInstance()->dispatchPending();
+}
+
+void BattleScene::updateBattleSystems(float dt) {
+    auto troopLayer = dynamic_cast<BattleTroopLayer*>(_mapLayer->getChildByTag(999));
+    if (!troopLayer) return;
+
+    // 按固定步长推进，与帧率和倍速无关：倍速下一帧执行多步，高帧率下部分帧不执行
+    // 录制和回放在相同的战斗时间执行相同的步，状态哈希按步数采样才能逐个比对
+    // 录制时兵种在帧之间部署，从下一步开始参与结算；回放在每步之前补上该步之前到时的部署
+    const float tick = BattleRecorder::SYSTEM_TICK;
+    _systemAccumulator += dt;
+    while (_systemAccumulator >= tick) {
+        _systemAccumulator -= tick;
+        _recorder.deployDueTroops((_systemTick + 1) * tick, troopLayer);
+        DefenseSystem::getInstance()->updateBuildingDefense(troopLayer, tick);
+        TrapSystem::getInstance()->updateTrapDetection(troopLayer, tick);
+
+        ++_systemTick;
+        _recorder.sampleStateHash(_systemTick, troopLayer);
     }
 }
 
+void BattleScene::resetSystemClock() {
+    const float tick = BattleRecorder::SYSTEM_TICK;
+    float clock = _recorder.getBattleClock();
+    _systemTick = static_cast<int>(std::floor(clock / tick));
+    _systemAccumulator = clock - _systemTick * tick;
+}
+
 void BattleScene::switchState(BattleState newState) {
     CCLOG("##############################################");
     CCLOG("BattleScene::switchState");
@@ -226,7 +268,8 @@ void BattleScene::switchState(BattleState newState) {
             
         case BattleState::FIGHTING:
             CCLOG(">>> Entering FIGHTING state");
-            _stateTimer = 180.0f;
+            _stateTimer = FIGHTING_TIME_LIMIT;
+            resetSystemClock();
             
             // 保存当前地图状态到回放数据
             if (!_recorder.isReplayMode()) {
@@ -266,6 +309,13 @@ void BattleScene::switchState(BattleState newState) {
         case BattleState::RESULT:
             CCLOG(">>> Entering RESULT state");
             _stateTimer = 0;
+
+            // 结算时不再需要推荐方案
+            AttackPlanner::getInstance()->cancel();
+            clearAttackSuggestion();
+
+            // 结算界面恢复正常速度
+            _recorder.resetPlaybackSpeed();
             
             // 停止所有战斗音乐
             CCLOG(">>> Stopping all combat music");
@@ -346,11 +396,18 @@ void BattleScene::loadEnemyVillage() {
 void BattleScene::onNextOpponentClicked() {
     if (_isSearching) return;
 
+    // 旧地图的推荐方案不再适用
+    AttackPlanner::getInstance()->cancel();
+    clearAttackSuggestion();
+
     // 执行云层过渡动画
     performCloudTransition([this]() {
         // 云层遮住屏幕时刷新地图
         this->loadEnemyVillage();
 
+        // 新对手的建筑需要重新建立摧毁追踪
+        DestructionTracker::getInstance()->initTracking();
+
         // 重置侦查倒计时
         _stateTimer = 30.0f;
     }, false);
@@ -361,6 +418,9 @@ void BattleScene::onEndBattleClicked() {
     CCLOG("BattleScene::onEndBattleClicked - START");
     CCLOG("========================================");
 
+    // 先分发本帧尚未处理的战斗事件，确保星数和掠夺数据是最新的
+    BattleEventBus::getInstance()->dispatchPending();
+
     // 停止所有战斗音乐
     auto audioManager = AudioManager::getInstance();
     if (_combatPlanningMusicID != -1) {
@@ -467,16 +527,18 @@ void BattleScene::onReturnHomeClicked() {
     
     // 退出战斗模式，切换回村庄数据源
     dataManager->setInBattleMode(false);
+
+    // 掠夺的资源需要存档（addGold/addElixir 只通知界面刷新）
+    if (_lootedGold > 0 || _lootedElixir > 0) {
+        dataManager->requestSave();
+    }
     
     // 只在返回村庄时才重置建筑状态
     BattleProcessController::getInstance()->resetBattleState();
     CCLOG("BattleScene: Building states reset when returning home");
     
-    // 清理建筑摧毁事件监听器
-    if (_buildingDestroyedListener) {
-        _eventDispatcher->removeEventListener(_buildingDestroyedListener);
-        _buildingDestroyedListener = nullptr;
-    }
+    // 取消战斗事件订阅
+    cleanupBattleEventSubscription();
     
     // 重置战斗进度UI
     if (_battleProgressUI) {
@@ -815,6 +877,107 @@ void BattleScene::showPlacementTip(const std::string& message, const cocos2d::Ve
     ));
 }
 
+// ========== 推荐进攻方案 ==========
+
+void BattleScene::onSuggestAttackClicked() {
+    if (_currentState != BattleState::PREPARE || _isSearching) return;
+    if (_recorder.isReplayMode()) return;
+
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+    Vec2 tipPos(visibleSize.width / 2, visibleSize.height / 2);
+
+    auto planner = AttackPlanner::getInstance();
+    if (planner->isSearching()) {
+        showPlacementTip("正在计算中，请稍候", tipPos);
+        return;
+    }
+
+    // 以剩余兵力为准，模拟在后台线程进行，结果回到主线程显示
+    const auto& mapData = VillageDataManager::getInstance()->getBattleMapData();
+    bool started = planner->requestSuggestion(mapData, _remainingTroops, [this](const AttackPlan& plan) {
+        showAttackSuggestion(plan);
+    });
+
+    if (started) {
+        clearAttackSuggestion();
+        showPlacementTip("正在分析进攻方案...", tipPos);
+    }
+}
+
+void BattleScene::showAttackSuggestion(const AttackPlan& plan) {
+    clearAttackSuggestion();
+    if (_currentState == BattleState::RESULT || !_mapLayer) return;
+
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+    if (plan.deployments.empty()) {
+        showPlacementTip("没有可用的进攻方案", Vec2(visibleSize.width / 2, visibleSize.height / 2));
+        return;
+    }
+
+    // 按 兵种 + 放兵点 合并，保持首次部署的先后顺序
+    struct Marker {
+        int troopId;
+        int gridX;
+        int gridY;
+        int count;
+    };
+    std::vector<Marker> markers;
+    for (const auto& d : plan.deployments) {
+        auto it = std::find_if(markers.begin(), markers.end(), [&d](const Marker& m) {
+            return m.troopId == d.troopId && m.gridX == d.gridX && m.gridY == d.gridY;
+        });
+        if (it != markers.end()) {
+            it->count++;
+        } else {
+            markers.push_back({ d.troopId, d.gridX, d.gridY, 1 });
+        }
+    }
+
+    _suggestionNode = Node::create();
+    _mapLayer->addChild(_suggestionNode, 1000);
+
+    auto troopConfig = TroopConfig::getInstance();
+    for (size_t i = 0; i < markers.size(); ++i) {
+        const auto& m = markers[i];
+        Vec2 pos = GridMapUtils::gridToPixelCenter(m.gridX, m.gridY);
+
+        auto dot = DrawNode::create();
+        dot->drawSolidCircle(pos, 10.0f, 0.0f, 16, Color4F(0.0f, 1.0f, 1.0f, 0.8f));
+        _suggestionNode->addChild(dot);
+
+        std::string name = troopConfig->getTroopById(m.troopId).name;
+        auto label = Label::createWithTTF(
+            StringUtils::format("%d. %s x%d", static_cast<int>(i + 1), name.c_str(), m.count),
+            "fonts/simhei.ttf", 20);
+        label->setPosition(pos + Vec2(0, 22));
+        label->setColor(Color3B(0, 255, 255));
+        label->enableOutline(Color4B::BLACK, 2);
+        _suggestionNode->addChild(label);
+    }
+
+    _suggestionLabel = Label::createWithTTF(
+        StringUtils::format("推荐方案：预计 %.1f 星，摧毁 %.0f%%，掠夺 %.0f",
+                            plan.expectedStars, plan.expectedDestruction, plan.expectedLoot),
+        "fonts/simhei.ttf", 24);
+    _suggestionLabel->setPosition(Vec2(visibleSize.width / 2, visibleSize.height - 80));
+    _suggestionLabel->setColor(Color3B(0, 255, 255));
+    _suggestionLabel->enableOutline(Color4B::BLACK, 2);
+    this->addChild(_suggestionLabel, 150);
+
+    CCLOG("BattleScene: Attack suggestion shown (%zu markers, %d samples)", markers.size(), plan.samples);
+}
+
+void BattleScene::clearAttackSuggestion() {
+    if (_suggestionNode) {
+        _suggestionNode->removeFromParent();
+        _suggestionNode = nullptr;
+    }
+    if (_suggestionLabel) {
+        _suggestionLabel->removeFromParent();
+        _suggestionLabel = nullptr;
+    }
+}
+
 // ========== 兵种追踪系统实现 ==========
 
 void BattleScene::initBattleTroops() {
@@ -882,98 +1045,80 @@ void BattleScene::addLootedElixir(int amount) {
     }
 }
 
-void BattleScene::setupBuildingDestroyedListener() {
-    _buildingDestroyedListener = EventListenerCustom::create(
-        "EVENT_BUILDING_DESTROYED",
-        CC_CALLBACK_1(BattleScene::onBuildingDestroyed, this)
-    );
-    _eventDispatcher->addEventListenerWithSceneGraphPriority(_buildingDestroyedListener, this);
-    CCLOG("BattleScene: Building destroyed listener setup");
+void BattleScene::setupBattleEventSubscription() {
+    auto eventBus = BattleEventBus::getInstance();
+
+    // 丢弃上一场战斗残留的事件
+    eventBus->clear();
+
+    if (_battleEventSubscription != 0) return;
+
+    _battleEventSubscription = eventBus->subscribe(
+        BattleEventBus::maskOf(BattleEventType::BUILDING_DESTROYED) |
+        BattleEventBus::maskOf(BattleEventType::DESTRUCTION_PROGRESS) |
+        BattleEventBus::maskOf(BattleEventType::STAR_AWARDED),
+        [this](const BattleEvent& event) {
+        switch (event.type) {
+            case BattleEventType::BUILDING_DESTROYED:   onBuildingDestroyed(event); break;
+            case BattleEventType::DESTRUCTION_PROGRESS: onProgressUpdated(event);   break;
+            case BattleEventType::STAR_AWARDED:         onStarAwarded(event);       break;
+            default: break;
+        }
+    });
+    CCLOG("BattleScene: Battle event subscription setup");
 }
 
-void BattleScene::onBuildingDestroyed(cocos2d::EventCustom* event) {
-    BuildingInstance* building = static_cast<BuildingInstance*>(event->getUserData());
-    if (!building) return;
-    
-    CCLOG("BattleScene: Building destroyed - ID=%d, Type=%d", building->id, building->type);
+void BattleScene::cleanupBattleEventSubscription() {
+    if (_battleEventSubscription != 0) {
+        BattleEventBus::getInstance()->unsubscribe(_battleEventSubscription);
+        _battleEventSubscription = 0;
+    }
+}
+
+void BattleScene::onBuildingDestroyed(const BattleEvent& event) {
+    CCLOG("BattleScene: Building destroyed - ID=%d, Type=%d", event.buildingId, event.buildingType);
     
     // 检查是否是储存建筑
-    if (building->type == 204) {  // 储金罐
+    if (event.buildingType == 204) {  // 储金罐
         addLootedGold(_goldPerStorage);
         CCLOG("BattleScene: Gold storage destroyed, looted %d gold", _goldPerStorage);
     }
-    else if (building->type == 205) {  // 圣水瓶
+    else if (event.buildingType == 205) {  // 圣水瓶
         addLootedElixir(_elixirPerStorage);
         CCLOG("BattleScene: Elixir storage destroyed, looted %d elixir", _elixirPerStorage);
     }
-    
-    //检查是否所有建筑都已被摧毁
-    if (_currentState == BattleState::FIGHTING) {
-        checkAllBuildingsDestroyed();
-    }
 }
 
 void BattleScene::checkAllBuildingsDestroyed() {
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
-    
-    // 遍历所有建筑，检查是否还有未摧毁的建筑（不包括城墙）
-    bool allDestroyed = true;
-    int totalBuildings = 0;
-    int destroyedBuildings = 0;
-    
-    for (const auto& building : buildings) {
-        // 跳过放置中的建筑和城墙（城墙类型为303）
-        if (building.state == BuildingInstance::State::PLACING) {
-            continue;
-        }
-        if (building.type == 303 || building.type == 401 || building.type == 404) {  // 城墙和陷阱不计入判定
-            continue;
-        }
-        
-        totalBuildings++;
-        
-        if (building.isDestroyed || building.currentHP <= 0) {
-            destroyedBuildings++;
-        } else {
-            allDestroyed = false;
-        }
-    }
-    
-    CCLOG("BattleScene: Building check - %d/%d destroyed", destroyedBuildings, totalBuildings);
-    
-    // 如果所有建筑都已被摧毁，自动进入结算页面
-    if (allDestroyed && totalBuildings > 0) {
-        CCLOG("BattleScene: All buildings destroyed! Automatically ending battle.");
-        
-        // 使用延迟调度器，让玩家有时间看到最后一个建筑被摧毁的效果
-        this->scheduleOnce([this](float) {
-            onEndBattleClicked();
-        }, 1.5f, "auto_end_battle");
+    // 由 DestructionTracker 维护存活计数，这里只做计数判断
+    if (!DestructionTracker::getInstance()->areAllBuildingsDestroyed()) {
+        return;
     }
-}
 
-void BattleScene::onProgressUpdated(EventCustom* event) {
-    auto data = static_cast<DestructionProgressEventData*>(event->getUserData());
-    if (!data) return;
+    CCLOG("BattleScene: All buildings destroyed! Automatically ending battle.");
 
+    // 使用延迟调度器，让玩家有时间看到最后一个建筑被摧毁的效果
+    this->scheduleOnce([this](float) {
+        onEndBattleClicked();
+    }, 1.5f, "auto_end_battle");
+}
+
+void BattleScene::onProgressUpdated(const BattleEvent& event) {
     //更新战斗进度UI
     if (_battleProgressUI) {
-        _battleProgressUI->updateProgress(data->progress);
+        _battleProgressUI->updateProgress(event.progress);
     }
 
-    CCLOG("BattleScene: Progress updated to %.1f%%, Stars: %d",
-          data->progress, data->stars);
+    // 进度事件在 DestructionTracker 处理完摧毁事件之后投递，此时存活计数已是最新
+    if (_currentState == BattleState::FIGHTING) {
+        checkAllBuildingsDestroyed();
+    }
 }
 
-void BattleScene::onStarAwarded(EventCustom* event) {
-    auto data = static_cast<StarAwardedEventData*>(event->getUserData());
-    if (!data) return;
+void BattleScene::onStarAwarded(const BattleEvent& event) {
+    int starIndex = event.value;
 
-    int starIndex = data->starIndex;
-
-    CCLOG("BattleScene: Star #%d awarded! Reason: %s",
-          starIndex + 1, data->reason.c_str());
+    CCLOG("BattleScene: Star #%d awarded!", starIndex + 1);
 
     //更新战斗进度UI的星星
     if (_battleProgressUI) {
@@ -986,16 +1131,13 @@ void BattleScene::onExit() {
     CCLOG("BattleScene::onExit - Cleaning up resources");
 
     cleanupTouchListener();
+    cleanupBattleEventSubscription();
 
-    if (_progressListener) {
-        Director::getInstance()->getEventDispatcher()->removeEventListener(_progressListener);
-        _progressListener = nullptr;
-    }
+    // 丢弃进行中的方案搜索，避免回调访问已退出的场景
+    AttackPlanner::getInstance()->cancel();
 
-    if (_starListener) {
-        Director::getInstance()->getEventDispatcher()->removeEventListener(_starListener);
-        _starListener = nullptr;
-    }
+    // 回放倍速作用于全局调度器，离开场景时必须恢复
+    _recorder.resetPlaybackSpeed();
 
     Scene::onExit();
 }
@@ -1025,9 +1167,8 @@ BattleScene* BattleScene::createReplayScene(const BattleReplayData& replayData)
 void BattleScene::startReplay() {
     if (!_recorder.isReplayMode()) return;
 
-    const auto& replayData = _recorder.getReplayData();
     CCLOG("BattleScene: Starting replay playback with %zu events",
-          replayData.troopEvents.size());
+          _recorder.getReplayData().troopEvents.size());
 
     _recorder.startReplay(_hudLayer, [this]() {
         switchState(BattleState::FIGHTING);
@@ -1079,6 +1220,96 @@ void BattleScene::updateReplay(float dt) {
     });
 }
 
+void BattleScene::onReplaySpeedClicked() {
+    if (!_recorder.isReplayMode() || _currentState != BattleState::FIGHTING) return;
+
+    float speed = _recorder.cyclePlaybackSpeed();
+    if (_hudLayer) _hudLayer->updateReplaySpeed(speed);
+}
+
+void BattleScene::onReplaySkipClicked() {
+    if (!_recorder.isReplayMode() || _currentState != BattleState::FIGHTING) return;
+    if (_recorder.isFastForwarding()) return;
+
+    CCLOG("BattleScene: Skipping replay to end from %.2fs", _recorder.getReplayTime());
+
+    // 回放时长之后还有结算延迟，推进到进入结算为止
+    fastForwardReplay(_recorder.getReplayData().battleDuration + REPLAY_RESULT_DELAY);
+}
+
+void BattleScene::onReplaySeek(float fraction) {
+    if (!_recorder.isReplayMode() || _currentState != BattleState::FIGHTING) return;
+    if (_recorder.isFastForwarding()) return;
+
+    fraction = std::max(0.0f, std::min(fraction, 1.0f));
+    seekReplay(fraction * _recorder.getReplayData().battleDuration);
+}
+
+void BattleScene::seekReplay(float targetTime) {
+    auto troopLayer = dynamic_cast<BattleTroopLayer*>(_mapLayer->getChildByTag(999));
+    if (!troopLayer) return;
+
+    float currentTime = _recorder.getReplayTime();
+    const BattleKeyframe* keyframe = _recorder.findKeyframe(targetTime);
+    float keyframeTime = keyframe ? keyframe->time : 0.0f;
+
+    CCLOG("BattleScene: Seeking replay %.2fs -> %.2fs (keyframe @ %.2fs)",
+          currentTime, targetTime, keyframeTime);
+
+    // 目标在当前时间之后、且当前时间不早于最近关键帧时，直接快进更省；否则先恢复关键帧
+    if (targetTime < currentTime || currentTime < keyframeTime) {
+        restoreReplayState(keyframe, troopLayer);
+    }
+
+    fastForwardReplay(targetTime);
+}
+
+void BattleScene::restoreReplayState(const BattleKeyframe* keyframe, BattleTroopLayer* troopLayer) {
+    // 丢弃旧时间线上的结算定时器和未分发的战斗事件
+    this->unschedule("show_replay_result");
+    this->unschedule("auto_end_battle");
+    BattleEventBus::getInstance()->clear();
+
+    _recorder.restoreKeyframe(keyframe, _mapLayer, troopLayer);
+    resetSystemClock();
+
+    _stateTimer = FIGHTING_TIME_LIMIT - _recorder.getReplayTime();
+    if (_hudLayer) _hudLayer->updateTimer((int)_stateTimer);
+
+    _lootedGold = keyframe ? keyframe->lootedGold : 0;
+    _lootedElixir = keyframe ? keyframe->lootedElixir : 0;
+    if (_hudLayer) {
+        _hudLayer->updateLootDisplay(_lootedGold, _lootedElixir,
+                                     _totalLootableGold, _totalLootableElixir);
+    }
+
+    auto tracker = DestructionTracker::getInstance();
+    if (_battleProgressUI) {
+        _battleProgressUI->updateProgress(tracker->getProgress());
+        _battleProgressUI->updateStars(tracker->getStars());
+    }
+}
+
+void BattleScene::fastForwardReplay(float targetTime) {
+    float remaining = targetTime - _recorder.getReplayTime();
+    if (remaining <= 0.0f) return;
+
+    _recorder.setFastForwarding(true);
+
+    // 不渲染中间帧：以固定步长直接推进调度器（动作、场景update、定时回调）
+    // 步数上限按剩余时长计算，防止异常数据导致死循环
+    int maxSteps = static_cast<int>(std::ceil(remaining / FAST_FORWARD_STEP)) + 1;
+
+    this->retain();
+    auto scheduler = Director::getInstance()->getScheduler();
+    for (int i = 0; i < maxSteps && _currentState == BattleState::FIGHTING &&
+                    _recorder.getReplayTime() < targetTime; ++i) {
+        scheduler->update(FAST_FORWARD_STEP);
+    }
+    _recorder.setFastForwarding(false);
+    this->release();
+}
+
 void BattleScene::loadReplayMap() {
     _recorder.loadReplayMap(_mapLayer, _hudLayer);
 
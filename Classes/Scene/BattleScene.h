@@ -21,9 +21,10 @@ class BattleMapLayer;
 class BattleHUDLayer;
 class BattleResultLayer;
 class BattleProgressUI;
+class BattleTroopLayer;
 
-struct DestructionProgressEventData;
-struct StarAwardedEventData;
+struct BattleEvent;
+struct AttackPlan;
 
 class BattleScene : public cocos2d::Scene {
 public:
@@ -47,6 +48,10 @@ public:
     void onNextOpponentClicked();
     void onEndBattleClicked();
     void onReturnHomeClicked();
+    void onSuggestAttackClicked();  // 侦查阶段请求推荐进攻方案
+    void onReplaySpeedClicked();    // 回放倍速切换
+    void onReplaySkipClicked();     // 回放跳到结尾
+    void onReplaySeek(float fraction);  // 回放跳转到指定进度（0-1）
 
     // 兵种追踪系统
     int getRemainingTroopCount(int troopId) const;
@@ -68,6 +73,10 @@ private:
     BattleState _currentState = BattleState::PREPARE;
     float _stateTimer = 0.0f;
 
+    // 防御/陷阱系统的固定步长时钟（按战斗时钟对齐，录制和回放的步数一致）
+    int _systemTick = 0;                // 已执行的步数
+    float _systemAccumulator = 0.0f;    // 不足一步的剩余时间（秒）
+
     BattleMapLayer* _mapLayer = nullptr;
     BattleHUDLayer* _hudLayer = nullptr;
     BattleResultLayer* _resultLayer = nullptr;
@@ -89,14 +98,14 @@ private:
     int _totalLootableElixir = 0;  // 总可掠夺圣水
     int _goldPerStorage = 0;       // 每个储金罐的资源
     int _elixirPerStorage = 0;     // 每个圣水瓶的资源
-    cocos2d::EventListenerCustom* _buildingDestroyedListener = nullptr;
-    void onBuildingDestroyed(cocos2d::EventCustom* event);
+    void onBuildingDestroyed(const BattleEvent& event);
     void checkAllBuildingsDestroyed();  // 检查是否所有建筑都已被摧毁
 
     // 触摸监听和兵种部署
     void setupTouchListener();
     void cleanupTouchListener();
-    void setupBuildingDestroyedListener();
+    void setupBattleEventSubscription();
+    void cleanupBattleEventSubscription();
 
     bool onTouchBegan(cocos2d::Touch* touch, cocos2d::Event* event);
     void onTouchMoved(cocos2d::Touch* touch, cocos2d::Event* event);
@@ -125,13 +134,18 @@ private:
     // 战斗进度UI
     BattleProgressUI* _battleProgressUI = nullptr;
 
-    // 事件监听器
-    cocos2d::EventListenerCustom* _progressListener = nullptr;
-    cocos2d::EventListenerCustom* _starListener = nullptr;
+    // 推荐进攻方案显示
+    cocos2d::Node* _suggestionNode = nullptr;     // 地图上的放兵点标记
+    cocos2d::Label* _suggestionLabel = nullptr;   // 屏幕顶部的方案摘要
+    void showAttackSuggestion(const AttackPlan& plan);
+    void clearAttackSuggestion();
+
+    // 战斗事件总线订阅ID
+    int _battleEventSubscription = 0;
 
     // 回调函数
-    void onProgressUpdated(cocos2d::EventCustom* event);
-    void onStarAwarded(cocos2d::EventCustom* event);
+    void onProgressUpdated(const BattleEvent& event);
+    void onStarAwarded(const BattleEvent& event);
 
     // 回放录制系统（委托给BattleRecorder）
     BattleRecorder _recorder;                // 回放录制/播放管理器
@@ -145,6 +159,13 @@ private:
     // 回放相关方法（委托给_recorder）
     void startReplay();
     void updateReplay(float dt);
+    void seekReplay(float targetTime);          // 从最近的关键帧恢复后快进到目标时间
+    void restoreReplayState(const BattleKeyframe* keyframe, BattleTroopLayer* troopLayer);
+    void fastForwardReplay(float targetTime);   // 不渲染地推进调度器直到目标时间或进入结算
+
+    // 按固定步长更新防御和陷阱系统（倍速回放时 dt 会被放大），每步结束时采样状态哈希
+    void updateBattleSystems(float dt);
+    void resetSystemClock();    // 把固定步长时钟对齐到当前战斗时间（进入战斗和回放跳转时调用）
 
     void loadReplayMap();  // 加载回放地图
     virtual void onEnter() override;
@@ -2,6 +2,7 @@
 // 村庄场景实现，包含村庄层、军队层和HUD层
 
 #include "VillageScene.h"
+#include "Manager/AtlasManager.h"
 #include "Layer/HUDLayer.h"
 #include "Layer/BattleTroopLayer.h"
 #include "Layer/ReplayListLayer.h"
@@ -57,7 +58,7 @@ bool VillageScene::init() {
   auto visibleSize = Director::getInstance()->getVisibleSize();
 
   // 回放按钮
-  auto replayBtn = Button::create("UI/replay/replay_enter.png");
+  auto replayBtn = AtlasManager::getInstance()->createButton("UI/replay/replay_enter.png");
   replayBtn->setPosition(Vec2(60, visibleSize.height - 200));
   replayBtn->setScale(0.8f);
   replayBtn->addClickEventListener([this](Ref*) {
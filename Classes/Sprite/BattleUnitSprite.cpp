@@ -4,8 +4,8 @@
 #include "BattleUnitSprite.h"
 #include "Util/GridMapUtils.h"
 #include "Util/FindPathUtil.h"
-#include "Model/TroopConfig.h"
 #include "Manager/AnimationManager.h"
+#include "Controller/BattleRules.h"
 #include <algorithm>
 #include <cmath>
 
@@ -24,34 +24,9 @@ BattleUnitSprite* BattleUnitSprite::create(const std::string& unitType) {
 bool BattleUnitSprite::init(const std::string& unitType) {
     _unitType = unitType;
     _unitTypeID = parseUnitType(unitType);
+    _animationId = AnimationManager::getInstance()->getUnitAnimationId(unitType);
     _currentAnimation = AnimationType::IDLE;
     _isAnimating = false;
-    _currentGridPos = Vec2::ZERO;
-
-    auto troopConfig = TroopConfig::getInstance();
-
-    // 根据兵种类型映射troopID
-    int troopID = 0;
-    switch (_unitTypeID) {
-        case UnitTypeID::BARBARIAN:    troopID = 1001; break;
-        case UnitTypeID::ARCHER:       troopID = 1002; break;
-        case UnitTypeID::GOBLIN:       troopID = 1003; break;
-        case UnitTypeID::GIANT:        troopID = 1004; break;
-        case UnitTypeID::WALL_BREAKER: troopID = 1005; break;
-        case UnitTypeID::BALLOON:      troopID = 1006; break;
-        default:
-            CCLOG("BattleUnitSprite: Unknown unit type, defaulting to Barbarian HP");
-            troopID = 1001;
-            break;
-    }
-
-    // 从配置获取生命值
-    TroopInfo troopInfo = troopConfig->getTroopById(troopID);
-    _maxHP = troopInfo.hitpoints;
-    _currentHP = _maxHP;
-
-    CCLOG("BattleUnitSprite: Initialized %s with HP: %d/%d",
-          unitType.c_str(), _currentHP, _maxHP);
 
     bool success = false;
     if (_unitTypeID == UnitTypeID::BALLOON) {
@@ -126,12 +101,16 @@ void BattleUnitSprite::update(float dt) {
     int currentGridX = static_cast<int>(std::floor(gridPos.x));
     int currentGridY = static_cast<int>(std::floor(gridPos.y));
     
+    // 移动由动作驱动，把补间后的网格坐标写回数据存储
+    if (_store) {
+        _store->setGridPosition(_storeIndex, gridPos.x, gridPos.y);
+    }
+
     if (currentGridX != _lastGridX || currentGridY != _lastGridY) {
-        _currentGridPos = gridPos;
         _lastGridX = currentGridX;
         _lastGridY = currentGridY;
         
-        // 根据网格位置更新Z轴顺序以实现正确的深度渲染
+        // 根据网格位置更新Z轴顺序以实现正确的深度渲染（地图层按深度分桶，只是换桶不会重排序）
         int zOrder = GridMapUtils::calculateZOrder(currentGridX, currentGridY);
         
         if (_unitTypeID == UnitTypeID::BALLOON) {
@@ -143,19 +122,21 @@ void BattleUnitSprite::update(float dt) {
 }
 
 void BattleUnitSprite::setTargetedByBuilding(bool targeted) {
+    if (!_store) return;
+
     if (this->isDead()) {
         // 死亡单位拒绝被锁定
-        if (_isTargetedByBuilding) {
-            _isTargetedByBuilding = false;
+        if (isTargetedByBuilding()) {
+            _store->setFlag(_storeIndex, BattleUnitStore::FLAG_TARGETED, false);
             this->setColor(Color3B::WHITE);
             CCLOG("BattleUnitSprite: Dead unit refusing targeting, color reset to WHITE");
         }
         return;
     }
 
-    if (_isTargetedByBuilding == targeted) return;
+    if (isTargetedByBuilding() == targeted) return;
 
-    _isTargetedByBuilding = targeted;
+    _store->setFlag(_storeIndex, BattleUnitStore::FLAG_TARGETED, targeted);
 
     if (targeted) {
         this->setColor(Color3B(255, 100, 100));
@@ -164,6 +145,78 @@ void BattleUnitSprite::setTargetedByBuilding(bool targeted) {
     }
 }
 
+bool BattleUnitSprite::isTargetedByBuilding() const {
+    return _store && _store->hasFlag(_storeIndex, BattleUnitStore::FLAG_TARGETED);
+}
+
+bool BattleUnitSprite::isChangingTarget() const {
+    return _store && _store->hasFlag(_storeIndex, BattleUnitStore::FLAG_CHANGING_TARGET);
+}
+
+void BattleUnitSprite::setChangingTarget(bool changing) {
+    if (_store) _store->setFlag(_storeIndex, BattleUnitStore::FLAG_CHANGING_TARGET, changing);
+}
+
+void BattleUnitSprite::setTargetBuildingId(int buildingId) {
+    if (_store) _store->setTargetBuildingId(_storeIndex, buildingId);
+}
+
+int BattleUnitSprite::getForcedTargetId() const {
+    return _store ? _store->getForcedTargetId(_storeIndex) : -1;
+}
+
+void BattleUnitSprite::setForcedTargetId(int buildingId) {
+    if (_store) _store->setForcedTargetId(_storeIndex, buildingId);
+}
+
+std::vector<Vec2> BattleUnitSprite::getRemainingPath() {
+    if (!isFollowingPath() || _pathIndex >= _path.size()) return std::vector<Vec2>();
+    return std::vector<Vec2>(_path.begin() + _pathIndex, _path.end());
+}
+
+float BattleUnitSprite::getAttackRemaining() {
+    if (_currentAnimation != AnimationType::ATTACK &&
+        _currentAnimation != AnimationType::ATTACK_UP &&
+        _currentAnimation != AnimationType::ATTACK_DOWN) {
+        return -1.0f;
+    }
+
+    auto action = dynamic_cast<ActionInterval*>(getActionByTag(ANIMATION_TAG));
+    if (!action || action->isDone()) return -1.0f;
+    return std::max(0.0f, action->getDuration() - action->getElapsed());
+}
+
+void BattleUnitSprite::resumeAttack(float remaining, const std::function<void()>& callback) {
+    stopCurrentAnimation();
+    _currentAnimation = AnimationType::ATTACK;
+
+    auto seq = Sequence::create(
+        DelayTime::create(std::max(0.0f, remaining)),
+        CallFunc::create([this, callback]() {
+            _isAnimating = false;
+            if (callback) callback();
+        }),
+        nullptr
+    );
+    seq->setTag(ANIMATION_TAG);
+    this->runAction(seq);
+}
+
+int BattleUnitSprite::getCurrentHP() const {
+    return _store ? _store->getHP(_storeIndex) : 0;
+}
+
+int BattleUnitSprite::getMaxHP() const {
+    return _store ? _store->getMaxHP(_storeIndex) : 0;
+}
+
+Vec2 BattleUnitSprite::getGridPosition() const {
+    if (_store) {
+        return Vec2(_store->getGridX(_storeIndex), _store->getGridY(_storeIndex));
+    }
+    return GridMapUtils::pixelToGrid(this->getPosition());
+}
+
 UnitTypeID BattleUnitSprite::parseUnitType(const std::string& unitType) {
     std::string lower = unitType;
     std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
@@ -225,13 +278,15 @@ void BattleUnitSprite::playAnimation(
         } else if (animType == AnimationType::ATTACK || 
                    animType == AnimationType::ATTACK_UP || 
                    animType == AnimationType::ATTACK_DOWN) {
-            // 攻击动画添加延迟模拟投弹
+            // 攻击动画添加延迟模拟投弹（与帧动画使用同一标签，便于查询剩余时间）
             if (callback) {
-                this->runAction(Sequence::create(
-                    DelayTime::create(0.8f),
+                auto seq = Sequence::create(
+                    DelayTime::create(BattleRules::getAttackDuration(_unitTypeID, animType)),
                     CallFunc::create(callback),
                     nullptr
-                ));
+                );
+                seq->setTag(ANIMATION_TAG);
+                this->runAction(seq);
             }
         } else {
             if (callback) {
@@ -248,16 +303,17 @@ void BattleUnitSprite::playAnimation(
     _isAnimating = true;
 
     if (loop) {
-        auto action = animMgr->createLoopAnimate(_unitType, animType);
-        if (!action) {
+        // 循环动画挂到共享时钟上，由 AnimationManager 统一换帧
+        if (!animMgr->playLoop(this, _animationId, animType)) {
             CCLOG("BattleUnitSprite: Failed to create loop animation");
             _isAnimating = false;
             return;
         }
-        action->setTag(ANIMATION_TAG);
-        this->runAction(action);
+        if (_culled) {
+            animMgr->setLoopFrozen(this, true);
+        }
     } else {
-        auto animate = animMgr->createOnceAnimate(_unitType, animType);
+        auto animate = animMgr->createOnceAnimate(_animationId, animType);
         if (!animate) {
             CCLOG("BattleUnitSprite: Failed to create animation");
             _isAnimating = false;
@@ -281,6 +337,7 @@ void BattleUnitSprite::playAnimation(
 
 void BattleUnitSprite::stopCurrentAnimation() {
   this->stopActionByTag(ANIMATION_TAG);
+  AnimationManager::getInstance()->stopLoop(this);
   _isAnimating = false;
 }
 
@@ -381,38 +438,8 @@ void BattleUnitSprite::selectWalkAnimation(const Vec2& direction,
 void BattleUnitSprite::selectAttackAnimation(const Vec2& direction,
                                              AnimationType& outAnimType,
                                              bool& outFlipX) {
-  float angle = getAngleFromDirection(direction);
-
-  // 角度归一化到[0, 360)
-  while (angle < 0) angle += 360;
-  while (angle >= 360) angle -= 360;
-
-  // 八方向选择攻击动画
-  if (angle >= 337.5f || angle < 22.5f) {
-    outAnimType = AnimationType::ATTACK;
-    outFlipX = false;
-  } else if (angle >= 22.5f && angle < 67.5f) {
-    outAnimType = AnimationType::ATTACK_UP;
-    outFlipX = false;
-  } else if (angle >= 67.5f && angle < 112.5f) {
-    outAnimType = AnimationType::ATTACK_UP;
-    outFlipX = false;
-  } else if (angle >= 112.5f && angle < 157.5f) {
-    outAnimType = AnimationType::ATTACK_UP;
-    outFlipX = true;
-  } else if (angle >= 157.5f && angle < 202.5f) {
-    outAnimType = AnimationType::ATTACK;
-    outFlipX = true;
-  } else if (angle >= 202.5f && angle < 247.5f) {
-    outAnimType = AnimationType::ATTACK_DOWN;
-    outFlipX = true;
-  } else if (angle >= 247.5f && angle < 292.5f) {
-    outAnimType = AnimationType::ATTACK_DOWN;
-    outFlipX = false;
-  } else {
-    outAnimType = AnimationType::ATTACK_DOWN;
-    outFlipX = false;
-  }
+  // 与无界面模拟共用同一套方向划分，攻击时长按所选动画计算
+  BattleRules::selectAttackAnimation(direction, outAnimType, outFlipX);
 }
 
 void BattleUnitSprite::walkToPosition(const Vec2& targetPos, float duration,
@@ -459,7 +486,7 @@ void BattleUnitSprite::walkByOffset(const Vec2& offset, float duration,
 }
 
 void BattleUnitSprite::setGridPosition(int gridX, int gridY) {
-  _currentGridPos = Vec2(gridX, gridY);
+  if (_store) _store->setGridPosition(_storeIndex, gridX, gridY);
   CCLOG("BattleUnitSprite: Grid position set to (%d, %d)", gridX, gridY);
 }
 
@@ -469,7 +496,7 @@ void BattleUnitSprite::teleportToGrid(int gridX, int gridY) {
     return;
   }
 
-  _currentGridPos = Vec2(gridX, gridY);
+  if (_store) _store->setGridPosition(_storeIndex, gridX, gridY);
   Vec2 pixelPos = GridMapUtils::gridToPixelCenter(gridX, gridY);
   this->setPosition(pixelPos);
 
@@ -496,7 +523,7 @@ void BattleUnitSprite::walkToGrid(int targetGridX, int targetGridY, float speed,
         targetGridX, targetGridY, distance, duration);
 
   walkToPosition(targetPixelPos, duration, [this, targetGridX, targetGridY, callback]() {
-    _currentGridPos = Vec2(targetGridX, targetGridY);
+    if (_store) _store->setGridPosition(_storeIndex, targetGridX, targetGridY);
     CCLOG("BattleUnitSprite: Arrived at grid(%d, %d)", targetGridX, targetGridY);
 
     if (callback) {
@@ -644,13 +671,17 @@ void BattleUnitSprite::followPath(
 
     this->stopActionByTag(MOVE_TAG);
 
+    _path = path;
+    _pathIndex = 0;
+
     Vector<FiniteTimeAction*> actions;
 
     Vec2 currentPos = this->getPosition();
     bool hasValidMovement = false;
 
     // 遍历路径点创建移动动画序列
-    for (const auto& waypoint : path) {
+    for (size_t i = 0; i < path.size(); ++i) {
+        const Vec2& waypoint = path[i];
         Vec2 direction = waypoint - currentPos;
         float distance = direction.length();
 
@@ -666,7 +697,8 @@ void BattleUnitSprite::followPath(
         selectWalkAnimation(direction, animType, flipX);
 
         // 为每个路径点创建动画和移动动作
-        auto playAnim = CallFunc::create([this, animType, flipX]() {
+        auto playAnim = CallFunc::create([this, animType, flipX, i]() {
+            _pathIndex = i;
             this->setFlippedX(flipX);
             playAnimation(animType, true);
         });
@@ -687,6 +719,8 @@ void BattleUnitSprite::followPath(
 
     // 路径完成后恢复待机状态
     auto finishCallback = CallFunc::create([this, callback]() {
+        _path.clear();
+        _pathIndex = 0;
         this->setFlippedX(false);
         playIdleAnimation();
 
@@ -707,21 +741,21 @@ void BattleUnitSprite::followPath(
 }
 
 void BattleUnitSprite::takeDamage(int damage) {
-    if (_currentHP <= 0) return;
-
-    _currentHP -= damage;
-    if (_currentHP < 0) _currentHP = 0;
+    if (!_store || _store->applyDamage(_storeIndex, damage) == 0) return;
 
     updateHealthBar();
 
     CCLOG("BattleUnitSprite: %s took %d damage, HP: %d/%d",
-          _unitType.c_str(), damage, _currentHP, _maxHP);
+          _unitType.c_str(), damage, getCurrentHP(), getMaxHP());
 }
 
 void BattleUnitSprite::updateHealthBar() {
-    if (!_healthBar) {
-        // 首次创建血条，根据兵种类型设置宽度
-        HealthBarComponent::Config barConfig;
+    if (!_healthBarBatch) {
+        // 首次登记血条，根据兵种类型设置宽度
+        _healthBarBatch = HealthBarBatch::getFor(this);
+        if (!_healthBarBatch) return;
+
+        HealthBarBatch::Config barConfig;
 
         switch (_unitTypeID) {
             case UnitTypeID::GOBLIN:
@@ -748,13 +782,32 @@ void BattleUnitSprite::updateHealthBar() {
         barConfig.showWhenFull = false;
         barConfig.fadeInDuration = 0.2f;
 
-        _healthBar = HealthBarComponent::create(barConfig);
-        this->addChild(_healthBar, 100);
+        _healthBarHandle = _healthBarBatch->addBar(this, barConfig);
+    }
+
+    _healthBarBatch->updateHealth(_healthBarHandle, getCurrentHP(), getMaxHP());
+}
 
-        _healthBar->updatePosition(this->getContentSize());
+void BattleUnitSprite::releaseHealthBar() {
+    if (_healthBarBatch) {
+        _healthBarBatch->removeBar(_healthBarHandle);
+        _healthBarBatch = nullptr;
+        _healthBarHandle = -1;
     }
+}
+
+void BattleUnitSprite::onExit() {
+    // 批量节点和共享动画时钟只记录宿主指针，离开场景前释放
+    releaseHealthBar();
+    AnimationManager::getInstance()->stopLoop(this);
+    Sprite::onExit();
+}
+
+void BattleUnitSprite::setCulled(bool culled) {
+    _culled = culled;
 
-    _healthBar->updateHealth(_currentHP, _maxHP);
+    // 只有循环动画可冻结；一次性动画的回调驱动攻击和死亡流程，必须照常播放
+    AnimationManager::getInstance()->setLoopFrozen(this, culled);
 }
 
 void BattleUnitSprite::playDeathAnimation(const std::function<void()>& callback) {
@@ -764,8 +817,8 @@ void BattleUnitSprite::playDeathAnimation(const std::function<void()>& callback)
 
     this->setTargetedByBuilding(false);
 
-    if (_healthBar) {
-        _healthBar->hide();
+    if (_healthBarBatch) {
+        _healthBarBatch->hideBar(_healthBarHandle);
     }
 
     CCLOG("BattleUnitSprite: Death animation started, color reset to WHITE, targeting cleared");
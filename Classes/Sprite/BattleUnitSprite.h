@@ -1,5 +1,5 @@
 ﻿// BattleUnitSprite.h
-// 战斗单位精灵，支持动画、移动、攻击和生命值系统
+// 战斗单位精灵，负责动画、移动和血条显示；战斗状态存放在 BattleUnitStore
 
 #ifndef __BATTLE_UNIT_SPRITE_H__
 #define __BATTLE_UNIT_SPRITE_H__
@@ -7,26 +7,21 @@
 #include "cocos2d.h"
 #include "Manager/AnimationManager.h"
 #include "../Util/GridMapUtils.h"
-#include "Component/HealthBarComponent.h"
+#include "Component/HealthBarBatch.h"
+#include "Layer/IsoDepthLayer.h"
+#include "../Model/BattleUnitStore.h"
 
 USING_NS_CC;
 
-// 单位类型枚举
-enum class UnitTypeID {
-    UNKNOWN = 0,
-    BARBARIAN = 1001,
-    ARCHER = 1002,
-    GOBLIN = 1003,
-    GIANT = 1004,
-    WALL_BREAKER = 1005,
-    BALLOON = 1006
-};
-
-class BattleUnitSprite : public Sprite {
+class BattleUnitSprite : public Sprite, public IsoCullable {
 public:
   static BattleUnitSprite* create(const std::string& unitType);
   virtual bool init(const std::string& unitType);
   virtual void update(float dt) override;
+  virtual void onExit() override;
+
+  // 离开视口时冻结循环帧动画（移动和战斗逻辑照常进行）
+  virtual void setCulled(bool culled) override;
 
   // 基础动画控制
   void playAnimation(AnimationType animType, bool loop = false,
@@ -66,7 +61,7 @@ public:
 
   // 网格位置管理
   void setGridPosition(int gridX, int gridY);
-  Vec2 getGridPosition() const { return _currentGridPos; }
+  Vec2 getGridPosition() const;
   void teleportToGrid(int gridX, int gridY);
 
   // 寻路移动
@@ -86,11 +81,11 @@ public:
       float speed = 100.0f,
       const std::function<void()>& callback = nullptr);
 
-  // 生命值系统
+  // 生命值系统（未绑定数据存储的单位视为已死亡）
   void takeDamage(int damage);
-  int getCurrentHP() const { return _currentHP; }
-  int getMaxHP() const { return _maxHP; }
-  bool isDead() const { return _currentHP <= 0; }
+  int getCurrentHP() const;
+  int getMaxHP() const;
+  bool isDead() const { return getCurrentHP() <= 0; }
 
   // 属性访问
   std::string getUnitType() const { return _unitType; }
@@ -99,34 +94,64 @@ public:
   bool isAnimating() const { return _isAnimating; }
   
   // 状态标志
-  bool isChangingTarget() const { return _isChangingTarget; }
-  void setChangingTarget(bool changing) { _isChangingTarget = changing; }
+  bool isChangingTarget() const;
+  void setChangingTarget(bool changing);
   
   // 建筑锁定状态
-  bool isTargetedByBuilding() const { return _isTargetedByBuilding; }
+  bool isTargetedByBuilding() const;
   void setTargetedByBuilding(bool targeted);
   void updateHealthBar();
 
+  // 当前攻击的目标建筑
+  void setTargetBuildingId(int buildingId);
+
+  // 强制攻击的城墙（-1 表示无）
+  int getForcedTargetId() const;
+  void setForcedTargetId(int buildingId);
+
+  // 移动进度：是否正在沿路径移动，以及尚未走完的路径点（像素坐标，含当前正在前往的点）
+  bool isFollowingPath() { return getActionByTag(MOVE_TAG) != nullptr; }
+  std::vector<Vec2> getRemainingPath();
+
+  // 攻击动作距回调（结算伤害）的剩余时间，没有进行中的攻击返回 -1
+  float getAttackRemaining();
+
+  // 恢复进行中的攻击：等待剩余时间后回调（回放跳转用，不重播攻击动画）
+  void resumeAttack(float remaining, const std::function<void()>& callback);
+
+  // 数据存储绑定（由 BattleUnitStore 在增删单位时调用）
+  void bindStore(BattleUnitStore* store, int index) { _store = store; _storeIndex = index; }
+  void unbindStore() { _store = nullptr; _storeIndex = -1; }
+  int getStoreIndex() const { return _storeIndex; }
+
 protected:
   std::string _unitType;
   UnitTypeID _unitTypeID = UnitTypeID::UNKNOWN;
+  int _animationId = -1;    // AnimationManager 中的兵种动画ID
   AnimationType _currentAnimation;
   bool _isAnimating;
-  Vec2 _currentGridPos;
+  bool _culled = false;
   int _lastGridX = -999;
   int _lastGridY = -999;
-  bool _isChangingTarget = false;
-  bool _isTargetedByBuilding = false;
 
   Vec2 _lastMoveDirection = Vec2::ZERO;
-  
-  int _currentHP = 0;
-  int _maxHP = 0;
+
+  // 当前路径和正在前往的路径点下标
+  std::vector<Vec2> _path;
+  size_t _pathIndex = 0;
+
+  // 战斗状态所在的数据存储及下标
+  BattleUnitStore* _store = nullptr;
+  int _storeIndex = -1;
   
   static const int ANIMATION_TAG = 1000;
   static const int MOVE_TAG = 1001;
 
-  HealthBarComponent* _healthBar = nullptr;
+  // 血条（由所在层的 HealthBarBatch 统一绘制）
+  HealthBarBatch* _healthBarBatch = nullptr;
+  int _healthBarHandle = -1;
+
+  void releaseHealthBar();
 
   void selectWalkAnimation(const Vec2& direction, AnimationType& outAnimType, bool& outFlipX);
   void selectAttackAnimation(const Vec2& direction, AnimationType& outAnimType, bool& outFlipX);
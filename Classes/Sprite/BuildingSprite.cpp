@@ -3,7 +3,8 @@
 
 #include "BuildingSprite.h"
 #include "../Model/BuildingConfig.h"
-#include "Component/HealthBarComponent.h"
+#include "../Manager/AtlasManager.h"
+#include "../Util/HudFont.h"
 
 USING_NS_CC;
 
@@ -75,16 +76,14 @@ void BuildingSprite::initConstructionUI() {
   _constructionUIContainer->addChild(_progressBar, 2);
 
   // 创建倒计时文本标签
-  _countdownLabel = Label::createWithTTF("", "fonts/simhei.ttf", 18);
+  _countdownLabel = HudFont::createLabel("", HudFont::Face::SIMHEI, 18);
   _countdownLabel->setColor(Color3B::WHITE);
-  _countdownLabel->enableOutline(Color4B::BLACK, 2);
   _countdownLabel->setPosition(Vec2(spriteSize.width / 2, spriteSize.height + 50));
   _constructionUIContainer->addChild(_countdownLabel, 3);
 
   // 创建百分比文本标签
-  _percentLabel = Label::createWithTTF("", "fonts/simhei.ttf", 20);
+  _percentLabel = HudFont::createLabel("", HudFont::Face::SIMHEI, 20);
   _percentLabel->setColor(Color3B::YELLOW);
-  _percentLabel->enableOutline(Color4B::BLACK, 2);
   _percentLabel->setPosition(Vec2(spriteSize.width / 2, spriteSize.height + 70));
   _constructionUIContainer->addChild(_percentLabel, 4);
 
@@ -221,12 +220,8 @@ void BuildingSprite::loadSprite(int type, int level) {
     return;
   }
 
-  auto texture = Director::getInstance()->getTextureCache()->addImage(spritePath);
-  if (texture) {
-    this->setTexture(texture);
-    auto rect = Rect(0, 0, texture->getContentSize().width, texture->getContentSize().height);
-    this->setTextureRect(rect);
-
+  // 优先使用图集帧，同一图集的建筑可以合批绘制
+  if (AtlasManager::getInstance()->setSpriteImage(this, spritePath)) {
     auto configData = config->getConfig(type);
     if (configData) {
       _visualOffset = configData->anchorOffset;
@@ -396,12 +391,15 @@ void BuildingSprite::hideSelectionEffect() {
 }
 
 void BuildingSprite::updateHealthBar(int currentHP, int maxHP) {
-    if (!_healthBar) {
-        // 首次创建血条，根据建筑网格宽度计算血条宽度
+    if (!_healthBarBatch) {
+        // 首次登记血条，根据建筑网格宽度计算血条宽度
+        _healthBarBatch = HealthBarBatch::getFor(this);
+        if (!_healthBarBatch) return;
+
         auto config = BuildingConfig::getInstance()->getConfig(_buildingType);
         int gridWidth = config ? config->gridWidth : 2;
 
-        HealthBarComponent::Config barConfig;
+        HealthBarBatch::Config barConfig;
         barConfig.width = std::max(40.0f, std::min(120.0f, gridWidth * 30.0f));
         barConfig.height = 8.0f;
         barConfig.offset = Vec2(0, 15);
@@ -409,13 +407,20 @@ void BuildingSprite::updateHealthBar(int currentHP, int maxHP) {
         barConfig.mediumThreshold = 25.0f;
         barConfig.showWhenFull = false;
 
-        _healthBar = HealthBarComponent::create(barConfig);
-        this->addChild(_healthBar, 99);
-
-        _healthBar->updatePosition(this->getContentSize());
+        _healthBarHandle = _healthBarBatch->addBar(this, barConfig);
     }
 
-    _healthBar->updateHealth(currentHP, maxHP);
+    _healthBarBatch->updateHealth(_healthBarHandle, currentHP, maxHP);
+}
+
+void BuildingSprite::onExit() {
+    // 批量节点只记录宿主指针，离开场景前释放槽位
+    if (_healthBarBatch) {
+        _healthBarBatch->removeBar(_healthBarHandle);
+        _healthBarBatch = nullptr;
+        _healthBarHandle = -1;
+    }
+    Sprite::onExit();
 }
 
 void BuildingSprite::showDestroyedRubble() {
@@ -443,12 +448,7 @@ void BuildingSprite::showDestroyedRubble() {
     this->setOpacity(255);
     
     // 加载并显示废墟纹理
-    auto texture = Director::getInstance()->getTextureCache()->addImage(rubblePath);
-    if (texture) {
-        this->setTexture(texture);
-        auto rect = Rect(0, 0, texture->getContentSize().width, texture->getContentSize().height);
-        this->setTextureRect(rect);
-        
+    if (AtlasManager::getInstance()->setSpriteImage(this, rubblePath)) {
         this->setColor(Color3B::WHITE);
         
         CCLOG("BuildingSprite: Showing rubble for building ID=%d, size=%dx%d, path=%s", 
@@ -467,15 +467,15 @@ void BuildingSprite::showDestroyedRubble() {
         CCLOG("BuildingSprite: Defense animation hidden (ID=%d)", _buildingId);
     }
     
-    if (_healthBar) {
-        _healthBar->hide();
+    if (_healthBarBatch) {
+        _healthBarBatch->hideBar(_healthBarHandle);
     }
 }
 
 void BuildingSprite::showTargetBeacon() {
   if (!_targetBeacon) {
     // 创建目标指示信标精灵
-    _targetBeacon = Sprite::create("UI/battle/beacon/beacon.png");
+    _targetBeacon = AtlasManager::getInstance()->createSprite("UI/battle/beacon/beacon.png");
     if (_targetBeacon) {
       auto size = this->getContentSize();
       float beaconY = size.height * 0.5f + _visualOffset.y;
@@ -4,12 +4,13 @@
 #pragma once
 #include "cocos2d.h"
 #include "../Model/VillageData.h"
-#include "Component/HealthBarComponent.h"
+#include "Component/HealthBarBatch.h"
 
 class BuildingSprite : public cocos2d::Sprite {
 public:
   static BuildingSprite* create(const BuildingInstance& building);
   virtual bool init(const BuildingInstance& building);
+  virtual void onExit() override;
 
   void updateBuilding(const BuildingInstance& building);
   void updateLevel(int level);
@@ -88,8 +89,9 @@ private:
   cocos2d::DrawNode* _selectionGlow;
   bool _isSelected;
 
-  // 血条组件
-  HealthBarComponent* _healthBar = nullptr;
+  // 血条（由所在层的 HealthBarBatch 统一绘制）
+  HealthBarBatch* _healthBarBatch = nullptr;
+  int _healthBarHandle = -1;
 
   // 摧毁状态
   bool _isShowingRubble = false;
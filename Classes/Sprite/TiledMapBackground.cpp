@@ -0,0 +1,312 @@
+﻿// TiledMapBackground.cpp
+// 瓦片地图背景实现，视口裁剪、级别选择和瓦片的异步加载与释放
+
+#include "TiledMapBackground.h"
+#include <cmath>
+
+USING_NS_CC;
+
+namespace {
+    const char* TILE_ROOT = "tiles/";
+}
+
+TiledMapBackground* TiledMapBackground::create(const std::string& imagePath) {
+    auto node = new (std::nothrow) TiledMapBackground();
+    if (node && node->init(imagePath)) {
+        node->autorelease();
+        return node;
+    }
+    CC_SAFE_DELETE(node);
+    return nullptr;
+}
+
+TiledMapBackground::~TiledMapBackground() {
+    // 取消仍在加载的瓦片回调，释放细节瓦片纹理
+    auto textureCache = Director::getInstance()->getTextureCache();
+    for (const auto& pair : _tiles) {
+        int level = pair.first >> 20;
+        int row = (pair.first >> 10) & 0x3FF;
+        int col = pair.first & 0x3FF;
+        std::string path = tilePath(level, col, row);
+        if (pair.second.loading) {
+            textureCache->unbindImageAsync(asyncKey(path));
+        }
+        textureCache->removeTextureForKey(path);
+    }
+}
+
+bool TiledMapBackground::init(const std::string& imagePath) {
+    if (!Node::init()) {
+        return false;
+    }
+
+    _imagePath = imagePath;
+    this->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
+
+    if (!loadManifest(manifestPathFor(imagePath))) {
+        // 没有切片数据：整张图片
+        auto sprite = Sprite::create(imagePath);
+        if (!sprite) {
+            CCLOG("TiledMapBackground: ERROR - Failed to load map image: %s", imagePath.c_str());
+            return false;
+        }
+        sprite->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
+        sprite->setPosition(Vec2::ZERO);
+        this->addChild(sprite);
+        this->setContentSize(sprite->getContentSize());
+
+        CCLOG("TiledMapBackground: No tiles for %s, using single texture", imagePath.c_str());
+        return true;
+    }
+
+    _baseLayer = Node::create();
+    this->addChild(_baseLayer, 0);
+    _detailLayer = Node::create();
+    this->addChild(_detailLayer, 1);
+
+    createBaseLevel();
+
+    CCLOG("TiledMapBackground: %s tiled (%.0fx%.0f, %zu levels, tile=%d)", imagePath.c_str(),
+          _contentSize.width, _contentSize.height, _levels.size(), _tileSize);
+    return true;
+}
+
+std::string TiledMapBackground::manifestPathFor(const std::string& imagePath) {
+    size_t slash = imagePath.find_last_of('/');
+    std::string name = slash == std::string::npos ? imagePath : imagePath.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos) name = name.substr(0, dot);
+    return TILE_ROOT + name + "/tiles.plist";
+}
+
+bool TiledMapBackground::loadManifest(const std::string& manifestPath) {
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(manifestPath)) return false;
+
+    ValueMap manifest = fileUtils->getValueMapFromFile(manifestPath);
+    int width = manifest["width"].asInt();
+    int height = manifest["height"].asInt();
+    int levelCount = manifest["levels"].asInt();
+    _tileSize = manifest["tileSize"].asInt();
+    _extension = manifest["extension"].asString();
+
+    // 瓦片键中行列各占 10 位
+    if (width <= 0 || height <= 0 || levelCount <= 0 || _tileSize <= 0 || _extension.empty() ||
+        (width + _tileSize - 1) / _tileSize > 1024 || (height + _tileSize - 1) / _tileSize > 1024) {
+        CCLOG("TiledMapBackground: WARNING - Invalid tile manifest %s", manifestPath.c_str());
+        return false;
+    }
+
+    _tileDir = manifestPath.substr(0, manifestPath.find_last_of('/') + 1);
+    this->setContentSize(Size(width, height));
+
+    // 与 MapTiler 相同：每级宽高减半（向上取整）
+    int levelWidth = width;
+    int levelHeight = height;
+    for (int i = 0; i < levelCount; ++i) {
+        Level level;
+        level.width = levelWidth;
+        level.height = levelHeight;
+        level.cols = (levelWidth + _tileSize - 1) / _tileSize;
+        level.rows = (levelHeight + _tileSize - 1) / _tileSize;
+        _levels.push_back(level);
+
+        levelWidth = std::max(1, (levelWidth + 1) / 2);
+        levelHeight = std::max(1, (levelHeight + 1) / 2);
+    }
+    return true;
+}
+
+void TiledMapBackground::createBaseLevel() {
+    int base = static_cast<int>(_levels.size()) - 1;
+    const Level& level = _levels[base];
+    auto textureCache = Director::getInstance()->getTextureCache();
+
+    for (int row = 0; row < level.rows; ++row) {
+        for (int col = 0; col < level.cols; ++col) {
+            auto texture = textureCache->addImage(tilePath(base, col, row));
+            if (!texture) continue;
+            _baseLayer->addChild(createTileSprite(texture, base, col, row));
+        }
+    }
+}
+
+void TiledMapBackground::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags) {
+    if (_visible && isTiled()) {
+        updateVisibleTiles();
+    }
+    Node::visit(renderer, parentTransform, parentFlags);
+}
+
+int TiledMapBackground::selectLevel(float screenScale) const {
+    // 选最粗、但每个纹素仍不小于一个屏幕像素的级别
+    int level = 0;
+    if (screenScale > 0) {
+        level = static_cast<int>(std::floor(std::log2(1.0f / screenScale)));
+    }
+    return std::max(0, std::min(level, static_cast<int>(_levels.size()) - 1));
+}
+
+void TiledMapBackground::updateVisibleTiles() {
+    auto director = Director::getInstance();
+    Vec2 origin = director->getVisibleOrigin();
+    Size visibleSize = director->getVisibleSize();
+
+    // 屏幕可见矩形转换到节点坐标（取四角包围盒）
+    Mat4 nodeToWorld = getNodeToWorldTransform();
+    Mat4 worldToNode = nodeToWorld.getInversed();
+    Vec2 corners[4] = {
+        origin,
+        Vec2(origin.x + visibleSize.width, origin.y),
+        Vec2(origin.x, origin.y + visibleSize.height),
+        Vec2(origin.x + visibleSize.width, origin.y + visibleSize.height)
+    };
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (const auto& corner : corners) {
+        Vec3 p(corner.x, corner.y, 0);
+        worldToNode.transformPoint(&p);
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    float screenScale = Vec2(nodeToWorld.m[0], nodeToWorld.m[1]).length();
+    int levelIndex = selectLevel(screenScale);
+    int base = static_cast<int>(_levels.size()) - 1;
+
+    // 最粗一级已常驻，不需要细节瓦片
+    int range[4] = { 0, -1, 0, -1 };
+    if (levelIndex < base) {
+        const Level& level = _levels[levelIndex];
+        float scaleX = _contentSize.width / level.width;
+        float scaleY = _contentSize.height / level.height;
+        float tileW = _tileSize * scaleX;
+        float tileH = _tileSize * scaleY;
+
+        // 行号从图片顶部开始，外扩一圈作为预取
+        range[0] = std::max(0, static_cast<int>(std::floor(minX / tileW)) - 1);
+        range[1] = std::min(level.cols - 1, static_cast<int>(std::floor(maxX / tileW)) + 1);
+        range[2] = std::max(0, static_cast<int>(std::floor((_contentSize.height - maxY) / tileH)) - 1);
+        range[3] = std::min(level.rows - 1, static_cast<int>(std::floor((_contentSize.height - minY) / tileH)) + 1);
+    }
+
+    if (levelIndex == _lastLevel && std::equal(range, range + 4, _lastRange)) return;
+    _lastLevel = levelIndex;
+    std::copy(range, range + 4, _lastRange);
+
+    for (auto& pair : _tiles) {
+        pair.second.wanted = false;
+    }
+    for (int row = range[2]; row <= range[3]; ++row) {
+        for (int col = range[0]; col <= range[1]; ++col) {
+            requestTile(levelIndex, col, row);
+        }
+    }
+
+    // 释放不再需要的瓦片（包括其它级别的）
+    std::vector<int> unused;
+    for (const auto& pair : _tiles) {
+        if (!pair.second.wanted) unused.push_back(pair.first);
+    }
+    for (int key : unused) {
+        releaseTile(key);
+    }
+}
+
+void TiledMapBackground::requestTile(int level, int col, int row) {
+    int key = makeKey(level, col, row);
+    auto it = _tiles.find(key);
+    if (it != _tiles.end()) {
+        it->second.wanted = true;
+        return;
+    }
+
+    Tile& tile = _tiles[key];
+    tile.wanted = true;
+    tile.loading = true;
+
+    // 纹理已在缓存中时回调会立即执行
+    std::string path = tilePath(level, col, row);
+    Director::getInstance()->getTextureCache()->addImageAsync(path,
+        [this, key](Texture2D* texture) {
+        onTileLoaded(key, texture);
+    }, asyncKey(path));
+}
+
+void TiledMapBackground::onTileLoaded(int key, Texture2D* texture) {
+    int level = key >> 20;
+    int row = (key >> 10) & 0x3FF;
+    int col = key & 0x3FF;
+
+    auto it = _tiles.find(key);
+    if (it == _tiles.end() || it->second.sprite) return;
+
+    it->second.loading = false;
+    if (!it->second.wanted) {
+        // 加载期间已离开视口：没有其它使用者时从缓存移除
+        _tiles.erase(it);
+        if (texture && texture->getReferenceCount() == 1) {
+            Director::getInstance()->getTextureCache()->removeTexture(texture);
+        }
+        return;
+    }
+
+    if (!texture) {
+        CCLOG("TiledMapBackground: WARNING - Failed to load tile %s", tilePath(level, col, row).c_str());
+        return;
+    }
+
+    it->second.sprite = createTileSprite(texture, level, col, row);
+    _detailLayer->addChild(it->second.sprite);
+}
+
+void TiledMapBackground::releaseTile(int key) {
+    auto it = _tiles.find(key);
+    if (it == _tiles.end()) return;
+
+    // 仍在加载的瓦片保留到回调中处理，回调捕获了 this，析构时需要凭它取消
+    if (it->second.loading) {
+        it->second.wanted = false;
+        return;
+    }
+
+    int level = key >> 20;
+    int row = (key >> 10) & 0x3FF;
+    int col = key & 0x3FF;
+    std::string path = tilePath(level, col, row);
+
+    // 已显示的瓦片移出缓存，精灵移除后纹理即被释放
+    if (it->second.sprite) {
+        it->second.sprite->removeFromParent();
+        Director::getInstance()->getTextureCache()->removeTextureForKey(path);
+    }
+    _tiles.erase(it);
+}
+
+Sprite* TiledMapBackground::createTileSprite(Texture2D* texture, int level, int col, int row) const {
+    const Level& info = _levels[level];
+    float scaleX = _contentSize.width / info.width;
+    float scaleY = _contentSize.height / info.height;
+
+    // 瓦片在该级图像中的像素范围（行从顶部开始）
+    int x0 = col * _tileSize;
+    int y0 = row * _tileSize;
+    int h = std::min(_tileSize, info.height - y0);
+
+    texture->setAntiAliasTexParameters();
+
+    auto sprite = Sprite::createWithTexture(texture);
+    sprite->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
+    sprite->setPosition(Vec2(x0 * scaleX, _contentSize.height - (y0 + h) * scaleY));
+    sprite->setScale(scaleX, scaleY);
+    return sprite;
+}
+
+std::string TiledMapBackground::tilePath(int level, int col, int row) const {
+    return _tileDir + StringUtils::format("%d/%d_%d.", level, col, row) + _extension;
+}
+
+std::string TiledMapBackground::asyncKey(const std::string& path) const {
+    return StringUtils::format("TiledMapBackground:%p:", this) + path;
+}
@@ -0,0 +1,84 @@
+﻿// TiledMapBackground.h
+// 瓦片地图背景节点声明，按可见范围和缩放级别加载地图瓦片，替代整张大图背景
+
+#pragma once
+
+#include "cocos2d.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+USING_NS_CC;
+
+// 瓦片地图背景
+// 功能：
+// 1. 读取构建时 MapTiler 生成的 tiles/<地图名>/tiles.plist，节点尺寸为原图尺寸
+// 2. 每帧根据屏幕可见范围和当前缩放选择级别，只加载与视口（外扩一圈）相交的瓦片，离开视口的瓦片连同纹理释放
+// 3. 最粗一级常驻作为底图，细节瓦片异步加载完成前不会露出空洞
+// 4. 没有切片数据时回退为整张图片精灵
+class TiledMapBackground : public Node {
+public:
+    // 按原图路径创建（如 "Scene/VillageScene.png"），切片和原图都不存在时返回 nullptr
+    static TiledMapBackground* create(const std::string& imagePath);
+
+    virtual ~TiledMapBackground();
+    virtual bool init(const std::string& imagePath);
+    virtual void visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags) override;
+
+    const std::string& getImagePath() const { return _imagePath; }
+    bool isTiled() const { return !_levels.empty(); }
+
+    // 当前已加载的细节瓦片数量（不含常驻底图）
+    int getLoadedTileCount() const { return static_cast<int>(_tiles.size()); }
+
+private:
+    // 一级瓦片的尺寸信息
+    struct Level {
+        int width = 0;      // 该级图像像素尺寸
+        int height = 0;
+        int cols = 0;
+        int rows = 0;
+    };
+
+    // 细节瓦片：已显示的精灵，或仍在异步加载
+    // 加载中的瓦片离开视口后仍保留到回调执行，析构时据此取消回调
+    struct Tile {
+        Sprite* sprite = nullptr;
+        bool wanted = false;
+        bool loading = false;
+    };
+
+    std::string _imagePath;
+    std::string _tileDir;
+    std::string _extension;
+    int _tileSize = 0;
+    std::vector<Level> _levels;
+
+    Node* _baseLayer = nullptr;      // 最粗一级（常驻）
+    Node* _detailLayer = nullptr;    // 当前级别的细节瓦片
+    std::unordered_map<int, Tile> _tiles;
+
+    // 上次更新时的级别和瓦片范围，未变化时跳过
+    int _lastLevel = -1;
+    int _lastRange[4] = { -1, -1, -1, -1 };
+
+    bool loadManifest(const std::string& manifestPath);
+    void createBaseLevel();
+
+    // 根据视口更新需要的瓦片
+    void updateVisibleTiles();
+    int selectLevel(float screenScale) const;
+
+    void requestTile(int level, int col, int row);
+    void releaseTile(int key);
+    void onTileLoaded(int key, Texture2D* texture);
+
+    Sprite* createTileSprite(Texture2D* texture, int level, int col, int row) const;
+    std::string tilePath(int level, int col, int row) const;
+
+    // 异步加载回调键（按实例区分，析构时只取消自己的回调）
+    std::string asyncKey(const std::string& path) const;
+
+    static int makeKey(int level, int col, int row) { return (level << 20) | (row << 10) | col; }
+    static std::string manifestPathFor(const std::string& imagePath);
+};
@@ -4,9 +4,17 @@
 #pragma execution_character_set("utf-8")
 
 #include "BattleProgressUI.h"
+#include "Manager/AtlasManager.h"
 
 USING_NS_CC;
 
+namespace {
+
+// 星星显示尺寸（像素）
+const float STAR_SIZE = 35.0f;
+
+} // namespace
+
 BattleProgressUI* BattleProgressUI::create() {
     auto ret = new (std::nothrow) BattleProgressUI();
     if (ret && ret->init()) {
@@ -65,7 +73,7 @@ void BattleProgressUI::initBackground() {
 }
 
 void BattleProgressUI::initStars() {
-    float starSize = 35.0f;
+    float starSize = STAR_SIZE;
     float starSpacing = 50.0f;
 
     // 星星在背景上居中排列
@@ -73,7 +81,7 @@ void BattleProgressUI::initStars() {
     float starY = 71.0f;
 
     for (int i = 0; i < 3; i++) {
-        _starSprites[i] = Sprite::create("UI/battle/battle-prepare/victory_star_bg.png");
+        _starSprites[i] = AtlasManager::getInstance()->createSprite("UI/battle/battle-prepare/victory_star_bg.png");
 
         if (!_starSprites[i]) {
             // 加载失败时创建灰色占位符
@@ -118,6 +126,11 @@ void BattleProgressUI::updateStars(int starCount) {
         playStarAnimation(i);
     }
 
+    // 星数减少（回放向前跳转）时把多出的星星恢复为暗色
+    for (int i = starCount; i < _currentStars; i++) {
+        resetStarSprite(i);
+    }
+
     _currentStars = starCount;
 }
 
@@ -151,15 +164,7 @@ void BattleProgressUI::playStarAnimation(int starIndex) {
     float originalScale = star->getScale();
 
     // 切换到金色星星纹理
-    auto goldTexture = Director::getInstance()->getTextureCache()->addImage(
-        "UI/battle/battle-prepare/victory_star.png"
-    );
-
-    if (goldTexture) {
-        star->setTexture(goldTexture);
-        auto rect = Rect(0, 0, goldTexture->getContentSize().width,
-                         goldTexture->getContentSize().height);
-        star->setTextureRect(rect);
+    if (AtlasManager::getInstance()->setSpriteImage(star, "UI/battle/battle-prepare/victory_star.png")) {
         star->setScale(originalScale);
     } else {
         star->setColor(Color3B(255, 215, 0));
@@ -181,6 +186,23 @@ void BattleProgressUI::playStarAnimation(int starIndex) {
     CCLOG("BattleProgressUI: Star %d animation played", starIndex);
 }
 
+void BattleProgressUI::resetStarSprite(int starIndex) {
+    if (starIndex < 0 || starIndex >= 3 || !_starSprites[starIndex]) {
+        return;
+    }
+
+    auto star = _starSprites[starIndex];
+
+    // 停止可能仍在播放的弹跳动画
+    star->stopAllActions();
+
+    if (!AtlasManager::getInstance()->setSpriteImage(star, "UI/battle/battle-prepare/victory_star_bg.png")) {
+        star->setColor(Color3B(50, 50, 50));
+    }
+
+    star->setScale(STAR_SIZE / star->getContentSize().width);
+}
+
 void BattleProgressUI::playResultAnimation(const std::function<void()>& onComplete) {
     auto visibleSize = Director::getInstance()->getVisibleSize();
     auto origin = Director::getInstance()->getVisibleOrigin();
@@ -225,16 +247,7 @@ void BattleProgressUI::reset() {
 
     // 重置所有星星为暗色背景
     for (int i = 0; i < 3; i++) {
-        if (_starSprites[i]) {
-            auto texture = Director::getInstance()->getTextureCache()->addImage(
-                "UI/battle/battle-prepare/victory_star_bg.png"
-            );
-            if (texture) {
-                _starSprites[i]->setTexture(texture);
-            } else {
-                _starSprites[i]->setColor(Color3B(50, 50, 50));
-            }
-        }
+        resetStarSprite(i);
     }
 
     _progressLabel->setString("0%");
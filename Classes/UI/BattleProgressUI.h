@@ -11,7 +11,7 @@ public:
 
     virtual bool init() override;
 
-    // 更新星星显示(0-3星)
+    // 更新星星显示(0-3星)，星数减少时直接恢复暗色（回放跳转）
     void updateStars(int starCount);
 
     // 更新摧毁率显示(0.0-100.0)
@@ -40,6 +40,7 @@ private:
     void initStars();
     void initProgressLabel();
     void playStarAnimation(int starIndex);
+    void resetStarSprite(int starIndex);
 
     BattleProgressUI* _battleProgressUI;
     bool _hasDeployedFirstTroop;
@@ -3,6 +3,7 @@
 
 #pragma execution_character_set("utf-8")
 #include "PlacementConfirmUI.h"
+#include "Manager/AtlasManager.h"
 
 USING_NS_CC;
 using namespace ui;
@@ -40,7 +41,7 @@ void PlacementConfirmUI::initButtons() {
   float buttonSpacing = 80.0f;
 
   // 创建确认按钮(绿勾)
-  _confirmBtn = Button::create("ImageElements/right.png");
+  _confirmBtn = AtlasManager::getInstance()->createButton("ImageElements/right.png");
   if (_confirmBtn) {
     _confirmBtn->setScale(0.8f);
     _confirmBtn->setPosition(Vec2(buttonSpacing, 0));
@@ -53,7 +54,7 @@ void PlacementConfirmUI::initButtons() {
   }
 
   // 创建取消按钮(红叉)
-  _cancelBtn = Button::create("ImageElements/wrong.png");
+  _cancelBtn = AtlasManager::getInstance()->createButton("ImageElements/wrong.png");
   if (_cancelBtn) {
     _cancelBtn->setScale(0.8f);
     _cancelBtn->setPosition(Vec2(-buttonSpacing, 0));
@@ -4,6 +4,7 @@
 #pragma execution_character_set("utf-8")
 #include "ResourceCollectionUI.h"
 #include "Manager/Resource/ResourceProductionSystem.h"
+#include "Util/HudFont.h"
 
 USING_NS_CC;
 using namespace ui;
@@ -180,9 +181,8 @@ void ResourceCollectionUI::initButtons() {
   _collectGoldBtn->addClickEventListener([this](Ref*) { onCollectGold(); });
   this->addChild(_collectGoldBtn);
 
-  _pendingGoldLabel = Label::createWithTTF("+0/500", FONT_PATH, 20);
+  _pendingGoldLabel = HudFont::createLabel("+0/500", HudFont::Face::SIMHEI, 20);
   _pendingGoldLabel->setColor(Color3B::YELLOW);
-  _pendingGoldLabel->enableOutline(Color4B::BLACK, 2);
   _pendingGoldLabel->setPosition(Vec2(130, visibleSize.height - 125));
   this->addChild(_pendingGoldLabel);
 
@@ -202,9 +202,8 @@ void ResourceCollectionUI::initButtons() {
   _collectElixirBtn->addClickEventListener([this](Ref*) { onCollectElixir(); });
   this->addChild(_collectElixirBtn);
 
-  _pendingElixirLabel = Label::createWithTTF("+0/500", FONT_PATH, 20);
+  _pendingElixirLabel = HudFont::createLabel("+0/500", HudFont::Face::SIMHEI, 20);
   _pendingElixirLabel->setColor(Color3B::MAGENTA);
-  _pendingElixirLabel->enableOutline(Color4B::BLACK, 2);
   _pendingElixirLabel->setPosition(Vec2(330, visibleSize.height - 125));
   this->addChild(_pendingElixirLabel);
 }
@@ -0,0 +1,103 @@
+﻿// BinaryStream.cpp
+// 二进制读写流实现
+
+#include "BinaryStream.h"
+
+// ========== BinaryWriter ==========
+
+void BinaryWriter::writeU32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        _buffer.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+void BinaryWriter::writeU64(uint64_t value) {
+    writeU32(static_cast<uint32_t>(value));
+    writeU32(static_cast<uint32_t>(value >> 32));
+}
+
+void BinaryWriter::writeVarUInt(uint64_t value) {
+    while (value >= 0x80) {
+        _buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    _buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void BinaryWriter::writeVarInt(int64_t value) {
+    // zigzag：0,-1,1,-2,2... 映射为 0,1,2,3,4...
+    writeVarUInt((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void BinaryWriter::writeString(const std::string& value) {
+    writeVarUInt(value.size());
+    writeBytes(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+}
+
+void BinaryWriter::writeBytes(const uint8_t* data, size_t size) {
+    _buffer.insert(_buffer.end(), data, data + size);
+}
+
+// ========== BinaryReader ==========
+
+uint8_t BinaryReader::readU8() {
+    if (!_valid || _pos >= _size) {
+        _valid = false;
+        return 0;
+    }
+    return _data[_pos++];
+}
+
+uint32_t BinaryReader::readU32() {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(readU8()) << (i * 8);
+    }
+    return _valid ? value : 0;
+}
+
+uint64_t BinaryReader::readU64() {
+    uint64_t low = readU32();
+    uint64_t high = readU32();
+    return _valid ? (low | (high << 32)) : 0;
+}
+
+uint64_t BinaryReader::readVarUInt() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = readU8();
+        if (!_valid) return 0;
+
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+
+    // 超过 10 字节仍未结束，视为数据损坏
+    _valid = false;
+    return 0;
+}
+
+int64_t BinaryReader::readVarInt() {
+    uint64_t raw = readVarUInt();
+    return static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+}
+
+std::string BinaryReader::readString() {
+    uint64_t length = readVarUInt();
+    if (!_valid || length > _size - _pos) {
+        _valid = false;
+        return std::string();
+    }
+
+    std::string value(reinterpret_cast<const char*>(_data + _pos), static_cast<size_t>(length));
+    _pos += static_cast<size_t>(length);
+    return value;
+}
+
+void BinaryReader::skip(size_t count) {
+    if (!_valid || count > _size - _pos) {
+        _valid = false;
+        return;
+    }
+    _pos += count;
+}
@@ -0,0 +1,59 @@
+﻿// BinaryStream.h
+// 二进制读写流声明，提供变长整数（varint/zigzag）和定长字段的紧凑编码
+
+#ifndef __BINARY_STREAM_H__
+#define __BINARY_STREAM_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 二进制写入流
+// 整数统一按 LEB128 变长编码，有符号数先做 zigzag 映射，小数值只占 1 字节
+class BinaryWriter {
+public:
+    void writeU8(uint8_t value) { _buffer.push_back(value); }
+    void writeU32(uint32_t value);                // 定长小端序，用于魔数
+    void writeU64(uint64_t value);                // 定长小端序，用于哈希值
+    void writeVarUInt(uint64_t value);
+    void writeVarInt(int64_t value);              // zigzag + varint
+    void writeString(const std::string& value);   // 长度前缀 + UTF-8 字节
+    void writeBytes(const uint8_t* data, size_t size);
+
+    size_t size() const { return _buffer.size(); }
+    const std::vector<uint8_t>& getBuffer() const { return _buffer; }
+    std::vector<uint8_t>& getBuffer() { return _buffer; }
+
+private:
+    std::vector<uint8_t> _buffer;
+};
+
+// 二进制读取流
+// 越界或格式错误时置失败标志并返回 0，调用方在读取结束后统一检查 isValid()
+class BinaryReader {
+public:
+    BinaryReader(const uint8_t* data, size_t size) : _data(data), _size(size) {}
+
+    uint8_t readU8();
+    uint32_t readU32();
+    uint64_t readU64();
+    uint64_t readVarUInt();
+    int64_t readVarInt();
+    std::string readString();
+
+    // 跳过指定字节数
+    void skip(size_t count);
+
+    size_t position() const { return _pos; }
+    size_t remaining() const { return _valid ? _size - _pos : 0; }
+    bool isValid() const { return _valid; }
+
+private:
+    const uint8_t* _data;
+    size_t _size;
+    size_t _pos = 0;
+    bool _valid = true;
+};
+
+#endif // __BINARY_STREAM_H__
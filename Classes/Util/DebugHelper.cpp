@@ -4,6 +4,7 @@
 #pragma execution_character_set("utf-8")
 #include "DebugHelper.h"
 #include "../Manager/VillageDataManager.h"
+#include "../Manager/VillageSaveService.h"
 #include "../Layer/VillageLayer.h"
 #include "../Layer/HUDLayer.h"
 #include "../Manager/BuildingManager.h"
@@ -89,7 +90,7 @@ void DebugHelper::setBuildingLevel(int buildingId, int level) {
     }
     
     // 保存到存档文件
-    dataManager->saveToFile("village.json");
+    dataManager->requestSave();
     
     // 触发资源更新事件（因为等级变化可能影响存储容量等属性）
     Director::getInstance()->getEventDispatcher()
@@ -130,7 +131,7 @@ void DebugHelper::deleteBuilding(int buildingId) {
     dataManager->removeBuilding(buildingId);
     
     // 步骤5：保存存档
-    dataManager->saveToFile("village.json");
+    dataManager->requestSave();
     
     // 步骤6：触发资源更新事件（删除资源建筑可能影响容量）
     Director::getInstance()->getEventDispatcher()
@@ -181,11 +182,9 @@ void DebugHelper::resetSaveData() {
     std::string writablePath = fileUtils->getWritablePath();
     std::string savePath = writablePath + "village.json";
     
-    // 检查并删除存档文件
-    if (fileUtils->isFileExist(savePath)) {
-        fileUtils->removeFile(savePath);
-        CCLOG("DebugHelper: Save file deleted: %s", savePath.c_str());
-    }
+    // 丢弃还没写入的修改，并删除存档快照和日志
+    VillageSaveService::getInstance()->deleteSaveFiles();
+    CCLOG("DebugHelper: Save file deleted: %s", savePath.c_str());
     
     // 销毁数据管理器单例，强制下次重新初始化
     VillageDataManager::destroyInstance();
@@ -2,11 +2,11 @@
 // 寻路工具实现，提供A*寻路算法和智能攻击路径查找功能
 
 #include "FindPathUtil.h"
-#include "../Manager/VillageDataManager.h"
-#include "../Model/BuildingConfig.h"
+#include "../Model/BattleBuildingStore.h"
 #include "GridMapUtils.h"
 #include <queue>
 #include <algorithm>
+#include <climits>
 #include <cmath>
 
 USING_NS_CC;
@@ -14,7 +14,11 @@ USING_NS_CC;
 FindPathUtil* FindPathUtil::_instance = nullptr;
 
 FindPathUtil* FindPathUtil::getInstance() {
-    if (!_instance) _instance = new FindPathUtil();
+    if (!_instance) {
+        _instance = new FindPathUtil();
+        CCLOG("FindPathUtil: Initialized with optimized memory pools (map size: %dx%d)",
+              GridMapUtils::GRID_WIDTH, GridMapUtils::GRID_HEIGHT);
+    }
     return _instance;
 }
 
@@ -30,19 +34,17 @@ FindPathUtil::FindPathUtil()
     
     // 初始化寻路地图数组
     _pathfindingMap.resize(mapSize, 0);
+    _buildingIndexMap.resize(mapSize, -1);
     
     // 预分配A*算法所需的内存，避免频繁分配
     _gScore.resize(mapSize, INT_MAX);
     _cameFrom.resize(mapSize, -1);
     _closedSet.resize(mapSize, false);
-    
-    CCLOG("FindPathUtil: Initialized with optimized memory pools (map size: %dx%d = %d cells)", 
-          _mapWidth, _mapHeight, mapSize);
-    CCLOG("  -> Pathfinding map will be updated by VillageDataManager");
 }
 
 FindPathUtil::~FindPathUtil() {
     _pathfindingMap.clear();
+    _buildingIndexMap.clear();
     _gScore.clear();
     _cameFrom.clear();
     _closedSet.clear();
@@ -52,21 +54,14 @@ FindPathUtil::~FindPathUtil() {
 // 核心功能：智能攻击寻路
 // ===================================================================================
 
-std::vector<Vec2> FindPathUtil::findPathToAttackBuilding(const Vec2& unitWorldPos, const BuildingInstance& building, int attackRange) {
+std::vector<Vec2> FindPathUtil::findPathToAttackBuilding(const Vec2& unitWorldPos,
+                                                       int bX, int bY, int bW, int bH,
+                                                       int attackRange) {
     // 将单位的世界坐标转换为网格坐标
     Vec2 startGridPos = GridMapUtils::pixelToGrid(unitWorldPos);
     int startX = static_cast<int>(std::floor(startGridPos.x));
     int startY = static_cast<int>(std::floor(startGridPos.y));
 
-    // 获取目标建筑的配置信息
-    auto config = BuildingConfig::getInstance()->getConfig(building.type);
-    if (!config) return {};
-
-    int bX = building.gridX;
-    int bY = building.gridY;
-    int bW = config->gridWidth;
-    int bH = config->gridHeight;
-
     // 候选攻击位置结构
     struct CandidateSpot {
         int x, y;
@@ -156,39 +151,29 @@ std::vector<Vec2> FindPathUtil::findPathToAttackBuilding(const Vec2& unitWorldPo
 // 地图数据更新
 // ===================================================================================
 
-void FindPathUtil::updatePathfindingMap() {
+void FindPathUtil::updatePathfindingMap(const BattleBuildingStore& buildings) {
     // 清空地图数据
     std::fill(_pathfindingMap.begin(), _pathfindingMap.end(), 0);
+    std::fill(_buildingIndexMap.begin(), _buildingIndexMap.end(), -1);
 
-    auto dataManager = VillageDataManager::getInstance();
-    const auto& buildings = dataManager->getAllBuildings();
+    for (int i = 0; i < buildings.size(); ++i) {
+        const auto& b = buildings.getInfo(i);
 
-    for (const auto& b : buildings) {
-        // 跳过正在放置的建筑
-        if (b.state == BuildingInstance::State::PLACING) continue;
-        
-        // 跳过已摧毁的建筑
-        if (b.isDestroyed || b.currentHP <= 0) continue;
+        // 跳过正在放置、没有配置和已摧毁的建筑
+        if (!b.active || !buildings.isAlive(i)) continue;
 
         // 跳过陷阱（type 400-499），陷阱不阻挡寻路
-        if (b.type >= 400 && b.type < 500) continue;
-
-        auto config = BuildingConfig::getInstance()->getConfig(b.type);
-        if (!config) continue;
+        if (b.isTrap) continue;
 
         // 区分城墙和普通建筑
-        GridType gridType;
-        if (b.type == 303) {  // 城墙
-            gridType = GridType::WALL;
-        } else {
-            gridType = GridType::BUILDING;
-        }
+        GridType gridType = b.isWall ? GridType::WALL : GridType::BUILDING;
 
         // 标记建筑占用的所有格子
-        for (int x = b.gridX; x < b.gridX + config->gridWidth; ++x) {
-            for (int y = b.gridY; y < b.gridY + config->gridHeight; ++y) {
+        for (int x = b.gridX; x < b.gridX + b.gridWidth; ++x) {
+            for (int y = b.gridY; y < b.gridY + b.gridHeight; ++y) {
                 if (x >= 0 && x < _mapWidth && y >= 0 && y < _mapHeight) {
                     _pathfindingMap[toIndex(x, y)] = static_cast<uint8_t>(gridType);
+                    _buildingIndexMap[toIndex(x, y)] = i;
                 }
             }
         }
@@ -200,6 +185,11 @@ bool FindPathUtil::isWalkable(int gridX, int gridY) const {
     return _pathfindingMap[toIndex(gridX, gridY)] == static_cast<uint8_t>(GridType::EMPTY);
 }
 
+int FindPathUtil::getBuildingIndexAt(int gridX, int gridY) const {
+    if (gridX < 0 || gridX >= _mapWidth || gridY < 0 || gridY >= _mapHeight) return -1;
+    return _buildingIndexMap[toIndex(gridX, gridY)];
+}
+
 // ===================================================================================
 // 忽略城墙的寻路（炸弹人专用）
 // ===================================================================================
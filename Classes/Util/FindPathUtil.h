@@ -2,10 +2,12 @@
 #define __FIND_PATH_UTIL_H__
 
 #include "cocos2d.h"
-#include "../Model/VillageData.h"
 #include <vector>
 #include <unordered_map>
 
+class BattleBuildingStore;
+
+// 寻路工具：实时战斗使用单例；无界面模拟每场战斗各自创建实例（实例之间不共享状态，可在工作线程中使用）
 class FindPathUtil {
 public:
     // 网格类型定义
@@ -19,22 +21,31 @@ public:
     static FindPathUtil* getInstance();
     static void destroyInstance();
 
+    FindPathUtil();
+    ~FindPathUtil();
+
     // =============================================================
     // 🔥 核心接口：智能寻找攻击路径 🔥
-    // 输入：单位当前世界坐标，目标建筑实例，攻击范围（1=近战，2=弓箭手）
+    // 输入：单位当前世界坐标，目标建筑占用的网格矩形，攻击范围（1=近战，3=弓箭手）
     // 输出：一系列世界坐标点（路径），如果无法到达返回空
     // =============================================================
-    std::vector<cocos2d::Vec2> findPathToAttackBuilding(const cocos2d::Vec2& unitWorldPos, const BuildingInstance& targetBuilding, int attackRange = 1);
+    std::vector<cocos2d::Vec2> findPathToAttackBuilding(const cocos2d::Vec2& unitWorldPos,
+                                                        int buildingX, int buildingY,
+                                                        int buildingWidth, int buildingHeight,
+                                                        int attackRange = 1);
 
     // 计算"破墙路径"的长度（把城墙当作可通行）
     std::vector<cocos2d::Vec2> findPathIgnoringWalls(const cocos2d::Vec2& startWorldPos, const cocos2d::Vec2& endWorldPos);
 
-    // 重新同步地图数据（当建筑位置改变时调用）
-    void updatePathfindingMap();
+    // 按战斗建筑状态表重新同步地图数据（开战、建筑被摧毁时调用）：存活且参与战斗的建筑阻挡寻路，陷阱不阻挡
+    void updatePathfindingMap(const BattleBuildingStore& buildings);
 
     // 辅助：判断某格是否可走
     bool isWalkable(int gridX, int gridY) const;
 
+    // 占用该格的存活建筑在状态表中的下标，空地返回 -1
+    int getBuildingIndexAt(int gridX, int gridY) const;
+
     //  基础寻路接口（网格坐标）
     std::vector<cocos2d::Vec2> findPath(const cocos2d::Vec2& startGridPos, const cocos2d::Vec2& endGridPos);
     
@@ -45,14 +56,12 @@ public:
     std::vector<cocos2d::Vec2> findPathGrid(const cocos2d::Vec2& startGrid, const cocos2d::Vec2& endGrid);
 
 private:
-    FindPathUtil();
-    ~FindPathUtil();
-
     static FindPathUtil* _instance;
 
     int _mapWidth;
     int _mapHeight;
     std::vector<uint8_t> _pathfindingMap; // 扁平化的一维数组存储地图数据
+    std::vector<int> _buildingIndexMap;   // 每格占用建筑的状态表下标，-1 为空地
 
     //  性能优化：复用的 A* 数据结构（避免频繁分配）
     std::vector<int> _gScore;           // G值缓存
@@ -0,0 +1,50 @@
+﻿// HudFont.cpp
+// HUD 动态数字标签字体实现，位图字体加载和 TTF 回退
+
+#include "HudFont.h"
+
+USING_NS_CC;
+
+namespace {
+    const char* BMFONT_ROOT = "fonts/bmfont/";
+    const int OUTLINE_SIZE = 2;
+}
+
+Label* HudFont::createLabel(const std::string& text, Face face, float fontSize, bool outlined) {
+    Label* label = nullptr;
+
+    if (hasBakedFont(face, outlined)) {
+        label = Label::createWithBMFont(bakedFontPath(face, outlined), text);
+        if (label) {
+            label->setBMFontSize(fontSize);
+            return label;
+        }
+        CCLOG("HudFont: WARNING - Failed to load %s, falling back to TTF", bakedFontPath(face, outlined).c_str());
+    }
+
+    label = Label::createWithTTF(text, ttfPath(face), fontSize);
+    if (!label) {
+        label = Label::createWithSystemFont(text, "Arial", fontSize);
+    }
+    if (label && outlined) {
+        label->enableOutline(Color4B::BLACK, OUTLINE_SIZE);
+    }
+    return label;
+}
+
+bool HudFont::hasBakedFont(Face face, bool outlined) {
+    // FileUtils 内部缓存了路径查找结果，重复调用开销很小
+    return FileUtils::getInstance()->isFileExist(bakedFontPath(face, outlined));
+}
+
+std::string HudFont::bakedFontPath(Face face, bool outlined) {
+    std::string name = face == Face::SIMHEI ? "simhei" : "marker";
+    if (outlined) {
+        name += "_outline";
+    }
+    return BMFONT_ROOT + name + ".fnt";
+}
+
+const char* HudFont::ttfPath(Face face) {
+    return face == Face::SIMHEI ? "fonts/simhei.ttf" : "fonts/Marker Felt.ttf";
+}
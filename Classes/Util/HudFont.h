@@ -0,0 +1,36 @@
+﻿// HudFont.h
+// HUD 动态数字标签字体声明，优先使用构建时烘焙的位图字体
+
+#ifndef __HUD_FONT_H__
+#define __HUD_FONT_H__
+
+#include "cocos2d.h"
+#include <string>
+
+USING_NS_CC;
+
+// HUD 字体工具
+// 倒计时、资源数量等每帧或每秒刷新的标签用位图字体（FontBaker 构建时生成到 fonts/bmfont/）：
+// - 改字只重写字形四边形，不经过 FreeType 光栅化，也不会往动态字形图集里新增字形
+// - 描边已烘焙进字形（黑色描边、白色字形），setColor 只改变字形颜色
+// - 烘焙字体缺失时回退为 TTF + enableOutline，再回退为系统字体，外观保持一致
+// 注意：位图字体标签不支持 enableOutline，调用方不要再对返回的标签设置描边
+class HudFont {
+public:
+    enum class Face {
+        SIMHEI,         // fonts/simhei.ttf，中文倒计时和进度
+        MARKER_FELT     // fonts/Marker Felt.ttf，资源数量
+    };
+
+    // 创建标签，fontSize 为显示字号，outlined 表示带 2 像素黑色描边
+    static Label* createLabel(const std::string& text, Face face, float fontSize, bool outlined = true);
+
+    // 烘焙的位图字体是否存在
+    static bool hasBakedFont(Face face, bool outlined);
+
+private:
+    static std::string bakedFontPath(Face face, bool outlined);
+    static const char* ttfPath(Face face);
+};
+
+#endif // __HUD_FONT_H__
@@ -0,0 +1,354 @@
+﻿// main.cpp
+// 纹理图集打包工具：构建时把建筑和界面散图打包成少量图集（PNG + plist），运行时由 AtlasManager 加载
+//
+// 用法：AtlasPacker --resources <资源目录> --out <输出目录> [--max-size N] [--max-sprite N] <图集名>=<子目录>[,<子目录>...] ...
+//   例：AtlasPacker --resources /path/to/Resources --out build/atlas buildings=buildings ui=UI,ImageElements
+//   - 资源目录需为绝对路径（由 CMake 传入）
+//   - 帧名为相对资源目录的路径（如 "buildings/Town_Hall/Town_Hall1.png"），与代码中的散图路径一致
+//   - 每个图集按需要分成多页，输出 <图集名>_<页号>.png/.plist（plist 为 cocos2d 格式 2）
+//   - 任一边超过 --max-sprite 的大图不打包，运行时继续按散图加载
+//   - 输出目录下的 atlases.plist 列出所有页，供运行时一次性加载
+
+#include "cocos2d.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+const int PADDING = 2;              // 图块间距（含 1 像素边缘外扩，防止缩放采样串色）
+
+struct Options {
+    std::string resourcesDir;
+    std::string outDir;
+    int maxSize = 2048;             // 图集页最大边长
+    int maxSprite = 1024;           // 可打包的单图最大边长
+    std::vector<std::pair<std::string, std::vector<std::string>>> atlases;
+};
+
+// 待打包的单张图片（已统一为 RGBA8888）
+struct SourceImage {
+    std::string name;               // 帧名（相对资源目录）
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+    int page = -1;
+    int x = 0;
+    int y = 0;
+};
+
+// 一页图集的排布状态（按行货架排布）
+struct Page {
+    int shelfY = 0;
+    int shelfHeight = 0;
+    int cursorX = 0;
+    int usedHeight = 0;
+};
+
+void printUsage() {
+    std::cerr << "Usage: AtlasPacker --resources <dir> --out <dir> [--max-size N] [--max-sprite N] "
+              << "<atlas>=<subdir>[,<subdir>...] ..." << std::endl;
+}
+
+std::vector<std::string> split(const std::string& value, char separator) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(separator, start);
+        if (end == std::string::npos) end = value.size();
+        if (end > start) parts.push_back(value.substr(start, end - start));
+        start = end + 1;
+    }
+    return parts;
+}
+
+std::string withSlash(std::string dir) {
+    if (!dir.empty() && dir.back() != '/' && dir.back() != '\\') dir += '/';
+    return dir;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--resources" && i + 1 < argc) {
+            options.resourcesDir = withSlash(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outDir = withSlash(argv[++i]);
+        } else if (arg == "--max-size" && i + 1 < argc) {
+            options.maxSize = std::atoi(argv[++i]);
+        } else if (arg == "--max-sprite" && i + 1 < argc) {
+            options.maxSprite = std::atoi(argv[++i]);
+        } else if (arg.find('=') != std::string::npos && arg[0] != '-') {
+            size_t eq = arg.find('=');
+            auto dirs = split(arg.substr(eq + 1), ',');
+            if (eq == 0 || dirs.empty()) return false;
+            options.atlases.emplace_back(arg.substr(0, eq), dirs);
+        } else {
+            return false;
+        }
+    }
+    return !options.resourcesDir.empty() && !options.outDir.empty() && !options.atlases.empty() &&
+           options.maxSize > 0 && options.maxSprite > 0 && options.maxSprite + PADDING <= options.maxSize;
+}
+
+bool hasSuffix(const std::string& name, const std::string& suffix) {
+    return name.size() > suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// 读取图片并转换为 RGBA8888（PNG 可能解码为 RGB、灰度或灰度+透明）
+bool loadImage(const std::string& path, SourceImage& out) {
+    Image image;
+    if (!image.initWithImageFile(path)) return false;
+
+    int channels;
+    switch (image.getRenderFormat()) {
+        case Texture2D::PixelFormat::RGBA8888: channels = 4; break;
+        case Texture2D::PixelFormat::RGB888:   channels = 3; break;
+        case Texture2D::PixelFormat::AI88:     channels = 2; break;
+        case Texture2D::PixelFormat::I8:       channels = 1; break;
+        default: return false;
+    }
+
+    out.width = image.getWidth();
+    out.height = image.getHeight();
+    out.pixels.resize(static_cast<size_t>(out.width) * out.height * 4);
+
+    const unsigned char* src = image.getData();
+    size_t count = static_cast<size_t>(out.width) * out.height;
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char* p = src + i * channels;
+        unsigned char* q = &out.pixels[i * 4];
+        if (channels >= 3) {
+            q[0] = p[0]; q[1] = p[1]; q[2] = p[2];
+            q[3] = channels == 4 ? p[3] : 255;
+        } else {
+            q[0] = q[1] = q[2] = p[0];
+            q[3] = channels == 2 ? p[1] : 255;
+        }
+    }
+    return true;
+}
+
+// 按高度降序货架排布，放不下时开新页
+void layoutImages(std::vector<SourceImage*>& images, int maxSize, std::vector<Page>& pages) {
+    std::stable_sort(images.begin(), images.end(), [](const SourceImage* a, const SourceImage* b) {
+        return a->height > b->height;
+    });
+
+    for (auto image : images) {
+        int w = image->width + PADDING;
+        int h = image->height + PADDING;
+
+        bool placed = false;
+        for (size_t p = 0; p < pages.size() && !placed; ++p) {
+            Page& page = pages[p];
+
+            // 当前行放不下时需要换行；先确认换行后页面高度够用再修改页面状态，
+            // 否则图片转到下一页时这一页会留下一个空行
+            bool newShelf = page.cursorX + w > maxSize;
+            int shelfY = newShelf ? page.shelfY + page.shelfHeight : page.shelfY;
+            if (shelfY + h > maxSize) continue;
+
+            if (newShelf) {
+                page.shelfY = shelfY;
+                page.shelfHeight = 0;
+                page.cursorX = 0;
+            }
+
+            image->page = static_cast<int>(p);
+            image->x = page.cursorX + PADDING / 2;
+            image->y = page.shelfY + PADDING / 2;
+            page.cursorX += w;
+            page.shelfHeight = std::max(page.shelfHeight, h);
+            page.usedHeight = std::max(page.usedHeight, page.shelfY + page.shelfHeight);
+            placed = true;
+        }
+
+        if (!placed) {
+            pages.emplace_back();
+            Page& page = pages.back();
+            image->page = static_cast<int>(pages.size() - 1);
+            image->x = PADDING / 2;
+            image->y = PADDING / 2;
+            page.cursorX = w;
+            page.shelfHeight = h;
+            page.usedHeight = h;
+        }
+    }
+}
+
+// 把图片拷入页面，并向四周外扩 1 像素边缘
+void blit(std::vector<unsigned char>& page, int pageWidth, int pageHeight, const SourceImage& image) {
+    for (int y = -1; y <= image.height; ++y) {
+        int dy = image.y + y;
+        if (dy < 0 || dy >= pageHeight) continue;
+        int sy = std::min(std::max(y, 0), image.height - 1);
+
+        for (int x = -1; x <= image.width; ++x) {
+            int dx = image.x + x;
+            if (dx < 0 || dx >= pageWidth) continue;
+            int sx = std::min(std::max(x, 0), image.width - 1);
+
+            const unsigned char* src = &image.pixels[(static_cast<size_t>(sy) * image.width + sx) * 4];
+            unsigned char* dst = &page[(static_cast<size_t>(dy) * pageWidth + dx) * 4];
+            std::copy(src, src + 4, dst);
+        }
+    }
+}
+
+std::string rectString(int x, int y, int w, int h) {
+    return StringUtils::format("{{%d,%d},{%d,%d}}", x, y, w, h);
+}
+
+std::string sizeString(int w, int h) {
+    return StringUtils::format("{%d,%d}", w, h);
+}
+
+// 写出一页图集，返回 plist 文件名（失败返回空）
+std::string writePage(const Options& options, const std::string& atlasName, int pageIndex,
+                      int pageWidth, int pageHeight, const std::vector<SourceImage*>& images) {
+    std::vector<unsigned char> pixels(static_cast<size_t>(pageWidth) * pageHeight * 4, 0);
+    ValueMap frames;
+
+    for (auto image : images) {
+        if (image->page != pageIndex) continue;
+        blit(pixels, pageWidth, pageHeight, *image);
+
+        ValueMap frame;
+        frame["frame"] = rectString(image->x, image->y, image->width, image->height);
+        frame["offset"] = "{0,0}";
+        frame["rotated"] = false;
+        frame["sourceColorRect"] = rectString(0, 0, image->width, image->height);
+        frame["sourceSize"] = sizeString(image->width, image->height);
+        frames[image->name] = Value(frame);
+    }
+
+    std::string baseName = StringUtils::format("%s_%d", atlasName.c_str(), pageIndex);
+    std::string pngName = baseName + ".png";
+    std::string plistName = baseName + ".plist";
+
+    Image page;
+    if (!page.initWithRawData(pixels.data(), pixels.size(), pageWidth, pageHeight, 8) ||
+        !page.saveToFile(options.outDir + pngName, false)) {
+        std::cerr << "AtlasPacker: failed to write " << options.outDir << pngName << std::endl;
+        return std::string();
+    }
+
+    ValueMap metadata;
+    metadata["format"] = 2;
+    metadata["realTextureFileName"] = pngName;
+    metadata["textureFileName"] = pngName;
+    metadata["size"] = sizeString(pageWidth, pageHeight);
+
+    ValueMap plist;
+    plist["frames"] = Value(frames);
+    plist["metadata"] = Value(metadata);
+    if (!FileUtils::getInstance()->writeValueMapToFile(plist, options.outDir + plistName)) {
+        std::cerr << "AtlasPacker: failed to write " << options.outDir << plistName << std::endl;
+        return std::string();
+    }
+    return plistName;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // 保持原始（非预乘）像素，运行时加载图集时再按散图相同方式预乘
+    Image::setPNGPremultipliedAlphaEnabled(false);
+
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isAbsolutePath(options.resourcesDir)) {
+        std::cerr << "AtlasPacker: --resources must be an absolute path" << std::endl;
+        return 2;
+    }
+    if (!fileUtils->isDirectoryExist(options.outDir) && !fileUtils->createDirectory(options.outDir)) {
+        std::cerr << "AtlasPacker: cannot create output directory " << options.outDir << std::endl;
+        return 1;
+    }
+
+    ValueVector manifest;
+    int totalPacked = 0;
+    int totalLoose = 0;
+
+    for (const auto& atlas : options.atlases) {
+        // 收集图片（帧名用正斜杠的相对路径）
+        std::vector<SourceImage> sources;
+        for (const auto& subdir : atlas.second) {
+            std::vector<std::string> files;
+            fileUtils->listFilesRecursively(options.resourcesDir + subdir, &files);
+            std::sort(files.begin(), files.end());
+
+            for (const auto& path : files) {
+                if (!hasSuffix(path, ".png")) continue;
+                if (path.compare(0, options.resourcesDir.size(), options.resourcesDir) != 0) continue;
+
+                // 帧名：相对资源目录，统一为单个正斜杠分隔
+                std::string name = path.substr(options.resourcesDir.size());
+                std::replace(name.begin(), name.end(), '\\', '/');
+                for (size_t pos = name.find("//"); pos != std::string::npos; pos = name.find("//", pos)) {
+                    name.erase(pos, 1);
+                }
+
+                SourceImage image;
+                image.name = name;
+                if (!loadImage(path, image)) {
+                    std::cerr << "AtlasPacker: skipped unreadable image " << path << std::endl;
+                    continue;
+                }
+                if (image.width > options.maxSprite || image.height > options.maxSprite) {
+                    totalLoose++;
+                    continue;
+                }
+                sources.push_back(std::move(image));
+            }
+        }
+
+        std::vector<SourceImage*> images;
+        for (auto& image : sources) images.push_back(&image);
+
+        std::vector<Page> pages;
+        layoutImages(images, options.maxSize, pages);
+
+        for (size_t p = 0; p < pages.size(); ++p) {
+            // 宽度取实际用到的最右端，高度取最后一行底部，按 4 对齐
+            int usedWidth = 0;
+            for (auto image : images) {
+                if (image->page == static_cast<int>(p)) {
+                    usedWidth = std::max(usedWidth, image->x + image->width + PADDING / 2);
+                }
+            }
+            int pageWidth = (usedWidth + 3) & ~3;
+            int pageHeight = (pages[p].usedHeight + 3) & ~3;
+
+            std::string plistName = writePage(options, atlas.first, static_cast<int>(p),
+                                              pageWidth, pageHeight, images);
+            if (plistName.empty()) return 1;
+
+            manifest.push_back(Value("atlas/" + plistName));
+            std::cout << "AtlasPacker: " << plistName << " " << pageWidth << "x" << pageHeight << std::endl;
+        }
+        totalPacked += static_cast<int>(images.size());
+    }
+
+    ValueMap root;
+    root["atlases"] = Value(manifest);
+    if (!fileUtils->writeValueMapToFile(root, options.outDir + "atlases.plist")) {
+        std::cerr << "AtlasPacker: failed to write manifest" << std::endl;
+        return 1;
+    }
+
+    std::cout << "AtlasPacker: packed " << totalPacked << " images into " << manifest.size()
+              << " pages, " << totalLoose << " oversized images left as loose files" << std::endl;
+    return 0;
+}
@@ -0,0 +1,266 @@
+﻿// main.cpp
+// 位图字体烘焙工具：构建时把 HUD 动态标签用到的字符（数字、标点和少量汉字）从 TTF 烘焙成 BMFont（.fnt + .png），运行时由 HudFont 加载
+//
+// 用法：FontBaker --font <ttf> --size N [--outline N] (--chars <UTF-8 字符> | --chars-file <文件>) --out <输出路径前缀>
+//   例：FontBaker --font Resources/fonts/simhei.ttf --size 24 --outline 2 --chars-file tools/FontBaker/hud_chars.txt --out build/bmfont/simhei_outline
+//   - 输出 <前缀>.fnt（AngelCode 文本格式）和 <前缀>.png
+//   - 字形度量取自 FontFreeType，与同字体同字号的 TTF 标签排版一致
+//   - 描边直接烘焙进字形：字形白色、描边黑色，运行时 setColor 只改变字形颜色，效果与 TTF 标签 enableOutline(BLACK) 相同
+
+#include "cocos2d.h"
+#include "2d/CCFontFreeType.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+const int PADDING = 2;              // 字形间距，防止缩放采样串色
+
+struct Options {
+    std::string fontPath;
+    float size = 24.0f;
+    float outline = 0.0f;
+    std::string chars;
+    std::string charsFile;
+    std::string outPrefix;
+};
+
+// 单个字形（RGBA8888，非预乘）
+struct Glyph {
+    char32_t code = 0;
+    int width = 0;
+    int height = 0;
+    int xOffset = 0;
+    int yOffset = 0;                // 相对行顶
+    int xAdvance = 0;
+    std::vector<unsigned char> pixels;
+    int x = 0;
+    int y = 0;
+};
+
+void printUsage() {
+    std::cerr << "Usage: FontBaker --font <ttf> --size N [--outline N] "
+              << "(--chars <utf8> | --chars-file <file>) --out <prefix>" << std::endl;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--font" && i + 1 < argc) {
+            options.fontPath = argv[++i];
+        } else if (arg == "--size" && i + 1 < argc) {
+            options.size = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--outline" && i + 1 < argc) {
+            options.outline = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--chars" && i + 1 < argc) {
+            options.chars = argv[++i];
+        } else if (arg == "--chars-file" && i + 1 < argc) {
+            options.charsFile = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outPrefix = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return !options.fontPath.empty() && !options.outPrefix.empty() && options.size > 0.0f
+        && options.outline >= 0.0f && (!options.chars.empty() || !options.charsFile.empty());
+}
+
+std::string fileNameOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+int nextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+// 把 FontFreeType 返回的字形位图转为 RGBA
+// 有描边时位图为双通道（描边 alpha, 字形 alpha），白色字形叠在黑色描边上
+void convertBitmap(const unsigned char* bitmap, bool outlined, Glyph& glyph) {
+    int count = glyph.width * glyph.height;
+    glyph.pixels.assign(count * 4, 0);
+
+    for (int i = 0; i < count; ++i) {
+        unsigned char* dst = &glyph.pixels[i * 4];
+        if (!outlined) {
+            dst[0] = dst[1] = dst[2] = 255;
+            dst[3] = bitmap[i];
+            continue;
+        }
+
+        float outlineAlpha = bitmap[i * 2] / 255.0f;
+        float fillAlpha = bitmap[i * 2 + 1] / 255.0f;
+        float alpha = fillAlpha + outlineAlpha * (1.0f - fillAlpha);
+        unsigned char gray = alpha > 0.0f ? static_cast<unsigned char>(255.0f * fillAlpha / alpha + 0.5f) : 0;
+        dst[0] = dst[1] = dst[2] = gray;
+        dst[3] = static_cast<unsigned char>(255.0f * alpha + 0.5f);
+    }
+}
+
+// 按行货架排布，返回所需高度；宽度不够时返回 -1
+int layoutGlyphs(std::vector<Glyph*>& glyphs, int width) {
+    int cursorX = PADDING;
+    int shelfY = PADDING;
+    int shelfHeight = 0;
+
+    for (auto glyph : glyphs) {
+        if (glyph->width + PADDING * 2 > width) return -1;
+
+        if (cursorX + glyph->width + PADDING > width) {
+            shelfY += shelfHeight + PADDING;
+            cursorX = PADDING;
+            shelfHeight = 0;
+        }
+        glyph->x = cursorX;
+        glyph->y = shelfY;
+        cursorX += glyph->width + PADDING;
+        shelfHeight = std::max(shelfHeight, glyph->height);
+    }
+    return shelfY + shelfHeight + PADDING;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    Image::setPNGPremultipliedAlphaEnabled(false);
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string utf8 = options.chars;
+    if (!options.charsFile.empty()) {
+        utf8 += fileUtils->getStringFromFile(options.charsFile);
+    }
+
+    std::u32string codes;
+    if (!StringUtils::UTF8ToUTF32(utf8, codes)) {
+        std::cerr << "FontBaker: character list is not valid UTF-8" << std::endl;
+        return 2;
+    }
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+
+    auto font = FontFreeType::create(options.fontPath, options.size, GlyphCollection::DYNAMIC, nullptr, false, options.outline);
+    if (!font) {
+        std::cerr << "FontBaker: cannot load font " << options.fontPath << std::endl;
+        return 1;
+    }
+    font->retain();
+
+    const bool outlined = options.outline > 0.0f;
+    const int ascender = font->getFontAscender();
+    const int lineHeight = font->getFontMaxHeight();
+
+    std::vector<Glyph> glyphs;
+    for (char32_t code : codes) {
+        if (code == U'\n' || code == U'\r' || code == U'\t') continue;
+
+        long width = 0;
+        long height = 0;
+        Rect rect;
+        int xAdvance = 0;
+        unsigned char* bitmap = font->getGlyphBitmap(code, width, height, rect, xAdvance);
+        if (!bitmap && code != U' ') {
+            std::cerr << "FontBaker: warning - no glyph for U+" << std::hex << static_cast<unsigned>(code) << std::dec << std::endl;
+            continue;
+        }
+
+        Glyph glyph;
+        glyph.code = code;
+        glyph.xAdvance = xAdvance;
+        glyph.xOffset = static_cast<int>(rect.origin.x);
+        glyph.yOffset = ascender + static_cast<int>(rect.origin.y);
+        if (bitmap && width > 0 && height > 0) {
+            glyph.width = static_cast<int>(width);
+            glyph.height = static_cast<int>(height);
+            convertBitmap(bitmap, outlined, glyph);
+
+            // 描边位图由 FontFreeType 新分配，普通位图属于 FreeType
+            if (outlined) delete[] bitmap;
+        }
+        glyphs.push_back(glyph);
+    }
+    font->release();
+
+    if (glyphs.empty()) {
+        std::cerr << "FontBaker: no glyphs to bake" << std::endl;
+        return 1;
+    }
+
+    // 从窄到宽尝试，取第一个高度不超过宽度的方形附近尺寸
+    std::vector<Glyph*> order;
+    for (auto& glyph : glyphs) order.push_back(&glyph);
+    std::sort(order.begin(), order.end(), [](const Glyph* a, const Glyph* b) {
+        return a->height != b->height ? a->height > b->height : a->code < b->code;
+    });
+
+    int textureWidth = 64;
+    int textureHeight = -1;
+    for (; textureWidth <= 4096; textureWidth *= 2) {
+        textureHeight = layoutGlyphs(order, textureWidth);
+        if (textureHeight > 0 && textureHeight <= textureWidth) break;
+    }
+    if (textureHeight <= 0 || textureWidth > 4096) {
+        std::cerr << "FontBaker: glyphs do not fit into a 4096 texture" << std::endl;
+        return 1;
+    }
+    textureHeight = nextPowerOfTwo(textureHeight);
+
+    std::vector<unsigned char> atlas(textureWidth * textureHeight * 4, 0);
+    for (const auto& glyph : glyphs) {
+        for (int row = 0; row < glyph.height; ++row) {
+            std::copy(glyph.pixels.begin() + row * glyph.width * 4,
+                      glyph.pixels.begin() + (row + 1) * glyph.width * 4,
+                      atlas.begin() + ((glyph.y + row) * textureWidth + glyph.x) * 4);
+        }
+    }
+
+    const std::string pngPath = options.outPrefix + ".png";
+    const std::string fntPath = options.outPrefix + ".fnt";
+
+    Image image;
+    if (!image.initWithRawData(atlas.data(), atlas.size(), textureWidth, textureHeight, 8, false)
+        || !image.saveToFile(pngPath, false)) {
+        std::cerr << "FontBaker: cannot write " << pngPath << std::endl;
+        return 1;
+    }
+
+    std::ofstream fnt(fntPath, std::ios::binary);
+    if (!fnt) {
+        std::cerr << "FontBaker: cannot write " << fntPath << std::endl;
+        return 1;
+    }
+
+    const std::string face = fileNameOf(options.fontPath);
+    fnt << "info face=\"" << face << "\" size=" << static_cast<int>(options.size)
+        << " bold=0 italic=0 charset=\"\" unicode=1 stretchH=100 smooth=1 aa=1 padding=0,0,0,0 spacing="
+        << PADDING << "," << PADDING << "\n";
+    fnt << "common lineHeight=" << lineHeight << " base=" << ascender
+        << " scaleW=" << textureWidth << " scaleH=" << textureHeight << " pages=1 packed=0\n";
+    fnt << "page id=0 file=\"" << fileNameOf(pngPath) << "\"\n";
+    fnt << "chars count=" << glyphs.size() << "\n";
+    for (const auto& glyph : glyphs) {
+        fnt << "char id=" << static_cast<unsigned>(glyph.code)
+            << " x=" << glyph.x << " y=" << glyph.y
+            << " width=" << glyph.width << " height=" << glyph.height
+            << " xoffset=" << glyph.xOffset << " yoffset=" << glyph.yOffset
+            << " xadvance=" << glyph.xAdvance << " page=0 chnl=15\n";
+    }
+
+    std::cout << "FontBaker: " << fileNameOf(fntPath) << " " << glyphs.size() << " glyphs, "
+              << textureWidth << "x" << textureHeight << std::endl;
+    return 0;
+}
@@ -0,0 +1,228 @@
+﻿// main.cpp
+// 地图背景切片工具：构建时把整张地图背景切成固定尺寸的瓦片并生成各级缩小图，运行时由 TiledMapBackground 按可见范围加载
+//
+// 用法：MapTiler --out <输出目录> [--tile-size N] <图片> [<图片> ...]
+//   例：MapTiler --out build/tiles Resources/Scene/VillageScene.png Resources/Scene/Map_Royale.png
+//   - 每张图片输出到 <输出目录>/<文件名去扩展名>/
+//   - 第 0 级为原图，之后每级宽高减半，直到宽高都不超过瓦片尺寸
+//   - 瓦片文件为 <级别>/<列>_<行>.<jpg|png>（行从图片顶部开始），不透明图片用 jpg
+//   - tiles.plist 记录原图尺寸、瓦片尺寸、级数和扩展名
+
+#include "cocos2d.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+struct Options {
+    std::string outDir;
+    int tileSize = 512;
+    std::vector<std::string> images;
+};
+
+// 一级图像数据（RGB 或 RGBA，每通道 8 位）
+struct Level {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> pixels;
+};
+
+void printUsage() {
+    std::cerr << "Usage: MapTiler --out <dir> [--tile-size N] <image> [<image> ...]" << std::endl;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            options.outDir = argv[++i];
+            if (options.outDir.back() != '/' && options.outDir.back() != '\\') options.outDir += '/';
+        } else if (arg == "--tile-size" && i + 1 < argc) {
+            options.tileSize = std::atoi(argv[++i]);
+        } else if (!arg.empty() && arg[0] != '-') {
+            options.images.push_back(arg);
+        } else {
+            return false;
+        }
+    }
+    return !options.outDir.empty() && !options.images.empty() && options.tileSize >= 64;
+}
+
+std::string stemOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+// 读取原图为第 0 级（灰度图展开为 RGB/RGBA）
+bool loadLevel0(const std::string& path, Level& out) {
+    Image image;
+    if (!image.initWithImageFile(path)) return false;
+
+    int srcChannels;
+    switch (image.getRenderFormat()) {
+        case Texture2D::PixelFormat::RGBA8888: srcChannels = 4; break;
+        case Texture2D::PixelFormat::RGB888:   srcChannels = 3; break;
+        case Texture2D::PixelFormat::AI88:     srcChannels = 2; break;
+        case Texture2D::PixelFormat::I8:       srcChannels = 1; break;
+        default: return false;
+    }
+
+    out.width = image.getWidth();
+    out.height = image.getHeight();
+    out.channels = (srcChannels == 4 || srcChannels == 2) ? 4 : 3;
+    out.pixels.resize(static_cast<size_t>(out.width) * out.height * out.channels);
+
+    const unsigned char* src = image.getData();
+    size_t count = static_cast<size_t>(out.width) * out.height;
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char* p = src + i * srcChannels;
+        unsigned char* q = &out.pixels[i * out.channels];
+        if (srcChannels >= 3) {
+            q[0] = p[0]; q[1] = p[1]; q[2] = p[2];
+        } else {
+            q[0] = q[1] = q[2] = p[0];
+        }
+        if (out.channels == 4) q[3] = srcChannels == 4 ? p[3] : p[1];
+    }
+    return true;
+}
+
+// 2x2 盒式滤波缩小一半（奇数边长时最后一列/行重复采样）
+Level downsample(const Level& src) {
+    Level dst;
+    dst.width = std::max(1, (src.width + 1) / 2);
+    dst.height = std::max(1, (src.height + 1) / 2);
+    dst.channels = src.channels;
+    dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * dst.channels);
+
+    for (int y = 0; y < dst.height; ++y) {
+        int y0 = std::min(y * 2, src.height - 1);
+        int y1 = std::min(y * 2 + 1, src.height - 1);
+        for (int x = 0; x < dst.width; ++x) {
+            int x0 = std::min(x * 2, src.width - 1);
+            int x1 = std::min(x * 2 + 1, src.width - 1);
+            for (int c = 0; c < dst.channels; ++c) {
+                int sum = src.pixels[(static_cast<size_t>(y0) * src.width + x0) * src.channels + c] +
+                          src.pixels[(static_cast<size_t>(y0) * src.width + x1) * src.channels + c] +
+                          src.pixels[(static_cast<size_t>(y1) * src.width + x0) * src.channels + c] +
+                          src.pixels[(static_cast<size_t>(y1) * src.width + x1) * src.channels + c];
+                dst.pixels[(static_cast<size_t>(y) * dst.width + x) * dst.channels + c] =
+                    static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+bool writeTile(const Level& level, int col, int row, int tileSize, const std::string& path) {
+    int x0 = col * tileSize;
+    int y0 = row * tileSize;
+    int w = std::min(tileSize, level.width - x0);
+    int h = std::min(tileSize, level.height - y0);
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) * h * level.channels);
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* src = &level.pixels[(static_cast<size_t>(y0 + y) * level.width + x0) * level.channels];
+        std::copy(src, src + static_cast<size_t>(w) * level.channels,
+                  &pixels[static_cast<size_t>(y) * w * level.channels]);
+    }
+
+    // initWithRawData 只接受 RGBA，RGB 数据先补不透明通道，保存为 jpg 时再去掉
+    Image tile;
+    if (level.channels == 4) {
+        if (!tile.initWithRawData(pixels.data(), pixels.size(), w, h, 8)) return false;
+        return tile.saveToFile(path, false);
+    }
+
+    std::vector<unsigned char> rgba(static_cast<size_t>(w) * h * 4);
+    for (size_t i = 0, n = static_cast<size_t>(w) * h; i < n; ++i) {
+        rgba[i * 4 + 0] = pixels[i * 3 + 0];
+        rgba[i * 4 + 1] = pixels[i * 3 + 1];
+        rgba[i * 4 + 2] = pixels[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+    if (!tile.initWithRawData(rgba.data(), rgba.size(), w, h, 8)) return false;
+    return tile.saveToFile(path, true);
+}
+
+bool tileImage(const Options& options, const std::string& path) {
+    Level level;
+    if (!loadLevel0(path, level)) {
+        std::cerr << "MapTiler: cannot read " << path << std::endl;
+        return false;
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    const std::string dir = options.outDir + stemOf(path) + "/";
+    const std::string ext = level.channels == 4 ? "png" : "jpg";
+    const int width = level.width;
+    const int height = level.height;
+
+    int levelIndex = 0;
+    int tileCount = 0;
+    while (true) {
+        std::string levelDir = dir + StringUtils::format("%d/", levelIndex);
+        if (!fileUtils->createDirectory(levelDir)) {
+            std::cerr << "MapTiler: cannot create " << levelDir << std::endl;
+            return false;
+        }
+
+        int cols = (level.width + options.tileSize - 1) / options.tileSize;
+        int rows = (level.height + options.tileSize - 1) / options.tileSize;
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                std::string tilePath = levelDir + StringUtils::format("%d_%d.", col, row) + ext;
+                if (!writeTile(level, col, row, options.tileSize, tilePath)) {
+                    std::cerr << "MapTiler: failed to write " << tilePath << std::endl;
+                    return false;
+                }
+                tileCount++;
+            }
+        }
+
+        levelIndex++;
+        if (level.width <= options.tileSize && level.height <= options.tileSize) break;
+        level = downsample(level);
+    }
+
+    ValueMap manifest;
+    manifest["width"] = width;
+    manifest["height"] = height;
+    manifest["tileSize"] = options.tileSize;
+    manifest["levels"] = levelIndex;
+    manifest["extension"] = ext;
+    if (!fileUtils->writeValueMapToFile(manifest, dir + "tiles.plist")) {
+        std::cerr << "MapTiler: failed to write manifest for " << path << std::endl;
+        return false;
+    }
+
+    std::cout << "MapTiler: " << stemOf(path) << " " << width << "x" << height << ", "
+              << levelIndex << " levels, " << tileCount << " tiles" << std::endl;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // 瓦片按原始像素保存，运行时加载时再预乘
+    Image::setPNGPremultipliedAlphaEnabled(false);
+
+    for (const auto& image : options.images) {
+        if (!tileImage(options, image)) return 1;
+    }
+    return 0;
+}
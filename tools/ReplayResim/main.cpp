@@ -0,0 +1,268 @@
+﻿// main.cpp
+// 回放批量重算命令行工具：读取回放目录，无界面并行重算每场战斗，输出 CSV/JSON 结果
+//
+// 用法：ReplayResim <回放目录> [--format csv|json] [--out 文件] [--fail-on-regression]
+//   回放目录一般为 <可写目录>/replays/，读取 replay_*.rpl 以及旧版 replay_*.json
+//   --fail-on-regression  任一回放的模拟器状态哈希与保存时的模拟器基准不一致，
+//                         或重算的星数/摧毁百分比与实时战斗记录不一致时返回 1
+//                         （用于平衡性修改和模拟器优化后的回归检查）
+//
+// 记录星数和摧毁百分比来自实时战斗，重算结果来自固定步长的模拟器；两者调用同一套 BattleRules，
+// 结果不一致说明战斗规则或模拟器出现了分歧
+
+#include "cocos2d.h"
+#include "Model/ReplayData.h"
+#include "Model/ReplayCodec.h"
+#include "Controller/HeadlessBattleSim.h"
+#include "json/prettywriter.h"
+#include "json/stringbuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+const char* TROOP_COLUMN_NAMES[SimResult::TROOP_TYPE_COUNT] = {
+    "barbarian", "archer", "goblin", "giant", "wall_breaker", "balloon"
+};
+
+struct ResimRow {
+    std::string file;
+    int replayId = 0;
+    int recordedStars = 0;
+    int recordedDestruction = 0;
+    float recordedDuration = 0.0f;
+    int deployCount = 0;
+    SimResult sim;
+    double simMilliseconds = 0.0;
+
+    // 重算的星数和摧毁百分比（取整，与回放记录的精度一致）是否与实时战斗一致
+    bool matchesLive() const {
+        return sim.stars == recordedStars && static_cast<int>(sim.destruction) == recordedDestruction;
+    }
+
+    // 模拟器回归检查：基准为保存回放时同一模拟器的推演结果
+    std::vector<StateHashSample> baselineHashes;
+    std::vector<StateHashSample> simHashes;
+    int regressionTick = -1;        // 第一个与基准不一致的采样序号，-1 表示一致或没有基准
+    std::string regressionDiff;
+
+    bool hasBaseline() const { return !baselineHashes.empty(); }
+};
+
+struct Options {
+    std::string replayDir;
+    std::string format = "csv";
+    std::string outPath;
+    bool failOnRegression = false;
+};
+
+void printUsage() {
+    std::cerr << "Usage: ReplayResim <replay_dir> [--format csv|json] [--out file] [--fail-on-regression]" << std::endl;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            options.format = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outPath = argv[++i];
+        } else if (arg == "--fail-on-regression") {
+            options.failOnRegression = true;
+        } else if (!arg.empty() && arg[0] != '-' && options.replayDir.empty()) {
+            options.replayDir = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.replayDir.empty() && (options.format == "csv" || options.format == "json");
+}
+
+bool hasSuffix(const std::string& name, const std::string& suffix) {
+    return name.size() > suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool isReplayFile(const std::string& path) {
+    std::string name = path.substr(path.find_last_of("/\\") + 1);
+    return name.compare(0, 7, "replay_") == 0 &&
+           (hasSuffix(name, ReplayCodec::FILE_EXTENSION) || hasSuffix(name, ".json"));
+}
+
+void writeCsv(std::ostream& out, const std::vector<ResimRow>& rows) {
+    out << "file,replay_id,recorded_stars,recorded_destruction,recorded_duration,deploy_count,"
+        << "sim_stars,sim_destruction,sim_duration,baseline_regression_tick";
+    for (const char* name : TROOP_COLUMN_NAMES) {
+        out << ",damage_" << name;
+    }
+    out << ",sim_ms\n";
+
+    for (const auto& row : rows) {
+        out << row.file << ',' << row.replayId << ','
+            << row.recordedStars << ',' << row.recordedDestruction << ','
+            << row.recordedDuration << ',' << row.deployCount << ','
+            << row.sim.stars << ',' << row.sim.destruction << ',' << row.sim.duration << ',';
+        if (row.hasBaseline()) out << row.regressionTick;
+        for (int damage : row.sim.troopDamage) {
+            out << ',' << damage;
+        }
+        out << ',' << row.simMilliseconds << '\n';
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<ResimRow>& rows) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+    writer.StartArray();
+    for (const auto& row : rows) {
+        writer.StartObject();
+        writer.Key("file");                 writer.String(row.file.c_str());
+        writer.Key("replayId");             writer.Int(row.replayId);
+        writer.Key("recordedStars");        writer.Int(row.recordedStars);
+        writer.Key("recordedDestruction");  writer.Int(row.recordedDestruction);
+        writer.Key("recordedDuration");     writer.Double(row.recordedDuration);
+        writer.Key("deployCount");          writer.Int(row.deployCount);
+        writer.Key("simStars");             writer.Int(row.sim.stars);
+        writer.Key("simDestruction");       writer.Double(row.sim.destruction);
+        writer.Key("simDuration");          writer.Double(row.sim.duration);
+        writer.Key("baselineRegressionTick");
+        if (row.hasBaseline()) writer.Int(row.regressionTick); else writer.Null();
+        if (row.regressionTick >= 0) {
+            writer.Key("regression");       writer.String(row.regressionDiff.c_str());
+        }
+        writer.Key("troopDamage");
+        writer.StartObject();
+        for (int i = 0; i < SimResult::TROOP_TYPE_COUNT; ++i) {
+            writer.Key(TROOP_COLUMN_NAMES[i]);
+            writer.Int(row.sim.troopDamage[i]);
+        }
+        writer.EndObject();
+        writer.Key("simMs");                writer.Double(row.simMilliseconds);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    out << buffer.GetString() << '\n';
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string dir = options.replayDir;
+    if (dir.back() != '/' && dir.back() != '\\') dir += '/';
+
+    if (!fileUtils->isDirectoryExist(dir)) {
+        std::cerr << "ReplayResim: directory not found: " << dir << std::endl;
+        return 2;
+    }
+
+    std::vector<std::string> files;
+    for (const auto& path : fileUtils->listFiles(dir)) {
+        if (isReplayFile(path)) files.push_back(path);
+    }
+    std::sort(files.begin(), files.end());
+
+    // 读取回放和构建模拟快照都会访问单例，在主线程完成
+    std::vector<ResimRow> rows;
+    std::vector<HeadlessBattleSetup> setups;
+    std::vector<std::vector<SimDeployment>> deployments;
+
+    for (const auto& path : files) {
+        BattleReplayData replay;
+        if (!ReplayCodec::loadFromFile(path, replay)) {
+            std::cerr << "ReplayResim: skipped unreadable replay " << path << std::endl;
+            continue;
+        }
+
+        std::vector<SimDeployment> events = HeadlessBattleSim::deploymentsFromReplay(replay);
+
+        ResimRow row;
+        row.file = path.substr(path.find_last_of("/\\") + 1);
+        row.replayId = replay.replayId;
+        row.recordedStars = replay.finalStars;
+        row.recordedDestruction = replay.destructionPercentage;
+        row.recordedDuration = replay.battleDuration;
+        row.deployCount = static_cast<int>(events.size());
+        row.baselineHashes = std::move(replay.simHashes);
+
+        rows.push_back(std::move(row));
+        setups.push_back(HeadlessBattleSim::buildSetup(replay));
+        deployments.push_back(std::move(events));
+    }
+
+    auto batchStart = std::chrono::steady_clock::now();
+
+    // 按部署顺序严格重算（不加随机扰动），每个回放独立计时
+    HeadlessBattleSim::parallelFor(static_cast<int>(rows.size()), [&](int i) {
+        auto start = std::chrono::steady_clock::now();
+        auto& row = rows[i];
+        row.sim = HeadlessBattleSim::run(setups[i], deployments[i], 0u, false,
+                                         row.hasBaseline() ? &row.simHashes : nullptr);
+        row.simMilliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        int index = BattleStateHasher::findFirstDivergence(row.baselineHashes, row.simHashes);
+        if (index >= 0) {
+            const auto& actual = row.simHashes[index];
+            row.regressionTick = actual.tick;
+            row.regressionDiff = BattleStateHasher::describeDiff(
+                *BattleStateHasher::findSample(row.baselineHashes, actual.tick), actual);
+        }
+    });
+
+    double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+
+    std::ofstream file;
+    if (!options.outPath.empty()) {
+        file.open(options.outPath);
+        if (!file) {
+            std::cerr << "ReplayResim: cannot write " << options.outPath << std::endl;
+            return 2;
+        }
+    }
+    std::ostream& out = options.outPath.empty() ? std::cout : file;
+
+    if (options.format == "json") {
+        writeJson(out, rows);
+    } else {
+        writeCsv(out, rows);
+    }
+
+    // 汇总写到 stderr，不影响重定向的结果数据
+    int liveMismatch = 0;
+    int regressed = 0;
+    for (const auto& row : rows) {
+        if (!row.matchesLive()) {
+            liveMismatch++;
+            std::cerr << "ReplayResim: " << row.file << " differs from live result: stars "
+                      << row.recordedStars << " -> " << row.sim.stars << ", destruction "
+                      << row.recordedDestruction << "% -> " << static_cast<int>(row.sim.destruction) << "%" << std::endl;
+        }
+        if (row.regressionTick >= 0) {
+            regressed++;
+            std::cerr << "ReplayResim: " << row.file << " differs from sim baseline at tick " << row.regressionTick
+                      << " (" << row.regressionTick * BattleStateHasher::SAMPLE_INTERVAL << "s): "
+                      << row.regressionDiff << std::endl;
+        }
+    }
+    std::cerr << "ReplayResim: " << rows.size() << " replays, "
+              << HeadlessBattleSim::getWorkerCount() << " threads, "
+              << batchSeconds << "s, sim/live result mismatch in " << liveMismatch << " replays, "
+              << "sim baseline regression in " << regressed << " replays" << std::endl;
+
+    return (options.failOnRegression && (regressed > 0 || liveMismatch > 0)) ? 1 : 0;
+}
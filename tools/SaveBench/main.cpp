@@ -0,0 +1,400 @@
+﻿// main.cpp
+// 村庄存档读写基准工具：在合成的大存档上比较旧版 DOM 读写和 VillageSaveCodec 流式读写
+//
+// 用法：SaveBench [--buildings N] [--runs R]
+//   默认 2000 座建筑、20 轮，输出每种方式的中位耗时、分配次数、分配总量和峰值占用
+//   两种方式的解析结果和写出的 JSON 必须完全一致，否则返回 1
+
+#include "Model/VillageData.h"
+#include "Model/VillageSaveCodec.h"
+#include "json/document.h"
+#include "json/writer.h"
+#include "json/stringbuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// ========== 分配统计 ==========
+// 全局 operator new 统计 STL 容器的分配，CountingAllocator 统计旧版 DOM 路径中 rapidjson 的分配
+// （流式解析器内部 256 字节的解析栈走 malloc，不在统计内）
+
+namespace {
+
+struct AllocStats {
+    size_t calls = 0;
+    size_t bytes = 0;
+    size_t live = 0;
+    size_t peak = 0;
+};
+
+AllocStats g_stats;
+const size_t HEADER_SIZE = 16;      // 保存分配大小，同时保持 16 字节对齐
+
+void* countedMalloc(size_t size) {
+    if (size == 0) size = 1;
+    char* block = static_cast<char*>(std::malloc(size + HEADER_SIZE));
+    if (!block) return nullptr;
+
+    *reinterpret_cast<size_t*>(block) = size;
+    g_stats.calls++;
+    g_stats.bytes += size;
+    g_stats.live += size;
+    g_stats.peak = std::max(g_stats.peak, g_stats.live);
+    return block + HEADER_SIZE;
+}
+
+void countedFree(void* ptr) {
+    if (!ptr) return;
+    char* block = static_cast<char*>(ptr) - HEADER_SIZE;
+    g_stats.live -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+}
+
+void* countedRealloc(void* ptr, size_t newSize) {
+    if (!ptr) return countedMalloc(newSize);
+    if (newSize == 0) {
+        countedFree(ptr);
+        return nullptr;
+    }
+
+    size_t oldSize = *reinterpret_cast<size_t*>(static_cast<char*>(ptr) - HEADER_SIZE);
+    void* result = countedMalloc(newSize);
+    if (result) {
+        std::memcpy(result, ptr, std::min(oldSize, newSize));
+        countedFree(ptr);
+    }
+    return result;
+}
+
+// rapidjson 分配器接口
+class CountingAllocator {
+public:
+    static const bool kNeedFree = true;
+    void* Malloc(size_t size) { return size ? countedMalloc(size) : nullptr; }
+    void* Realloc(void* ptr, size_t, size_t newSize) { return countedRealloc(ptr, newSize); }
+    static void Free(void* ptr) { countedFree(ptr); }
+};
+
+typedef rapidjson::GenericDocument<rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<CountingAllocator>,
+                                   CountingAllocator> CountingDocument;
+typedef rapidjson::GenericStringBuffer<rapidjson::UTF8<>, CountingAllocator> CountingStringBuffer;
+
+} // namespace
+
+void* operator new(size_t size) {
+    void* ptr = countedMalloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+
+namespace {
+
+// ========== 旧版 DOM 读写（重构前 VillageDataManager 的实现） ==========
+
+std::string saveWithDocument(const VillageSaveSnapshot& snapshot, uint64_t generation) {
+    const VillageData& data = snapshot.data;
+
+    CountingDocument doc;
+    doc.SetObject();
+    auto& allocator = doc.GetAllocator();
+
+    doc.AddMember("gold", data.gold, allocator);
+    doc.AddMember("elixir", data.elixir, allocator);
+    doc.AddMember("gem", data.gem, allocator);
+    doc.AddMember("currentTheme", snapshot.currentThemeId, allocator);
+
+    CountingDocument::ValueType purchasedArr(rapidjson::kArrayType);
+    for (int id : snapshot.purchasedThemes) {
+        purchasedArr.PushBack(id, allocator);
+    }
+    doc.AddMember("purchasedThemes", purchasedArr, allocator);
+
+    CountingDocument::ValueType troopsArray(rapidjson::kArrayType);
+    for (const auto& pair : data.troops) {
+        CountingDocument::ValueType troopObj(rapidjson::kObjectType);
+        troopObj.AddMember("id", pair.first, allocator);
+        troopObj.AddMember("count", pair.second, allocator);
+        troopsArray.PushBack(troopObj, allocator);
+    }
+    doc.AddMember("troops", troopsArray, allocator);
+
+    CountingDocument::ValueType buildingsArray(rapidjson::kArrayType);
+    for (const auto& building : data.buildings) {
+        CountingDocument::ValueType buildingObj(rapidjson::kObjectType);
+        buildingObj.AddMember("id", building.id, allocator);
+        buildingObj.AddMember("type", building.type, allocator);
+        buildingObj.AddMember("level", building.level, allocator);
+        buildingObj.AddMember("gridX", building.gridX, allocator);
+        buildingObj.AddMember("gridY", building.gridY, allocator);
+        buildingObj.AddMember("state", (int)building.state, allocator);
+        buildingObj.AddMember("finishTime", static_cast<int64_t>(building.finishTime), allocator);
+        buildingObj.AddMember("isInitialConstruction", building.isInitialConstruction, allocator);
+        buildingObj.AddMember("currentHP", building.currentHP, allocator);
+        buildingsArray.PushBack(buildingObj, allocator);
+    }
+    doc.AddMember("buildings", buildingsArray, allocator);
+
+    CountingDocument::ValueType troopLevelsArray(rapidjson::kArrayType);
+    for (const auto& pair : data.troopLevels) {
+        CountingDocument::ValueType levelObj(rapidjson::kObjectType);
+        levelObj.AddMember("id", pair.first, allocator);
+        levelObj.AddMember("level", pair.second, allocator);
+        troopLevelsArray.PushBack(levelObj, allocator);
+    }
+    doc.AddMember("troopLevels", troopLevelsArray, allocator);
+
+    doc.AddMember("researchingTroopId", data.researchingTroopId, allocator);
+    doc.AddMember("researchFinishTime", static_cast<int64_t>(data.researchFinishTime), allocator);
+    doc.AddMember("journalGeneration", generation, allocator);
+
+    CountingStringBuffer buffer;
+    rapidjson::Writer<CountingStringBuffer, rapidjson::UTF8<>, rapidjson::UTF8<>, CountingAllocator> writer(buffer);
+    doc.Accept(writer);
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+bool loadWithDocument(const std::string& content, VillageSaveSnapshot& out, uint64_t& generation) {
+    CountingDocument doc;
+    doc.Parse(content.c_str());
+    if (doc.HasParseError()) return false;
+
+    VillageData& data = out.data;
+    if (doc.HasMember("gold") && doc["gold"].IsInt()) data.gold = doc["gold"].GetInt();
+    if (doc.HasMember("elixir") && doc["elixir"].IsInt()) data.elixir = doc["elixir"].GetInt();
+    if (doc.HasMember("gem") && doc["gem"].IsInt()) data.gem = doc["gem"].GetInt();
+    if (doc.HasMember("currentTheme") && doc["currentTheme"].IsInt()) out.currentThemeId = doc["currentTheme"].GetInt();
+
+    out.purchasedThemes.clear();
+    if (doc.HasMember("purchasedThemes") && doc["purchasedThemes"].IsArray()) {
+        const auto& arr = doc["purchasedThemes"];
+        for (rapidjson::SizeType i = 0; i < arr.Size(); i++) {
+            out.purchasedThemes.push_back(arr[i].GetInt());
+        }
+    }
+
+    data.troops.clear();
+    if (doc.HasMember("troops") && doc["troops"].IsArray()) {
+        const auto& troopsArray = doc["troops"];
+        for (rapidjson::SizeType i = 0; i < troopsArray.Size(); i++) {
+            data.troops[troopsArray[i]["id"].GetInt()] = troopsArray[i]["count"].GetInt();
+        }
+    }
+
+    data.buildings.clear();
+    if (doc.HasMember("buildings") && doc["buildings"].IsArray()) {
+        const auto& buildingsArray = doc["buildings"];
+        for (rapidjson::SizeType i = 0; i < buildingsArray.Size(); i++) {
+            const auto& buildingObj = buildingsArray[i];
+
+            BuildingInstance building;
+            building.id = buildingObj["id"].GetInt();
+            building.type = buildingObj["type"].GetInt();
+            building.level = buildingObj["level"].GetInt();
+            building.gridX = buildingObj["gridX"].GetInt();
+            building.gridY = buildingObj["gridY"].GetInt();
+            building.state = (BuildingInstance::State)buildingObj["state"].GetInt();
+            building.finishTime = buildingObj["finishTime"].GetInt64();
+            building.isInitialConstruction = buildingObj.HasMember("isInitialConstruction") &&
+                                             buildingObj["isInitialConstruction"].GetBool();
+            building.currentHP = (buildingObj.HasMember("currentHP") && buildingObj["currentHP"].IsInt())
+                                 ? buildingObj["currentHP"].GetInt() : VillageSaveCodec::MISSING_HP;
+            building.isDestroyed = false;
+            data.buildings.push_back(building);
+        }
+    }
+
+    data.troopLevels.clear();
+    if (doc.HasMember("troopLevels") && doc["troopLevels"].IsArray()) {
+        const auto& levelsArray = doc["troopLevels"];
+        for (rapidjson::SizeType i = 0; i < levelsArray.Size(); i++) {
+            data.troopLevels[levelsArray[i]["id"].GetInt()] = levelsArray[i]["level"].GetInt();
+        }
+    }
+
+    data.researchingTroopId = (doc.HasMember("researchingTroopId") && doc["researchingTroopId"].IsInt())
+                              ? doc["researchingTroopId"].GetInt() : -1;
+    data.researchFinishTime = (doc.HasMember("researchFinishTime") && doc["researchFinishTime"].IsInt64())
+                              ? doc["researchFinishTime"].GetInt64() : 0;
+    generation = (doc.HasMember("journalGeneration") && doc["journalGeneration"].IsUint64())
+                 ? doc["journalGeneration"].GetUint64() : 0;
+    return true;
+}
+
+// ========== 合成存档 ==========
+
+VillageSaveSnapshot makeSyntheticVillage(int buildingCount) {
+    static const int BUILDING_TYPES[] = { 1, 101, 102, 103, 104, 105, 201, 202, 203, 204, 205, 301, 302, 303, 401 };
+    const int typeCount = sizeof(BUILDING_TYPES) / sizeof(BUILDING_TYPES[0]);
+
+    VillageSaveSnapshot snapshot;
+    VillageData& data = snapshot.data;
+    data.gold = 1234567;
+    data.elixir = 7654321;
+    data.gem = 4321;
+    data.researchingTroopId = 3;
+    data.researchFinishTime = 1767225600LL;
+
+    data.buildings.reserve(buildingCount);
+    for (int i = 0; i < buildingCount; ++i) {
+        BuildingInstance building;
+        building.id = i + 1;
+        building.type = BUILDING_TYPES[i % typeCount];
+        building.level = 1 + i % 10;
+        building.gridX = (i * 3) % 200;
+        building.gridY = (i * 7) % 200;
+        building.state = (i % 17 == 0) ? BuildingInstance::State::CONSTRUCTING : BuildingInstance::State::BUILT;
+        building.finishTime = (i % 17 == 0) ? 1767225600LL + i : 0;
+        building.isInitialConstruction = (i % 34 == 0);
+        building.currentHP = 400 + (i % 50) * 37;
+        building.isDestroyed = false;
+        data.buildings.push_back(building);
+    }
+
+    for (int troopId = 1; troopId <= 6; ++troopId) {
+        data.troops[troopId] = troopId * 5;
+        data.troopLevels[troopId] = 1 + troopId % 4;
+    }
+
+    snapshot.currentThemeId = 2;
+    snapshot.purchasedThemes = { 1, 2, 3 };
+    return snapshot;
+}
+
+bool sameSnapshot(const VillageSaveSnapshot& a, const VillageSaveSnapshot& b) {
+    if (a.data.buildings.size() != b.data.buildings.size()) return false;
+    for (size_t i = 0; i < a.data.buildings.size(); ++i) {
+        const auto& x = a.data.buildings[i];
+        const auto& y = b.data.buildings[i];
+        if (x.id != y.id || x.type != y.type || x.level != y.level || x.gridX != y.gridX ||
+            x.gridY != y.gridY || x.state != y.state || x.finishTime != y.finishTime ||
+            x.isInitialConstruction != y.isInitialConstruction || x.currentHP != y.currentHP) {
+            return false;
+        }
+    }
+    return a.data.gold == b.data.gold && a.data.elixir == b.data.elixir && a.data.gem == b.data.gem &&
+           a.data.troops == b.data.troops && a.data.troopLevels == b.data.troopLevels &&
+           a.data.researchingTroopId == b.data.researchingTroopId &&
+           a.data.researchFinishTime == b.data.researchFinishTime &&
+           a.currentThemeId == b.currentThemeId && a.purchasedThemes == b.purchasedThemes;
+}
+
+// ========== 计时 ==========
+
+struct BenchResult {
+    double medianMs = 0.0;
+    size_t allocCalls = 0;      // 单次执行的分配次数
+    size_t allocBytes = 0;      // 单次执行的分配总量
+    size_t peakBytes = 0;       // 单次执行中相对起点的峰值占用
+};
+
+template <typename Func>
+BenchResult runBench(int runs, Func func) {
+    BenchResult result;
+    std::vector<double> times;
+    times.reserve(runs);
+
+    for (int i = 0; i < runs; ++i) {
+        AllocStats before = g_stats;
+        g_stats.peak = g_stats.live;
+
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto end = std::chrono::steady_clock::now();
+
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        result.allocCalls = g_stats.calls - before.calls;
+        result.allocBytes = g_stats.bytes - before.bytes;
+        result.peakBytes = g_stats.peak - before.live;
+    }
+
+    std::sort(times.begin(), times.end());
+    result.medianMs = times[times.size() / 2];
+    return result;
+}
+
+void printRow(const char* name, const BenchResult& result) {
+    std::printf("%-14s %10.3f %10zu %12.1f %12.1f\n", name, result.medianMs, result.allocCalls,
+                result.allocBytes / 1024.0, result.peakBytes / 1024.0);
+}
+
+void printUsage() {
+    std::cerr << "Usage: SaveBench [--buildings N] [--runs R]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int buildingCount = 2000;
+    int runs = 20;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--buildings" && i + 1 < argc) {
+            buildingCount = std::atoi(argv[++i]);
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (buildingCount <= 0 || runs <= 0) {
+        printUsage();
+        return 2;
+    }
+
+    const uint64_t generation = 7;
+    VillageSaveSnapshot village = makeSyntheticVillage(buildingCount);
+    std::string json = VillageSaveCodec::write(village, generation);
+
+    // 两种实现的结果必须一致
+    bool identical = saveWithDocument(village, generation) == json;
+    VillageSaveSnapshot domLoaded;
+    VillageSaveSnapshot saxLoaded;
+    uint64_t domGeneration = 0;
+    uint64_t saxGeneration = 0;
+    identical = loadWithDocument(json, domLoaded, domGeneration) && identical;
+    identical = VillageSaveCodec::read(json.data(), json.size(), saxLoaded, saxGeneration) && identical;
+    identical = identical && sameSnapshot(domLoaded, village) && sameSnapshot(saxLoaded, village) &&
+                domGeneration == generation && saxGeneration == generation;
+
+    std::printf("village: %d buildings, %.1f KB JSON, %d runs\n", buildingCount, json.size() / 1024.0, runs);
+    std::printf("%-14s %10s %10s %12s %12s\n", "", "median ms", "allocs", "alloc KB", "peak KB");
+
+    printRow("load DOM", runBench(runs, [&json]() {
+        VillageSaveSnapshot out;
+        uint64_t gen = 0;
+        loadWithDocument(json, out, gen);
+    }));
+    printRow("load SAX", runBench(runs, [&json]() {
+        VillageSaveSnapshot out;
+        uint64_t gen = 0;
+        VillageSaveCodec::read(json.data(), json.size(), out, gen);
+    }));
+    printRow("save DOM", runBench(runs, [&village, generation]() {
+        std::string out = saveWithDocument(village, generation);
+    }));
+    printRow("save stream", runBench(runs, [&village, generation]() {
+        std::string out = VillageSaveCodec::write(village, generation);
+    }));
+
+    if (!identical) {
+        std::cerr << "SaveBench: DOM and streaming results differ" << std::endl;
+        return 1;
+    }
+    return 0;
+}